@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * Benchmark of the adaptive window polynomial estimators: the
+ * classic and the recursive modes of AWLinEstimator and
+ * AWQuadEstimator are fed with the same synthetic joints signals
+ * (sinusoids plus steps plus gaussian noise, with a fixed seed),
+ * reporting the per-sample cost and the maximum deviation between
+ * the two modes.
+ *
+ * Usage: awPolyEstimatorBenchmark [joints] [samples]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include <yarp/sig/Vector.h>
+#include <iCub/ctrl/adaptWinPolyEstimator.h>
+
+using namespace std;
+using namespace yarp::sig;
+using namespace iCub::ctrl;
+
+
+/***************************************************************************/
+struct Result
+{
+    double nsPerSample;
+    vector<Vector> output;
+};
+
+
+/***************************************************************************/
+Result run(AWPolyEstimator &est, const vector<AWPolyElement> &input)
+{
+    Result res;
+    res.output.reserve(input.size());
+
+    auto t0=chrono::steady_clock::now();
+    for (auto &el:input)
+        res.output.push_back(est.estimate(el));
+    auto t1=chrono::steady_clock::now();
+
+    res.nsPerSample=chrono::duration<double,nano>(t1-t0).count()/input.size();
+    return res;
+}
+
+
+/***************************************************************************/
+double maxDeviation(const Result &r1, const Result &r2)
+{
+    double dev=0.0;
+    for (size_t k=0; k<r1.output.size(); k++)
+        for (size_t i=0; i<r1.output[k].length(); i++)
+            dev=std::max(dev,fabs(r1.output[k][i]-r2.output[k][i]));
+    return dev;
+}
+
+
+/***************************************************************************/
+void report(const char *name, AWPolyEstimator &classic,
+            AWPolyEstimator &recursive, const vector<AWPolyElement> &input)
+{
+    recursive.setRecursive(true);
+    Result r1=run(classic,input);
+    Result r2=run(recursive,input);
+
+    printf("%-16s classic %10.1f ns/sample | recursive %10.1f ns/sample | speedup %6.1fx | max deviation %g\n",
+           name,r1.nsPerSample,r2.nsPerSample,r1.nsPerSample/r2.nsPerSample,
+           maxDeviation(r1,r2));
+}
+
+
+/***************************************************************************/
+int main(int argc, char *argv[])
+{
+    int joints=(argc>1) ? atoi(argv[1]) : 32;
+    int samples=(argc>2) ? atoi(argv[2]) : 5000;
+
+    // 100 Hz thread with some jitter
+    mt19937 gen(0);
+    normal_distribution<double> noise(0.0,0.05);
+    uniform_real_distribution<double> jitter(-0.001,0.001);
+
+    vector<AWPolyElement> input;
+    input.reserve(samples);
+    double t=0.0;
+    for (int k=0; k<samples; k++)
+    {
+        t+=0.01+jitter(gen);
+        Vector x(joints);
+        for (int i=0; i<joints; i++)
+            x[i]=30.0*sin(0.3*(i+1)*t)+10.0*((k/250+i)%2)+noise(gen);
+        input.push_back(AWPolyElement(x,t));
+    }
+
+    printf("joints=%d samples=%d\n",joints,samples);
+
+    AWLinEstimator lin1(16,1.0),lin2(16,1.0);
+    report("AWLinEstimator",lin1,lin2,input);
+
+    AWQuadEstimator quad1(25,1.0),quad2(25,1.0);
+    report("AWQuadEstimator",quad1,quad2,input);
+
+    return 0;
+}
+
+
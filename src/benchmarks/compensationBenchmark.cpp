@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * Benchmark of the per-taxel compensation of the skinManager: the
+ * kernels compensate() and updateBaselines() are compared against
+ * the former loops of Compensator::readRawAndWriteCompensatedData()
+ * and Compensator::updateBaseline(), for a single hand port (192
+ * taxels), a forearm port (384 taxels) and the whole-body skin
+ * (4224 taxels), with every combination of the options. Both run
+ * on the same synthetic raw data (noise around the baselines, with
+ * presses coming and going and a slow drift) and all their outputs
+ * are compared bitwise at every cycle.
+ *
+ * Usage: compensationBenchmark [cycles]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+#include <yarp/sig/Vector.h>
+
+#include "iCub/skinManager/compensationKernel.h"
+
+using namespace std;
+using namespace yarp::sig;
+using namespace iCub::skinManager;
+
+const int MAX_SKIN=255;
+const double BIN_TOUCH=100.0;
+const double BIN_NO_TOUCH=0.0;
+
+
+/***************************************************************************/
+struct Options
+{
+    bool zeroUpRawData;
+    bool smoothFilter;
+    bool binarization;
+};
+
+
+/***************************************************************************/
+// the former per-taxel loops of the Compensator
+class LegacyCompensator
+{
+public:
+    unsigned int skinDim;
+    unsigned int addThreshold;
+    double compensationGain;
+    double contactCompensationGain;
+    float smoothFactor;
+    mutex smoothFactorSem;
+    Options opt;
+
+    vector<bool> touchDetected, touchDetectedFilt, subTouchDetected;
+    Vector rawData, touchThresholds, baselines;
+    Vector compensatedData, compensatedDataOld, compensatedDataFilt, out;
+
+    void readRawAndWriteCompensatedData()
+    {
+        double d;
+        for(unsigned int i=0; i<skinDim; i++){
+            d =  (double)( opt.zeroUpRawData ? rawData(i)-baselines[i] : MAX_SKIN-rawData(i)-baselines[i] );
+            d =   min<double>( MAX_SKIN, d);
+            compensatedData[i] = d;
+            touchDetected[i] = (d > touchThresholds[i] + addThreshold);
+            subTouchDetected[i] = (d < -touchThresholds[i] - addThreshold);
+            if(opt.smoothFilter){
+                lock_guard<mutex> lck(smoothFactorSem);
+                d = (1-smoothFactor)*d + smoothFactor*compensatedDataOld(i);
+                compensatedDataOld(i) = d;
+            }
+            compensatedDataFilt[i] = d;
+            touchDetectedFilt[i] = (d > touchThresholds[i] + addThreshold);
+            if(opt.binarization)
+                d = ( touchDetectedFilt[i] ? BIN_TOUCH : BIN_NO_TOUCH );
+            out[i] = max<double>(0.0, d);
+        }
+    }
+
+    void updateBaseline()
+    {
+        double mean_change = 0, change, gain;
+        unsigned int non_touching_taxels = 0;
+        double d;
+        for(unsigned int j=0; j<skinDim; j++) {
+            d = compensatedData(j);
+            if(touchDetected[j]){
+                gain            = contactCompensationGain*0.02;
+            }else{
+                gain            = compensationGain*0.02;
+                non_touching_taxels++;
+            }
+            change          = gain*d/touchThresholds[j];
+            baselines[j]    += change;
+            mean_change     += change;
+        }
+    }
+};
+
+
+/***************************************************************************/
+// the kernels, as driven by the Compensator
+class KernelCompensator
+{
+public:
+    unsigned int skinDim;
+    unsigned int addThreshold;
+    double compensationGain;
+    double contactCompensationGain;
+    float smoothFactor;
+    mutex smoothFactorSem;
+    Options opt;
+
+    vector<unsigned char> touchDetected, touchDetectedFilt, subTouchDetected;
+    Vector rawData, touchThresholds, baselines;
+    Vector compensatedData, compensatedDataOld, compensatedDataFilt, out;
+
+    void readRawAndWriteCompensatedData()
+    {
+        CompensationParams p;
+        p.maxSkin=MAX_SKIN;
+        p.addThreshold=addThreshold;
+        p.binTouch=BIN_TOUCH;
+        p.binNoTouch=BIN_NO_TOUCH;
+        p.zeroUpRawData=opt.zeroUpRawData;
+        p.binarization=opt.binarization;
+        p.smoothFilter=opt.smoothFilter;
+        {
+            lock_guard<mutex> lck(smoothFactorSem);
+            p.smoothFactor=smoothFactor;
+        }
+
+        CompensationBuffers b;
+        b.raw=rawData.data();
+        b.baselines=baselines.data();
+        b.thresholds=touchThresholds.data();
+        b.compensated=compensatedData.data();
+        b.compensatedOld=compensatedDataOld.data();
+        b.compensatedFilt=compensatedDataFilt.data();
+        b.output=out.data();
+        b.touch=touchDetected.data();
+        b.subTouch=subTouchDetected.data();
+        b.touchFilt=touchDetectedFilt.data();
+        compensate(skinDim,p,b);
+    }
+
+    void updateBaseline()
+    {
+        updateBaselines(skinDim,compensationGain*0.02,contactCompensationGain*0.02,
+                        compensatedData.data(),touchDetected.data(),
+                        touchThresholds.data(),baselines.data());
+    }
+};
+
+
+/***************************************************************************/
+template<class T>
+void setup(T &c, const unsigned int n, const Options &opt,
+           const Vector &baselines, const Vector &thresholds)
+{
+    c.skinDim=n;
+    c.addThreshold=2;
+    c.compensationGain=0.2;
+    c.contactCompensationGain=0.05;
+    c.smoothFactor=0.5f;
+    c.opt=opt;
+    c.touchDetected.assign(n,0);
+    c.touchDetectedFilt.assign(n,0);
+    c.subTouchDetected.assign(n,0);
+    c.rawData.resize(n,0.0);
+    c.touchThresholds=thresholds;
+    c.baselines=baselines;
+    c.compensatedData.resize(n,0.0);
+    c.compensatedDataOld=baselines;
+    c.compensatedDataFilt.resize(n,0.0);
+    c.out.resize(n,0.0);
+}
+
+
+/***************************************************************************/
+bool sameBits(const Vector &a, const Vector &b)
+{
+    return (a.size()==b.size()) && (memcmp(a.data(),b.data(),a.size()*sizeof(double))==0);
+}
+
+
+/***************************************************************************/
+template<class F>
+bool sameFlags(const vector<bool> &a, const F &b)
+{
+    for (size_t i=0; i<a.size(); i++)
+        if (a[i]!=(b[i]!=0))
+            return false;
+    return true;
+}
+
+
+/***************************************************************************/
+void run(const unsigned int n, const Options &opt, const int cycles)
+{
+    mt19937 gen(n);
+    auto uniform=[&gen]() { return gen()/4294967296.0; };
+
+    // calibration
+    Vector baselines(n), thresholds(n);
+    for (unsigned int i=0; i<n; i++)
+    {
+        baselines[i]=20.0+200.0*uniform();
+        thresholds[i]=1.0+6.0*uniform();
+    }
+
+    // raw data of all the cycles: noise around the baselines, presses
+    // over a tenth of the taxels coming and going, and a slow drift
+    vector<Vector> raw(cycles,Vector(n));
+    for (int k=0; k<cycles; k++)
+    {
+        bool pressed=((k/25)%2==1);
+        for (unsigned int i=0; i<n; i++)
+        {
+            double v=baselines[i]+(uniform()-0.5)*4.0+0.002*k;
+            if (pressed && (i%10==0))
+                v+=30.0+20.0*uniform();
+            v=std::max(0.0,std::min((double)MAX_SKIN,floor(v+0.5)));
+            raw[k][i]=opt.zeroUpRawData ? v : MAX_SKIN-v;
+        }
+    }
+
+    LegacyCompensator legacy;
+    KernelCompensator kernel;
+    setup(legacy,n,opt,baselines,thresholds);
+    setup(kernel,n,opt,baselines,thresholds);
+
+    bool identical=true;
+    double tLegacy=0.0, tKernel=0.0;
+    for (int k=0; k<cycles; k++)
+    {
+        legacy.rawData=raw[k];
+        kernel.rawData=raw[k];
+
+        auto t0=chrono::steady_clock::now();
+        legacy.readRawAndWriteCompensatedData();
+        legacy.updateBaseline();
+        auto t1=chrono::steady_clock::now();
+        kernel.readRawAndWriteCompensatedData();
+        kernel.updateBaseline();
+        auto t2=chrono::steady_clock::now();
+
+        tLegacy+=chrono::duration<double,micro>(t1-t0).count();
+        tKernel+=chrono::duration<double,micro>(t2-t1).count();
+
+        identical=identical && sameBits(legacy.out,kernel.out) &&
+                  sameBits(legacy.baselines,kernel.baselines) &&
+                  sameBits(legacy.compensatedData,kernel.compensatedData) &&
+                  sameBits(legacy.compensatedDataOld,kernel.compensatedDataOld) &&
+                  sameBits(legacy.compensatedDataFilt,kernel.compensatedDataFilt) &&
+                  sameFlags(legacy.touchDetected,kernel.touchDetected) &&
+                  sameFlags(legacy.subTouchDetected,kernel.subTouchDetected) &&
+                  sameFlags(legacy.touchDetectedFilt,kernel.touchDetectedFilt);
+    }
+
+    printf("taxels=%-5u zeroUp=%d smooth=%d binarize=%d legacy %8.2f us | kernel %8.2f us | speedup %5.1fx | %s\n",
+           n,opt.zeroUpRawData,opt.smoothFilter,opt.binarization,
+           tLegacy/cycles,tKernel/cycles,tLegacy/tKernel,
+           identical?"identical":"MISMATCH");
+}
+
+
+/***************************************************************************/
+int main(int argc, char *argv[])
+{
+    int cycles=(argc>1) ? atoi(argv[1]) : 1000;
+
+    for (unsigned int n : {192u,384u,4224u})
+    {
+        for (int o=0; o<8; o++)
+        {
+            Options opt;
+            opt.zeroUpRawData=((o&4)!=0);
+            opt.smoothFilter=((o&2)!=0);
+            opt.binarization=((o&1)!=0);
+            run(n,opt,cycles);
+        }
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,509 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * Benchmark suite of the computations running within the control
+ * loops: iKin forward kinematics and inverse kinematics, iDyn
+ * Newton-Euler, mass matrix and whole-body solve, ctrlLib
+ * estimators, filters and minimum jerk generators.
+ *
+ * All the inputs are drawn beforehand from generators with fixed
+ * seeds, so that two runs process the very same data. Each
+ * operation is timed on its own, and the heap allocations it
+ * performs are counted by replacing the global operator new.
+ *
+ * The results are printed one line per benchmark either as JSON
+ * objects (the default) or as CSV, with the fields:
+ * name, samples, ns_per_op, allocs_per_op, p50_ns, p90_ns, p99_ns
+ * and max_ns.
+ *
+ * Usage: hotPathsBenchmark [samples] [json|csv] [filter]
+ * where filter restricts the run to the benchmarks whose name
+ * contains the given string.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+
+#include <iCub/ctrl/math.h>
+#include <iCub/ctrl/filters.h>
+#include <iCub/ctrl/minJerkCtrl.h>
+#include <iCub/ctrl/adaptWinPolyEstimator.h>
+#include <iCub/iKin/iKinFwd.h>
+#ifdef BENCHMARK_IPOPT
+    #include <iCub/iKin/iKinIpOpt.h>
+#endif
+#include <iCub/iDyn/iDyn.h>
+#include <iCub/iDyn/iDynBody.h>
+
+using namespace std;
+using namespace yarp::sig;
+using namespace iCub::ctrl;
+using namespace iCub::iKin;
+using namespace iCub::iDyn;
+using namespace iCub::skinDynLib;
+
+
+/***************************************************************************/
+static atomic<uint64_t> allocations(0);
+
+void *operator new(size_t size)
+{
+    allocations.fetch_add(1,memory_order_relaxed);
+    if (void *p=malloc(size>0?size:1))
+        return p;
+    throw bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    allocations.fetch_add(1,memory_order_relaxed);
+    if (void *p=malloc(size>0?size:1))
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+
+/***************************************************************************/
+struct Stats
+{
+    string name;
+    size_t samples;
+    double nsPerOp;
+    double allocsPerOp;
+    double p50,p90,p99,max;
+};
+
+
+/***************************************************************************/
+class Suite
+{
+    size_t samples;
+    bool csv;
+    string filter;
+
+    double percentile(const vector<double> &sorted, const double p) const
+    {
+        // nearest-rank definition
+        size_t rank=(size_t)ceil(p*sorted.size());
+        return sorted[std::max(rank,(size_t)1)-1];
+    }
+
+public:
+    Suite(const size_t _samples, const bool _csv, const string &_filter) :
+          samples(_samples), csv(_csv), filter(_filter)
+    {
+        if (csv)
+            printf("name,samples,ns_per_op,allocs_per_op,p50_ns,p90_ns,p99_ns,max_ns\n");
+    }
+
+    size_t getSamples() const { return samples; }
+
+    bool enabled(const string &name) const
+    {
+        return (name.find(filter)!=string::npos);
+    }
+
+    // prepare(k) sets up the inputs of the k-th operation outside
+    // of the timed region, op(k) is the operation being measured;
+    // the first operations warm up caches and lazily allocated
+    // buffers and do not enter the statistics
+    template<class Prepare, class Op>
+    void run(const string &name, const size_t n, Prepare prepare, Op op)
+    {
+        if (!enabled(name))
+            return;
+
+        size_t warmup=std::min(n/10,(size_t)100);
+        if (n<=warmup)
+            return;
+
+        vector<double> dt;
+        dt.reserve(n-warmup);
+        uint64_t allocs=0;
+        for (size_t k=0; k<n; k++)
+        {
+            prepare(k);
+            uint64_t a0=allocations.load(memory_order_relaxed);
+            auto t0=chrono::steady_clock::now();
+            op(k);
+            auto t1=chrono::steady_clock::now();
+            uint64_t a1=allocations.load(memory_order_relaxed);
+            if (k>=warmup)
+            {
+                allocs+=a1-a0;
+                dt.push_back(chrono::duration<double,nano>(t1-t0).count());
+            }
+        }
+        Stats s;
+        s.name=name;
+        s.samples=dt.size();
+        s.nsPerOp=0.0;
+        for (auto &t:dt)
+            s.nsPerOp+=t;
+        s.nsPerOp/=s.samples;
+        s.allocsPerOp=(double)allocs/s.samples;
+
+        sort(dt.begin(),dt.end());
+        s.p50=percentile(dt,0.50);
+        s.p90=percentile(dt,0.90);
+        s.p99=percentile(dt,0.99);
+        s.max=dt.back();
+        print(s);
+    }
+
+    template<class Op>
+    void run(const string &name, const size_t n, Op op)
+    {
+        run(name,n,[](const size_t){},op);
+    }
+
+    void print(const Stats &s) const
+    {
+        if (csv)
+            printf("%s,%zu,%.1f,%.2f,%.1f,%.1f,%.1f,%.1f\n",
+                   s.name.c_str(),s.samples,s.nsPerOp,s.allocsPerOp,
+                   s.p50,s.p90,s.p99,s.max);
+        else
+            printf("{\"name\": \"%s\", \"samples\": %zu, \"ns_per_op\": %.1f, \"allocs_per_op\": %.2f, "
+                   "\"p50_ns\": %.1f, \"p90_ns\": %.1f, \"p99_ns\": %.1f, \"max_ns\": %.1f}\n",
+                   s.name.c_str(),s.samples,s.nsPerOp,s.allocsPerOp,
+                   s.p50,s.p90,s.p99,s.max);
+        fflush(stdout);
+    }
+};
+
+
+/***************************************************************************/
+// raw engine output is used in place of the std distributions,
+// whose sequences are implementation-defined
+double uniform(mt19937 &gen, const double lo, const double hi)
+{
+    return lo+(hi-lo)*(gen()/4294967296.0);
+}
+
+
+/***************************************************************************/
+Vector uniform(mt19937 &gen, const size_t n, const double lo, const double hi)
+{
+    Vector v(n);
+    for (size_t i=0; i<n; i++)
+        v[i]=uniform(gen,lo,hi);
+    return v;
+}
+
+
+/***************************************************************************/
+vector<Vector> randomConfs(iKinChain &chain, const size_t n, const unsigned int seed)
+{
+    mt19937 gen(seed);
+    vector<Vector> Q(n,Vector(chain.getDOF()));
+    for (auto &q:Q)
+        for (unsigned int i=0; i<chain.getDOF(); i++)
+            q[i]=uniform(gen,chain(i).getMin(),chain(i).getMax());
+    return Q;
+}
+
+
+/***************************************************************************/
+void benchKinematics(Suite &suite, const string &limb, iKinLimb &lmb)
+{
+    iKinChain &chain=*lmb.asChain();
+    vector<Vector> Q=randomConfs(chain,suite.getSamples(),1);
+    const string prefix="iKin/"+limb+"/";
+
+    Matrix H;
+    suite.run(prefix+"getH",Q.size(),[&](const size_t k){
+        H=chain.getH(Q[k]);
+    });
+
+    Matrix J;
+    suite.run(prefix+"GeoJacobian",Q.size(),[&](const size_t k){
+        J=chain.GeoJacobian(Q[k]);
+    });
+
+    Vector x;
+    suite.run(prefix+"EndEffPose",Q.size(),[&](const size_t k){
+        x=chain.EndEffPose(Q[k]);
+    });
+
+    iKinHMatrix Hf;
+    suite.run(prefix+"fastGetH",Q.size(),[&](const size_t k){
+        chain.setAng(Q[k]);
+        chain.fastGetH(Hf);
+    });
+
+    Matrix Jf(6,chain.getDOF());
+    suite.run(prefix+"fastGeoJacobian",Q.size(),[&](const size_t k){
+        chain.setAng(Q[k]);
+        chain.fastGeoJacobian(Jf);
+    });
+
+    Vector xf(7);
+    suite.run(prefix+"fastEndEffPose",Q.size(),[&](const size_t k){
+        chain.setAng(Q[k]);
+        chain.fastEndEffPose(xf);
+    });
+}
+
+
+/***************************************************************************/
+#ifdef BENCHMARK_IPOPT
+void benchInverseKinematics(Suite &suite)
+{
+    iCubArm arm("right");
+    iKinChain &chain=*arm.asChain();
+    chain.releaseLink(0);
+    chain.releaseLink(1);
+    chain.releaseLink(2);
+
+    // targets are reachable poses, the solver always
+    // starts from the same configuration
+    size_t n=std::max(suite.getSamples()/50,(size_t)10);
+    vector<Vector> Q=randomConfs(chain,n,2);
+    vector<Vector> X;
+    for (auto &q:Q)
+        X.push_back(chain.EndEffPose(q));
+
+    Vector q0(chain.getDOF(),0.0);
+    chain.setAng(q0);
+
+    iKinIpOptMin slv(chain,IKINCTRL_POSE_FULL,1e-3,1e-6,200);
+    Vector qd;
+    suite.run("iKin/arm/iKinIpOptMin::solve",n,[&](const size_t k){
+        qd=slv.solve(q0,X[k]);
+    });
+}
+#endif
+
+
+/***************************************************************************/
+void benchDynamics(Suite &suite, const string &limb, iDynLimb &lmb)
+{
+    iDynChain &chain=*lmb.asChain();
+    chain.prepareNewtonEuler(DYNAMIC);
+    const string prefix="iDyn/"+limb+"/";
+
+    size_t n=suite.getSamples();
+    vector<Vector> Q=randomConfs(chain,n,3);
+    mt19937 gen(4);
+    vector<Vector> dQ,d2Q;
+    for (size_t k=0; k<n; k++)
+    {
+        dQ.push_back(uniform(gen,chain.getDOF(),-1.0,1.0));
+        d2Q.push_back(uniform(gen,chain.getDOF(),-2.0,2.0));
+    }
+
+    Vector w0(3,0.0),dw0(3,0.0),ddp0(3,0.0);
+    Vector Fend(3,0.0),Muend(3,0.0);
+    ddp0[2]=9.81;
+
+    suite.run(prefix+"computeNewtonEuler",n,
+              [&](const size_t k){
+                  chain.setAng(Q[k]);
+                  chain.setDAng(dQ[k]);
+                  chain.setD2Ang(d2Q[k]);
+              },
+              [&](const size_t){
+                  chain.computeNewtonEuler(w0,dw0,ddp0,Fend,Muend);
+              });
+
+    Matrix M;
+    suite.run(prefix+"computeMassMatrix",n,[&](const size_t k){
+        M=chain.computeMassMatrix(Q[k]);
+    });
+}
+
+
+/***************************************************************************/
+void benchWholeBody(Suite &suite)
+{
+    iCubWholeBody icub(version_tag(),DYNAMIC,NO_VERBOSE);
+
+    iDynSensorTorsoNode *nodes[]={icub.upperTorso,icub.upperTorso,icub.upperTorso,
+                                  icub.lowerTorso,icub.lowerTorso,icub.lowerTorso};
+    const string limbs[]={"head","left_arm","right_arm",
+                          "torso","left_leg","right_leg"};
+
+    // configurations of all the limbs, the sensors measurements
+    // and the inertial readings are drawn beforehand
+    size_t n=std::max(suite.getSamples()/10,(size_t)10);
+    mt19937 gen(5);
+    struct Input
+    {
+        vector<Vector> q,dq,d2q;
+        Vector w0,dw0,ddp0;
+        Vector FM_rarm,FM_larm,FM_rleg,FM_lleg;
+    };
+    vector<Input> inputs(n);
+    for (auto &in:inputs)
+    {
+        for (int i=0; i<6; i++)
+        {
+            size_t dof=nodes[i]->getAng(limbs[i]).length();
+            in.q.push_back(uniform(gen,dof,-0.5,0.5));
+            in.dq.push_back(uniform(gen,dof,-1.0,1.0));
+            in.d2q.push_back(uniform(gen,dof,-2.0,2.0));
+        }
+        in.w0=uniform(gen,3,-0.1,0.1);
+        in.dw0=uniform(gen,3,-0.1,0.1);
+        in.ddp0=uniform(gen,3,-0.5,0.5);
+        in.ddp0[2]+=9.81;
+        in.FM_rarm=uniform(gen,6,-2.0,2.0);
+        in.FM_larm=uniform(gen,6,-2.0,2.0);
+        in.FM_rleg=uniform(gen,6,-20.0,20.0);
+        in.FM_lleg=uniform(gen,6,-20.0,20.0);
+    }
+
+    Vector FM_up(6,0.0);
+    suite.run("iDyn/wholeBody/solve",n,
+              [&](const size_t k){
+                  Input &in=inputs[k];
+                  for (int i=0; i<6; i++)
+                  {
+                      nodes[i]->setAng(limbs[i],in.q[i]);
+                      nodes[i]->setDAng(limbs[i],in.dq[i]);
+                      nodes[i]->setD2Ang(limbs[i],in.d2q[i]);
+                  }
+                  icub.upperTorso->setInertialMeasure(in.w0,in.dw0,in.ddp0);
+                  icub.upperTorso->setSensorMeasurement(in.FM_rarm,in.FM_larm,FM_up);
+              },
+              [&](const size_t k){
+                  icub.solve(inputs[k].FM_rleg,inputs[k].FM_lleg);
+              });
+}
+
+
+/***************************************************************************/
+void benchControl(Suite &suite)
+{
+    const size_t dim=16;
+    size_t n=suite.getSamples();
+
+    // joints signals sampled at 100 Hz with some jitter
+    mt19937 gen(6);
+    vector<Vector> U;
+    vector<double> stamps;
+    double t=0.0;
+    for (size_t k=0; k<n; k++)
+    {
+        t+=0.01+uniform(gen,-0.001,0.001);
+        Vector u(dim);
+        for (size_t i=0; i<dim; i++)
+            u[i]=30.0*sin(0.3*(i+1)*t)+10.0*((k/250+i)%2)+uniform(gen,-0.1,0.1);
+        U.push_back(u);
+        stamps.push_back(t);
+    }
+
+    vector<AWPolyElement> elements;
+    for (size_t k=0; k<n; k++)
+        elements.push_back(AWPolyElement(U[k],stamps[k]));
+
+    Vector y;
+    AWLinEstimator linEst(16,1.0);
+    suite.run("ctrl/AWLinEstimator",n,[&](const size_t k){
+        y=linEst.estimate(elements[k]);
+    });
+
+    AWLinEstimator linEstRec(16,1.0);
+    linEstRec.setRecursive(true);
+    suite.run("ctrl/AWLinEstimator/recursive",n,[&](const size_t k){
+        y=linEstRec.estimate(elements[k]);
+    });
+
+    // 2nd order low-pass with cut-off frequency at 5 Hz
+    Vector num(3),den(3);
+    num[0]=0.0201; num[1]=0.0402; num[2]=0.0201;
+    den[0]=1.0;    den[1]=-1.5610; den[2]=0.6414;
+    Filter filter(num,den,U[0]);
+    suite.run("ctrl/Filter",n,[&](const size_t k){
+        filter.filt(U[k]);
+    });
+
+    FirstOrderLowPassFilter lowPass(5.0,0.01,U[0]);
+    suite.run("ctrl/FirstOrderLowPassFilter",n,[&](const size_t k){
+        lowPass.filt(U[k]);
+    });
+
+    MedianFilter median(5,U[0]);
+    suite.run("ctrl/MedianFilter",n,[&](const size_t k){
+        median.filt(U[k]);
+    });
+
+    RateLimiter limiter(Vector(dim,-1.0),Vector(dim,1.0));
+    limiter.init(U[0]);
+    suite.run("ctrl/RateLimiter",n,[&](const size_t k){
+        limiter.filt(U[k]);
+    });
+
+    minJerkTrajGen trajGen(U[0],0.01,1.0);
+    suite.run("ctrl/minJerkTrajGen",n,[&](const size_t k){
+        trajGen.computeNextValues(U[k]);
+    });
+
+    minJerkTrajGenSoA trajGenSoA(U[0],0.01,1.0);
+    suite.run("ctrl/minJerkTrajGenSoA",n,[&](const size_t k){
+        trajGenSoA.computeNextValues(U[k]);
+    });
+}
+
+
+/***************************************************************************/
+int main(int argc, char *argv[])
+{
+    int samples=(argc>1) ? atoi(argv[1]) : 10000;
+    string format=(argc>2) ? argv[2] : "json";
+    string filter=(argc>3) ? argv[3] : "";
+
+    Suite suite(std::max(samples,1),format=="csv",filter);
+
+    iCubArm arm("right");
+    iCubLeg leg("right");
+    benchKinematics(suite,"arm",arm);
+    benchKinematics(suite,"leg",leg);
+
+#ifdef BENCHMARK_IPOPT
+    if (suite.enabled("iKin/arm/iKinIpOptMin::solve"))
+        benchInverseKinematics(suite);
+#endif
+
+    iCubArmDyn armDyn("right");
+    iCubLegDyn legDyn("right");
+    benchDynamics(suite,"arm",armDyn);
+    benchDynamics(suite,"leg",legDyn);
+
+    if (suite.enabled("iDyn/wholeBody/solve"))
+        benchWholeBody(suite);
+
+    benchControl(suite);
+
+    return 0;
+}
+
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * Benchmark of the minimum jerk generators: minJerkTrajGen,
+ * minJerkRefGen and minJerkVelCtrlForIdealPlant are compared
+ * against their structure-of-arrays counterparts, which are fed
+ * with the same sequence of set-points (random steps with a fixed
+ * seed), reporting the per-step cost and the maximum deviation
+ * between the outputs.
+ *
+ * Usage: minJerkBenchmark [joints] [steps]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include <yarp/sig/Vector.h>
+#include <iCub/ctrl/minJerkCtrl.h>
+
+using namespace std;
+using namespace yarp::sig;
+using namespace iCub::ctrl;
+
+
+/***************************************************************************/
+struct Result
+{
+    double nsPerStep;
+    vector<double> output;
+};
+
+
+/***************************************************************************/
+void store(Result &res, const size_t k, const Vector &pos,
+           const Vector &vel, const Vector &acc)
+{
+    size_t dim=pos.length();
+    double *out=&res.output[3*dim*k];
+    copy(pos.data(),pos.data()+dim,out);
+    copy(vel.data(),vel.data()+dim,out+dim);
+    copy(acc.data(),acc.data()+dim,out+2*dim);
+}
+
+
+/***************************************************************************/
+template<class Gen>
+Result runTraj(Gen &gen, const vector<Vector> &input)
+{
+    Result res;
+    res.output.resize(3*input[0].length()*input.size());
+
+    auto t0=chrono::steady_clock::now();
+    for (size_t k=0; k<input.size(); k++)
+    {
+        gen.computeNextValues(input[k]);
+        store(res,k,gen.getPos(),gen.getVel(),gen.getAcc());
+    }
+    auto t1=chrono::steady_clock::now();
+
+    res.nsPerStep=chrono::duration<double,nano>(t1-t0).count()/input.size();
+    return res;
+}
+
+
+/***************************************************************************/
+template<class Gen>
+Result runRef(Gen &gen, const vector<Vector> &input, const vector<Vector> &fb)
+{
+    Result res;
+    res.output.resize(3*input[0].length()*input.size());
+
+    auto t0=chrono::steady_clock::now();
+    for (size_t k=0; k<input.size(); k++)
+    {
+        gen.computeNextValues(fb[k],input[k]);
+        store(res,k,gen.getPos(),gen.getVel(),gen.getAcc());
+    }
+    auto t1=chrono::steady_clock::now();
+
+    res.nsPerStep=chrono::duration<double,nano>(t1-t0).count()/input.size();
+    return res;
+}
+
+
+/***************************************************************************/
+template<class Ctrl>
+Result runVel(Ctrl &ctrl, const double T, const vector<Vector> &input,
+              const vector<Vector> &fb)
+{
+    size_t dim=input[0].length();
+    Result res;
+    res.output.resize(dim*input.size());
+
+    Vector e(dim);
+    auto t0=chrono::steady_clock::now();
+    for (size_t k=0; k<input.size(); k++)
+    {
+        for (size_t i=0; i<dim; i++)
+            e[i]=input[k][i]-fb[k][i];
+        Vector cmd=ctrl.computeCmd(T,e);
+        copy(cmd.data(),cmd.data()+dim,&res.output[dim*k]);
+    }
+    auto t1=chrono::steady_clock::now();
+
+    res.nsPerStep=chrono::duration<double,nano>(t1-t0).count()/input.size();
+    return res;
+}
+
+
+/***************************************************************************/
+void report(const char *name, const Result &r1, const Result &r2)
+{
+    double dev=0.0;
+    for (size_t i=0; i<r1.output.size(); i++)
+        dev=std::max(dev,fabs(r1.output[i]-r2.output[i]));
+
+    printf("%-16s legacy %10.1f ns/step | SoA %10.1f ns/step | speedup %6.1fx | max deviation %g\n",
+           name,r1.nsPerStep,r2.nsPerStep,r1.nsPerStep/r2.nsPerStep,dev);
+}
+
+
+/***************************************************************************/
+int main(int argc, char *argv[])
+{
+    int joints=(argc>1) ? atoi(argv[1]) : 16;
+    int steps=(argc>2) ? atoi(argv[2]) : 20000;
+
+    // 100 Hz thread with a new set-point every 2 seconds
+    const double Ts=0.01;
+    const double T=1.0;
+    mt19937 gen(0);
+    uniform_real_distribution<double> target(-60.0,60.0);
+    normal_distribution<double> noise(0.0,0.1);
+
+    vector<Vector> input,fb;
+    input.reserve(steps);
+    fb.reserve(steps);
+    Vector xd(joints,0.0);
+    for (int k=0; k<steps; k++)
+    {
+        if (k%200==0)
+            for (int i=0; i<joints; i++)
+                xd[i]=target(gen);
+        input.push_back(xd);
+
+        // the feedback lags behind the set-point
+        Vector x(joints);
+        for (int i=0; i<joints; i++)
+            x[i]=input[std::max(k-50,0)][i]+noise(gen);
+        fb.push_back(x);
+    }
+
+    printf("joints=%d steps=%d\n",joints,steps);
+
+    Vector x0(joints,0.0);
+    minJerkTrajGen traj1(x0,Ts,T);
+    minJerkTrajGenSoA traj2(x0,Ts,T);
+    Result rt1=runTraj(traj1,input);
+    Result rt2=runTraj(traj2,input);
+    report("minJerkTrajGen",rt1,rt2);
+
+    minJerkRefGen ref1(x0,Ts,T);
+    minJerkRefGenSoA ref2(x0,Ts,T);
+    Result rr1=runRef(ref1,input,fb);
+    Result rr2=runRef(ref2,input,fb);
+    report("minJerkRefGen",rr1,rr2);
+
+    minJerkVelCtrlForIdealPlant vel1(Ts,joints);
+    minJerkVelCtrlForIdealPlantSoA vel2(Ts,joints);
+    Result rv1=runVel(vel1,T,input,fb);
+    Result rv2=runVel(vel2,T,input,fb);
+    report("minJerkVelCtrl",rv1,rv2);
+
+    return 0;
+}
+
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * Contention benchmark of the data exchange among the gaze
+ * controller threads: one writer updates joints, fixation point
+ * and velocities as the controller does, while a number of readers
+ * fetch them as the solver, the localizer and the RPC thread do.
+ * Two schemes are compared:
+ * - one mutex per field with getters returning heap copies, i.e.
+ *   the former ExchangeData;
+ * - a SeqLock over a fixed-size structure read as one snapshot.
+ *
+ * For both, the read and write latencies are reported as
+ * percentiles, along with the number of reads whose fields came
+ * from different writer cycles (torn reads).
+ *
+ * Usage: seqLockBenchmark [readers] [seconds]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <yarp/sig/Vector.h>
+#include <iCub/ctrl/seqLock.h>
+
+using namespace std;
+using namespace yarp::sig;
+using namespace iCub::ctrl;
+
+#define MAXLEN  8
+
+
+/***************************************************************************/
+struct FixedVector
+{
+    double data[MAXLEN];
+    size_t len;
+};
+
+
+/***************************************************************************/
+struct State
+{
+    FixedVector x,q,torso,v;
+    double S[16];
+};
+
+
+/***************************************************************************/
+class MutexExchange
+{
+    mutex mtx[4];
+    Vector x,q,torso,v;
+
+public:
+    MutexExchange() : x(3,0.0), q(6,0.0), torso(3,0.0), v(6,0.0) { }
+
+    void write(const double k)
+    {
+        { lock_guard<mutex> lg(mtx[0]); x=k;     }
+        { lock_guard<mutex> lg(mtx[1]); q=k;     }
+        { lock_guard<mutex> lg(mtx[2]); torso=k; }
+        { lock_guard<mutex> lg(mtx[3]); v=k;     }
+    }
+
+    bool read()
+    {
+        Vector _x,_q,_torso;
+        { lock_guard<mutex> lg(mtx[0]); _x=x;         }
+        { lock_guard<mutex> lg(mtx[1]); _q=q;         }
+        { lock_guard<mutex> lg(mtx[2]); _torso=torso; }
+        return (_x[0]==_q[0]) && (_q[0]==_torso[0]);
+    }
+};
+
+
+/***************************************************************************/
+class SeqLockExchange
+{
+    SeqLock<State> state;
+
+public:
+    SeqLockExchange()
+    {
+        state.update([](State &s)
+        {
+            s.x.len=3; s.q.len=6; s.torso.len=3; s.v.len=6;
+        });
+    }
+
+    void write(const double k)
+    {
+        state.update([k](State &s)
+        {
+            fill(s.x.data,s.x.data+s.x.len,k);
+            fill(s.q.data,s.q.data+s.q.len,k);
+            fill(s.torso.data,s.torso.data+s.torso.len,k);
+            fill(s.v.data,s.v.data+s.v.len,k);
+        });
+    }
+
+    bool read()
+    {
+        State s;
+        state.read(s);
+        return (s.x.data[0]==s.q.data[0]) && (s.q.data[0]==s.torso.data[0]);
+    }
+};
+
+
+/***************************************************************************/
+struct Stats
+{
+    vector<double> latencies;
+    size_t ops=0;
+    size_t torn=0;
+};
+
+
+/***************************************************************************/
+double percentile(vector<double> &l, const double p)
+{
+    if (l.empty())
+        return 0.0;
+
+    size_t n=std::min((size_t)(p*l.size()),l.size()-1);
+    nth_element(l.begin(),l.begin()+n,l.end());
+    return l[n];
+}
+
+
+/***************************************************************************/
+void print(const char *scheme, const char *role, Stats &stats,
+           const double seconds)
+{
+    vector<double> &l=stats.latencies;
+    double rate=stats.ops/seconds;
+    double p50=percentile(l,0.5);
+    double p99=percentile(l,0.99);
+    double p999=percentile(l,0.999);
+    double max=l.empty() ? 0.0 : *max_element(l.begin(),l.end());
+    printf("%-8s %-6s %12.0f op/s | p50 %8.0f ns | p99 %8.0f ns | p99.9 %8.0f ns | max %10.0f ns | torn %zu\n",
+           scheme,role,rate,p50,p99,p999,max,stats.torn);
+}
+
+
+/***************************************************************************/
+template<typename Exchange>
+void run(const char *scheme, const int readers, const double seconds)
+{
+    Exchange exchange;
+    atomic<bool> stop(false);
+    vector<Stats> readStats(readers);
+    Stats writeStats;
+
+    auto measure=[](vector<double> &l, chrono::steady_clock::time_point t0)
+    {
+        l.push_back(chrono::duration<double,nano>(chrono::steady_clock::now()-t0).count());
+    };
+
+    // the writer runs as fast as it can to maximize the contention;
+    // latencies are sampled up to the reserved capacity
+    thread writer([&]()
+    {
+        writeStats.latencies.reserve(1<<20);
+        double k=0.0;
+        while (!stop)
+        {
+            auto t0=chrono::steady_clock::now();
+            exchange.write(k+=1.0);
+            writeStats.ops++;
+            if (writeStats.latencies.size()<writeStats.latencies.capacity())
+                measure(writeStats.latencies,t0);
+        }
+    });
+
+    vector<thread> threads;
+    for (int i=0; i<readers; i++)
+    {
+        threads.push_back(thread([&,i]()
+        {
+            Stats &stats=readStats[i];
+            stats.latencies.reserve(1<<20);
+            while (!stop)
+            {
+                auto t0=chrono::steady_clock::now();
+                if (!exchange.read())
+                    stats.torn++;
+                stats.ops++;
+                if (stats.latencies.size()<stats.latencies.capacity())
+                    measure(stats.latencies,t0);
+            }
+        }));
+    }
+
+    this_thread::sleep_for(chrono::duration<double>(seconds));
+    stop=true;
+    writer.join();
+    for (auto &t:threads)
+        t.join();
+
+    Stats all;
+    for (auto &s:readStats)
+    {
+        all.latencies.insert(all.latencies.end(),s.latencies.begin(),s.latencies.end());
+        all.ops+=s.ops;
+        all.torn+=s.torn;
+    }
+
+    print(scheme,"read",all,seconds);
+    print(scheme,"write",writeStats,seconds);
+}
+
+
+/***************************************************************************/
+int main(int argc, char *argv[])
+{
+    int readers=(argc>1) ? atoi(argv[1]) : 4;
+    double seconds=(argc>2) ? atof(argv[2]) : 2.0;
+
+    printf("readers=%d seconds=%g\n",readers,seconds);
+    run<MutexExchange>("mutex",readers,seconds);
+    run<SeqLockExchange>("seqlock",readers,seconds);
+
+    return 0;
+}
+
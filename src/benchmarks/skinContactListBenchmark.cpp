@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * Benchmark of the serialization of the skin events: a
+ * skinContactList is written and read back through an in-memory
+ * connection, both in the Bottle format and in the compact binary
+ * one, for a light touch on a hand, a large press on a forearm and
+ * contacts spread all over the body. For each case, the size of a
+ * frame and the time of a write plus read are reported, and the
+ * decoded lists are checked to be the same as the original one.
+ *
+ * Usage: skinContactListBenchmark [cycles]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <yarp/os/DummyConnector.h>
+#include <yarp/sig/Vector.h>
+#include <iCub/skinDynLib/skinContactList.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace iCub::skinDynLib;
+
+
+/***************************************************************************/
+skinContact makeContact(mt19937 &gen, const SkinPart skinPart,
+                        const unsigned int firstTaxel, const unsigned int numTaxels)
+{
+    auto uniform=[&gen]() { return gen()/4294967296.0; };
+
+    // active taxels clustered around the first one, with some holes
+    vector<unsigned int> taxels;
+    for (unsigned int id=firstTaxel; taxels.size()<numTaxels; id++)
+        if (uniform()<0.8)
+            taxels.push_back(id);
+
+    Vector CoP(3),geoCenter(3),normal(3),F(3),Mu(3,0.0);
+    for (int i=0; i<3; i++)
+    {
+        CoP[i]=0.1*uniform()-0.05;
+        geoCenter[i]=CoP[i]+0.001*uniform();
+        normal[i]=uniform()-0.5;
+        F[i]=10.0*uniform()-5.0;
+    }
+
+    return skinContact(getBodyPart(skinPart),skinPart,getLinkNum(skinPart),
+                       CoP,geoCenter,taxels,20.0*uniform(),normal,F,Mu);
+}
+
+
+/***************************************************************************/
+bool same(const skinContactList &a, const skinContactList &b)
+{
+    if (a.size()!=b.size())
+        return false;
+
+    for (size_t k=0; k<a.size(); k++)
+    {
+        Vector va=a[k].toVector();
+        Vector vb=b[k].toVector();
+        if ((va.length()!=vb.length()) ||
+            (memcmp(va.data(),vb.data(),va.length()*sizeof(double))!=0))
+            return false;
+    }
+    return true;
+}
+
+
+/***************************************************************************/
+void run(const string &name, skinContactList &list, const int cycles)
+{
+    size_t bytes[2];
+    double t[2];
+    bool identical[2];
+    for (int binary=0; binary<2; binary++)
+    {
+        list.setBinaryFormat(binary!=0);
+        skinContactList decoded;
+        DummyConnector connector;
+
+        auto t0=chrono::steady_clock::now();
+        for (int k=0; k<cycles; k++)
+        {
+            connector.reset();
+            list.write(connector.getWriter());
+            decoded.read(connector.getReader());
+        }
+        auto t1=chrono::steady_clock::now();
+
+        connector.reset();
+        list.write(connector.getWriter());
+        bytes[binary]=connector.getReader().getSize();
+        t[binary]=chrono::duration<double,micro>(t1-t0).count()/cycles;
+        identical[binary]=decoded.read(connector.getReader()) && same(list,decoded);
+    }
+
+    size_t numTaxels=0;
+    for (auto &c:list)
+        numTaxels+=c.getActiveTaxels();
+
+    printf("%-10s contacts=%-3zu taxels=%-5zu bottle %7zu B %8.1f us | binary %6zu B %7.1f us | %5.1fx smaller, %5.1fx faster | %s\n",
+           name.c_str(),list.size(),numTaxels,bytes[0],t[0],bytes[1],t[1],
+           (double)bytes[0]/bytes[1],t[0]/t[1],
+           (identical[0] && identical[1])?"identical":"MISMATCH");
+}
+
+
+/***************************************************************************/
+int main(int argc, char *argv[])
+{
+    int cycles=(argc>1) ? atoi(argv[1]) : 10000;
+    mt19937 gen(0);
+
+    skinContactList hand;
+    hand.push_back(makeContact(gen,SKIN_RIGHT_HAND,12,9));
+    hand.push_back(makeContact(gen,SKIN_RIGHT_HAND,96,6));
+    run("hand",hand,cycles);
+
+    skinContactList forearm;
+    forearm.push_back(makeContact(gen,SKIN_LEFT_FOREARM,24,300));
+    run("forearm",forearm,cycles);
+
+    skinContactList body;
+    const SkinPart parts[]={SKIN_LEFT_HAND,SKIN_LEFT_FOREARM,SKIN_LEFT_UPPER_ARM,
+                            SKIN_RIGHT_HAND,SKIN_RIGHT_FOREARM,SKIN_RIGHT_UPPER_ARM,
+                            SKIN_FRONT_TORSO,LEFT_LEG_UPPER,RIGHT_LEG_UPPER};
+    for (auto part:parts)
+        for (int c=0; c<2; c++)
+            body.push_back(makeContact(gen,part,gen()%200,20+gen()%120));
+    run("whole-body",body,cycles/10);
+
+    return 0;
+}
+
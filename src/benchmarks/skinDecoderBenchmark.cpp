@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * Benchmark of the decoding of the skin messages of the CanBusSkin
+ * device: the SkinFrameDecoder is compared against the former loop
+ * of CanBusSkin::run(), which scanned the list of the boards for
+ * every message. The messages are replayed by the fakecan device,
+ * from a recording of a real bus if given, otherwise from synthetic
+ * recordings of 2, 7 and 14 boards (heads and tails of all the
+ * triangles with diagnostics, some of them lost or split across two
+ * reads, and messages of other boards). At every cycle both decode
+ * the same read into their own taxels, which are compared bitwise
+ * together with the detected errors.
+ *
+ * Usage: skinDecoderBenchmark [cycles] [replayFile boardId1 boardId2 ...]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <yarp/os/Property.h>
+#include <yarp/sig/Vector.h>
+
+#include <fakeCan.h>
+#include <SkinFrameDecoder.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::dev;
+using namespace iCub::skin::diagnostics;
+
+const int CAN_DRIVER_BUFFER_SIZE=2047;
+
+
+/***************************************************************************/
+// the former decoding loop of CanBusSkin::run(), with the detected
+// errors collected instead of printed
+void legacyDecode(CanBuffer &inBuffer, const unsigned int canMessages,
+                  const VectorOf<int> &cardId, const int netID,
+                  Vector &data, VectorOf<DetectedError> &errors,
+                  vector<DetectedError> &detected)
+{
+    errors.resize(canMessages);
+    detected.clear();
+
+    for (unsigned int i = 0; i < canMessages; i++) {
+
+        CanMessage &msg = inBuffer[i];
+
+        unsigned int msgid = msg.getId();
+        unsigned int id = (msgid & 0x00F0) >> 4;
+        unsigned int sensorId = (msgid & 0x000F);
+        unsigned int msgType = (int) msg.getData()[0];
+        int len = msg.getLen();
+
+        for (size_t j = 0; j < cardId.size(); j++) {
+            if (id == cardId[j]) {
+                int index = 16*12*j + sensorId*12;
+
+                if (msgType == 0x40) {
+                    for(int k = 0; k < 7; k++) {
+                        data[index + k] = msg.getData()[k + 1];
+                    }
+                } else if (msgType == 0xC0) {
+                    for(int k = 0; k < 5; k++) {
+                        data[index + k + 7] = msg.getData()[k + 1];
+                    }
+
+                    if (len == 8) {
+                        short head = msg.getData()[6];
+                        short tail = msg.getData()[7];
+                        int fullMsg = (head << 8) | (tail & 0xFF);
+
+                        errors[i].net = netID;
+                        errors[i].board = id;
+                        errors[i].sensor = sensorId;
+                        errors[i].error = fullMsg;
+
+                        if(fullMsg != SkinErrorCode::StatusOK)
+                            detected.push_back(errors[i]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+/***************************************************************************/
+// the messages of a triangle, as the replay file expects them
+void appendFrame(string &line, const int id, const int type,
+                 const unsigned char *taxels, const int n, const int diag)
+{
+    int d[8]={type,0,0,0,0,0,0,0};
+    for (int k=0; k<n; k++)
+        d[k+1]=taxels[k];
+    if (diag>=0)
+    {
+        d[6]=(diag>>8)&0xFF;
+        d[7]=diag&0xFF;
+    }
+
+    char buf[128];
+    snprintf(buf,sizeof(buf),"%d %d %d %d %d %d %d %d %d %d ",
+             id,8,d[0],d[1],d[2],d[3],d[4],d[5],d[6],d[7]);
+    line+=buf;
+}
+
+
+/***************************************************************************/
+// a synthetic recording of the periodic messages of the given boards
+void writeRecording(const string &fileName, const vector<int> &boards,
+                    const int reads)
+{
+    mt19937 gen((unsigned int)boards.size());
+    auto uniform=[&gen]() { return gen()/4294967296.0; };
+
+    FILE *file=fopen(fileName.c_str(),"w");
+    string line,next;
+    for (int r=0; r<reads; r++)
+    {
+        line=next;
+        next.clear();
+        for (int t=0; t<16; t++)
+        {
+            for (int b : boards)
+            {
+                const int id=(0x4<<8)|(b<<4)|t;
+                unsigned char taxels[12];
+                for (int k=0; k<12; k++)
+                    taxels[k]=(unsigned char)(240.0+15.0*uniform());
+
+                const int diag=(uniform()<0.001) ? 0x0001 : SkinErrorCode::StatusOK;
+
+                // about one frame out of two hundreds is lost, and some
+                // tails arrive in the next read
+                if (uniform()>0.005)
+                    appendFrame(line,id,0x40,taxels,7,-1);
+                if (uniform()>0.005)
+                    appendFrame((uniform()<0.02) ? next : line,id,0xC0,taxels+7,5,diag);
+            }
+
+            // messages of a board not on this bus
+            if (t%4==0)
+            {
+                unsigned char taxels[7]={0,0,0,0,0,0,0};
+                appendFrame(line,(0x4<<8)|(15<<4)|t,0x40,taxels,7,-1);
+            }
+        }
+        fprintf(file,"%s\n",line.c_str());
+    }
+    fclose(file);
+}
+
+
+/***************************************************************************/
+bool run(const string &name, const string &replayFile, const vector<int> &boards,
+         const int cycles)
+{
+    FakeCan can;
+    Property prop;
+    prop.put("replayFile",replayFile);
+    if (!can.open(prop))
+        return false;
+
+    CanBuffer inBuffer=can.createBuffer(CAN_DRIVER_BUFFER_SIZE);
+
+    VectorOf<int> cardId;
+    for (int b : boards)
+        cardId.push_back(b);
+    const int netID=0;
+
+    Vector legacyData(SkinFrameDecoder::TAXELS_PER_BOARD*cardId.size(),0.0);
+    VectorOf<DetectedError> legacyErrors;
+    vector<DetectedError> legacyDetected;
+
+    Vector data(SkinFrameDecoder::TAXELS_PER_BOARD*cardId.size(),0.0);
+    SkinFrameDecoder decoder;
+    decoder.setBoards(cardId,netID);
+
+    bool identical=true;
+    double tLegacy=0.0, tDecoder=0.0, maxLegacy=0.0, maxDecoder=0.0;
+    unsigned long messages=0, incomplete=0, discarded=0, diagErrors=0;
+    for (int k=0; k<cycles; k++)
+    {
+        unsigned int canMessages=0;
+        can.canRead(inBuffer,CAN_DRIVER_BUFFER_SIZE,&canMessages);
+
+        auto t0=chrono::steady_clock::now();
+        legacyDecode(inBuffer,canMessages,cardId,netID,legacyData,legacyErrors,legacyDetected);
+        auto t1=chrono::steady_clock::now();
+        decoder.decode(inBuffer,canMessages,data.data(),true);
+        auto t2=chrono::steady_clock::now();
+
+        double dtLegacy=chrono::duration<double,micro>(t1-t0).count();
+        double dtDecoder=chrono::duration<double,micro>(t2-t1).count();
+        tLegacy+=dtLegacy;
+        tDecoder+=dtDecoder;
+        maxLegacy=std::max(maxLegacy,dtLegacy);
+        maxDecoder=std::max(maxDecoder,dtDecoder);
+
+        const SkinDecodeStats &stats=decoder.getStats();
+        messages+=stats.messages;
+        incomplete+=stats.incomplete;
+        discarded+=stats.discarded;
+        diagErrors+=stats.diagErrors;
+
+        const vector<DetectedError> &errors=decoder.getErrors();
+        identical=identical &&
+                  (memcmp(legacyData.data(),data.data(),data.size()*sizeof(double))==0) &&
+                  (legacyDetected.size()==errors.size());
+        for (size_t i=0; identical && (i<errors.size()); i++)
+            identical=(legacyDetected[i].net==errors[i].net) &&
+                      (legacyDetected[i].board==errors[i].board) &&
+                      (legacyDetected[i].sensor==errors[i].sensor) &&
+                      (legacyDetected[i].error==errors[i].error);
+    }
+
+    can.destroyBuffer(inBuffer);
+    can.close();
+
+    printf("%-10s boards=%-2zu msg/cycle=%6.1f incomplete=%-5lu discarded=%-6lu errors=%-3lu legacy %7.2f us (max %7.2f) | decoder %7.2f us (max %7.2f) | speedup %5.1fx | %s\n",
+           name.c_str(),boards.size(),(double)messages/cycles,incomplete,discarded,diagErrors,
+           tLegacy/cycles,maxLegacy,tDecoder/cycles,maxDecoder,tLegacy/tDecoder,
+           identical?"identical":"MISMATCH");
+    return true;
+}
+
+
+/***************************************************************************/
+int main(int argc, char *argv[])
+{
+    int cycles=(argc>1) ? atoi(argv[1]) : 5000;
+
+    // replay of a recorded bus
+    if (argc>2)
+    {
+        vector<int> boards;
+        for (int i=3; i<argc; i++)
+            boards.push_back(atoi(argv[i]));
+        return run("recording",argv[2],boards,cycles) ? 0 : 1;
+    }
+
+    // replay of synthetic recordings
+    for (int n : {2,7,14})
+    {
+        vector<int> boards;
+        for (int b=1; b<=n; b++)
+            boards.push_back(b);
+
+        string fileName="skinDecoderBenchmark_"+to_string(n)+".replay";
+        writeRecording(fileName,boards,500);
+        bool ok=run("synthetic",fileName,boards,cycles);
+        remove(fileName.c_str());
+        if (!ok)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * Benchmark of the clustering of the active taxels into contacts
+ * carried out by the skinManager: the union-find pass of
+ * TaxelClusters is compared against the former merging of the
+ * per-contact taxel lists of Compensator::getContacts(), on
+ * synthetic dense contacts over square skin patches (a full press,
+ * a large disc, scattered blobs and a comb whose teeth get merged
+ * one by one). As on the iCub skin, the taxel ids are assigned per
+ * triangular module of 12 taxels (here 4x3 tiles) and the modules
+ * are numbered regardless of their placement (here in random
+ * order, with a fixed seed). The clusters are checked to be the
+ * same.
+ *
+ * Usage: taxelClustersBenchmark [cycles]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+
+#include <yarp/sig/Vector.h>
+
+#include "iCub/skinManager/taxelNeighbors.h"
+#include "iCub/skinManager/taxelClusters.h"
+
+using namespace std;
+using namespace yarp::sig;
+using namespace iCub::skinManager;
+
+
+/***************************************************************************/
+// the former clustering of Compensator::getContacts()
+deque<deque<int> > legacyClusters(const TaxelNeighbors &neighbors,
+                                  const vector<unsigned char> &touchDetectedFilt)
+{
+    unsigned int skinDim=neighbors.size();
+    vector<int>         contactXtaxel(skinDim, -1);
+    deque<deque<int> >  taxelsXcontact;
+    int                 contactId = 0;
+    int                 neighCont;
+
+    for(unsigned int i=0; i<skinDim; i++){
+        if(touchDetectedFilt[i] ){
+            for(const unsigned int *it=neighbors.begin(i); it!=neighbors.end(i); it++){
+                neighCont = contactXtaxel[(*it)];
+                if(neighCont >= 0){
+                    if(contactXtaxel[i]<0){
+                        contactXtaxel[i] = neighCont;
+                        taxelsXcontact[neighCont].push_back(i);
+                    }else if(contactXtaxel[i]!=neighCont){
+                        int newId = min(contactXtaxel[i], neighCont);
+                        int oldId = max(contactXtaxel[i], neighCont);
+                        deque<int> tax2move = taxelsXcontact[oldId];
+                        for(deque<int>::iterator it=tax2move.begin(); it!=tax2move.end(); it++){
+                            contactXtaxel[(*it)] = newId;
+                            taxelsXcontact[newId].push_back((*it));
+                        }
+                        taxelsXcontact[oldId].clear();
+                    }
+                }
+            }
+            if(contactXtaxel[i]<0){
+                contactXtaxel[i] = contactId;
+                taxelsXcontact.resize(contactId+1);
+                taxelsXcontact[contactId].push_back(i);
+                contactId++;
+            }
+        }
+    }
+    return taxelsXcontact;
+}
+
+
+/***************************************************************************/
+bool same(const deque<deque<int> > &legacy, const TaxelClusters &clusters)
+{
+    if (legacy.size()!=clusters.getNumSeeds())
+        return false;
+
+    unsigned int k=0;
+    for (auto &c:legacy)
+    {
+        if (c.empty())
+            continue;
+        if (k>=clusters.size())
+            return false;
+
+        vector<unsigned int> l(c.begin(),c.end());
+        sort(l.begin(),l.end());
+        if ((l.size()!=clusters.count(k)) ||
+            !equal(l.begin(),l.end(),clusters.begin(k)))
+            return false;
+        k++;
+    }
+    return (k==clusters.size());
+}
+
+
+/***************************************************************************/
+void run(const unsigned int side, const string &pattern,
+         const vector<unsigned char> &active, const TaxelNeighbors &neighbors,
+         const int cycles)
+{
+    deque<deque<int> > legacy;
+    auto t0=chrono::steady_clock::now();
+    for (int k=0; k<cycles; k++)
+        legacy=legacyClusters(neighbors,active);
+    auto t1=chrono::steady_clock::now();
+
+    TaxelClusters clusters;
+    auto t2=chrono::steady_clock::now();
+    for (int k=0; k<cycles; k++)
+        clusters.compute(neighbors,active);
+    auto t3=chrono::steady_clock::now();
+
+    size_t numActive=count(active.begin(),active.end(),true);
+    double tLegacy=chrono::duration<double,micro>(t1-t0).count()/cycles;
+    double tClusters=chrono::duration<double,micro>(t3-t2).count()/cycles;
+    printf("taxels=%-6u %-6s active=%-6zu contacts=%-4u legacy %10.1f us | union-find %8.1f us | speedup %7.1fx | %s\n",
+           side*side,pattern.c_str(),numActive,clusters.size(),tLegacy,tClusters,
+           tLegacy/tClusters,same(legacy,clusters)?"identical":"MISMATCH");
+}
+
+
+/***************************************************************************/
+int main(int argc, char *argv[])
+{
+    int cycles=(argc>1) ? atoi(argv[1]) : 20;
+
+    // square patches of taxels 4 mm apart
+    const double pitch=0.004;
+    const double maxNeighDist=0.006;
+    for (unsigned int side : {64u,128u})
+    {
+        unsigned int n=side*side;
+        mt19937 gen(side);
+
+        // id of the taxel at each place of the patch
+        unsigned int tilesX=side/4, tilesY=side/3+1;
+        vector<unsigned int> tiles(tilesX*tilesY);
+        for (unsigned int t=0; t<tiles.size(); t++)
+            tiles[t]=t;
+        for (unsigned int t=(unsigned int)tiles.size()-1; t>0; t--)
+            swap(tiles[t],tiles[gen()%(t+1)]);
+
+        vector<pair<unsigned int,unsigned int> > order(n);
+        for (unsigned int i=0; i<n; i++)
+        {
+            unsigned int x=i%side, y=i/side;
+            unsigned int tile=tiles[(y/3)*tilesX+x/4];
+            order[i]=make_pair(12*tile+(y%3)*4+x%4,i);
+        }
+        sort(order.begin(),order.end());
+        vector<unsigned int> id(n);
+        for (unsigned int k=0; k<n; k++)
+            id[order[k].second]=k;
+
+        vector<Vector> taxelPos(n,Vector(3,0.0));
+        for (unsigned int i=0; i<n; i++)
+        {
+            taxelPos[id[i]][0]=pitch*(i%side);
+            taxelPos[id[i]][1]=pitch*(i/side);
+        }
+
+        TaxelNeighbors neighbors;
+        neighbors.build(taxelPos,maxNeighDist);
+
+        vector<unsigned char> active(n,true);
+        run(side,"full",active,neighbors,cycles);
+
+        for (unsigned int i=0; i<n; i++)
+        {
+            double x=(double)(i%side)-side/2.0;
+            double y=(double)(i/side)-side/2.0;
+            active[id[i]]=(x*x+y*y<=side*side/5.0);
+        }
+        run(side,"disc",active,neighbors,cycles);
+
+        fill(active.begin(),active.end(),false);
+        for (int b=0; b<16; b++)
+        {
+            int cx=gen()%side, cy=gen()%side, r=2+gen()%6;
+            for (unsigned int i=0; i<n; i++)
+            {
+                int x=(int)(i%side)-cx, y=(int)(i/side)-cy;
+                if (x*x+y*y<=r*r)
+                    active[id[i]]=true;
+            }
+        }
+        run(side,"blobs",active,neighbors,cycles);
+
+        // the teeth are joined by the last row
+        for (unsigned int i=0; i<n; i++)
+            active[id[i]]=((i%side)%2==0) || (i/side==side-1);
+        run(side,"comb",active,neighbors,cycles);
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * Benchmark of the taxel neighborhoods of the skinManager: the
+ * spatial index of TaxelNeighbors is compared against the former
+ * all-pairs scan of the Compensator (lists of neighbors), both
+ * when all the neighbors are computed and when single taxels are
+ * moved, on skin patches of 4k and 16k taxels laid out on a
+ * cylinder with a fixed seed. The two adjacencies are checked to
+ * be the same.
+ *
+ * Usage: taxelNeighborsBenchmark [updates]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <list>
+#include <algorithm>
+
+#include <yarp/sig/Vector.h>
+#include <yarp/math/Math.h>
+
+#include "iCub/skinManager/taxelNeighbors.h"
+
+using namespace std;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace iCub::skinManager;
+
+
+/***************************************************************************/
+// the former implementation of Compensator::computeNeighbors()
+void legacyCompute(vector<list<int> > &neighborsXtaxel,
+                   const vector<Vector> &taxelPos, const double maxNeighDist)
+{
+    unsigned int skinDim=(unsigned int)taxelPos.size();
+    neighborsXtaxel.clear();
+    neighborsXtaxel.resize(skinDim, list<int>(0));
+    Vector v;
+    double d2 = maxNeighDist*maxNeighDist;
+    for(unsigned int i=0; i<skinDim; i++){
+        for(unsigned int j=i+1; j<skinDim; j++){
+            v = taxelPos[i]-taxelPos[j];
+            if( dot(v,v) <= d2){
+                neighborsXtaxel[i].push_back(j);
+                neighborsXtaxel[j].push_back(i);
+            }
+        }
+    }
+}
+
+
+/***************************************************************************/
+// the former implementation of Compensator::updateNeighbors()
+void legacyUpdate(vector<list<int> > &neighborsXtaxel, const vector<Vector> &taxelPos,
+                  const double maxNeighDist, const unsigned int taxelId)
+{
+    unsigned int skinDim=(unsigned int)taxelPos.size();
+    Vector v;
+    double d2 = maxNeighDist*maxNeighDist;
+    neighborsXtaxel[taxelId].clear();
+    for(unsigned int i=0; i<skinDim; i++){
+        neighborsXtaxel[i].remove(taxelId);
+        v = taxelPos[i]-taxelPos[taxelId];
+        if( dot(v,v) <= d2){
+            neighborsXtaxel[i].push_back(taxelId);
+            neighborsXtaxel[taxelId].push_back(i);
+        }
+    }
+}
+
+
+/***************************************************************************/
+bool same(const vector<list<int> > &legacy, const TaxelNeighbors &neighbors)
+{
+    if (legacy.size()!=neighbors.size())
+        return false;
+
+    // the former update also added each taxel to its own list
+    for (unsigned int i=0; i<neighbors.size(); i++)
+    {
+        vector<unsigned int> l;
+        for (auto j:legacy[i])
+            if (j!=(int)i)
+                l.push_back(j);
+        sort(l.begin(),l.end());
+        if (!equal(l.begin(),l.end(),neighbors.begin(i),neighbors.end(i)) ||
+            (l.size()!=neighbors.count(i)))
+            return false;
+    }
+    return true;
+}
+
+
+/***************************************************************************/
+double uniform(mt19937 &gen, const double lo, const double hi)
+{
+    return lo+(hi-lo)*(gen()/4294967296.0);
+}
+
+
+/***************************************************************************/
+void run(const unsigned int numTaxels, const int updates)
+{
+    // taxels 4 mm apart on a cylinder, 64 around it
+    const double pitch=0.004;
+    const unsigned int cols=64;
+    const double radius=cols*pitch/(2.0*M_PI);
+    const double maxNeighDist=0.012;
+
+    mt19937 gen(numTaxels);
+    vector<Vector> taxelPos(numTaxels,Vector(3));
+    for (unsigned int i=0; i<numTaxels; i++)
+    {
+        double theta=2.0*M_PI*(i%cols)/cols;
+        taxelPos[i][0]=radius*cos(theta)+uniform(gen,-0.0005,0.0005);
+        taxelPos[i][1]=radius*sin(theta)+uniform(gen,-0.0005,0.0005);
+        taxelPos[i][2]=pitch*(i/cols)+uniform(gen,-0.0005,0.0005);
+    }
+
+    vector<unsigned int> ids(updates);
+    vector<Vector> moves(updates,Vector(3));
+    for (int k=0; k<updates; k++)
+    {
+        ids[k]=gen()%numTaxels;
+        for (int j=0; j<3; j++)
+            moves[k][j]=uniform(gen,-0.003,0.003);
+    }
+
+    vector<list<int> > legacy;
+    auto t0=chrono::steady_clock::now();
+    legacyCompute(legacy,taxelPos,maxNeighDist);
+    auto t1=chrono::steady_clock::now();
+
+    TaxelNeighbors neighbors;
+    auto t2=chrono::steady_clock::now();
+    neighbors.build(taxelPos,maxNeighDist);
+    auto t3=chrono::steady_clock::now();
+
+    bool ok=same(legacy,neighbors);
+    unsigned int minNeighbors,maxNeighbors;
+    neighbors.getStats(minNeighbors,maxNeighbors);
+
+    double tLegacyBuild=chrono::duration<double,milli>(t1-t0).count();
+    double tBuild=chrono::duration<double,milli>(t3-t2).count();
+    printf("taxels=%u neighbors=[%u,%u]\n",numTaxels,minNeighbors,maxNeighbors);
+    printf("  compute   legacy %10.2f ms | index %10.2f ms | speedup %8.1fx\n",
+           tLegacyBuild,tBuild,tLegacyBuild/tBuild);
+
+    vector<Vector> legacyPos=taxelPos;
+    double tLegacyUpdate=0.0,tUpdate=0.0;
+    for (int k=0; k<updates; k++)
+    {
+        unsigned int i=ids[k];
+        legacyPos[i]+=moves[k];
+        t0=chrono::steady_clock::now();
+        legacyUpdate(legacy,legacyPos,maxNeighDist,i);
+        t1=chrono::steady_clock::now();
+        neighbors.update(i,legacyPos[i]);
+        t2=chrono::steady_clock::now();
+
+        tLegacyUpdate+=chrono::duration<double,micro>(t1-t0).count();
+        tUpdate+=chrono::duration<double,micro>(t2-t1).count();
+    }
+
+    ok&=same(legacy,neighbors);
+    if (updates>0)
+    {
+        tLegacyUpdate/=updates;
+        tUpdate/=updates;
+        printf("  update    legacy %10.2f us | index %10.2f us | speedup %8.1fx\n",
+               tLegacyUpdate,tUpdate,tLegacyUpdate/tUpdate);
+    }
+    printf("  adjacency %s\n",ok?"identical":"MISMATCH");
+}
+
+
+/***************************************************************************/
+int main(int argc, char *argv[])
+{
+    int updates=(argc>1) ? atoi(argv[1]) : 200;
+
+    run(4096,updates);
+    run(16384,updates);
+
+    return 0;
+}
+
@@ -26,6 +26,7 @@
 #define __ADAPTWINPOLYESTIMATOR_H__
 
 #include <deque>
+#include <vector>
 
 #include <yarp/sig/Vector.h>
 #include <iCub/ctrl/math.h>
@@ -86,6 +87,27 @@ protected:
 
     bool firstRun;
 
+    bool recursive;
+    unsigned int dim;
+    unsigned int ringHead;
+    unsigned int ringSize;
+    unsigned int refreshCnt;
+    unsigned int invalidCnt;
+    double t0;
+
+    std::vector<double> ringT;
+    std::vector<double> ringX;
+    std::vector<double> statT;
+    std::vector<double> statY;
+    std::vector<double> normEq;
+    std::vector<unsigned int> statLen;
+
+    void feedRecursive(const AWPolyElement &el);
+    void updateStat(const unsigned int i, const unsigned int age, const double sign);
+    void refreshStats();
+    void fitStat(const unsigned int i);
+    yarp::sig::Vector estimateRecursive();
+
     /**
     * Find the regressor which best fits in least square sense the 
     * last n data sample couples, or all couples if n==0. 
@@ -127,6 +149,27 @@ public:
     */
     AWPolyList &getList() { return elemList; }
 
+    /**
+    * Switch to/from the recursive mode. In recursive mode the last
+    * N samples are kept in a ring buffer, together with the
+    * running sums of the powers of time and of their products with
+    * the data, which are updated incrementally as the windows slide
+    * and shrink/grow; each fit is then obtained by solving the
+    * small normal equations system, without refitting the whole
+    * window from scratch.
+    * @param sw true to enable the recursive mode.
+    * @note The internal state is reinitialized upon switching. The
+    *       elements list returned by getList() is not filled in
+    *       recursive mode.
+    */
+    void setRecursive(const bool sw);
+
+    /**
+    * Return the current mode.
+    * @return true if the recursive mode is enabled.
+    */
+    bool getRecursive() const { return recursive; }
+
     /**
     * Feed data into the algorithm.
     * @param el is the new data of type AWPolyElement.
@@ -24,6 +24,7 @@
 
 #include <string>
 #include <deque>
+#include <vector>
 
 #include <yarp/os/Property.h>
 #include <yarp/sig/Vector.h>
@@ -123,6 +124,75 @@ public:
 };
 
 
+/**
+* \ingroup minJerkCtrl
+*
+* Same as minJerkVelCtrlForIdealPlant, with the second-order
+* filter implemented inline in the way of minJerkBaseGenSoA: the
+* past inputs and outputs of all the variables are stored as
+* contiguous rows, which are rotated rather than copied at each
+* step. The outputs are bitwise identical to those of
+* minJerkVelCtrlForIdealPlant.
+*/
+class minJerkVelCtrlForIdealPlantSoA : public minJerkVelCtrl
+{
+private:
+    // Default constructor: not implemented.
+    minJerkVelCtrlForIdealPlantSoA();
+
+protected:
+    double b[3];
+    double a[3];
+    std::vector<double> storage;
+    double *u[2];           // past inputs, most recent first
+    double *y[2];           // past outputs, most recent first
+    yarp::sig::Vector cmd;
+
+    double Ts;
+    double T;
+    int dim;
+
+    void allocate();
+    void copyStates(const minJerkVelCtrlForIdealPlantSoA &z);
+    virtual void computeCoeffs();
+
+public:
+    /**
+    * Constructor. 
+    * @param _Ts is the controller sample time in seconds. 
+    * @param _dim is the controller's dimension 
+    */
+    minJerkVelCtrlForIdealPlantSoA(const double _Ts, const int _dim);
+
+    /**
+    * Copy constructor. 
+    * @param z the object to copy. 
+    */
+    minJerkVelCtrlForIdealPlantSoA(const minJerkVelCtrlForIdealPlantSoA &z);
+
+    /**
+    * Assignment operator. 
+    * @param z the object to copy. 
+    */
+    minJerkVelCtrlForIdealPlantSoA& operator=(const minJerkVelCtrlForIdealPlantSoA &z);
+
+    /**
+    * Computes the velocity command.
+    * @param _T the current execution time.
+    * @param e the error between the desired position and the 
+    *          feedback.
+    * @return the velocity command.
+    */
+    virtual yarp::sig::Vector computeCmd(const double _T, const yarp::sig::Vector &e);
+
+    /**
+    * Resets the controller to a given value.
+    * @param u0 the initial output of the controller.
+    */
+    virtual void reset(const yarp::sig::Vector &u0);
+};
+
+
 /**
 * \ingroup minJerkCtrl
 *
@@ -456,6 +526,281 @@ public:
                                    const yarp::sig::Vector &yd);
 };
 
+
+/**
+* \ingroup minJerkCtrl
+*
+* Base class for minimum jerk generators working on a fixed
+* number of variables with no memory allocation at run-time.
+*
+* The discrete-time dynamics are the same as those of
+* minJerkBaseGen and its derived classes, but the filters are
+* implemented inline: the past inputs and outputs of all the
+* variables are stored as contiguous rows (structure-of-arrays),
+* which are rotated rather than copied at each step, so that the
+* update of each filter is a single loop over the variables that
+* the compiler can vectorize. All the storage is allocated once
+* upon construction.
+*/
+class minJerkBaseGenSoA
+{
+protected:
+    // IIR filter of order up to 3 acting on all the variables
+    struct Section
+    {
+        double b[4];
+        double a[4];
+        unsigned int order;
+        double *u[3];       // past inputs, most recent first
+        double *y[3];       // past outputs, most recent first
+    };
+
+    Section posSection;     // section used to compute the position
+    Section velSection;     // section used to compute the velocity
+    Section accSection;     // section used to compute the acceleration
+
+    std::vector<double> storage;
+
+    yarp::sig::Vector pos;          // current position
+    yarp::sig::Vector vel;          // current velocity
+    yarp::sig::Vector acc;          // current acceleration
+    yarp::sig::Vector lastRef;      // last reference position
+    yarp::sig::Vector err;          // scratch space for the inputs
+
+    double Ts;                      // sample time in seconds
+    double T;                       // trajectory reference time in seconds
+    unsigned int dim;               // dimension of the controlled variable
+    bool configured;                // true once the coefficients are set
+
+    void allocate();
+    void setCoeffs(Section &s, const unsigned int order,
+                   const double *num, const double *den);
+    void initSection(Section &s, const double *y0, const double *u0);
+    void step(Section &s, const double *in, double *out);
+
+    virtual void computeCoeffs()=0; // compute the filter coefficients
+
+public:
+    /**
+    * Constructor.
+    * @param _dim number of variables.
+    * @param _Ts sample time in seconds.
+    * @param _T trajectory reference time (90% of steady-state value 
+    *           in t=_T, transient extinguished for t>=1.5*_T).
+    */
+    minJerkBaseGenSoA(const unsigned int _dim, const double _Ts, const double _T);
+
+    /**
+    * Constructor with initial value.
+    * @param y0 initial value of the trajectory.
+    * @param _Ts sample time in seconds.
+    * @param _T trajectory reference time (90% of steady-state value 
+    *           in t=_T, transient extinguished for t>=1.5*_T).
+    */
+    minJerkBaseGenSoA(const yarp::sig::Vector &y0, const double _Ts, const double _T);
+
+    /**
+    * Copy constructor. 
+    * @param z the object to copy. 
+    * @note After copy, internal filters are reset. 
+    */
+    minJerkBaseGenSoA(const minJerkBaseGenSoA &z);
+
+    /**
+    * Assignment operator. 
+    * @param z the object to copy; it must have the same number of 
+    *          variables.
+    * @note After copy, internal filters are reset. 
+    */
+    minJerkBaseGenSoA& operator=(const minJerkBaseGenSoA &z);
+
+    /**
+    * Destructor. 
+    */
+    virtual ~minJerkBaseGenSoA() { }
+
+    /**
+    * Initialize the trajectory.
+    * @param y0 initial value of the trajectory.
+    */
+    virtual void init(const yarp::sig::Vector &y0);
+
+    /**
+    * Get the number of variables.
+    */
+    unsigned int getDim() const { return dim; }
+
+    /**
+    * Get the current position.
+    */
+    const yarp::sig::Vector& getPos() const { return pos; }
+
+    /**
+    * Get the current velocity.
+    */
+    const yarp::sig::Vector& getVel() const { return vel; }
+
+    /**
+    * Get the current acceleration.
+    */
+    const yarp::sig::Vector& getAcc() const { return acc; }
+
+    /**
+    * Get the trajectory reference time in seconds
+    * (90% of steady-state value in t=_T, transient extinguished for
+    * t>=1.5*_T). 
+    */
+    double getT() const { return T; }
+
+    /**
+    * Get the sample time in seconds.
+    */
+    double getTs() const { return Ts; }
+
+    /**
+    * Set the trajectory reference time
+    * (90% of steady-state value in t=_T, transient extinguished for t>=1.5*_T).
+    * @param _T trajectory reference time in seconds.
+    * @return true if operation succeeded, false otherwise.
+    */
+    bool setT(const double _T);
+
+    /**
+    * Set the sample time.
+    * @param _Ts sample time in seconds.
+    * @return true if operation succeeded, false otherwise.
+    */
+    bool setTs(const double _Ts);
+};
+
+
+/**
+* \ingroup minJerkCtrl
+*
+* Same as minJerkTrajGen, with the implementation of
+* minJerkBaseGenSoA.
+*/
+class minJerkTrajGenSoA : public minJerkBaseGenSoA
+{
+protected:
+    virtual void computeCoeffs();
+
+public:
+    /**
+    * Constructor.
+    * @param _dim number of variables.
+    * @param _Ts sample time in seconds.
+    * @param _T trajectory reference time (90% of steady-state value 
+    *           in t=_T, transient extinguished for t>=1.5*_T).
+    */
+    minJerkTrajGenSoA(const unsigned int _dim, const double _Ts, const double _T);
+
+    /**
+    * Constructor with initial value.
+    * @param y0 initial value of the trajectory.
+    * @param _Ts sample time in seconds.
+    * @param _T trajectory reference time (90% of steady-state value 
+    *           in t=_T, transient extinguished for t>=1.5*_T).
+    */
+    minJerkTrajGenSoA(const yarp::sig::Vector &y0, const double _Ts, const double _T);
+
+    /**
+    * Copy constructor. 
+    * @param z the object to copy. 
+    * @note After copy, internal filters are reset. 
+    */
+    minJerkTrajGenSoA(const minJerkTrajGenSoA &z);
+
+    /**
+    * Assignment operator. 
+    * @param z the object to copy. 
+    * @note After copy, internal filters are reset. 
+    */
+    minJerkTrajGenSoA& operator=(const minJerkTrajGenSoA &z);
+
+    /**
+    * Compute the next position, velocity and acceleration.
+    * @param yd desired final value of the trajectory.
+    */
+    void computeNextValues(const yarp::sig::Vector &yd);
+
+    /**
+    * Compute the next position, velocity and acceleration.
+    * @param yd array of getDim() elements containing the desired 
+    *           final value of the trajectory.
+    */
+    void computeNextValues(const double *yd);
+};
+
+
+/**
+* \ingroup minJerkCtrl
+*
+* Same as minJerkRefGen, with the implementation of
+* minJerkBaseGenSoA.
+*/
+class minJerkRefGenSoA : public minJerkBaseGenSoA
+{
+protected:
+    virtual void computeCoeffs();
+
+public:
+    /**
+    * Constructor.
+    * @param _dim number of variables.
+    * @param _Ts sample time in seconds.
+    * @param _T trajectory reference time (90% of steady-state value 
+    *           in t=_T, transient extinguished for t>=1.5*_T).
+    */
+    minJerkRefGenSoA(const unsigned int _dim, const double _Ts, const double _T);
+
+    /**
+    * Constructor with initial value.
+    * @param y0 initial value of the trajectory.
+    * @param _Ts sample time in seconds.
+    * @param _T trajectory reference time (90% of steady-state value 
+    *           in t=_T, transient extinguished for t>=1.5*_T).
+    */
+    minJerkRefGenSoA(const yarp::sig::Vector &y0, const double _Ts, const double _T);
+
+    /**
+    * Copy constructor. 
+    * @param z the object to copy. 
+    * @note After copy, internal filters are reset. 
+    */
+    minJerkRefGenSoA(const minJerkRefGenSoA &z);
+
+    /**
+    * Assignment operator. 
+    * @param z the object to copy. 
+    * @note After copy, internal filters are reset. 
+    */
+    minJerkRefGenSoA& operator=(const minJerkRefGenSoA &z);
+
+    /**
+    * Computes the position, velocity and acceleration references.
+    * @param y current position.
+    */
+    void computeNextValues(const yarp::sig::Vector &y);
+
+    /**
+    * Computes the position, velocity and acceleration references.
+    * @param y  current position.
+    * @param yd desired final value of the trajectory.
+    */
+    void computeNextValues(const yarp::sig::Vector &y, const yarp::sig::Vector &yd);
+
+    /**
+    * Computes the position, velocity and acceleration references.
+    * @param y  array of getDim() elements containing the current 
+    *           position.
+    * @param yd array of getDim() elements containing the desired 
+    *           final value of the trajectory (NULL to keep the last
+    *           one).
+    */
+    void computeNextValues(const double *y, const double *yd=NULL);
+};
+
 }
 
 }
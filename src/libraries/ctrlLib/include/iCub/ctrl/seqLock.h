@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * \defgroup seqLock Sequence Lock
+ *
+ * @ingroup ctrlLib
+ *
+ * Lock-free consistent snapshots of data shared among threads.
+ *
+ * \author Ugo Pattacini
+ *
+ */
+
+#ifndef __SEQLOCK_H__
+#define __SEQLOCK_H__
+
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace iCub
+{
+
+namespace ctrl
+{
+
+/**
+* \ingroup seqLock
+*
+* Sequence lock guarding a plain structure of fixed size.
+*
+* Writers are serialized by an internal mutex and bump a sequence
+* counter before and after touching the data; readers never block
+* nor write anything shared: they copy the whole structure and
+* retry only if a writer went through in the meanwhile. Readers get
+* therefore a consistent snapshot of all the fields at once, while
+* a busy reader can never delay a writer (i.e. no priority
+* inversion).
+*
+* The data are stored as an array of atomic words accessed with
+* relaxed ordering, which compiles to plain loads and stores on the
+* common architectures, and are copied in and out with no memory
+* allocation.
+*
+* @note T must be trivially copyable.
+*/
+template<typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SeqLock requires a trivially copyable type");
+
+    static constexpr size_t numWords=(sizeof(T)+sizeof(uint64_t)-1)/sizeof(uint64_t);
+
+    std::atomic<unsigned int> seq;
+    std::atomic<uint64_t>     words[numWords];
+    std::mutex                mtxWrite;
+
+    void load(T &data) const
+    {
+        uint64_t buf[numWords];
+        for (size_t i=0; i<numWords; i++)
+            buf[i]=words[i].load(std::memory_order_relaxed);
+        std::memcpy(&data,buf,sizeof(T));
+    }
+
+    void store(const T &data)
+    {
+        uint64_t buf[numWords]={0};
+        std::memcpy(buf,&data,sizeof(T));
+        for (size_t i=0; i<numWords; i++)
+            words[i].store(buf[i],std::memory_order_relaxed);
+    }
+
+public:
+    /**
+    * Constructor.
+    * @param data is the initial content.
+    */
+    explicit SeqLock(const T &data=T()) : seq(0)
+    {
+        store(data);
+    }
+
+    /**
+    * Copies out a consistent snapshot of the data.
+    * @param data is the destination.
+    */
+    void read(T &data) const
+    {
+        unsigned int s0,s1;
+        do
+        {
+            while ((s0=seq.load(std::memory_order_acquire))&1)
+                std::this_thread::yield();
+
+            load(data);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            s1=seq.load(std::memory_order_relaxed);
+        }
+        while (s0!=s1);
+    }
+
+    /**
+    * Returns a consistent snapshot of the data.
+    * @return the snapshot.
+    */
+    T read() const
+    {
+        T data;
+        read(data);
+        return data;
+    }
+
+    /**
+    * Modifies the data in place, as seen by readers in one go.
+    * @param f is a callable taking a T& that applies the changes;
+    *          it is invoked with the current content.
+    * @note the callable should be short, as it keeps the readers
+    *       spinning.
+    */
+    template<typename F>
+    void update(F f)
+    {
+        std::lock_guard<std::mutex> lck(mtxWrite);
+        T data;
+        load(data);
+        f(data);
+
+        unsigned int s=seq.load(std::memory_order_relaxed);
+        seq.store(s+1,std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        store(data);
+        seq.store(s+2,std::memory_order_release);
+    }
+
+    /**
+    * Replaces the whole content.
+    * @param data is the new content.
+    */
+    void write(const T &data)
+    {
+        update([&data](T &d) { d=data; });
+    }
+};
+
+}
+
+}
+
+#endif
+
+
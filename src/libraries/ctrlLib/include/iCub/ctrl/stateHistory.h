@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * \defgroup stateHistory State History
+ *
+ * @ingroup ctrlLib
+ *
+ * Bounded history of timestamped states with interpolation.
+ *
+ * \author Ugo Pattacini
+ *
+ */
+
+#ifndef __STATEHISTORY_H__
+#define __STATEHISTORY_H__
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+
+#include <yarp/sig/Vector.h>
+
+namespace iCub
+{
+
+namespace ctrl
+{
+
+/**
+* \ingroup stateHistory
+*
+* Ring buffer of the latest states of a system (e.g. the joints
+* angles read by a control loop) along with their timestamps,
+* allowing to retrieve the state at a given time in the past by
+* linear interpolation of the two samples around it.
+*
+* The buffer is meant to be fed by one thread only (the loop) and
+* queried by any other thread: each slot is guarded by its own
+* sequence counter, hence neither the writer nor the readers ever
+* block, and a reader racing with the writer on the oldest slot
+* simply sees it as expired. Storage is allocated once at
+* construction.
+*
+* Typical usage:
+* \code
+* // control loop
+* history.push(encodersStamp,q);
+* ...
+* // another thread, e.g. serving a request about a past image
+* Vector q;
+* if (history.get(imageStamp,q))
+*     ...
+* \endcode
+*/
+class StateHistory
+{
+protected:
+    size_t dim;
+    size_t capacity;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> seqs;
+    std::unique_ptr<std::atomic<double>[]>   stamps;
+    std::unique_ptr<std::atomic<double>[]>   data;
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> first;
+
+    uint64_t firstValid(const uint64_t n) const;
+    bool readStamp(const uint64_t i, double &stamp) const;
+    bool readState(const uint64_t i, double *x) const;
+
+public:
+    /**
+    * Constructor.
+    * @param _dim is the dimension of the state.
+    * @param _capacity is the number of samples kept.
+    */
+    StateHistory(const size_t _dim, const size_t _capacity);
+
+    /**
+    * Returns the dimension of the state.
+    * @return the dimension.
+    */
+    size_t getDim() const { return dim; }
+
+    /**
+    * Returns the number of samples kept.
+    * @return the capacity.
+    */
+    size_t getCapacity() const { return capacity; }
+
+    /**
+    * Stores a new sample.
+    * @param stamp is the timestamp of the sample [s], which is
+    *              expected not to decrease over successive calls.
+    * @param x is the state; only the first getDim() components are
+    *          retained, while missing components are zero-filled.
+    * @note to be called by one thread only.
+    */
+    void push(const double stamp, const yarp::sig::Vector &x);
+
+    /**
+    * Forgets all the samples.
+    * @note to be called by the same thread calling push().
+    */
+    void clear();
+
+    /**
+    * Returns the time span currently covered by the buffer.
+    * @param oldest is the stamp of the oldest sample [s].
+    * @param latest is the stamp of the latest sample [s].
+    * @return true iff the buffer is not empty.
+    */
+    bool getRange(double &oldest, double &latest) const;
+
+    /**
+    * Retrieves the state at a given time.
+    * @param stamp is the time of interest [s].
+    * @param x is the state, linearly interpolated between the two
+    *          samples enclosing the stamp.
+    * @return true iff the stamp lies within the span covered by
+    *         the buffer.
+    */
+    bool get(const double stamp, yarp::sig::Vector &x) const;
+};
+
+}
+
+}
+
+#endif
+
+
@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * \defgroup timingProbe Timing Probe
+ *
+ * @ingroup ctrlLib
+ *
+ * Per-stage cycle-time instrumentation of periodic control loops.
+ *
+ * \author Ugo Pattacini
+ *
+ */
+
+#ifndef __TIMINGPROBE_H__
+#define __TIMINGPROBE_H__
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+
+#include <yarp/os/Vocab.h>
+#include <yarp/os/Bottle.h>
+
+#define TIMINGPROBE_MAGIC       yarp::os::createVocab32('t','p','r','b')
+#define TIMINGPROBE_VERSION     1
+
+namespace iCub
+{
+
+namespace ctrl
+{
+
+/**
+* \ingroup timingProbe
+*
+* Collects the time spent in each stage of a periodic loop (e.g.
+* the run() method of a PeriodicThread), the overall cycle time
+* and the actual period, keeping for each of them the count, the
+* mean, the maximum, the number of overruns against a budget and
+* a fixed-bucket histogram.
+*
+* The probe is meant to be fed by one thread only (the loop) and
+* queried by any other thread (e.g. the one serving the RPC port):
+* all the statistics are stored in atomic variables, therefore
+* neither the loop nor the readers ever block. Requests coming
+* from the readers (reset, start/stop of the log) are applied by
+* the loop at the beginning of the next cycle.
+*
+* Typical usage:
+* \code
+* void run()
+* {
+*     probe.beginCycle();
+*     ...                     // first stage
+*     probe.mark(0);
+*     {
+*         TimingScope scope(probe,1);
+*         ...                 // second stage
+*     }
+*     probe.endCycle();
+* }
+* \endcode
+*
+* The binary log is made of a header followed by one record per
+* cycle:
+* \code
+* int32   magic    ('tprb' vocab)
+* int32   version  (TIMINGPROBE_VERSION)
+* int32   number of stages (n)
+* float64 budget [s]
+* n x { int32 length, char name[length] }
+* ...
+* float64 timestamp [s]
+* float32 stage[n] [s]
+* float32 cycle [s]
+* float32 period [s]
+* \endcode
+*/
+class TimingProbe
+{
+protected:
+    struct Channel
+    {
+        std::string name;
+        double budget;
+        std::atomic<unsigned int> count;
+        std::atomic<unsigned int> overruns;
+        std::atomic<double> sum;
+        std::atomic<double> max;
+        std::unique_ptr<std::atomic<unsigned int>[]> bins;
+    };
+
+    size_t nStages;
+    double budget;
+    double binWidth;
+    unsigned int numBins;
+
+    // stages first, then cycle and period
+    std::unique_ptr<Channel[]> channels;
+
+    // owned by the loop
+    double tCycle;
+    double tMark;
+    double tPrevCycle;
+    bool cycleOpen;
+    std::vector<float> samples;
+    FILE *log;
+    std::string logDir;
+
+    std::atomic<bool> resetRequested;
+    std::atomic<FILE*> pendingLog;
+
+    void add(const size_t channel, const double dt);
+    void applyRequests();
+    void clear();
+    int  find(const std::string &name) const;
+
+public:
+    /**
+    * Constructor.
+    * @param stageNames are the names of the stages of the loop.
+    * @param _budget is the time allowed to the whole cycle [s],
+    *                typically the period of the thread.
+    * @param _numBins is the number of buckets of the histograms;
+    *                 one more bucket collects the samples beyond
+    *                 the range.
+    * @param _binWidth is the width of the buckets [s]; if not
+    *                  positive, the range of the histograms is
+    *                  chosen to be twice the budget.
+    */
+    TimingProbe(const std::vector<std::string> &stageNames,
+                const double _budget, const unsigned int _numBins=40,
+                const double _binWidth=0.0);
+
+    /**
+    * Destructor.
+    */
+    virtual ~TimingProbe();
+
+    /**
+    * Returns the number of stages.
+    * @return the number of stages.
+    */
+    size_t getNumStages() const { return nStages; }
+
+    /**
+    * Sets the time allowed to a stage, beyond which an overrun is
+    * counted (by default stages have no budget).
+    * @param stage is the stage index.
+    * @param _budget is the budget [s]; 0.0 disables the counter.
+    * @note to be called before the loop is started.
+    */
+    void setStageBudget(const size_t stage, const double _budget);
+
+    /**
+    * Returns the current time as used by the probe.
+    * @return the system time [s].
+    * @note the system clock is used regardless of the network
+    *       clock, since the probe measures the real cost of the
+    *       code.
+    */
+    static double now();
+
+    /**
+    * Marks the beginning of a new cycle. If the previous cycle has
+    * not been closed by endCycle() (e.g. because of an early
+    * return), it gets closed here.
+    */
+    void beginCycle();
+
+    /**
+    * Records the time elapsed since the beginning of the cycle or
+    * since the last mark as spent in the given stage.
+    * @param stage is the stage index.
+    */
+    void mark(const size_t stage);
+
+    /**
+    * Records a duration for the given stage, leaving the mark
+    * untouched.
+    * @param stage is the stage index.
+    * @param dt is the duration [s].
+    */
+    void record(const size_t stage, const double dt);
+
+    /**
+    * Marks the end of the current cycle.
+    */
+    void endCycle();
+
+    /**
+    * Asks for resetting the statistics.
+    */
+    void reset();
+
+    /**
+    * Starts dumping the cycles to a binary log.
+    * @param fileName is the name of the log file.
+    * @return true/false on success/failure.
+    */
+    bool openLog(const std::string &fileName);
+
+    /**
+    * Stops dumping the cycles to the binary log.
+    */
+    void closeLog();
+
+    /**
+    * Sets the directory where the logs requested through the RPC
+    * are created (by default the RPC cannot start the log).
+    * @param dir is the directory; an empty string disables the
+    *            log requests coming from the RPC.
+    * @note to be called before the RPC port is opened.
+    */
+    void setLogDir(const std::string &dir) { logDir=dir; }
+
+    /**
+    * Fills the reply with the statistics as a list of
+    * (name count mean max overruns) for each stage, the cycle and
+    * the period, with times in [ms].
+    * @param reply is the bottle to fill in.
+    */
+    void getStatistics(yarp::os::Bottle &reply) const;
+
+    /**
+    * Fills the reply with the histogram of a stage, the cycle or the
+    * period as (name bin_width (bins ...) overflow), with the width
+    * in [ms].
+    * @param name is the name of the stage, "cycle" or "period".
+    * @param reply is the bottle to fill in.
+    * @return true iff the name is known.
+    */
+    bool getHistogram(const std::string &name, yarp::os::Bottle &reply) const;
+
+    /**
+    * Serves the "timing" command of a RPC port:
+    * \code
+    * timing               statistics
+    * timing hist <name>   histogram
+    * timing reset         reset of the statistics
+    * timing log <file>    start of the binary log
+    * timing log off       stop of the binary log
+    * \endcode
+    * The log file must be a plain name (no path), which is created
+    * within the directory given to setLogDir(); the request is
+    * refused if no directory has been set.
+    * The reply starts with the [ack]/[nack] vocab, followed by the
+    * requested data, if any.
+    * @param command is the received command.
+    * @param reply is the reply to be filled in.
+    * @return true iff the command has been handled.
+    */
+    bool respond(const yarp::os::Bottle &command, yarp::os::Bottle &reply);
+};
+
+
+/**
+* \ingroup timingProbe
+*
+* Records the time spent within its scope as the given stage of a
+* TimingProbe.
+*/
+class TimingScope
+{
+    TimingProbe &probe;
+    size_t stage;
+    double t0;
+
+public:
+    /**
+    * Constructor.
+    * @param _probe is the probe to feed.
+    * @param _stage is the stage index.
+    */
+    TimingScope(TimingProbe &_probe, const size_t _stage) :
+                probe(_probe), stage(_stage), t0(TimingProbe::now()) { }
+
+    /**
+    * Destructor.
+    */
+    ~TimingScope() { probe.record(stage,TimingProbe::now()-t0); }
+};
+
+}
+
+}
+
+#endif
+
+
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * \defgroup vectorPacket Vector Packet
+ *
+ * @ingroup ctrlLib
+ *
+ * Fixed-layout binary container for streaming vectors of doubles
+ * over YARP ports.
+ *
+ * \author Ugo Pattacini
+ *
+ */
+
+#ifndef __VECTORPACKET_H__
+#define __VECTORPACKET_H__
+
+#include <vector>
+
+#include <yarp/os/Vocab.h>
+#include <yarp/os/Portable.h>
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
+#include <yarp/sig/Vector.h>
+
+#define VECTORPACKET_MAGIC      yarp::os::createVocab32('v','p','k','t')
+#define VECTORPACKET_VERSION    1
+
+namespace iCub
+{
+
+namespace ctrl
+{
+
+/**
+* \ingroup vectorPacket
+*
+* A portable holding an address, a timestamp and an array of
+* doubles, meant to replace Bottle-encoded streams in high-rate
+* loops (e.g. the joint torques published by wholeBodyDynamics).
+*
+* The wire layout is fixed:
+* \code
+* int32   magic    ('vpkt' vocab)
+* int32   version  (VECTORPACKET_VERSION)
+* int32   address
+* int32   length   (n)
+* float64 timestamp
+* float64 data[n]
+* \endcode
+* The data array is sent as one contiguous block, with no per-item
+* tags. Integers and doubles follow the native little-endian
+* encoding used by YARP for Vector.
+*
+* No reader of this format is shipped with the modules that
+* publish it: the binary streams are meant for external readers
+* linking ctrlLib.
+*
+* The internal buffer is resized only when the length changes,
+* thus repeated calls to set() and read() with the same length do
+* not allocate memory.
+*/
+class VectorPacket : public yarp::os::Portable
+{
+protected:
+    int address;
+    double timestamp;
+    std::vector<double> buffer;
+
+public:
+    /**
+    * Constructor.
+    * @param n is the initial length of the data array.
+    */
+    VectorPacket(const size_t n=0);
+
+    /**
+    * Resizes the data array, preserving its content.
+    * @param n is the new length.
+    */
+    void resize(const size_t n) { buffer.resize(n,0.0); }
+
+    /**
+    * Returns the length of the data array.
+    * @return the length.
+    */
+    size_t length() const { return buffer.size(); }
+
+    /**
+    * Returns a pointer to the data array.
+    * @return the pointer.
+    */
+    double *data() { return buffer.data(); }
+
+    /**
+    * Returns a const pointer to the data array.
+    * @return the pointer.
+    */
+    const double *data() const { return buffer.data(); }
+
+    /**
+    * Sets the address field.
+    * @param _address is the new address.
+    */
+    void setAddress(const int _address) { address=_address; }
+
+    /**
+    * Returns the address field.
+    * @return the address.
+    */
+    int getAddress() const { return address; }
+
+    /**
+    * Sets the timestamp field.
+    * @param _timestamp is the new timestamp [s].
+    */
+    void setTimestamp(const double _timestamp) { timestamp=_timestamp; }
+
+    /**
+    * Returns the timestamp field.
+    * @return the timestamp [s].
+    */
+    double getTimestamp() const { return timestamp; }
+
+    /**
+    * Fills in the packet.
+    * @param v is the vector to be copied in the data array.
+    * @param _address is the address field.
+    * @param _timestamp is the timestamp field [s].
+    */
+    void set(const yarp::sig::Vector &v, const int _address,
+             const double _timestamp);
+
+    /**
+    * Copies the data array into a vector, resizing it only if
+    * required.
+    * @param v is the destination vector.
+    */
+    void get(yarp::sig::Vector &v) const;
+
+    /**
+    * Reads the packet from a connection.
+    * @param connection is the connection reader.
+    * @return true iff a packet was read correctly.
+    */
+    bool read(yarp::os::ConnectionReader &connection) override;
+
+    /**
+    * Writes the packet to a connection.
+    * @param connection is the connection writer.
+    * @return true iff the packet was written correctly.
+    * @note on text-mode connections (e.g. "yarp read") the packet
+    *       is written as a human-readable list.
+    */
+    bool write(yarp::os::ConnectionWriter &connection) const override;
+};
+
+}
+
+}
+
+#endif
+
+
@@ -34,6 +34,12 @@ AWPolyEstimator::AWPolyEstimator(unsigned int _order, unsigned int _N, const dou
     x.resize(N);
 
     firstRun=true;
+
+    recursive=false;
+    dim=0;
+    ringHead=ringSize=0;
+    refreshCnt=invalidCnt=0;
+    t0=0.0;
 }
 
 
@@ -92,13 +98,255 @@ Vector AWPolyEstimator::fit(const Vector &x, const Vector &y, const unsigned int
 /***************************************************************************/
 void AWPolyEstimator::feedData(const AWPolyElement &el)
 {
-    elemList.push_back(el);
+    if (recursive)
+        feedRecursive(el);
+    else
+        elemList.push_back(el);
+}
+
+
+/***************************************************************************/
+void AWPolyEstimator::setRecursive(const bool sw)
+{
+    recursive=sw;
+    elemList.clear();
+    dim=0;
+    ringHead=ringSize=0;
+    refreshCnt=invalidCnt=0;
+    firstRun=true;
+}
+
+
+/***************************************************************************/
+void AWPolyEstimator::feedRecursive(const AWPolyElement &el)
+{
+    if (dim==0)
+    {
+        dim=(unsigned int)el.data.length();
+        ringT.assign(N,0.0);
+        ringX.assign(N*dim,0.0);
+        statT.assign(dim*(2*order+1),0.0);
+        statY.assign(dim*(order+1),0.0);
+        statLen.assign(dim,0);
+        normEq.assign((order+1)*(order+2),0.0);
+    }
+
+    yAssert(el.data.length()==dim);
+
+    if ((ringSize>0) && (el.time<=ringT[(ringHead+N-1)%N]))
+        invalidCnt=N;
+
+    // the oldest sample is about to be overwritten
+    bool valid=(refreshCnt>0);
+    if (valid && (ringSize==N))
+    {
+        for (unsigned int i=0; i<dim; i++)
+        {
+            if (statLen[i]==N)
+            {
+                updateStat(i,N-1,-1.0);
+                statLen[i]--;
+            }
+        }
+    }
+
+    ringT[ringHead]=el.time;
+    for (unsigned int i=0; i<dim; i++)
+        ringX[ringHead*dim+i]=el.data[i];
+    ringHead=(ringHead+1)%N;
+    ringSize=std::min(ringSize+1,N);
+
+    if (valid)
+    {
+        for (unsigned int i=0; i<dim; i++)
+        {
+            updateStat(i,0,1.0);
+            statLen[i]++;
+        }
+    }
+}
+
+
+/***************************************************************************/
+void AWPolyEstimator::updateStat(const unsigned int i, const unsigned int age,
+                                 const double sign)
+{
+    unsigned int idx=(ringHead+N-1-age)%N;
+    double tau=ringT[idx]-t0;
+    double xi=ringX[idx*dim+i];
+
+    double *sT=&statT[i*(2*order+1)];
+    double *sY=&statY[i*(order+1)];
+    double p=sign;
+    for (unsigned int k=0; k<=2*order; k++)
+    {
+        sT[k]+=p;
+        if (k<=order)
+            sY[k]+=p*xi;
+        p*=tau;
+    }
+}
+
+
+/***************************************************************************/
+void AWPolyEstimator::refreshStats()
+{
+    // bring the time origin to the last sample and
+    // recompute the sums to get rid of round-off errors
+    t0=ringT[(ringHead+N-1)%N];
+    std::fill(statT.begin(),statT.end(),0.0);
+    std::fill(statY.begin(),statY.end(),0.0);
+    for (unsigned int i=0; i<dim; i++)
+    {
+        statLen[i]=(unsigned int)winLen[i];
+        for (unsigned int age=0; age<statLen[i]; age++)
+            updateStat(i,age,1.0);
+    }
+}
+
+
+/***************************************************************************/
+void AWPolyEstimator::fitStat(const unsigned int i)
+{
+    // solve the normal equations through Gaussian elimination
+    // with partial pivoting on the augmented matrix [A|b]
+    const unsigned int n=order+1;
+    const unsigned int m=n+1;
+    const double *sT=&statT[i*(2*order+1)];
+    const double *sY=&statY[i*(order+1)];
+    double *A=normEq.data();
+
+    for (unsigned int r=0; r<n; r++)
+    {
+        for (unsigned int c=0; c<n; c++)
+            A[r*m+c]=sT[r+c];
+        A[r*m+n]=sY[r];
+    }
+
+    for (unsigned int c=0; c<n; c++)
+    {
+        unsigned int piv=c;
+        for (unsigned int r=c+1; r<n; r++)
+            if (fabs(A[r*m+c])>fabs(A[piv*m+c]))
+                piv=r;
+        if (piv!=c)
+            for (unsigned int k=c; k<m; k++)
+                std::swap(A[c*m+k],A[piv*m+k]);
+
+        for (unsigned int r=c+1; r<n; r++)
+        {
+            double f=A[r*m+c]/A[c*m+c];
+            for (unsigned int k=c; k<m; k++)
+                A[r*m+k]-=f*A[c*m+k];
+        }
+    }
+
+    for (int r=n-1; r>=0; r--)
+    {
+        double v=A[r*m+n];
+        for (unsigned int c=r+1; c<n; c++)
+            v-=A[r*m+c]*coeff[c];
+        coeff[r]=v/A[r*m+r];
+    }
+}
+
+
+/***************************************************************************/
+Vector AWPolyEstimator::estimateRecursive()
+{
+    yAssert(ringSize>0);
+
+    Vector esteem(dim,0.0);
+
+    if (firstRun)
+    {
+        winLen.resize(dim,N);
+        mse.resize(dim,0.0);
+        firstRun=false;
+    }
+
+    if (ringSize<N)
+        return esteem;
+
+    if (invalidCnt>0)
+    {
+        yWarning()<<"Provided non-increasing time vector";
+        invalidCnt--;
+        return esteem;
+    }
+
+    if (refreshCnt==0)
+    {
+        refreshStats();
+        refreshCnt=N;
+    }
+    refreshCnt--;
+
+    for (unsigned int i=0; i<dim; i++)
+    {
+        // change the window length of two units, back and forth
+        unsigned int n1=(unsigned int)((winLen[i]>(order+1))?(winLen[i]-1):(order+1));
+        unsigned int n2=(unsigned int)((winLen[i]<N)?(winLen[i]+1):N);
+
+        // shrink the statistics to the shortest window
+        for (; statLen[i]>n1; statLen[i]--)
+            updateStat(i,statLen[i]-1,-1.0);
+        for (; statLen[i]<n1; statLen[i]++)
+            updateStat(i,statLen[i],1.0);
+
+        // cycle upon all possibile window's length,
+        // growing the statistics by one sample each time
+        for (unsigned int n=n1; n<=n2; n++)
+        {
+            for (; statLen[i]<n; statLen[i]++)
+                updateStat(i,statLen[i],1.0);
+
+            fitStat(i);
+            bool _stop=false;
+
+            // test the regressor upon all the elements
+            // belonging to the actual window
+            mse[i]=0.0;
+            unsigned int idx=(ringHead+N-1)%N;
+            for (unsigned int age=0; age<n; age++, idx=(idx>0)?(idx-1):(N-1))
+            {
+                double tau=ringT[idx]-t0;
+                double y=coeff[order];
+                for (int k=order-1; k>=0; k--)
+                    y=y*tau+coeff[k];
+
+                double e=ringX[idx*dim+i]-y;
+                _stop|=(fabs(e)>D);
+                mse[i]+=e*e;
+            }
+            mse[i]/=n;
+
+            // set the new window's length in case of
+            // crossing of max deviation threshold
+            if (_stop)
+            {
+                winLen[i]=n;
+                break;
+            }
+        }
+
+        esteem[i]=getEsteeme();
+
+        // keep the statistics on the current window
+        for (; statLen[i]>winLen[i]; statLen[i]--)
+            updateStat(i,statLen[i]-1,-1.0);
+    }
+
+    return esteem;
 }
 
 
 /***************************************************************************/
 Vector AWPolyEstimator::estimate()
 {
+    if (recursive)
+        return estimateRecursive();
+
     yAssert(elemList.size()>0);
 
     size_t dim=elemList[0].data.length();
@@ -197,6 +445,13 @@ void AWPolyEstimator::reset()
         winLen.resize(elemList[0].data.length(),N);
         elemList.clear();
     }
+
+    if (ringSize>0)
+    {
+        winLen.resize(dim,N);
+        ringHead=ringSize=0;
+        refreshCnt=invalidCnt=0;
+    }
 }
 
 
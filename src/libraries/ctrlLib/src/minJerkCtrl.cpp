@@ -10,7 +10,10 @@
 
 #include <sstream>
 #include <cmath>
+#include <limits>
+#include <algorithm>
 
+#include <yarp/os/Log.h>
 #include <yarp/os/Time.h>
 #include <yarp/math/Math.h>
 #include <iCub/ctrl/minJerkCtrl.h>
@@ -95,6 +98,176 @@ minJerkVelCtrlForIdealPlant::~minJerkVelCtrlForIdealPlant()
 }
 
 
+/*******************************************************************************************/
+minJerkVelCtrlForIdealPlantSoA::minJerkVelCtrlForIdealPlantSoA(const double _Ts, const int _dim) :
+                                                               Ts(_Ts), T(1.0), dim(_dim)
+{
+    allocate();
+    computeCoeffs();
+}
+
+
+/*******************************************************************************************/
+minJerkVelCtrlForIdealPlantSoA::minJerkVelCtrlForIdealPlantSoA(const minJerkVelCtrlForIdealPlantSoA &z) :
+                                                               Ts(z.Ts), T(z.T), dim(z.dim)
+{
+    allocate();
+    copyStates(z);
+}
+
+
+/*******************************************************************************************/
+minJerkVelCtrlForIdealPlantSoA& minJerkVelCtrlForIdealPlantSoA::operator=(const minJerkVelCtrlForIdealPlantSoA &z)
+{
+    if (this!=&z)
+    {
+        if (dim!=z.dim)
+        {
+            dim=z.dim;
+            allocate();
+        }
+
+        Ts=z.Ts;
+        T=z.T;
+        copyStates(z);
+    }
+
+    return *this;
+}
+
+
+/*******************************************************************************************/
+void minJerkVelCtrlForIdealPlantSoA::allocate()
+{
+    // 2 rows of past inputs and 2 of past outputs
+    storage.assign(4*dim,0.0);
+    u[0]=storage.data();  u[1]=u[0]+dim;
+    y[0]=u[1]+dim;        y[1]=y[0]+dim;
+    cmd.resize(dim,0.0);
+}
+
+
+/*******************************************************************************************/
+void minJerkVelCtrlForIdealPlantSoA::copyStates(const minJerkVelCtrlForIdealPlantSoA &z)
+{
+    for (int i=0; i<3; i++)
+    {
+        b[i]=z.b[i];
+        a[i]=z.a[i];
+    }
+
+    // the rows of z may be rotated, hence they are copied one by one
+    for (int i=0; i<2; i++)
+    {
+        std::copy(z.u[i],z.u[i]+dim,u[i]);
+        std::copy(z.y[i],z.y[i]+dim,y[i]);
+    }
+
+    cmd=z.cmd;
+}
+
+
+/*******************************************************************************************/
+void minJerkVelCtrlForIdealPlantSoA::computeCoeffs()
+{
+    // same coefficients as minJerkVelCtrlForIdealPlant
+    double T2=T*T;
+    double T3=T2*T;
+    double twoOnTs=2.0/Ts;
+
+    double a_=-150.765868956161/T3;
+    double b_=-84.9812819469538/T2;
+    double c_=-15.9669610709384/T;
+
+    double c1=twoOnTs*(twoOnTs-c_)-b_;
+    double c2=-a_/c1;
+
+    b[0]=c2;
+    b[1]=2.0*c2;
+    b[2]=c2;
+
+    a[0]=1.0;
+    a[1]=-2.0*(twoOnTs*twoOnTs+b_)/c1;
+    a[2]=(twoOnTs*(twoOnTs+c_)-b_)/c1;
+}
+
+
+/*******************************************************************************************/
+Vector minJerkVelCtrlForIdealPlantSoA::computeCmd(const double _T, const Vector &e)
+{
+    yAssert((int)e.length()==dim);
+    if (T!=_T)
+    {    
+        T=_T;
+        computeCoeffs();
+    }
+
+    // same operations in the same order as Filter::filt();
+    // the oldest rows are overwritten with the new samples
+    // and become the newest
+    const double b0=b[0], b1=b[1], b2=b[2];
+    const double a0=a[0], a1=a[1], a2=a[2];
+    double *u0=u[0], *u1=u[1];
+    double *y0=y[0], *y1=y[1];
+    const double *in=e.data();
+    double *out=cmd.data();
+    for (int j=0; j<dim; j++)
+    {
+        double uj=in[j];
+        double yj=b0*uj;
+        yj+=b1*u0[j];
+        yj+=b2*u1[j];
+        yj-=a1*y0[j];
+        yj-=a2*y1[j];
+        yj/=a0;
+        u1[j]=uj;
+        y1[j]=yj;
+        out[j]=yj;
+    }
+
+    u[0]=u1; u[1]=u0;
+    y[0]=y1; y[1]=y0;
+
+    return cmd;
+}
+
+
+/*******************************************************************************************/
+void minJerkVelCtrlForIdealPlantSoA::reset(const Vector &u0)
+{
+    // same as Filter::init(u0,uold[0])
+    yAssert((int)u0.length()==dim);
+    double sum_b=0.0;
+    for (int i=0; i<3; i++)
+        sum_b+=b[i];
+
+    double sum_a=0.0;
+    for (int i=0; i<3; i++)
+        sum_a+=a[i];
+
+    bool dcGain=(fabs(sum_b)>std::numeric_limits<double>::epsilon());
+    bool scaleY=(fabs(sum_a-a[0])>std::numeric_limits<double>::epsilon());
+    for (int j=0; j<dim; j++)
+    {
+        double u_init,y_init=u0[j];
+        if (dcGain)
+            u_init=(sum_a/sum_b)*u0[j];
+        else
+        {
+            u_init=u[0][j];
+            if (scaleY)
+                y_init=a[0]/(a[0]-sum_a)*u0[j];
+        }
+
+        for (int i=0; i<2; i++)
+        {
+            u[i][j]=u_init;
+            y[i][j]=y_init;
+        }
+    }
+}
+
+
 /*******************************************************************************************/
 minJerkVelCtrlForNonIdealPlant::minJerkVelCtrlForNonIdealPlant(const double _Ts, const int _dim) :
                                                                Ts(_Ts), dim(_dim), T(1.0)
@@ -565,3 +738,416 @@ void minJerkRefGen::computeNextValues(const yarp::sig::Vector &y, const yarp::si
 }
 
 
+/*******************************************************************************************/
+minJerkBaseGenSoA::minJerkBaseGenSoA(const unsigned int _dim, const double _Ts, const double _T)
+    :Ts(_Ts), T(_T), dim(_dim), configured(false)
+{
+    pos = vel = acc = lastRef = err = zeros(dim);
+    allocate();
+}
+
+
+/*******************************************************************************************/
+minJerkBaseGenSoA::minJerkBaseGenSoA(const Vector &y0, const double _Ts, const double _T)
+    :Ts(_Ts), T(_T), dim((unsigned int)y0.length()), configured(false)
+{
+    lastRef = pos = y0;
+    vel = acc = err = zeros(dim);
+    allocate();
+}
+
+
+/*******************************************************************************************/
+minJerkBaseGenSoA::minJerkBaseGenSoA(const minJerkBaseGenSoA &z)
+    :pos(z.pos), vel(z.vel), acc(z.acc), lastRef(z.lastRef), err(z.err),
+     Ts(z.Ts), T(z.T), dim(z.dim), configured(false)
+{
+    allocate();
+}
+
+
+/*******************************************************************************************/
+minJerkBaseGenSoA& minJerkBaseGenSoA::operator=(const minJerkBaseGenSoA &z)
+{
+    if (dim!=z.dim)
+    {
+        dim = z.dim;
+        err.resize(dim);
+        allocate();
+    }
+
+    pos = z.pos;
+    vel = z.vel;
+    acc = z.acc;
+    lastRef = z.lastRef;
+    T = z.T;
+    Ts = z.Ts;
+    configured = false;
+
+    return *this;
+}
+
+
+/*******************************************************************************************/
+void minJerkBaseGenSoA::allocate()
+{
+    // 3 sections, each with 3 rows of past inputs and 3 of past outputs
+    storage.assign(3*6*dim,0.0);
+    double *row=storage.data();
+
+    Section *sections[3]={&posSection, &velSection, &accSection};
+    for (int k=0; k<3; k++)
+    {
+        Section &s=*sections[k];
+        s.order=0;
+        for (int i=0; i<4; i++)
+            s.b[i]=s.a[i]=0.0;
+
+        for (int i=0; i<3; i++)
+        {
+            s.u[i]=row; row+=dim;
+            s.y[i]=row; row+=dim;
+        }
+    }
+}
+
+
+/*******************************************************************************************/
+void minJerkBaseGenSoA::setCoeffs(Section &s, const unsigned int order,
+                                  const double *num, const double *den)
+{
+    s.order=order;
+    for (unsigned int i=0; i<=order; i++)
+    {
+        s.b[i]=num[i];
+        s.a[i]=den[i];
+    }
+}
+
+
+/*******************************************************************************************/
+void minJerkBaseGenSoA::initSection(Section &s, const double *y0, const double *u0)
+{
+    // same as Filter::init(y0,u0), with y0==NULL standing for zeros
+    double sum_b=0.0;
+    for (unsigned int i=0; i<=s.order; i++)
+        sum_b+=s.b[i];
+
+    double sum_a=0.0;
+    for (unsigned int i=0; i<=s.order; i++)
+        sum_a+=s.a[i];
+
+    bool dcGain=(fabs(sum_b)>std::numeric_limits<double>::epsilon());
+    bool scaleY=(fabs(sum_a-s.a[0])>std::numeric_limits<double>::epsilon());
+    for (unsigned int j=0; j<dim; j++)
+    {
+        double y_j=(y0!=NULL)?y0[j]:0.0;
+        double u_init,y_init=y_j;
+        if (dcGain)
+            u_init=(sum_a/sum_b)*y_j;
+        else
+        {
+            u_init=u0[j];
+            if (scaleY)
+                y_init=s.a[0]/(s.a[0]-sum_a)*y_j;
+        }
+
+        for (unsigned int i=0; i<s.order; i++)
+        {
+            s.u[i][j]=u_init;
+            s.y[i][j]=y_init;
+        }
+    }
+}
+
+
+/*******************************************************************************************/
+void minJerkBaseGenSoA::step(Section &s, const double *in, double *out)
+{
+    // the operations are carried out in the same order as in
+    // Filter::filt() to get the very same outputs; the oldest rows
+    // are overwritten with the new samples and become the newest
+    const double b0=s.b[0], b1=s.b[1], b2=s.b[2], b3=s.b[3];
+    const double a0=s.a[0], a1=s.a[1], a2=s.a[2], a3=s.a[3];
+    if (s.order==3)
+    {
+        double *u0=s.u[0], *u1=s.u[1], *u2=s.u[2];
+        double *y0=s.y[0], *y1=s.y[1], *y2=s.y[2];
+        for (unsigned int j=0; j<dim; j++)
+        {
+            double u=in[j];
+            double y=b0*u;
+            y+=b1*u0[j];
+            y+=b2*u1[j];
+            y+=b3*u2[j];
+            y-=a1*y0[j];
+            y-=a2*y1[j];
+            y-=a3*y2[j];
+            y/=a0;
+            u2[j]=u;
+            y2[j]=y;
+            out[j]=y;
+        }
+
+        s.u[0]=u2; s.u[1]=u0; s.u[2]=u1;
+        s.y[0]=y2; s.y[1]=y0; s.y[2]=y1;
+    }
+    else
+    {
+        double *u0=s.u[0], *u1=s.u[1];
+        double *y0=s.y[0], *y1=s.y[1];
+        for (unsigned int j=0; j<dim; j++)
+        {
+            double u=in[j];
+            double y=b0*u;
+            y+=b1*u0[j];
+            y+=b2*u1[j];
+            y-=a1*y0[j];
+            y-=a2*y1[j];
+            y/=a0;
+            u1[j]=u;
+            y1[j]=y;
+            out[j]=y;
+        }
+
+        s.u[0]=u1; s.u[1]=u0;
+        s.y[0]=y1; s.y[1]=y0;
+    }
+}
+
+
+/*******************************************************************************************/
+void minJerkBaseGenSoA::init(const Vector &y0)
+{
+    yAssert(y0.length()==dim);
+
+    // same initialization as minJerkBaseGen::init()
+    lastRef = pos = y0;
+    if (configured)
+    {
+        initSection(posSection,pos.data(),posSection.u[0]);
+        initSection(velSection,NULL,pos.data());
+        initSection(accSection,NULL,pos.data());
+    }
+}
+
+
+/*******************************************************************************************/
+bool minJerkBaseGenSoA::setT(const double _T)
+{
+    if(_T<=0.0)
+        return false;
+    T = _T;
+    computeCoeffs();
+    return true;
+}
+
+
+/*******************************************************************************************/
+bool minJerkBaseGenSoA::setTs(const double _Ts)
+{
+    if(_Ts<=0.0)
+        return false;
+    Ts = _Ts;
+    computeCoeffs();
+    return true;
+}
+
+
+/*******************************************************************************************/
+minJerkTrajGenSoA::minJerkTrajGenSoA(const unsigned int _dim, const double _Ts, const double _T)
+    :minJerkBaseGenSoA(_dim,_Ts,_T)
+{
+    computeCoeffs();
+}
+
+
+/*******************************************************************************************/
+minJerkTrajGenSoA::minJerkTrajGenSoA(const Vector &y0, const double _Ts, const double _T)
+    :minJerkBaseGenSoA(y0,_Ts,_T)
+{
+    computeCoeffs();
+}
+
+
+/*******************************************************************************************/
+minJerkTrajGenSoA::minJerkTrajGenSoA(const minJerkTrajGenSoA &z)
+    :minJerkBaseGenSoA(z)
+{
+    computeCoeffs();
+}
+
+
+/*******************************************************************************************/
+minJerkTrajGenSoA& minJerkTrajGenSoA::operator=(const minJerkTrajGenSoA &z)
+{
+    minJerkBaseGenSoA::operator=(z);
+    computeCoeffs();
+    return *this;
+}
+
+
+/*******************************************************************************************/
+void minJerkTrajGenSoA::computeCoeffs()
+{
+    // same coefficients as minJerkTrajGen::computeCoeffs()
+    double a = -150.765868956161/(T*T*T);
+    double b = -84.9812819469538/(T*T);
+    double c = -15.9669610709384/T;
+
+    // implementing F(s)=-a/(s^3-c*s^2-b*s-a)
+    double m = 4.0*c*Ts;
+    double n = 2.0*b*Ts*Ts;
+    double p = a*Ts*Ts*Ts;
+    double num[4] = {p, 3.0*p, 3.0*p, p};
+    double den[4] = {m+n+p-8.0, -m+n+3.0*p+24.0, -m-n+3.0*p-24.0, m-n+p+8.0};
+    setCoeffs(posSection,3,num,den);
+    if (!configured)
+    {
+        std::fill(storage.begin(),storage.end(),0.0);
+        initSection(posSection,pos.data(),posSection.u[0]);
+    }
+
+    // implementing F(s)=-a*s/(s^3-c*s^2-b*s-a)
+    p = 2.0*a*Ts*Ts;
+    num[0] = p; num[1] = p; num[2] = -p; num[3] = -p;
+    setCoeffs(velSection,3,num,den);
+    initSection(velSection,NULL,pos.data());
+
+    // implementing F(s)=-a*s^2/(s^3-c*s^2-b*s-a)
+    p = 4.0*a*Ts;
+    num[0] = p; num[1] = -p; num[2] = -p; num[3] = p;
+    setCoeffs(accSection,3,num,den);
+    initSection(accSection,NULL,pos.data());
+
+    configured = true;
+}
+
+
+/*******************************************************************************************/
+void minJerkTrajGenSoA::computeNextValues(const Vector &yd)
+{
+    yAssert(yd.length()==dim);
+    computeNextValues(yd.data());
+}
+
+
+/*******************************************************************************************/
+void minJerkTrajGenSoA::computeNextValues(const double *yd)
+{
+    std::copy(yd,yd+dim,lastRef.data());
+    step(posSection,yd,pos.data());
+    step(velSection,yd,vel.data());
+    step(accSection,yd,acc.data());
+}
+
+
+/*******************************************************************************************/
+minJerkRefGenSoA::minJerkRefGenSoA(const unsigned int _dim, const double _Ts, const double _T)
+    :minJerkBaseGenSoA(_dim,_Ts,_T)
+{
+    computeCoeffs();
+}
+
+
+/*******************************************************************************************/
+minJerkRefGenSoA::minJerkRefGenSoA(const Vector &y0, const double _Ts, const double _T)
+    :minJerkBaseGenSoA(y0,_Ts,_T)
+{
+    computeCoeffs();
+}
+
+
+/*******************************************************************************************/
+minJerkRefGenSoA::minJerkRefGenSoA(const minJerkRefGenSoA &z)
+    :minJerkBaseGenSoA(z)
+{
+    computeCoeffs();
+}
+
+
+/*******************************************************************************************/
+minJerkRefGenSoA& minJerkRefGenSoA::operator=(const minJerkRefGenSoA &z)
+{
+    minJerkBaseGenSoA::operator=(z);
+    computeCoeffs();
+    return *this;
+}
+
+
+/*******************************************************************************************/
+void minJerkRefGenSoA::computeCoeffs()
+{
+    // same coefficients as minJerkRefGen::computeCoeffs()
+    double a = -150.765868956161/(T*T*T);
+    double b = -84.9812819469538/(T*T);
+    double c = -15.9669610709384/T;
+
+    // implementing F(s)=-a/(s^3-c*s^2-b*s-a)
+    double m = 4.0*c*Ts;
+    double n = 2.0*b*Ts*Ts;
+    double p = a*Ts*Ts*Ts;
+    double num[4] = {p, 3.0*p, 3.0*p, p};
+    double den[4] = {m+n+p-8.0, -m+n+3.0*p+24.0, -m-n+3.0*p-24.0, m-n+p+8.0};
+    setCoeffs(posSection,3,num,den);
+    if (!configured)
+    {
+        std::fill(storage.begin(),storage.end(),0.0);
+        initSection(posSection,pos.data(),posSection.u[0]);
+    }
+
+    // implementing F(s)=-a/(s^2-c*s-b)
+    double twoOnTs=2.0/Ts;
+    double c1=twoOnTs*(twoOnTs-c)-b;
+    double c2=-a/c1;
+    num[0] = c2; num[1] = 2.0*c2; num[2] = c2;
+    den[0] = 1.0; den[1] = -2.0*(twoOnTs*twoOnTs+b)/c1; den[2] = (twoOnTs*(twoOnTs+c)-b)/c1;
+    setCoeffs(velSection,2,num,den);
+    initSection(velSection,NULL,pos.data());
+
+    // implementing F(s)=-a*s/(s^2-c*s-b)
+    m = 2.0*c*Ts;
+    n = b*Ts*Ts;
+    p = 2.0*a*Ts;
+    num[0] = -p; num[1] = 0.0; num[2] = p;
+    den[0] = 4.0-m-n; den[1] = -8.0+m-2.0*n; den[2] = 4.0-n;
+    setCoeffs(accSection,2,num,den);
+    initSection(accSection,NULL,pos.data());
+
+    configured = true;
+}
+
+
+/*******************************************************************************************/
+void minJerkRefGenSoA::computeNextValues(const Vector &y)
+{
+    yAssert(y.length()==dim);
+    computeNextValues(y.data());
+}
+
+
+/*******************************************************************************************/
+void minJerkRefGenSoA::computeNextValues(const Vector &y, const Vector &yd)
+{
+    yAssert((y.length()==dim) && (yd.length()==dim));
+    computeNextValues(y.data(),yd.data());
+}
+
+
+/*******************************************************************************************/
+void minJerkRefGenSoA::computeNextValues(const double *y, const double *yd)
+{
+    if (yd!=NULL)
+        std::copy(yd,yd+dim,lastRef.data());
+
+    double *e=err.data();
+    const double *r=lastRef.data();
+    for (unsigned int j=0; j<dim; j++)
+        e[j]=r[j]-y[j];
+
+    step(posSection,r,pos.data());
+    step(velSection,e,vel.data());
+    step(accSection,e,acc.data());
+}
+
+
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#include <algorithm>
+
+#include <iCub/ctrl/stateHistory.h>
+
+using namespace std;
+using namespace yarp::sig;
+using namespace iCub::ctrl;
+
+
+/**********************************************************************/
+StateHistory::StateHistory(const size_t _dim, const size_t _capacity) :
+                           dim(_dim), capacity(std::max(_capacity,(size_t)2)),
+                           count(0), first(0)
+{
+    seqs.reset(new atomic<uint64_t>[capacity]);
+    stamps.reset(new atomic<double>[capacity]);
+    data.reset(new atomic<double>[capacity*dim]);
+
+    for (size_t i=0; i<capacity; i++)
+    {
+        seqs[i].store(0,memory_order_relaxed);
+        stamps[i].store(0.0,memory_order_relaxed);
+    }
+
+    for (size_t i=0; i<capacity*dim; i++)
+        data[i].store(0.0,memory_order_relaxed);
+}
+
+
+/**********************************************************************/
+void StateHistory::push(const double stamp, const Vector &x)
+{
+    // the i-th sample is complete when its slot holds 2*i+2,
+    // while an odd value flags a write in progress
+    uint64_t i=count.load(memory_order_relaxed);
+    size_t slot=i%capacity;
+
+    seqs[slot].store(2*i+1,memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    stamps[slot].store(stamp,memory_order_relaxed);
+    size_t n=std::min(dim,x.length());
+    atomic<double> *d=&data[slot*dim];
+    for (size_t j=0; j<n; j++)
+        d[j].store(x[j],memory_order_relaxed);
+    for (size_t j=n; j<dim; j++)
+        d[j].store(0.0,memory_order_relaxed);
+
+    seqs[slot].store(2*i+2,memory_order_release);
+    count.store(i+1,memory_order_release);
+}
+
+
+/**********************************************************************/
+void StateHistory::clear()
+{
+    // advance past the stored samples so that readers
+    // still holding old indices see their slots expired
+    uint64_t i=count.load(memory_order_relaxed);
+    for (size_t j=0; j<capacity; j++)
+        seqs[j].store(0,memory_order_relaxed);
+    first.store(i+capacity,memory_order_relaxed);
+    count.store(i+capacity,memory_order_release);
+}
+
+
+/**********************************************************************/
+uint64_t StateHistory::firstValid(const uint64_t n) const
+{
+    // the oldest slot is the next to be overwritten,
+    // hence it is skipped when the buffer is full;
+    // nothing before the last clear() is valid either
+    uint64_t lo=(n>capacity) ? n-capacity+1 : 0;
+    return std::max(lo,first.load(memory_order_relaxed));
+}
+
+
+/**********************************************************************/
+bool StateHistory::readStamp(const uint64_t i, double &stamp) const
+{
+    size_t slot=i%capacity;
+    uint64_t s0=seqs[slot].load(memory_order_acquire);
+    if (s0!=2*i+2)
+        return false;
+
+    stamp=stamps[slot].load(memory_order_relaxed);
+    atomic_thread_fence(memory_order_acquire);
+    return (seqs[slot].load(memory_order_relaxed)==s0);
+}
+
+
+/**********************************************************************/
+bool StateHistory::readState(const uint64_t i, double *x) const
+{
+    size_t slot=i%capacity;
+    uint64_t s0=seqs[slot].load(memory_order_acquire);
+    if (s0!=2*i+2)
+        return false;
+
+    const atomic<double> *d=&data[slot*dim];
+    for (size_t j=0; j<dim; j++)
+        x[j]=d[j].load(memory_order_relaxed);
+    atomic_thread_fence(memory_order_acquire);
+    return (seqs[slot].load(memory_order_relaxed)==s0);
+}
+
+
+/**********************************************************************/
+bool StateHistory::getRange(double &oldest, double &latest) const
+{
+    uint64_t n=count.load(memory_order_acquire);
+    if (n==0)
+        return false;
+
+    uint64_t i=firstValid(n);
+    for (; i<n; i++)
+        if (readStamp(i,oldest))
+            break;
+
+    return ((i<n) && readStamp(n-1,latest));
+}
+
+
+/**********************************************************************/
+bool StateHistory::get(const double stamp, Vector &x) const
+{
+    uint64_t n=count.load(memory_order_acquire);
+    if (n==0)
+        return false;
+
+    uint64_t lo=firstValid(n);
+    if (lo>=n)
+        return false;
+
+    uint64_t hi=n-1;
+
+    double tLo,tHi;
+    if (!readStamp(lo,tLo) || !readStamp(hi,tHi))
+        return false;
+
+    if ((stamp<tLo) || (stamp>tHi))
+        return false;
+
+    // find the last sample not newer than the stamp
+    while (hi-lo>1)
+    {
+        uint64_t mid=lo+(hi-lo)/2;
+        double tMid;
+        if (!readStamp(mid,tMid))
+            return false;
+
+        if (tMid<=stamp)
+        {
+            lo=mid;
+            tLo=tMid;
+        }
+        else
+        {
+            hi=mid;
+            tHi=tMid;
+        }
+    }
+
+    if (x.length()!=dim)
+        x.resize(dim);
+
+    if (!readState(lo,x.data()))
+        return false;
+
+    if ((lo==hi) || (tHi<=tLo) || (stamp<=tLo))
+        return true;
+
+    // blend the upper sample in place, validating it afterwards
+    size_t slot=hi%capacity;
+    uint64_t s0=seqs[slot].load(memory_order_acquire);
+    if (s0!=2*hi+2)
+        return false;
+
+    double alpha=(stamp-tLo)/(tHi-tLo);
+    const atomic<double> *d=&data[slot*dim];
+    for (size_t j=0; j<dim; j++)
+        x[j]+=alpha*(d[j].load(memory_order_relaxed)-x[j]);
+    atomic_thread_fence(memory_order_acquire);
+    return (seqs[slot].load(memory_order_relaxed)==s0);
+}
+
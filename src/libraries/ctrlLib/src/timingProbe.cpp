@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#include <cstdint>
+#include <algorithm>
+
+#include <yarp/os/SystemClock.h>
+#include <iCub/ctrl/timingProbe.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace iCub::ctrl;
+
+namespace
+{
+    // placeholder for the request of closing the log
+    char closeTag;
+    FILE *const LOG_CLOSE=reinterpret_cast<FILE*>(&closeTag);
+
+    // the loop is the only writer, hence a plain
+    // load/store pair is enough to update the atomics
+    template<typename T>
+    inline void accumulate(atomic<T> &a, const T v)
+    {
+        a.store(a.load(memory_order_relaxed)+v,memory_order_relaxed);
+    }
+}
+
+
+/**********************************************************************/
+TimingProbe::TimingProbe(const vector<string> &stageNames,
+                         const double _budget, const unsigned int _numBins,
+                         const double _binWidth) :
+                         nStages(stageNames.size()), budget(_budget),
+                         numBins(std::max(_numBins,1U)), tCycle(0.0),
+                         tMark(0.0), tPrevCycle(0.0), cycleOpen(false),
+                         samples(stageNames.size()+2,0.0f), log(nullptr),
+                         resetRequested(false), pendingLog(nullptr)
+{
+    if (_binWidth>0.0)
+        binWidth=_binWidth;
+    else if (budget>0.0)
+        binWidth=2.0*budget/numBins;
+    else
+        binWidth=0.001;
+
+    channels.reset(new Channel[nStages+2]);
+    for (size_t i=0; i<nStages+2; i++)
+    {
+        Channel &ch=channels[i];
+        ch.name=(i<nStages) ? stageNames[i] : (i==nStages ? "cycle" : "period");
+        ch.budget=(i==nStages) ? budget : 0.0;
+        ch.bins.reset(new atomic<unsigned int>[numBins+1]);
+    }
+
+    clear();
+}
+
+
+/**********************************************************************/
+TimingProbe::~TimingProbe()
+{
+    FILE *f=pendingLog.exchange(nullptr);
+    if ((f!=nullptr) && (f!=LOG_CLOSE))
+        fclose(f);
+
+    if (log!=nullptr)
+        fclose(log);
+}
+
+
+/**********************************************************************/
+void TimingProbe::setStageBudget(const size_t stage, const double _budget)
+{
+    if (stage<nStages)
+        channels[stage].budget=_budget;
+}
+
+
+/**********************************************************************/
+double TimingProbe::now()
+{
+    return SystemClock::nowSystem();
+}
+
+
+/**********************************************************************/
+void TimingProbe::clear()
+{
+    for (size_t i=0; i<nStages+2; i++)
+    {
+        Channel &ch=channels[i];
+        ch.count.store(0,memory_order_relaxed);
+        ch.overruns.store(0,memory_order_relaxed);
+        ch.sum.store(0.0,memory_order_relaxed);
+        ch.max.store(0.0,memory_order_relaxed);
+        for (unsigned int j=0; j<=numBins; j++)
+            ch.bins[j].store(0,memory_order_relaxed);
+    }
+}
+
+
+/**********************************************************************/
+void TimingProbe::add(const size_t channel, const double dt)
+{
+    Channel &ch=channels[channel];
+    accumulate(ch.count,1U);
+    accumulate(ch.sum,dt);
+    if (dt>ch.max.load(memory_order_relaxed))
+        ch.max.store(dt,memory_order_relaxed);
+    if ((ch.budget>0.0) && (dt>ch.budget))
+        accumulate(ch.overruns,1U);
+
+    unsigned int bin=(dt>0.0) ? (unsigned int)std::min(dt/binWidth,(double)numBins) : 0;
+    accumulate(ch.bins[bin],1U);
+}
+
+
+/**********************************************************************/
+void TimingProbe::applyRequests()
+{
+    if (resetRequested.exchange(false))
+    {
+        clear();
+        tPrevCycle=0.0;
+    }
+
+    FILE *f=pendingLog.exchange(nullptr);
+    if (f==nullptr)
+        return;
+
+    if (log!=nullptr)
+        fclose(log);
+    log=(f!=LOG_CLOSE) ? f : nullptr;
+
+    if (log!=nullptr)
+    {
+        int32_t header[3]={TIMINGPROBE_MAGIC,TIMINGPROBE_VERSION,(int32_t)nStages};
+        fwrite(header,sizeof(int32_t),3,log);
+        fwrite(&budget,sizeof(double),1,log);
+        for (size_t i=0; i<nStages; i++)
+        {
+            int32_t len=(int32_t)channels[i].name.length();
+            fwrite(&len,sizeof(int32_t),1,log);
+            fwrite(channels[i].name.c_str(),1,len,log);
+        }
+    }
+}
+
+
+/**********************************************************************/
+void TimingProbe::beginCycle()
+{
+    if (cycleOpen)
+        endCycle();
+
+    applyRequests();
+
+    double t=now();
+    std::fill(samples.begin(),samples.end(),0.0f);
+    if (tPrevCycle>0.0)
+    {
+        double period=t-tPrevCycle;
+        add(nStages+1,period);
+        samples[nStages+1]=(float)period;
+    }
+
+    tPrevCycle=tCycle=tMark=t;
+    cycleOpen=true;
+}
+
+
+/**********************************************************************/
+void TimingProbe::mark(const size_t stage)
+{
+    double t=now();
+    record(stage,t-tMark);
+    tMark=t;
+}
+
+
+/**********************************************************************/
+void TimingProbe::record(const size_t stage, const double dt)
+{
+    if (stage<nStages)
+    {
+        add(stage,dt);
+        samples[stage]+=(float)dt;
+    }
+}
+
+
+/**********************************************************************/
+void TimingProbe::endCycle()
+{
+    if (!cycleOpen)
+        return;
+
+    double cycle=now()-tCycle;
+    add(nStages,cycle);
+    samples[nStages]=(float)cycle;
+    cycleOpen=false;
+
+    if (log!=nullptr)
+    {
+        fwrite(&tCycle,sizeof(double),1,log);
+        fwrite(samples.data(),sizeof(float),samples.size(),log);
+    }
+}
+
+
+/**********************************************************************/
+void TimingProbe::reset()
+{
+    resetRequested=true;
+}
+
+
+/**********************************************************************/
+bool TimingProbe::openLog(const string &fileName)
+{
+    FILE *f=fopen(fileName.c_str(),"wb");
+    if (f==nullptr)
+        return false;
+
+    // the loop does the writes, so a large buffer
+    // keeps the disk access off most of the cycles
+    setvbuf(f,nullptr,_IOFBF,1<<16);
+
+    FILE *prev=pendingLog.exchange(f);
+    if ((prev!=nullptr) && (prev!=LOG_CLOSE))
+        fclose(prev);
+
+    return true;
+}
+
+
+/**********************************************************************/
+void TimingProbe::closeLog()
+{
+    FILE *prev=pendingLog.exchange(LOG_CLOSE);
+    if ((prev!=nullptr) && (prev!=LOG_CLOSE))
+        fclose(prev);
+}
+
+
+/**********************************************************************/
+int TimingProbe::find(const string &name) const
+{
+    for (size_t i=0; i<nStages+2; i++)
+        if (channels[i].name==name)
+            return (int)i;
+
+    return -1;
+}
+
+
+/**********************************************************************/
+void TimingProbe::getStatistics(Bottle &reply) const
+{
+    for (size_t i=0; i<nStages+2; i++)
+    {
+        const Channel &ch=channels[i];
+        unsigned int count=ch.count.load(memory_order_relaxed);
+
+        Bottle &b=reply.addList();
+        b.addString(ch.name);
+        b.addInt32((int)count);
+        b.addFloat64(1e3*ch.sum.load(memory_order_relaxed)/std::max(count,1U));
+        b.addFloat64(1e3*ch.max.load(memory_order_relaxed));
+        b.addInt32((int)ch.overruns.load(memory_order_relaxed));
+    }
+}
+
+
+/**********************************************************************/
+bool TimingProbe::getHistogram(const string &name, Bottle &reply) const
+{
+    int i=find(name);
+    if (i<0)
+        return false;
+
+    const Channel &ch=channels[i];
+    Bottle &b=reply.addList();
+    b.addString(ch.name);
+    b.addFloat64(1e3*binWidth);
+    Bottle &bins=b.addList();
+    for (unsigned int j=0; j<numBins; j++)
+        bins.addInt32((int)ch.bins[j].load(memory_order_relaxed));
+    b.addInt32((int)ch.bins[numBins].load(memory_order_relaxed));
+
+    return true;
+}
+
+
+/**********************************************************************/
+bool TimingProbe::respond(const Bottle &command, Bottle &reply)
+{
+    if (command.get(0).asString()!="timing")
+        return false;
+
+    string cmd=command.get(1).asString();
+    Bottle payload;
+    bool ok=true;
+
+    if (command.size()<2)
+        getStatistics(payload);
+    else if (cmd=="hist")
+        ok=getHistogram(command.get(2).asString(),payload);
+    else if (cmd=="reset")
+        reset();
+    else if ((cmd=="log") && (command.size()>2))
+    {
+        string fileName=command.get(2).asString();
+        if (fileName=="off")
+            closeLog();
+        // remote clients can only name a file within the log directory
+        else if (logDir.empty() || fileName.empty() || (fileName==".") ||
+                 (fileName=="..") || (fileName.find_first_of("/\\")!=string::npos))
+            ok=false;
+        else
+            ok=openLog(logDir+"/"+fileName);
+    }
+    else
+        ok=false;
+
+    reply.addVocab32(ok ? "ack" : "nack");
+    reply.append(payload);
+
+    return true;
+}
+
+
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#include <climits>
+#include <algorithm>
+
+#include <yarp/os/Bottle.h>
+#include <iCub/ctrl/vectorPacket.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace iCub::ctrl;
+
+
+/**********************************************************************/
+VectorPacket::VectorPacket(const size_t n) : address(0), timestamp(0.0),
+                                             buffer(n,0.0)
+{
+}
+
+
+/**********************************************************************/
+void VectorPacket::set(const Vector &v, const int _address,
+                       const double _timestamp)
+{
+    if (buffer.size()!=v.length())
+        buffer.resize(v.length());
+
+    std::copy(v.data(),v.data()+v.length(),buffer.begin());
+    address=_address;
+    timestamp=_timestamp;
+}
+
+
+/**********************************************************************/
+void VectorPacket::get(Vector &v) const
+{
+    if (v.length()!=buffer.size())
+        v.resize(buffer.size());
+
+    std::copy(buffer.begin(),buffer.end(),v.data());
+}
+
+
+/**********************************************************************/
+bool VectorPacket::read(ConnectionReader &connection)
+{
+    if (connection.isTextMode())
+    {
+        // text mode: (address timestamp (data ...))
+        Bottle b;
+        if (!b.read(connection) || (b.size()<3))
+            return false;
+
+        Bottle *payload=b.get(2).asList();
+        if (payload==nullptr)
+            return false;
+
+        address=b.get(0).asInt32();
+        timestamp=b.get(1).asFloat64();
+        buffer.resize(payload->size());
+        for (size_t i=0; i<buffer.size(); i++)
+            buffer[i]=payload->get(i).asFloat64();
+
+        return true;
+    }
+
+    if (connection.expectInt32()!=VECTORPACKET_MAGIC)
+        return false;
+
+    // newer versions are supposed to append fields to the header,
+    // which older readers cannot skip safely
+    int version=connection.expectInt32();
+    if ((version<1) || (version>VECTORPACKET_VERSION))
+        return false;
+
+    address=connection.expectInt32();
+    int n=connection.expectInt32();
+    if (n<0)
+        return false;
+
+    timestamp=connection.expectFloat64();
+
+    // the length comes from the wire, hence it is checked against
+    // the data actually available before allocating anything
+    if (((size_t)n>connection.getSize()/sizeof(double)) ||
+        ((size_t)n>INT_MAX/sizeof(double)))
+        return false;
+
+    if (buffer.size()!=(size_t)n)
+        buffer.resize(n);
+
+    if (n>0)
+        if (!connection.expectBlock((char*)buffer.data(),n*sizeof(double)))
+            return false;
+
+    return !connection.isError();
+}
+
+
+/**********************************************************************/
+bool VectorPacket::write(ConnectionWriter &connection) const
+{
+    if (connection.isTextMode())
+    {
+        Bottle b;
+        b.addInt32(address);
+        b.addFloat64(timestamp);
+        Bottle &payload=b.addList();
+        for (auto &d:buffer)
+            payload.addFloat64(d);
+
+        return b.write(connection);
+    }
+
+    connection.appendInt32(VECTORPACKET_MAGIC);
+    connection.appendInt32(VECTORPACKET_VERSION);
+    connection.appendInt32(address);
+    connection.appendInt32((int)buffer.size());
+    connection.appendFloat64(timestamp);
+
+    // the packet is kept alive by the port until the
+    // write is over, so the data can be sent by reference
+    if (!buffer.empty())
+        connection.appendExternalBlock((const char*)buffer.data(),
+                                       buffer.size()*sizeof(double));
+
+    return !connection.isError();
+}
+
+
@@ -73,6 +73,7 @@
 
 #include <deque>
 #include <string>
+#include <vector>
 
 
 namespace iCub
@@ -555,6 +556,43 @@ protected:
 
     const yarp::sig::Vector zero0;
 
+    ///scratch of the composite rigid body algorithm: frames of the links w.r.t. the 0th frame
+    std::vector<iKin::iKinHMatrix> crbaH;
+    ///scratch of the composite rigid body algorithm: masses, COMs (3 per link) and inertias (9 per link) of the composite bodies
+    std::vector<double> crbaMass, crbaCOM, crbaI;
+
+    /**
+    * Per-link scratch of the articulated-body algorithm. Spatial vectors are expressed
+    * in the link frame, with the angular part first, i.e. (w,v) for motions and (Mu,F)
+    * for wrenches.
+    */
+    struct ArticulatedLink
+    {
+        double X[36];   ///< motion transform from the previous link frame (row-major)
+        double S[6];    ///< joint axis (null for blocked links)
+        double v[6];    ///< spatial velocity
+        double c[6];    ///< velocity-product acceleration
+        double IA[36];  ///< articulated-body inertia (row-major)
+        double pA[6];   ///< articulated-body bias force
+        double U[6];    ///< IA*S
+        double D;       ///< S'*IA*S
+        double u;       ///< tau - S'*pA
+        double a[6];    ///< spatial acceleration
+        int    dof;     ///< index of the joint among the DOF, -1 if blocked
+    };
+
+    ///scratch of the articulated-body algorithm
+    std::vector<ArticulatedLink> abaLinks;
+
+    ///scratch of the derivatives of the Newton-Euler torques: derivatives of w, dw and ddpC (3 per link each)
+    std::vector<double> neDiff;
+
+    /**
+    * Allocates the scratch of the composite rigid body algorithm, of the articulated-body
+    * algorithm and of the derivatives of the Newton-Euler torques
+    */
+    void reserveScratch();
+
     /**
     * Clone function
     */
@@ -1104,6 +1142,30 @@ public:
     */
     yarp::sig::Matrix computeMassMatrix(const yarp::sig::Vector& q);
 
+    /**
+    * Compute the joint space mass matrix considering only the active joints, by means of the
+    * Composite Rigid Body Algorithm. The result is the same of computeMassMatrix(), but only
+    * the links masses, COMs and inertias are used: the Newton-Euler state (joints velocities
+    * and accelerations, wrenches) is left untouched.
+    * @return a DOF-by-DOF symmetric positive-definite matrix
+    */
+    yarp::sig::Matrix computeMassMatrixCRBA();
+
+    /**
+    * Compute the joint space mass matrix considering only the active joints, by means of the
+    * Composite Rigid Body Algorithm.
+    * @param q vector of the active joint positions
+    * @return a DOF-by-DOF symmetric positive-definite matrix
+    */
+    yarp::sig::Matrix computeMassMatrixCRBA(const yarp::sig::Vector& q);
+
+    /**
+    * Compute the joint space mass matrix considering only the active joints, by means of the
+    * Composite Rigid Body Algorithm, without allocating memory.
+    * @param M the DOF-by-DOF matrix filled with the result (resized only if it has not the right size)
+    */
+    void computeMassMatrixCRBA(yarp::sig::Matrix& M);
+
     /**
     * Compute the torques due to centrifugal and coriolis effects considering only the active joints.
     * @return a DOF-dim vector
@@ -1154,6 +1216,96 @@ public:
     yarp::sig::Vector computeCcGravityTorques(const yarp::sig::Vector& ddp0, const yarp::sig::Vector& q, const yarp::sig::Vector& dq);
 
 
+    //---------------------------
+    // Forward Dynamics
+    //---------------------------
+
+    /**
+    * Compute the joint accelerations produced by the given joint torques, considering only
+    * the active joints, by means of the O(N) Featherstone's Articulated-Body Algorithm.
+    * The current joint positions and velocities are used, while the base kinematics and the
+    * end-effector wrench follow the same conventions of computeNewtonEuler(), so that the
+    * result is the inverse of the Newton-Euler computation in DYNAMIC mode (i.e. without
+    * rotors inertia and friction). The state of the chain is left untouched and no memory
+    * is allocated, provided that ddq has the right size.
+    * @param w0 the angular velocity of the base, expressed in the base reference frame (3x1)
+    * @param dw0 the angular acceleration of the base, expressed in the base reference frame (3x1)
+    * @param ddp0 the linear acceleration of the base, i.e. equal and opposite to gravity if the base is still,
+    *             expressed in the base reference frame (not the 0th frame) (3x1)
+    * @param Fend the force exerted by the end-effector, expressed in the last link frame (3x1)
+    * @param Muend the moment exerted by the end-effector, expressed in the last link frame (3x1)
+    * @param tau the DOF-dim vector of the active joint torques
+    * @param ddq the DOF-dim vector of the resulting joint accelerations
+    * @return true/false on success/failure
+    */
+    bool computeForwardDynamics(const yarp::sig::Vector &w0, const yarp::sig::Vector &dw0, const yarp::sig::Vector &ddp0,
+                                const yarp::sig::Vector &Fend, const yarp::sig::Vector &Muend,
+                                const yarp::sig::Vector &tau, yarp::sig::Vector &ddq);
+
+    /**
+    * Compute the joint accelerations produced by the given joint torques, considering only
+    * the active joints, with the base still and no end-effector wrench.
+    * @param ddp0 a vector that is equal and opposite to gravity expressed in the base reference frame (not the 0th frame)
+    * @param tau the DOF-dim vector of the active joint torques
+    * @return the DOF-dim vector of the joint accelerations
+    */
+    yarp::sig::Vector computeForwardDynamics(const yarp::sig::Vector &ddp0, const yarp::sig::Vector &tau);
+
+    /**
+    * Compute the joint accelerations produced by the given joint torques, considering only
+    * the active joints, with the base still and no end-effector wrench.
+    * @param ddp0 a vector that is equal and opposite to gravity expressed in the base reference frame (not the 0th frame)
+    * @param q vector of the active joint positions
+    * @param dq vector of the active joint velocities
+    * @param tau the DOF-dim vector of the active joint torques
+    * @return the DOF-dim vector of the joint accelerations
+    */
+    yarp::sig::Vector computeForwardDynamics(const yarp::sig::Vector &ddp0, const yarp::sig::Vector &q,
+                                             const yarp::sig::Vector &dq, const yarp::sig::Vector &tau);
+
+
+    //---------------------------
+    // Derivatives of the Inverse Dynamics
+    //---------------------------
+
+    /**
+    * Compute the partial derivatives of the joint torques given by the Newton-Euler method
+    * w.r.t. the joint positions, velocities and accelerations, considering only the active
+    * joints. The derivatives are propagated analytically with a forward and a backward pass
+    * over the links of the OneChainNewtonEuler, right after the Newton-Euler computation
+    * (in DYNAMIC mode, with forward kinematics and backward wrench), whose results remain
+    * stored in the links as in computeNewtonEuler().
+    * @param w0 the angular velocity of the base (3x1)
+    * @param dw0 the angular acceleration of the base (3x1)
+    * @param ddp0 the linear acceleration of the base (3x1)
+    * @param Fend the end-effector force (3x1)
+    * @param Muend the end-effector moment (3x1)
+    * @param dtau_q the DOF-by-DOF matrix whose (i,j) element is the derivative of the i-th torque w.r.t. the j-th joint position
+    * @param dtau_dq the DOF-by-DOF matrix whose (i,j) element is the derivative of the i-th torque w.r.t. the j-th joint velocity
+    * @param dtau_ddq the DOF-by-DOF matrix whose (i,j) element is the derivative of the i-th torque w.r.t. the j-th joint acceleration,
+    *                 i.e. the mass matrix
+    * @return true/false on success/failure
+    * @note After calling this method the NewtonEulerMode is set to DYNAMIC
+    */
+    bool computeNewtonEulerDerivatives(const yarp::sig::Vector &w0, const yarp::sig::Vector &dw0, const yarp::sig::Vector &ddp0,
+                                       const yarp::sig::Vector &Fend, const yarp::sig::Vector &Muend,
+                                       yarp::sig::Matrix &dtau_q, yarp::sig::Matrix &dtau_dq, yarp::sig::Matrix &dtau_ddq);
+
+    /**
+    * Compute the partial derivatives of the joint torques given by the Newton-Euler method
+    * w.r.t. the joint positions, velocities and accelerations, considering only the active
+    * joints, with the base still and no end-effector wrench.
+    * @param ddp0 a vector that is equal and opposite to gravity expressed in the base reference frame (not the 0th frame)
+    * @param dtau_q the derivatives w.r.t. the joint positions (DOF-by-DOF)
+    * @param dtau_dq the derivatives w.r.t. the joint velocities (DOF-by-DOF)
+    * @param dtau_ddq the derivatives w.r.t. the joint accelerations (DOF-by-DOF)
+    * @return true/false on success/failure
+    * @note After calling this method the NewtonEulerMode is set to DYNAMIC
+    */
+    bool computeNewtonEulerDerivatives(const yarp::sig::Vector &ddp0, yarp::sig::Matrix &dtau_q,
+                                       yarp::sig::Matrix &dtau_dq, yarp::sig::Matrix &dtau_ddq);
+
+
 
 };
 
@@ -653,10 +653,28 @@ public:
 
     /**
     * Main function to manage the exchange of kinematic information among the limbs attached to the node.
+    * It is equivalent to solveInputKinematics() followed by solveOutputKinematics() on all limbs.
     * @return true if succeeds, false otherwise
     */
     bool solveKinematics();
 
+    /**
+    * First step of solveKinematics(): solves the kinematics of the (one) limb with kinematic flow
+    * of input type, and updates the node kinematic variables.
+    * @return true if succeeds, false otherwise
+    */
+    bool solveInputKinematics();
+
+    /**
+    * Second step of solveKinematics(): if the kinematic flow of the limb is of output type, the node
+    * kinematic variables are forwarded to the limb, whose kinematics is then solved; otherwise
+    * nothing is done. Since the node variables are only read, different limbs can be solved
+    * concurrently.
+    * @param iLimb the index of the limb - the index is the number of insertion of the limb in the node
+    * @return true if succeeds, false otherwise
+    */
+    bool solveOutputKinematics(unsigned int iLimb);
+
     /**
     * Set the kinematic measurement (w,dw,ddp) on the limb where the kinematic flow is of type RBT_NODE_IN.
     */
@@ -672,10 +690,34 @@ public:
     * performs a "basic" wrench computation without any sensor, just
     * setting wrenches at the end-effector or at the base, and calling
     * recursive wrench computation.
+    * It is equivalent to solveInputWrench() on all limbs followed by solveOutputWrench().
     * @return true if succeeds, false otherwise
     */
     virtual bool solveWrench();
 
+    /**
+    * First step of solveWrench(): if the wrench flow of the limb is of input type, the wrench
+    * phase of the limb is solved, without updating the node; otherwise nothing is done. 
+    * Different limbs can be solved concurrently.
+    * @param iLimb the index of the limb - the index is the number of insertion of the limb in the node
+    * @return true if succeeds, false otherwise
+    */
+    virtual bool solveInputWrench(unsigned int iLimb);
+
+    /**
+    * Second step of solveWrench(): the wrenches of the limbs with input flow are summed in the
+    * node, following the order of insertion of the limbs, then the node wrench is forwarded to the
+    * limbs with output flow, whose wrench phase is solved.
+    * @return true if succeeds, false otherwise
+    */
+    bool solveOutputWrench();
+
+    /**
+    * Return the number of limbs attached to the node.
+    * @return the number of limbs
+    */
+    unsigned int getNLimbs() const;
+
     /**
     * This is to manage the exchange of wrench information among the limbs attached to the node.
     * Multiple limbs with wrench flow of input type can exist, but at least one limb with output type must exist, to 
@@ -979,6 +1021,15 @@ public:
     */
     virtual bool solveWrench();
 
+    /**
+    * First step of solveWrench(): if the wrench flow of the limb is of input type, the wrench
+    * phase of the limb is solved, using its iDynSensor if the limb has a FT sensor; otherwise
+    * nothing is done. Different limbs can be solved concurrently.
+    * @param iLimb the index of the limb - the index is the number of insertion of the limb in the node
+    * @return true if succeeds, false otherwise
+    */
+    virtual bool solveInputWrench(unsigned int iLimb);
+
     /**
     * Set the Wrench measures on the limbs attached to the node.
     * The parameters F and M are (3xN) matrices, where each column
@@ -1461,6 +1512,8 @@ public:
 };
 
 
+class iDynWorkerPool;
+
 /**
 * \ingroup iDynBody
 *
@@ -1476,6 +1529,10 @@ protected:
     RigidBodyTransformation * rbt;
     version_tag tag;
 
+    /// the workers solving the independent limbs in solve()
+    iDynWorkerPool * pool;
+    unsigned int numThreads;
+
 public:
 
     /// pointer to UpperTorso = head + right arm + left arm
@@ -1510,6 +1567,34 @@ public:
     */
     void attachLowerTorso(const yarp::sig::Vector &FM_right_leg, const yarp::sig::Vector &FM_left_leg);
 
+    /**
+    * Solve kinematics and wrenches of the whole body. The inertial and sensor measurements
+    * of the UpperTorso must have been already set. The result is the same of the sequence
+    * upperTorso->solveKinematics(), upperTorso->solveWrench(), attachLowerTorso(), 
+    * lowerTorso->solveKinematics(), lowerTorso->solveWrench(), but the limbs whose
+    * computations do not depend on each other (the arms, the head, the torso and the legs
+    * once the head kinematics is known) are solved concurrently by the worker threads,
+    * see setNumThreads(). The node balances are always performed in the same order,
+    * thus the outcome does not depend on the number of threads.
+    * @param FM_right_leg the measurement of the right leg FT sensor
+    * @param FM_left_leg the measurement of the left leg FT sensor
+    * @return true if succeeds, false otherwise
+    */
+    bool solve(const yarp::sig::Vector &FM_right_leg, const yarp::sig::Vector &FM_left_leg);
+
+    /**
+    * Set the number of threads used by solve(), including the calling one. 
+    * The workers are spawned here and kept alive across calls.
+    * @param _numThreads the number of threads (0 is treated as 1, i.e. no workers)
+    */
+    void setNumThreads(const unsigned int _numThreads);
+
+    /**
+    * Return the number of threads used by solve().
+    * @return the number of threads
+    */
+    unsigned int getNumThreads() const { return numThreads; }
+
     /**
     * Performs the computation of the center of mass (COM) of the whole iCub
     * @return true if succeeds, false otherwise
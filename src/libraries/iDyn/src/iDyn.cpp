@@ -50,6 +50,36 @@ using namespace iCub::iDyn;
 //
 //================================
 
+namespace
+{
+    // c = a x b
+    inline void cross3(const double *a, const double *b, double *c)
+    {
+        c[0]=a[1]*b[2]-a[2]*b[1];
+        c[1]=a[2]*b[0]-a[0]*b[2];
+        c[2]=a[0]*b[1]-a[1]*b[0];
+    }
+
+    // y = A*x, with A 6x6 row-major
+    inline void mul6(const double *A, const double *x, double *y)
+    {
+        for(int r=0; r<6; r++)
+            y[r]=A[6*r]*x[0]+A[6*r+1]*x[1]+A[6*r+2]*x[2]+A[6*r+3]*x[3]+A[6*r+4]*x[4]+A[6*r+5]*x[5];
+    }
+
+    // y = A'*x, with A 6x6 row-major
+    inline void mul6T(const double *A, const double *x, double *y)
+    {
+        for(int c=0; c<6; c++)
+            y[c]=A[c]*x[0]+A[6+c]*x[1]+A[12+c]*x[2]+A[18+c]*x[3]+A[24+c]*x[4]+A[30+c]*x[5];
+    }
+
+    inline double dot6(const double *a, const double *b)
+    {
+        return a[0]*b[0]+a[1]*b[1]+a[2]*b[2]+a[3]*b[3]+a[4]*b[4]+a[5]*b[5];
+    }
+}
+
 
 void iCub::iDyn::notImplemented(const unsigned int verbose)
 {
@@ -498,6 +528,17 @@ void iDynChain::build()
         curr_dq = getDAng();
         curr_ddq = getD2Ang();
     }
+    reserveScratch();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynChain::reserveScratch()
+{
+    crbaH.resize(N+1);
+    crbaMass.resize(N);
+    crbaCOM.resize(3*N);
+    crbaI.resize(9*N);
+    abaLinks.resize(N);
+    neDiff.resize(9*N);
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 iDynChain::iDynChain(const iDynChain &c)
@@ -1646,6 +1687,129 @@ Matrix iDynChain::computeMassMatrix(const Vector& q)
     return computeMassMatrix();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+Matrix iDynChain::computeMassMatrixCRBA()
+{
+    Matrix M(DOF,DOF);
+    computeMassMatrixCRBA(M);
+    return M;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+Matrix iDynChain::computeMassMatrixCRBA(const Vector& q)
+{
+    setAng(q);
+    return computeMassMatrixCRBA();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Composite Rigid Body Algorithm. All the quantities are expressed in the 0th frame (the
+// mass matrix does not depend on the choice of the reference frame), being crbaH[k] the
+// frame of the joint k, i.e. the frame of the link k-1.
+// For each link k, going backward, the links k..N-1 are lumped into a composite body with
+// mass mc, COM pc and inertia Ic (w.r.t. pc); when the joint k undergoes a unit acceleration
+// about its axis z (through o), with null velocities, the composite body requires the force
+// f = mc*z x (pc-o) and the moment Ic*z + (pc-o') x f about any point o' of the parent links,
+// whose projection on the axis of joint j (through o') gives M(j,k).
+void iDynChain::computeMassMatrixCRBA(Matrix& M)
+{
+    if((M.rows()!=DOF) || (M.cols()!=DOF))
+        M.resize(DOF,DOF);
+    if(crbaH.size()!=N+1)
+        reserveScratch();
+
+    // forward pass: frames of the links
+    iKinHMatrix L;
+    crbaH[0].eye();
+    for(unsigned int k=0; k<N; k++)
+    {
+        allList[k]->fastGetH(L,true);
+        const iKinHMatrix &T=crbaH[k];
+        iKinHMatrix &Tn=crbaH[k+1];
+        for(int r=0; r<3; r++)
+        {
+            for(int c=0; c<4; c++)
+                Tn(r,c)=T(r,0)*L(0,c)+T(r,1)*L(1,c)+T(r,2)*L(2,c);
+            Tn(r,3)+=T(r,3);
+        }
+    }
+
+    // backward pass: composite bodies
+    double mc=0.0;
+    double pc[3]={0.0,0.0,0.0};
+    double Ic[9]={0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0,0.0};
+    for(int k=N-1; k>=0; k--)
+    {
+        const iKinHMatrix &T=crbaH[k+1];
+        const double m=allList[k]->getMass();
+        const Matrix &HC=allList[k]->getCOM();
+        const Matrix &Il=allList[k]->getInertia();
+
+        // COM and inertia of the link in the 0th frame
+        double c[3],RI[9],I[9];
+        for(int r=0; r<3; r++)
+            c[r]=T(r,0)*HC(0,3)+T(r,1)*HC(1,3)+T(r,2)*HC(2,3)+T(r,3);
+        for(int r=0; r<3; r++)
+            for(int j=0; j<3; j++)
+                RI[3*r+j]=T(r,0)*Il(0,j)+T(r,1)*Il(1,j)+T(r,2)*Il(2,j);
+        for(int r=0; r<3; r++)
+            for(int j=0; j<3; j++)
+                I[3*r+j]=RI[3*r]*T(j,0)+RI[3*r+1]*T(j,1)+RI[3*r+2]*T(j,2);
+
+        // lump the link into the composite body
+        double mn=mc+m;
+        double pn[3];
+        for(int r=0; r<3; r++)
+            pn[r]=(mn>0.0) ? (mc*pc[r]+m*c[r])/mn : c[r];
+
+        // parallel axis theorem for both the bodies
+        double d1[3]={pc[0]-pn[0],pc[1]-pn[1],pc[2]-pn[2]};
+        double d2[3]={c[0]-pn[0],c[1]-pn[1],c[2]-pn[2]};
+        double dd1=d1[0]*d1[0]+d1[1]*d1[1]+d1[2]*d1[2];
+        double dd2=d2[0]*d2[0]+d2[1]*d2[1]+d2[2]*d2[2];
+        for(int r=0; r<3; r++)
+        {
+            for(int j=0; j<3; j++)
+                Ic[3*r+j]+=I[3*r+j]-mc*d1[r]*d1[j]-m*d2[r]*d2[j];
+            Ic[4*r]+=mc*dd1+m*dd2;
+        }
+
+        mc=mn;
+        for(int r=0; r<3; r++)
+            pc[r]=pn[r];
+
+        crbaMass[k]=mc;
+        for(int r=0; r<3; r++)
+            crbaCOM[3*k+r]=pc[r];
+        for(int r=0; r<9; r++)
+            crbaI[9*k+r]=Ic[r];
+    }
+
+    // fill the mass matrix, exploiting the symmetry
+    for(unsigned int i=0; i<DOF; i++)
+    {
+        const unsigned int hash_i=hash[i];
+        const iKinHMatrix &Ti=crbaH[hash_i];
+        const double *p=&crbaCOM[3*hash_i];
+        const double *Ii=&crbaI[9*hash_i];
+        const double z[3]={Ti(0,2),Ti(1,2),Ti(2,2)};
+        const double d[3]={p[0]-Ti(0,3),p[1]-Ti(1,3),p[2]-Ti(2,3)};
+
+        double f[3],n[3];
+        f[0]=crbaMass[hash_i]*(z[1]*d[2]-z[2]*d[1]);
+        f[1]=crbaMass[hash_i]*(z[2]*d[0]-z[0]*d[2]);
+        f[2]=crbaMass[hash_i]*(z[0]*d[1]-z[1]*d[0]);
+        for(int r=0; r<3; r++)
+            n[r]=Ii[3*r]*z[0]+Ii[3*r+1]*z[1]+Ii[3*r+2]*z[2];
+
+        for(unsigned int j=0; j<=i; j++)
+        {
+            const iKinHMatrix &Tj=crbaH[hash[j]];
+            const double e[3]={p[0]-Tj(0,3),p[1]-Tj(1,3),p[2]-Tj(2,3)};
+            M(j,i)=M(i,j)=Tj(0,2)*(n[0]+e[1]*f[2]-e[2]*f[1])+
+                          Tj(1,2)*(n[1]+e[2]*f[0]-e[0]*f[2])+
+                          Tj(2,2)*(n[2]+e[0]*f[1]-e[1]*f[0]);
+        }
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // This is a simpler version of the method, just to understand what the method does.
 // The new version is about 2 times faster than this, because it exploits the fact that
 // the mass matrix is symmetric (but it is a little harder to understand the code).
@@ -1730,6 +1894,424 @@ Vector iDynChain::computeCcGravityTorques(const Vector& ddp0, const Vector& q, c
     setDAng(dq);
     return computeCcGravityTorques(ddp0);
 }
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Articulated-Body Algorithm (R. Featherstone, Rigid Body Dynamics Algorithms, table 7.1).
+// As in OneChainNewtonEuler, the base kinematics is rotated by H0 into the frame before the
+// 0th link, the joint k rotates about the z axis of the frame of the link k-1, and the
+// end-effector wrench is expressed in the frame of the last link (HN is not considered).
+bool iDynChain::computeForwardDynamics(const Vector &w0, const Vector &dw0, const Vector &ddp0,
+                                       const Vector &Fend, const Vector &Muend,
+                                       const Vector &tau, Vector &ddq)
+{
+    if((w0.length()!=3)||(dw0.length()!=3)||(ddp0.length()!=3)||(Fend.length()!=3)||(Muend.length()!=3))
+    {
+        if(verbose)
+            yError("iDynChain error: computeForwardDynamics() failed due to wrong sizes of the base/end-effector vectors: %d %d %d %d %d instead of 3 3 3 3 3 \n",
+                   (int)w0.length(),(int)dw0.length(),(int)ddp0.length(),(int)Fend.length(),(int)Muend.length());
+        return false;
+    }
+    if(tau.length()!=DOF)
+    {
+        if(verbose) yError("iDynChain error: computeForwardDynamics() failed due to wrong size of the torques vector: %d instead of %d \n",(int)tau.length(),DOF);
+        return false;
+    }
+    if(ddq.length()!=DOF)
+        ddq.resize(DOF);
+    if(abaLinks.size()!=N)
+        reserveScratch();
+
+    // base motion, with the origin of the base frame still, brought
+    // from the base reference frame to the frame before the 0th link
+    double vBase[6],aBase[6];
+    for(int r=0; r<3; r++)
+    {
+        vBase[r]=H0(0,r)*w0[0]+H0(1,r)*w0[1]+H0(2,r)*w0[2];
+        vBase[3+r]=0.0;
+        aBase[r]=H0(0,r)*dw0[0]+H0(1,r)*dw0[1]+H0(2,r)*dw0[2];
+        aBase[3+r]=H0(0,r)*ddp0[0]+H0(1,r)*ddp0[1]+H0(2,r)*ddp0[2];
+    }
+
+    // forward pass: velocities, velocity-product terms and rigid-body inertias
+    iKinHMatrix L;
+    int d=0;
+    for(unsigned int k=0; k<N; k++)
+    {
+        ArticulatedLink &l=abaLinks[k];
+        allList[k]->fastGetH(L,true);
+
+        // E=R' rotates from the previous frame, p is r projected in the link frame
+        double E[9],p[3],px[9];
+        for(int r=0; r<3; r++)
+            for(int c=0; c<3; c++)
+                E[3*r+c]=L(c,r);
+        for(int r=0; r<3; r++)
+            p[r]=E[3*r]*L(0,3)+E[3*r+1]*L(1,3)+E[3*r+2]*L(2,3);
+        px[0]=0.0;   px[1]=-p[2]; px[2]=p[1];
+        px[3]=p[2];  px[4]=0.0;   px[5]=-p[0];
+        px[6]=-p[1]; px[7]=p[0];  px[8]=0.0;
+
+        // X = [E 0; -[p]x*E E]
+        for(int r=0; r<3; r++)
+        {
+            for(int c=0; c<3; c++)
+            {
+                l.X[6*r+c]=E[3*r+c];
+                l.X[6*r+c+3]=0.0;
+                l.X[6*(r+3)+c]=-(px[3*r]*E[c]+px[3*r+1]*E[3+c]+px[3*r+2]*E[6+c]);
+                l.X[6*(r+3)+c+3]=E[3*r+c];
+            }
+        }
+
+        // the joint rotates about the z axis of the previous frame, which passes through -p
+        l.dof=-1;
+        for(int r=0; r<6; r++)
+            l.S[r]=0.0;
+        if(!allList[k]->isBlocked())
+        {
+            l.dof=d++;
+            l.S[0]=E[2]; l.S[1]=E[5]; l.S[2]=E[8];
+            cross3(l.S,p,l.S+3);
+        }
+
+        // v = X*v_prev + S*dq,  c = v x S*dq
+        const double *vPrev=(k==0) ? vBase : abaLinks[k-1].v;
+        mul6(l.X,vPrev,l.v);
+        const double dq=(l.dof>=0) ? allList[k]->getDAng() : 0.0;
+        double vJ[6];
+        for(int r=0; r<6; r++)
+        {
+            vJ[r]=l.S[r]*dq;
+            l.v[r]+=vJ[r];
+        }
+        double tmp[3];
+        cross3(l.v,vJ,l.c);
+        cross3(l.v,vJ+3,l.c+3);
+        cross3(l.v+3,vJ,tmp);
+        for(int r=0; r<3; r++)
+            l.c[3+r]+=tmp[r];
+
+        // spatial inertia about the link frame origin
+        const double m=allList[k]->getMass();
+        const Matrix &HC=allList[k]->getCOM();
+        const Matrix &I=allList[k]->getInertia();
+        const double rc[3]={HC(0,3),HC(1,3),HC(2,3)};
+        const double rc2=rc[0]*rc[0]+rc[1]*rc[1]+rc[2]*rc[2];
+        for(int r=0; r<3; r++)
+        {
+            for(int c=0; c<3; c++)
+            {
+                // I + m*[rc]x*[rc]x'
+                l.IA[6*r+c]=I(r,c)-m*rc[r]*rc[c];
+                l.IA[6*(r+3)+c+3]=0.0;
+            }
+            l.IA[7*r]+=m*rc2;
+            l.IA[7*(r+3)]=m;
+        }
+        // m*[rc]x and its transpose
+        l.IA[4]=-m*rc[2]; l.IA[5]=m*rc[1];
+        l.IA[9]=m*rc[2];  l.IA[11]=-m*rc[0];
+        l.IA[15]=-m*rc[1]; l.IA[16]=m*rc[0];
+        l.IA[3]=l.IA[10]=l.IA[17]=0.0;
+        for(int r=0; r<3; r++)
+            for(int c=0; c<3; c++)
+                l.IA[6*(r+3)+c]=l.IA[6*c+r+3];
+
+        // pA = v x* IA*v
+        double h[6];
+        mul6(l.IA,l.v,h);
+        cross3(l.v,h,l.pA);
+        cross3(l.v+3,h+3,tmp);
+        cross3(l.v,h+3,l.pA+3);
+        for(int r=0; r<3; r++)
+            l.pA[r]+=tmp[r];
+    }
+
+    // the end-effector wrench is exerted by the last link on the environment
+    for(int r=0; r<3; r++)
+    {
+        abaLinks[N-1].pA[r]+=Muend[r];
+        abaLinks[N-1].pA[3+r]+=Fend[r];
+    }
+
+    // backward pass: articulated-body inertias and bias forces
+    for(int k=N-1; k>=0; k--)
+    {
+        ArticulatedLink &l=abaLinks[k];
+        double Ia[36],pa[6];
+        for(int r=0; r<36; r++)
+            Ia[r]=l.IA[r];
+
+        if(l.dof>=0)
+        {
+            mul6(l.IA,l.S,l.U);
+            l.D=dot6(l.S,l.U);
+            l.u=tau[l.dof]-dot6(l.S,l.pA);
+            for(int r=0; r<6; r++)
+                for(int c=0; c<6; c++)
+                    Ia[6*r+c]-=l.U[r]*l.U[c]/l.D;
+        }
+
+        if(k>0)
+        {
+            ArticulatedLink &prev=abaLinks[k-1];
+
+            // pa = pA + Ia*c + U*u/D
+            mul6(Ia,l.c,pa);
+            for(int r=0; r<6; r++)
+            {
+                pa[r]+=l.pA[r];
+                if(l.dof>=0)
+                    pa[r]+=l.U[r]*l.u/l.D;
+            }
+
+            // IA_prev += X'*Ia*X,  pA_prev += X'*pa
+            double IaX[36],col[6],res[6];
+            for(int c=0; c<6; c++)
+            {
+                for(int r=0; r<6; r++)
+                    col[r]=l.X[6*r+c];
+                mul6(Ia,col,res);
+                for(int r=0; r<6; r++)
+                    IaX[6*r+c]=res[r];
+            }
+            for(int c=0; c<6; c++)
+            {
+                for(int r=0; r<6; r++)
+                    col[r]=IaX[6*r+c];
+                mul6T(l.X,col,res);
+                for(int r=0; r<6; r++)
+                    prev.IA[6*r+c]+=res[r];
+            }
+            mul6T(l.X,pa,res);
+            for(int r=0; r<6; r++)
+                prev.pA[r]+=res[r];
+        }
+    }
+
+    // forward pass: accelerations
+    for(unsigned int k=0; k<N; k++)
+    {
+        ArticulatedLink &l=abaLinks[k];
+        const double *aPrev=(k==0) ? aBase : abaLinks[k-1].a;
+        mul6(l.X,aPrev,l.a);
+        for(int r=0; r<6; r++)
+            l.a[r]+=l.c[r];
+
+        if(l.dof>=0)
+        {
+            double dd=(l.u-dot6(l.U,l.a))/l.D;
+            for(int r=0; r<6; r++)
+                l.a[r]+=l.S[r]*dd;
+            ddq[l.dof]=dd;
+        }
+    }
+
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+Vector iDynChain::computeForwardDynamics(const Vector &ddp0, const Vector &tau)
+{
+    Vector zero3(3,0.0), ddq(DOF,0.0);
+    computeForwardDynamics(zero3,zero3,ddp0,zero3,zero3,tau,ddq);
+    return ddq;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+Vector iDynChain::computeForwardDynamics(const Vector &ddp0, const Vector &q, const Vector &dq, const Vector &tau)
+{
+    setAng(q);
+    setDAng(dq);
+    return computeForwardDynamics(ddp0,tau);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The derivatives are propagated one variable x at a time through the Newton-Euler recursion,
+// reading the values stored in the links. The only non-trivial terms come from the rotation
+// of the link k w.r.t. its own joint: since dR/dq = [z]x*R, one has d(R'*x)/dq = (R'*x) x s,
+// with s = R'*z, and d(R*y)/dq = z x (R*y), while r projected in the link frame is constant.
+bool iDynChain::computeNewtonEulerDerivatives(const Vector &w0, const Vector &dw0, const Vector &ddp0,
+                                              const Vector &Fend, const Vector &Muend,
+                                              Matrix &dtau_q, Matrix &dtau_dq, Matrix &dtau_ddq)
+{
+    if((w0.length()!=3)||(dw0.length()!=3)||(ddp0.length()!=3)||(Fend.length()!=3)||(Muend.length()!=3))
+    {
+        if(verbose)
+            yError("iDynChain error: computeNewtonEulerDerivatives() failed due to wrong sizes of the base/end-effector vectors: %d %d %d %d %d instead of 3 3 3 3 3 \n",
+                   (int)w0.length(),(int)dw0.length(),(int)ddp0.length(),(int)Fend.length(),(int)Muend.length());
+        return false;
+    }
+
+    if(NE==NULL || NE->getMode()!=DYNAMIC)
+        prepareNewtonEuler(DYNAMIC);
+    NE->ForwardKinematicFromBase(w0,dw0,ddp0);
+    NE->BackwardWrenchFromEnd(Fend,Muend);
+
+    Matrix *dtau[3]={&dtau_q,&dtau_dq,&dtau_ddq};
+    for(int t=0; t<3; t++)
+        if((dtau[t]->rows()!=DOF) || (dtau[t]->cols()!=DOF))
+            dtau[t]->resize(DOF,DOF);
+    if(neDiff.size()!=9*N)
+        reserveScratch();
+
+    for(unsigned int j=0; j<DOF; j++)
+    {
+        const unsigned int a=hash[j];
+        for(int t=0; t<3; t++)
+        {
+            // forward pass: derivatives of w, dw, ddp and ddpC from link a onward
+            double wP[3]={0.0,0.0,0.0},dwP[3]={0.0,0.0,0.0},ddpP[3]={0.0,0.0,0.0};
+            for(unsigned int k=a; k<N; k++)
+            {
+                OneLinkNewtonEuler *l=NE->neChain[k+1];
+                OneLinkNewtonEuler *prev=NE->neChain[k];
+                const Matrix &R=l->getR();
+                const Vector &p=l->getr(true);
+                const Vector &rC=l->getrC();
+                const Vector &w=l->getAngVel();
+                const Vector &dw=l->getAngAcc();
+                const double s[3]={R(2,0),R(2,1),R(2,2)};
+                const double dq=l->getDq();
+                const bool self=(k==a);
+
+                // the derivatives w.r.t. the joint k are expressed in the previous frame
+                double u[3]={wP[0],wP[1],wP[2]};
+                double v[3]={dwP[0]+dq*wP[1],dwP[1]-dq*wP[0],dwP[2]};
+                if(self && (t==1))
+                {
+                    const Vector &wPrev=prev->getAngVel();
+                    u[2]+=1.0;
+                    v[0]+=wPrev[1];
+                    v[1]-=wPrev[0];
+                }
+                else if(self && (t==2))
+                    v[2]+=1.0;
+
+                double *wD=&neDiff[9*k];
+                double *dwD=wD+3;
+                double *ddpCD=wD+6;
+                double ddpD[3];
+                for(int r=0; r<3; r++)
+                {
+                    wD[r]=R(0,r)*u[0]+R(1,r)*u[1]+R(2,r)*u[2];
+                    dwD[r]=R(0,r)*v[0]+R(1,r)*v[1]+R(2,r)*v[2];
+                    ddpD[r]=R(0,r)*ddpP[0]+R(1,r)*ddpP[1]+R(2,r)*ddpP[2];
+                }
+
+                double tmp[3],tmp2[3];
+                if(self && (t==0))
+                {
+                    const Vector &ddpPrev=prev->getLinAcc();
+                    double RtddpPrev[3];
+                    for(int r=0; r<3; r++)
+                        RtddpPrev[r]=R(0,r)*ddpPrev[0]+R(1,r)*ddpPrev[1]+R(2,r)*ddpPrev[2];
+
+                    cross3(w.data(),s,tmp);
+                    for(int r=0; r<3; r++) wD[r]+=tmp[r];
+                    cross3(dw.data(),s,tmp);
+                    for(int r=0; r<3; r++) dwD[r]+=tmp[r];
+                    cross3(RtddpPrev,s,tmp);
+                    for(int r=0; r<3; r++) ddpD[r]+=tmp[r];
+                }
+
+                // ddp' += dw' x r + w' x (w x r) + w x (w' x r), and the same for ddpC with rC
+                cross3(dwD,p.data(),tmp);
+                for(int r=0; r<3; r++) ddpD[r]+=tmp[r];
+                cross3(w.data(),p.data(),tmp2);
+                cross3(wD,tmp2,tmp);
+                for(int r=0; r<3; r++) ddpD[r]+=tmp[r];
+                cross3(wD,p.data(),tmp2);
+                cross3(w.data(),tmp2,tmp);
+                for(int r=0; r<3; r++) ddpD[r]+=tmp[r];
+
+                for(int r=0; r<3; r++) ddpCD[r]=ddpD[r];
+                cross3(dwD,rC.data(),tmp);
+                for(int r=0; r<3; r++) ddpCD[r]+=tmp[r];
+                cross3(w.data(),rC.data(),tmp2);
+                cross3(wD,tmp2,tmp);
+                for(int r=0; r<3; r++) ddpCD[r]+=tmp[r];
+                cross3(wD,rC.data(),tmp2);
+                cross3(w.data(),tmp2,tmp);
+                for(int r=0; r<3; r++) ddpCD[r]+=tmp[r];
+
+                for(int r=0; r<3; r++)
+                {
+                    wP[r]=wD[r];
+                    dwP[r]=dwD[r];
+                    ddpP[r]=ddpD[r];
+                }
+            }
+
+            // backward pass: derivatives of F and Mu down to the base
+            double FD[3]={0.0,0.0,0.0},MuD[3]={0.0,0.0,0.0};
+            int d=DOF-1;
+            for(int k=N-1; k>=0; k--)
+            {
+                OneLinkNewtonEuler *l=NE->neChain[k+1];
+                const Matrix &R=l->getR();
+                const Vector &p=l->getr(true);
+                double f[3],n[3],tmp[3];
+
+                cross3(p.data(),FD,n);
+                for(int r=0; r<3; r++)
+                {
+                    f[r]=FD[r];
+                    n[r]+=MuD[r];
+                }
+
+                if(k>=(int)a)
+                {
+                    const double m=l->getMass();
+                    const Matrix &I=l->getInertia();
+                    const Vector &rC=l->getrC();
+                    const Vector &w=l->getAngVel();
+                    const double *wD=&neDiff[9*k];
+                    const double *dwD=wD+3;
+                    const double *ddpCD=wD+6;
+                    double mddpCD[3],prC[3],Iw[3],IwD[3];
+                    for(int r=0; r<3; r++)
+                    {
+                        mddpCD[r]=m*ddpCD[r];
+                        prC[r]=p[r]+rC[r];
+                        Iw[r]=I(r,0)*w[0]+I(r,1)*w[1]+I(r,2)*w[2];
+                        IwD[r]=I(r,0)*wD[0]+I(r,1)*wD[1]+I(r,2)*wD[2];
+                        f[r]+=mddpCD[r];
+                        n[r]+=I(r,0)*dwD[0]+I(r,1)*dwD[1]+I(r,2)*dwD[2];
+                    }
+                    cross3(prC,mddpCD,tmp);
+                    for(int r=0; r<3; r++) n[r]+=tmp[r];
+                    cross3(wD,Iw,tmp);
+                    for(int r=0; r<3; r++) n[r]+=tmp[r];
+                    cross3(w.data(),IwD,tmp);
+                    for(int r=0; r<3; r++) n[r]+=tmp[r];
+                }
+
+                for(int r=0; r<3; r++)
+                {
+                    FD[r]=R(r,0)*f[0]+R(r,1)*f[1]+R(r,2)*f[2];
+                    MuD[r]=R(r,0)*n[0]+R(r,1)*n[1]+R(r,2)*n[2];
+                }
+
+                // z x F and z x Mu of the previous link, which is not the base
+                if((k==(int)a) && (t==0) && (k>0))
+                {
+                    const Vector &F=NE->neChain[k]->getForce();
+                    const Vector &Mu=NE->neChain[k]->getMoment(false);
+                    FD[0]-=F[1]; FD[1]+=F[0];
+                    MuD[0]-=Mu[1]; MuD[1]+=Mu[0];
+                }
+
+                if(!allList[k]->isBlocked())
+                    (*dtau[t])(d--,j)=MuD[2];
+            }
+        }
+    }
+
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iDynChain::computeNewtonEulerDerivatives(const Vector &ddp0, Matrix &dtau_q, Matrix &dtau_dq, Matrix &dtau_ddq)
+{
+    Vector zero3(3,0.0);
+    return computeNewtonEulerDerivatives(zero3,zero3,ddp0,zero3,zero3,dtau_q,dtau_dq,dtau_ddq);
+}
 
 
 //================================
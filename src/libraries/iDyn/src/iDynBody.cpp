@@ -20,6 +20,11 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include <iCub/iDyn/iDyn.h>
 #include <iCub/iDyn/iDynBody.h>
@@ -461,51 +466,14 @@ Matrix iDynNode::getRBT(unsigned int iLimb) const
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iDynNode::solveKinematics()
 {
-    unsigned int inputNode=0;
-    
-    //first find the limb (one!) which must get the measured kinematics data
-    // e.g. the head gets this information from the inertial sensor on the head
-    for(unsigned int i=0; i<rbtList.size(); i++)
-    {
-        if(rbtList[i].getKinematicFlow()==RBT_NODE_IN)          
-        {
-            // measures are already set
-            //then compute the kinematics pass in that limb 
-            rbtList[i].computeLimbKinematic();
-            // and retrieve the kinematics data in the base/end
-            rbtList[i].getKinematic(w,dw,ddp);      
-            //check
-            inputNode++;
-        }
-    }
-
-    //just check if the input node is only one (as it should be)
-    if(inputNode==1)
-    {
-        //now forward the kinematic input from limbs whose kinematic flow is input type
-        for(unsigned int i=0; i<rbtList.size(); i++)
-        {
-            if(rbtList[i].getKinematicFlow()==RBT_NODE_OUT)
-            {
-                //init the kinematics with the node information
-                rbtList[i].setKinematic(w,dw,ddp);
-                //solve kinematics in that limb/chain
-                rbtList[i].computeLimbKinematic();
-            }
-        }
-        return true;
-    
-    }
-    else
-    {
-        if(verbose)
-        {
-            fprintf(stderr,"iDynNode error: there are %d limbs with Kinematic Flow = Input. Only one limb must have Kinematic Input from outside measurements/computations. \n",inputNode);
-            fprintf(stderr,"Please check the coherence of the limb configuration in the node <%s> \n",info.c_str());
-        }
+    if(!solveInputKinematics())
         return false;
-    }
 
+    //now forward the kinematic input from limbs whose kinematic flow is input type
+    for(unsigned int i=0; i<rbtList.size(); i++)
+        solveOutputKinematics(i);
+
+    return true;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iDynNode::solveKinematics(const Vector &w0, const Vector &dw0, const Vector &ddp0)
@@ -588,19 +556,93 @@ bool iDynNode::setKinematicMeasure(const Vector &w0, const Vector &dw0, const Ve
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iDynNode::solveWrench()
+{
+    //first solve the limbs with wrench input, assuming that each limb has been properly set
+    //with the outcoming measured forces/moments which are necessary for the wrench computation
+    for(unsigned int i=0; i<rbtList.size(); i++)
+        solveInputWrench(i);
+
+    //then balance the node and forward the wrench to the limbs with wrench output
+    return solveOutputWrench();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iDynNode::solveInputKinematics()
+{
+    unsigned int inputNode=0;
+    
+    //find the limb (one!) which must get the measured kinematics data
+    // e.g. the head gets this information from the inertial sensor on the head
+    for(unsigned int i=0; i<rbtList.size(); i++)
+    {
+        if(rbtList[i].getKinematicFlow()==RBT_NODE_IN)          
+        {
+            // measures are already set
+            //then compute the kinematics pass in that limb 
+            rbtList[i].computeLimbKinematic();
+            // and retrieve the kinematics data in the base/end
+            rbtList[i].getKinematic(w,dw,ddp);      
+            //check
+            inputNode++;
+        }
+    }
+
+    //just check if the input node is only one (as it should be)
+    if(inputNode!=1)
+    {
+        if(verbose)
+        {
+            fprintf(stderr,"iDynNode error: there are %d limbs with Kinematic Flow = Input. Only one limb must have Kinematic Input from outside measurements/computations. \n",inputNode);
+            fprintf(stderr,"Please check the coherence of the limb configuration in the node <%s> \n",info.c_str());
+        }
+        return false;
+    }
+
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iDynNode::solveOutputKinematics(unsigned int iLimb)
+{
+    if(iLimb>=rbtList.size())
+    {
+        if(verbose) fprintf(stderr,"iDynNode: error, could not solve the kinematics due to out of range index: %d , while we have %d limbs. \n",iLimb,(int)rbtList.size());
+        return false;
+    }
+
+    if(rbtList[iLimb].getKinematicFlow()==RBT_NODE_OUT)
+    {
+        //init the kinematics with the node information
+        rbtList[iLimb].setKinematic(w,dw,ddp);
+        //solve kinematics in that limb/chain
+        rbtList[iLimb].computeLimbKinematic();
+    }
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iDynNode::solveInputWrench(unsigned int iLimb)
+{
+    if(iLimb>=rbtList.size())
+    {
+        if(verbose) fprintf(stderr,"iDynNode: error, could not solve the wrench due to out of range index: %d , while we have %d limbs. \n",iLimb,(int)rbtList.size());
+        return false;
+    }
+
+    //compute the wrench pass in that limb
+    if(rbtList[iLimb].getWrenchFlow()==RBT_NODE_IN)
+        rbtList[iLimb].computeLimbWrench();
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iDynNode::solveOutputWrench()
 {
     unsigned int outputNode = 0;
     F.zero(); Mu.zero();
 
-    //first get the forces/moments from each limb
-    //assuming that each limb has been properly set with the outcoming measured
-    //forces/moments which are necessary for the wrench computation
+    //get the forces/moments from each limb with wrench input, in the order the limbs
+    //were added, so that the node summation does not depend on how they were solved
     for(unsigned int i=0; i<rbtList.size(); i++)
     {
         if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)         
         {
-            //compute the wrench pass in that limb
-            rbtList[i].computeLimbWrench();
             //update the node force/moment with the wrench coming from the limb base/end
             // note that getWrench sum the result to F,Mu - because they are passed by reference
             // F = F + F[i], Mu = Mu + Mu[i]
@@ -610,9 +652,6 @@ bool iDynNode::solveWrench()
         }
     }
 
-    // node summation: already performed by each RBT
-    // F = F + F[i], Mu = Mu + Mu[i]
-
     // at least one output node should exist 
     // however if for testing purposes only one limb is attached to the node, 
     // we can't avoid the computeWrench phase, but still we must remember that 
@@ -641,6 +680,11 @@ bool iDynNode::solveWrench()
     return true;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+unsigned int iDynNode::getNLimbs() const
+{
+    return (unsigned int)rbtList.size();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iDynNode::solveWrench(const Matrix &FM)
 {
     bool inputWasOk = setWrenchMeasure(FM);
@@ -1351,61 +1395,28 @@ void iDynSensorNode::addLimb(iDynLimb *limb, const Matrix &H, iDynSensor *sensor
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iDynSensorNode::solveWrench()
 {
-    unsigned int outputNode = 0;
-    // set to zero the node force/moment
-    F.zero(); Mu.zero();
-
-    //first get the forces/moments from each limb
-    //assuming that each limb has been properly set with the outcoming measured
-    //forces/moments which are necessary for the wrench computation
-    for(unsigned int i=0; i<rbtList.size(); i++)
-    {
-        if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)         
-        {
-            //compute the wrench pass in that limb
-            // if there's a sensor, we must use iDynSensor
-            // otherwise we use the limb method as usual
-            if(rbtList[i].isSensorized()==true)
-                sensorList[i]->computeWrenchFromSensorNewtonEuler();
-            else
-                rbtList[i].computeLimbWrench();
-
-            //update the node force/moment with the wrench coming from the limb base/end
-            // note that getWrench sum the result to F,Mu - because they are passed by reference
-            // F = F + F[i], Mu = Mu + Mu[i]
-            rbtList[i].getWrench(F,Mu);
-            //check
-            outputNode++;
-        }
-    }
-
-    // node summation: already performed by each RBT
-    // F = F + F[i], Mu = Mu + Mu[i]
-
-    // at least one output node should exist 
-    // however if for testing purposes only one limb is attached to the node, 
-    // we can't avoid the computeWrench phase, but still we must remember that 
-    // it is not correct, because the node must be in balanc
-    if(outputNode==rbtList.size())
+    // the limbs with a FT sensor are solved through their iDynSensor,
+    // see solveInputWrench()
+    return iDynNode::solveWrench();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iDynSensorNode::solveInputWrench(unsigned int iLimb)
+{
+    if(iLimb>=rbtList.size())
     {
-        if(verbose>1)
-        {
-            fprintf(stderr,"iDynNode: warning: there are no limbs with Wrench Flow = Output. At least one limb must have Wrench Output for balancing forces in the node. \n");
-            fprintf(stderr,"Please check the coherence of the limb configuration in the node <%s>\n",info.c_str());
-        }
+        if(verbose) fprintf(stderr,"iDynSensorNode: error, could not solve the wrench due to out of range index: %d , while we have %d limbs. \n",iLimb,(int)rbtList.size());
+        return false;
     }
 
-    //now forward the wrench output from the node to limbs whose wrench flow is output type
-    // assuming they don't have a FT sensor
-    for(unsigned int i=0; i<rbtList.size(); i++)
+    if(rbtList[iLimb].getWrenchFlow()==RBT_NODE_IN)         
     {
-        if(rbtList[i].getWrenchFlow()==RBT_NODE_OUT)
-        {
-            //init the wrench with the node information
-            rbtList[i].setWrench(F,Mu);
-            //solve wrench in that limb/chain
-            rbtList[i].computeLimbWrench();
-        }
+        //compute the wrench pass in that limb
+        // if there's a sensor, we must use iDynSensor
+        // otherwise we use the limb method as usual
+        if(rbtList[iLimb].isSensorized()==true)
+            sensorList[iLimb]->computeWrenchFromSensorNewtonEuler();
+        else
+            rbtList[iLimb].computeLimbWrench();
     }
     return true;
 }
@@ -2409,10 +2420,14 @@ iCubWholeBody::iCubWholeBody(version_tag _tag, const NewEulMode mode, unsigned i
     H.eye();
     //H  is no used currently since the transformation is an identity
     rbt = new RigidBodyTransformation(lowerTorso->up,H,"connection between lower and upper torso",false,RBT_NODE_OUT,RBT_NODE_OUT,mode,verbose);
+
+    pool = NULL;
+    setNumThreads(1);
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 iCubWholeBody::~iCubWholeBody()
 {
+    if (pool)       delete pool;       pool       = NULL;
     if (upperTorso) delete upperTorso; upperTorso = NULL;
     if (lowerTorso) delete lowerTorso; lowerTorso = NULL;
     if (rbt)        delete rbt;        rbt        = NULL;
@@ -2469,6 +2484,161 @@ void iCubWholeBody::attachLowerTorso(const Vector &FM_right_leg, const Vector &F
 
 }
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+namespace iCub
+{
+namespace iDyn
+{
+/**
+* A fixed set of tasks run over a fixed number of lanes: the lane 0 is the calling thread,
+* the others are persistent workers woken up at each run(). The k-th task is always run by
+* the lane k%nLanes.
+*/
+class iDynWorkerPool
+{
+    std::vector<std::function<bool()> > tasks;
+    std::vector<int> results;
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable cvRun;
+    std::condition_variable cvDone;
+    unsigned int nLanes;
+    unsigned int cycle;
+    unsigned int pending;
+    bool quit;
+
+    void exec(const unsigned int lane)
+    {
+        for(size_t k=lane; k<tasks.size(); k+=nLanes)
+            results[k]=tasks[k]() ? 1 : 0;
+    }
+
+    void loop(const unsigned int lane)
+    {
+        unsigned int seen=0;
+        std::unique_lock<std::mutex> lck(mtx);
+        while(true)
+        {
+            cvRun.wait(lck,[&](){ return quit || (cycle!=seen); });
+            if(quit)
+                return;
+
+            seen=cycle;
+            lck.unlock();
+            exec(lane);
+            lck.lock();
+            if(--pending==0)
+                cvDone.notify_one();
+        }
+    }
+
+public:
+    iDynWorkerPool(const std::vector<std::function<bool()> > &_tasks, const unsigned int numThreads) :
+                   tasks(_tasks), results(_tasks.size(),1), cycle(0), pending(0), quit(false)
+    {
+        nLanes=std::max(1U,std::min(numThreads,(unsigned int)tasks.size()));
+        for(unsigned int lane=1; lane<nLanes; lane++)
+            workers.push_back(std::thread(&iDynWorkerPool::loop,this,lane));
+    }
+
+    bool run()
+    {
+        if(!workers.empty())
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            pending=(unsigned int)workers.size();
+            cycle++;
+        }
+        cvRun.notify_all();
+
+        exec(0);
+
+        if(!workers.empty())
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            cvDone.wait(lck,[&](){ return pending==0; });
+        }
+
+        bool ok=true;
+        for(auto r:results)
+            ok=ok && (r!=0);
+        return ok;
+    }
+
+    ~iDynWorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            quit=true;
+        }
+        cvRun.notify_all();
+        for(auto &w:workers)
+            w.join();
+    }
+};
+}
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iCubWholeBody::setNumThreads(const unsigned int _numThreads)
+{
+    numThreads=std::max(_numThreads,1U);
+
+    // the tasks run once the head kinematics is known (see solve()):
+    // the lower torso comes first since it is the heaviest one;
+    // in the lower torso, the limb 0 (the torso) waits for the wrench 
+    // coming from the upper torso, thus only its kinematics is solved here
+    vector<function<bool()> > tasks;
+    tasks.push_back([this]()
+    {
+        bool ok=lowerTorso->setKinematicMeasure(upperTorso->getTorsoAngVel(),
+                                                upperTorso->getTorsoAngAcc(),
+                                                upperTorso->getTorsoLinAcc());
+        ok=lowerTorso->solveInputKinematics() && ok;
+        for(unsigned int i=1; i<lowerTorso->getNLimbs(); i++)
+        {
+            ok=lowerTorso->solveOutputKinematics(i) && ok;
+            ok=lowerTorso->solveInputWrench(i) && ok;
+        }
+        return ok;
+    });
+    for(unsigned int i=0; i<upperTorso->getNLimbs(); i++)
+    {
+        tasks.push_back([this,i]()
+        {
+            bool ok=upperTorso->solveOutputKinematics(i);
+            ok=upperTorso->solveInputWrench(i) && ok;
+            return ok;
+        });
+    }
+
+    if(pool)
+        delete pool;
+    pool=new iDynWorkerPool(tasks,numThreads);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iCubWholeBody::solve(const Vector &FM_right_leg, const Vector &FM_left_leg)
+{
+    //the head kinematics feeds the upper torso node
+    bool ok=upperTorso->solveInputKinematics();
+    //the legs FT measurements do not depend on the upper torso
+    ok=lowerTorso->setSensorMeasurement(FM_right_leg,FM_left_leg) && ok;
+
+    //arms, head, torso kinematics and legs
+    ok=pool->run() && ok;
+
+    //balance the upper torso node, then send its wrench to the lower torso
+    ok=upperTorso->solveOutputWrench() && ok;
+    Vector FUP(6);
+    Vector in_F=upperTorso->getTorsoForce();
+    Vector in_M=upperTorso->getTorsoMoment();
+    FUP[0]=in_F[0]; FUP[1]=in_F[1]; FUP[2]=in_F[2];
+    FUP[3]=in_M[0]; FUP[4]=in_M[1]; FUP[5]=in_M[2];
+    ok=lowerTorso->setSensorMeasurement(FM_right_leg,FM_left_leg,FUP) && ok;
+    ok=lowerTorso->solveInputWrench(0) && ok;
+    ok=lowerTorso->solveOutputWrench() && ok;
+
+    return ok;
+}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iCubWholeBody::computeCOM()
 {
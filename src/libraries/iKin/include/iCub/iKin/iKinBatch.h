@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * \defgroup iKinBatch iKinBatch
+ *
+ * @ingroup iKin
+ *
+ * Batched evaluation of the forward kinematics of serial-links
+ * chains over many joint configurations.
+ *
+ * \author Ugo Pattacini
+ *
+ */
+
+#ifndef __IKINBATCH_H__
+#define __IKINBATCH_H__
+
+#include <vector>
+
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+
+#include <iCub/iKin/iKinFwd.h>
+
+
+namespace iCub
+{
+
+namespace iKin
+{
+
+/**
+* \ingroup iKinBatch
+*
+* Evaluates end-effector poses and geometric Jacobians of a
+* chain (e.g. iCubArm, iCubLeg, iCubEye) for a batch of joint
+* configurations in one call.
+*
+* Data are laid out as structure-of-arrays: the K configurations
+* are stored as the columns of a DOFxK matrix, so that each
+* joint occupies a contiguous row. Internally, configurations are
+* processed in blocks whose sine/cosine evaluations and link
+* compositions run as tight loops over contiguous arrays, which
+* the compiler can vectorize. The batch can be optionally split
+* over a number of threads.
+*
+* \note The DH parameters, the blocked links and the joints
+*       bounds are snapshotted from the chain upon construction
+*       (or upon calling update()): later changes to the chain
+*       are not seen until update() is called again.
+*/
+class iKinBatch
+{
+protected:
+    unsigned int N;
+    unsigned int DOF;
+    unsigned int numThreads;
+
+    std::vector<double> A;
+    std::vector<double> D;
+    std::vector<double> c_alpha;
+    std::vector<double> s_alpha;
+    std::vector<double> Offset;
+    std::vector<double> Min;
+    std::vector<double> Max;
+    std::vector<double> Ang;
+    std::vector<int>    dof;
+    std::vector<bool>   constrained;
+
+    iKinHMatrix H0;
+    iKinHMatrix HN;
+
+    void compute(const yarp::sig::Matrix &Q, yarp::sig::Matrix *X,
+                 yarp::sig::Matrix *J, const bool axisRep,
+                 const size_t k0, const size_t k1) const;
+    bool run(const yarp::sig::Matrix &Q, yarp::sig::Matrix *X,
+             yarp::sig::Matrix *J, const bool axisRep) const;
+
+public:
+    /**
+    * Constructor.
+    * @param chain is the chain whose kinematics is to be evaluated.
+    * @param _numThreads is the number of threads the batch is split
+    *                    over (1 by default, i.e. no threads are
+    *                    spawned).
+    */
+    iKinBatch(iKinChain &chain, const unsigned int _numThreads=1);
+
+    /**
+    * Takes a new snapshot of the chain parameters.
+    * @param chain is the chain whose kinematics is to be evaluated.
+    */
+    void update(iKinChain &chain);
+
+    /**
+    * Sets the number of threads the batch is split over.
+    * @param _numThreads is the number of threads (0 is treated as
+    *                    1).
+    */
+    void setNumThreads(const unsigned int _numThreads);
+
+    /**
+    * Returns the number of threads the batch is split over.
+    * @return the number of threads.
+    */
+    unsigned int getNumThreads() const { return numThreads; }
+
+    /**
+    * Returns the number of DOF of the snapshotted chain.
+    * @return the number of DOF.
+    */
+    unsigned int getDOF() const { return DOF; }
+
+    /**
+    * Computes the end-effector poses for a batch of
+    * configurations.
+    * @param Q is the DOFxK matrix whose columns are the joint
+    *          configurations [rad].
+    * @param X is the 7xK (axis/angle notation) or 6xK (Euler
+    *          angles) matrix of poses, as returned by
+    *          iKinChain::EndEffPose().
+    * @param axisRep if true returns the axis/angle notation.
+    * @return true/false on success/failure.
+    */
+    bool EndEffPose(const yarp::sig::Matrix &Q, yarp::sig::Matrix &X,
+                    const bool axisRep=true) const;
+
+    /**
+    * Computes the geometric Jacobians of the end-effector for a
+    * batch of configurations.
+    * @param Q is the DOFxK matrix whose columns are the joint
+    *          configurations [rad].
+    * @param J is the (6*DOF)xK matrix whose column k holds the
+    *          6xDOF Jacobian of the k-th configuration stored by
+    *          rows, i.e. J(r*DOF+c,k) is the element (r,c).
+    * @return true/false on success/failure.
+    * @see getJacobian
+    */
+    bool GeoJacobian(const yarp::sig::Matrix &Q, yarp::sig::Matrix &J) const;
+
+    /**
+    * Computes both end-effector poses and geometric Jacobians in
+    * one sweep.
+    * @param Q is the DOFxK matrix of joint configurations [rad].
+    * @param X is the matrix of poses.
+    * @param J is the matrix of Jacobians.
+    * @param axisRep if true returns the axis/angle notation.
+    * @return true/false on success/failure.
+    * @see EndEffPose, GeoJacobian
+    */
+    bool EndEffPoseAndJacobian(const yarp::sig::Matrix &Q, yarp::sig::Matrix &X,
+                               yarp::sig::Matrix &J, const bool axisRep=true) const;
+
+    /**
+    * Extracts the 6xDOF Jacobian of the k-th configuration from the
+    * matrix returned by GeoJacobian().
+    * @param J is the batch of Jacobians.
+    * @param k is the configuration index.
+    * @return the 6xDOF Jacobian.
+    */
+    yarp::sig::Matrix getJacobian(const yarp::sig::Matrix &J, const size_t k) const;
+};
+
+}
+
+}
+
+#endif
+
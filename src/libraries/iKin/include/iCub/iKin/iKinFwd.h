@@ -55,6 +55,7 @@
 
 #include <string>
 #include <deque>
+#include <vector>
 
 #include <yarp/os/Property.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
@@ -73,6 +74,55 @@ namespace iKin
 
 void notImplemented(const unsigned int verbose);
 
+/**
+* \ingroup iKinFwd
+*
+* Fixed-size storage for a rigid roto-translation matrix. Only
+* the upper 3x4 block is stored since the last row of a
+* homogeneous transformation is always [0 0 0 1].
+*
+* @note Used by the allocation-free methods of iKinChain (e.g.
+*       fastGetH(), fastGeoJacobian()).
+*/
+struct iKinHMatrix
+{
+    double h[3][4];
+
+    /**
+    * Accesses the element (r,c) of the upper 3x4 block.
+    * @param r is the row index in [0,2].
+    * @param c is the column index in [0,3].
+    * @return a reference to the element.
+    */
+    double &operator()(const int r, const int c) { return h[r][c]; }
+
+    /**
+    * Accesses the element (r,c) of the upper 3x4 block.
+    * @param r is the row index in [0,2].
+    * @param c is the column index in [0,3].
+    * @return the element.
+    */
+    double operator()(const int r, const int c) const { return h[r][c]; }
+
+    /**
+    * Sets the transformation to the identity.
+    */
+    void eye();
+
+    /**
+    * Fills the storage from a 4x4 yarp::sig::Matrix.
+    * @param H is the 4x4 source matrix.
+    */
+    void fromMatrix(const yarp::sig::Matrix &H);
+
+    /**
+    * Copies the transformation into a 4x4 yarp::sig::Matrix.
+    * @param H is the destination matrix (resized only if not
+    *          already 4x4).
+    */
+    void toMatrix(yarp::sig::Matrix &H) const;
+};
+
 /**
 * \ingroup iKinFwd
 *
@@ -102,6 +152,7 @@ protected:
     yarp::sig::Matrix H;
     yarp::sig::Matrix cumH;
     yarp::sig::Matrix DnH;
+    iKinHMatrix       fastCumH;
 
     const yarp::sig::Matrix zeros1x1;
     const yarp::sig::Vector zeros1;
@@ -295,6 +346,30 @@ public:
     */
     yarp::sig::Matrix getDnH(unsigned int n=1, bool c_override=false);
 
+    /**
+    * Computes the homogeneous transformation matrix H of the Link
+    * without allocating memory.
+    * @param _H is the fixed-size destination storage.
+    * @param c_override if true avoid accumulating the computation
+    *                   of previous links in the chain (false by
+    *                   default).
+    * @see getH
+    */
+    void fastGetH(iKinHMatrix &_H, bool c_override=false) const;
+
+    /**
+    * Computes the first derivative of the homogeneous
+    * transformation matrix H with respect to the joint angle
+    * without allocating memory.
+    * @param _DH is the fixed-size destination storage (the last
+    *            row of the derivative is identically zero).
+    * @param c_override if true avoid accumulating the computation
+    *                   of previous links in the chain (false by
+    *                   default).
+    * @see getDnH
+    */
+    void fastGetDH(iKinHMatrix &_DH, bool c_override=false) const;
+
     /**
     * Default destructor. 
     */
@@ -350,6 +425,12 @@ public:
 * \ingroup iKinFwd
 *
 * A Base class for defining a Serial Link Chain. 
+*  
+* @note When the cache of the cumulative transformations is 
+*       enabled (see setCaching()), the kinematic queries such as
+*       getH(), Pose() and GeoJacobian() update the cache, hence
+*       they can no longer be issued concurrently by different
+*       threads on the same chain without external locking.
 */
 class iKinChain
 {
@@ -370,10 +451,33 @@ protected:
     yarp::sig::Matrix hess_J;
     yarp::sig::Matrix hess_Jlnk;
 
+    // scratch storage for the allocation-free methods
+    std::vector<iKinHMatrix> fastFwdH;
+    std::vector<iKinHMatrix> fastBwdH;
+
+    // cache of the cumulative transformations
+    bool                           cacheOn;
+    bool                           cacheStale;
+    std::vector<yarp::sig::Matrix> cacheAllH;
+    std::vector<yarp::sig::Matrix> cacheQuickH;
+    std::vector<unsigned int>      cacheQuickIdx;
+    std::vector<double>            cacheKeys;
+    yarp::sig::Matrix              cacheH0;
+    unsigned int                   cacheAllValid;
+    unsigned int                   cacheQuickValid;
+    unsigned long                  cacheHits;
+    unsigned long                  cacheRecomputations;
+
     virtual void clone(const iKinChain &c);
     virtual void build();
     virtual void dispose();
 
+    void fastReserve();
+    void invalidateCache();
+    void validateCache();
+    const yarp::sig::Matrix &getCachedAllH(const unsigned int n);
+    const yarp::sig::Matrix &getCachedQuickH(const unsigned int n);
+
     yarp::sig::Vector RotAng(const yarp::sig::Matrix &R);
     yarp::sig::Vector dRotAng(const yarp::sig::Matrix &R, const yarp::sig::Matrix &dR);
     yarp::sig::Vector d2RotAng(const yarp::sig::Matrix &R, const yarp::sig::Matrix &dRi,
@@ -586,6 +690,46 @@ public:
     */
     bool setHN(const yarp::sig::Matrix &_HN);
 
+    /**
+    * Enables/disables the cache of the cumulative transformation
+    * matrices. When enabled, getH(), Pose(), Position(),
+    * EndEffPose() and GeoJacobian() reuse the products computed
+    * in previous calls and recompute only the suffix of the chain
+    * that follows the first link whose joint angle (or DH
+    * parameters) changed in the meanwhile. Results are bit-exact
+    * with respect to the uncached computation.
+    * @param sw true to enable the cache (disabled by default).
+    * @note With the cache enabled, those queries modify the chain:
+    *       a chain shared among threads must then be accessed under
+    *       a lock, even for reading.
+    */
+    void setCaching(const bool sw);
+
+    /**
+    * Returns the status of the cache of the cumulative
+    * transformation matrices.
+    * @return true iff the cache is enabled.
+    */
+    bool getCaching() const { return cacheOn; }
+
+    /**
+    * Returns the number of queries served entirely by the cache.
+    * @return the number of cache hits.
+    */
+    unsigned long getCacheHits() const { return cacheHits; }
+
+    /**
+    * Returns the number of link transformations that have been
+    * recomputed because of cache misses.
+    * @return the number of recomputations.
+    */
+    unsigned long getCacheRecomputations() const { return cacheRecomputations; }
+
+    /**
+    * Resets the cache counters.
+    */
+    void resetCacheStats() { cacheHits=cacheRecomputations=0; }
+
     /**
     * Sets the free joint angles to values of q[i].
     * @param q is a vector containing values for DOF.
@@ -625,6 +769,7 @@ public:
     * @param allLink if true enables the spanning over the full set 
     *                of links (false by default).
     * @return Hi 
+    * @note It updates the cache, if enabled (see setCaching()).
     */
     yarp::sig::Matrix getH(const unsigned int i, const bool allLink=false);
 
@@ -653,6 +798,7 @@ public:
     * @param i is the Link number. 
     * @param axisRep if true returns the axis/angle notation. 
     * @return the ith Link Pose.
+    * @note It updates the cache, if enabled (see setCaching()).
     */
     yarp::sig::Vector Pose(const unsigned int i, const bool axisRep=true);
 
@@ -738,7 +884,8 @@ public:
     /**
     * Returns the geometric Jacobian of the end-effector.
     * @return the 6xDOF geometric Jacobian matrix.
-    * @note The blocked links are not considered.
+    * @note The blocked links are not considered. It updates the
+    *       cache, if enabled (see setCaching()).
     */
     yarp::sig::Matrix GeoJacobian();
 
@@ -858,6 +1005,86 @@ public:
     */
     yarp::sig::Matrix DJacobian(const unsigned int lnk, const yarp::sig::Vector &dq);
 
+    /**
+    * Same as getH(i,allLink) but the result is written into
+    * caller-owned fixed-size storage. No heap allocation is
+    * performed.
+    * @param i is the Link number.
+    * @param H is the destination storage.
+    * @param allLink if true enables the spanning over the full set
+    *                of links (false by default).
+    * @see getH
+    */
+    void fastGetH(const unsigned int i, iKinHMatrix &H, const bool allLink=false);
+
+    /**
+    * Same as getH() but the result is written into caller-owned
+    * fixed-size storage. No heap allocation is performed.
+    * @param H is the destination storage.
+    * @see getH
+    */
+    void fastGetH(iKinHMatrix &H);
+
+    /**
+    * Same as Position(i) but the result is written into a
+    * caller-owned vector. No heap allocation is performed once
+    * the vector has the right size.
+    * @param i is the Link number.
+    * @param p is the 3x1 destination vector.
+    * @see Position
+    */
+    void fastPosition(const unsigned int i, yarp::sig::Vector &p);
+
+    /**
+    * Same as EndEffPose() but the result is written into a
+    * caller-owned vector. No heap allocation is performed once
+    * the vector has the right size.
+    * @param x is the destination vector (7x1 if axisRep is true,
+    *          6x1 otherwise).
+    * @param axisRep if true returns the axis/angle notation.
+    * @note The only exception is represented by the degenerate
+    *       rotations of 0 and 180 [deg] when axisRep is true,
+    *       which are resolved by yarp::math::dcm2axis().
+    * @see EndEffPose
+    */
+    void fastEndEffPose(yarp::sig::Vector &x, const bool axisRep=true);
+
+    /**
+    * Same as AnaJacobian(col) but the result is written into a
+    * caller-owned matrix. Derivatives are obtained by composing
+    * forward and backward partial products instead of recomputing
+    * the whole chain for each DOF. No heap allocation is performed
+    * once the matrix has the right size.
+    * @param J is the 6xDOF destination matrix.
+    * @param col selects the part of the derived homogeneous matrix
+    *            to be put in the upper side of the Jacobian
+    *            matrix: 0 => x, 1 => y, 2 => z, 3 => p (default)
+    * @see AnaJacobian
+    */
+    void fastAnaJacobian(yarp::sig::Matrix &J, unsigned int col=3);
+
+    /**
+    * Same as GeoJacobian() but the result is written into a
+    * caller-owned matrix. No heap allocation is performed once the
+    * matrix has the right size.
+    * @param J is the 6xDOF destination matrix.
+    * @see GeoJacobian
+    */
+    void fastGeoJacobian(yarp::sig::Matrix &J);
+
+    /**
+    * Computes the end-effector transformation and the geometric
+    * Jacobian in one sweep over the links, thus sharing the
+    * products between the two. No heap allocation is performed
+    * once the matrix has the right size.
+    * @param H is the destination storage of the end-effector
+    *          transformation (same as getH()).
+    * @param J is the 6xDOF destination matrix (same as
+    *          GeoJacobian()).
+    * @see fastGetH, fastGeoJacobian
+    */
+    void fastPoseAndGeoJacobian(iKinHMatrix &H, yarp::sig::Matrix &J);
+
     /**
     * Destructor. 
     */
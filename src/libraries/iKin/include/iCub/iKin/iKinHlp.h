@@ -26,6 +26,8 @@
 
 #define IKIN_ALMOST_ZERO    1e-6
 
+#include <deque>
+
 #include <yarp/os/Bottle.h>
 #include <yarp/sig/all.h>
 
@@ -50,6 +52,10 @@ protected:
     static void addVectorOption(yarp::os::Bottle &b, const int vcb, const yarp::sig::Vector &v);
     static bool getDesiredOption(const yarp::os::Bottle &reply, yarp::sig::Vector &xdhat,
                                  yarp::sig::Vector &odhat, yarp::sig::Vector &qdhat);
+    static void addVectorsOption(yarp::os::Bottle &b, const int vcb,
+                                 const std::deque<yarp::sig::Vector> &v);
+    static bool getDesiredOption(const yarp::os::Bottle &reply, std::deque<yarp::sig::Vector> &xdhat,
+                                 std::deque<yarp::sig::Vector> &odhat, std::deque<yarp::sig::Vector> &qdhat);
 
 public:
     /**
@@ -223,6 +223,42 @@ protected:
     double upperBoundInf;
     std::string posePriority;
 
+    bool   warmStartOn;
+    bool   warmStartSet;
+    bool   warmStartValid;
+    bool   warmStartSuspended;
+    double warmStartMaxPosDist;
+    double warmStartMaxAngDist;
+    double warmStartMaxJntDist;
+    unsigned int warmStartCtrlPose;
+    std::string  warmStartPosePriority;
+    yarp::sig::Vector warmStart_xd;
+    yarp::sig::Vector warmStart_x;
+    yarp::sig::Vector warmStart_zL;
+    yarp::sig::Vector warmStart_zU;
+    yarp::sig::Vector warmStart_lambda;
+
+    struct MultiStartLane;
+    std::deque<MultiStartLane*> lanes;
+    int          multiStartNum;
+    unsigned int multiStartSeed;
+
+    bool isWarmStartFeasible(const yarp::sig::Vector &q0, const yarp::sig::Vector &xd,
+                             const int n, const int m) const;
+    void setWarmStartOption(const bool sw);
+    void syncLane(MultiStartLane *lane);
+
+    yarp::sig::Vector solveSingleStart(const yarp::sig::Vector &q0, yarp::sig::Vector &xd,
+                                       double weight2ndTask, yarp::sig::Vector &xd_2nd, yarp::sig::Vector &w_2nd,
+                                       double weight3rdTask, yarp::sig::Vector &qd_3rd, yarp::sig::Vector &w_3rd,
+                                       int *exit_code, bool *exhalt, iKinIterateCallback *iterate,
+                                       double *obj, double *viol);
+
+    yarp::sig::Vector solveMultiStart(const yarp::sig::Vector &q0, yarp::sig::Vector &xd,
+                                      double weight2ndTask, yarp::sig::Vector &xd_2nd, yarp::sig::Vector &w_2nd,
+                                      double weight3rdTask, yarp::sig::Vector &qd_3rd, yarp::sig::Vector &w_3rd,
+                                      int *exit_code, bool *exhalt, iKinIterateCallback *iterate);
+
 public:
     /**
     * Constructor. 
@@ -279,6 +315,103 @@ public:
     */
     std::string get_posePriority() const { return posePriority; }
 
+    /**
+    * Enables/disables the warm start of the solver: if the target 
+    * has moved only slightly since the last successful solution, 
+    * the optimization is initialized with the primal and dual 
+    * variables found there, which saves most of the iterations 
+    * while tracking a continuously moving target. 
+    * @param sw true to enable the warm start. 
+    * @param maxPosDist the maximum displacement [m] of the target 
+    *                   position allowed for warm starting.
+    * @param maxAngDist the maximum rotation [rad] of the target 
+    *                   orientation allowed for warm starting.
+    * @param maxJntDist the maximum distance [rad] of each joint of 
+    *                   the given starting point q0 from the last
+    *                   solution allowed for warm starting.
+    * @note the warm start is applied only if the previous solution 
+    *       was successful and neither the pose control settings, nor
+    *       the pose priority, nor the number of constraints changed 
+    *       in the meanwhile. 
+    */
+    void setWarmStart(const bool sw, const double maxPosDist=0.02,
+                      const double maxAngDist=0.1, const double maxJntDist=0.2);
+
+    /**
+    * Returns the state of the warm start.
+    * @return true iff the warm start is enabled.
+    */
+    bool getWarmStart() const { return warmStartOn; }
+
+    /**
+    * Suspends/resumes the warm start: while suspended, solve() 
+    * starts from the given q0 and neither uses nor updates the 
+    * warm start data, so that one-shot requests with their own 
+    * starting point do not interfere with the tracking of a 
+    * continuously moving target. 
+    * @param sw true to suspend the warm start.
+    */
+    void suspendWarmStart(const bool sw) { warmStartSuspended=sw; }
+
+    /**
+    * Returns whether the warm start is suspended.
+    * @return true iff the warm start is suspended.
+    */
+    bool isWarmStartSuspended() const { return warmStartSuspended; }
+
+    /**
+    * Enables the multi-start mode. Each call to solve() runs 
+    * num optimizations in parallel: the first one starts from the 
+    * given q0 (and is warm started, if enabled), whereas the 
+    * others start from points drawn uniformly within the joints 
+    * limits by a pseudo-random generator reset to the given seed 
+    * at each call. Every optimization runs in its own thread on a 
+    * private copy of the chain. 
+    *  
+    * Among the optimizations that converge, the one with the 
+    * lowest index is returned; as soon as one converges, those 
+    * with higher indexes are stopped, since they cannot be 
+    * selected anymore. If none converges, the solution with the 
+    * lowest cost is returned, looking first at the violation of 
+    * the constraints and then at the objective. Hence, for a 
+    * given target and a given q0, the result does not depend on 
+    * the scheduling of the threads. 
+    * @param num the number of starting points (1 disables the 
+    *            multi-start mode).
+    * @param seed the seed of the starting points generator.
+    * @note each optimization is bounded by the maximum number of 
+    *       iterations and by the maximum cpu time, which are
+    *       therefore also the bounds of the whole call.
+    * @note the callback passed to solve() is invoked only for the 
+    *       optimization starting from q0.
+    * @note the optimizations run in parallel only if isReentrant()
+    *       holds, otherwise they run one after the other, which
+    *       leads to the same result.
+    */
+    void setMultiStart(const int num, const unsigned int seed=0);
+
+    /**
+    * Returns the number of starting points of the multi-start 
+    * mode. 
+    * @return the number of starting points (1 if disabled).
+    */
+    int getMultiStart() const { return multiStartNum; }
+
+    /**
+    * Returns the seed of the multi-start points generator.
+    * @return the seed.
+    */
+    unsigned int getMultiStartSeed() const { return multiStartSeed; }
+
+    /**
+    * Tells whether several optimizers can solve at the same time 
+    * in separate threads. This depends on IPOPT: MUMPS, the 
+    * default linear solver, is not thread-safe and IPOPT 
+    * serializes the calls to it only since version 3.14. 
+    * @return true iff IPOPT is at least 3.14.
+    */
+    static bool isReentrant();
+
     /**
     * Attach a iKinLinIneqConstr object in order to impose 
     * constraints of the form lB <= C*q <= uB.
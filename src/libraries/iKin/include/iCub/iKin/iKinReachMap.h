@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * \defgroup iKinReachMap iKinReachMap
+ *
+ * @ingroup iKin
+ *
+ * Precomputed reachability and manipulability maps of
+ * serial-links chains.
+ *
+ * \author Ugo Pattacini
+ *
+ */
+
+#ifndef __IKINREACHMAP_H__
+#define __IKINREACHMAP_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <yarp/sig/Vector.h>
+
+#include <iCub/iKin/iKinFwd.h>
+
+
+namespace iCub
+{
+
+namespace iKin
+{
+
+/**
+* \ingroup iKinReachMap
+*
+* Voxelized map of the workspace of a chain (e.g. iCubArm,
+* iCubLeg) built offline by sampling the joints space, which
+* tells in constant time whether a position can be reached, how
+* well-conditioned the chain is there and which configuration
+* reaches it with the highest manipulability.
+*
+* For each voxel the map stores:
+* - the number of samples whose end-effector fell within it;
+* - the best Yoshikawa manipulability of the translational
+*   Jacobian, i.e. sqrt(det(Jp*Jp^T)), among those samples;
+* - the joints configuration [rad] attaining it, which can be
+*   used to seed the inverse kinematics.
+*
+* Since sampling cannot visit every voxel on the border of the
+* workspace, a voxel is additionally flagged when one of its 26
+* neighbours has been hit, which allows to reject targets
+* conservatively.
+*
+* The file format is a fixed header followed by plain arrays
+* aligned to 8 bytes, all in the byte order of the machine that
+* built the map (a marker in the header is checked on loading):
+* on POSIX systems the file is memory-mapped, hence loading is
+* immediate and the pages are shared among processes.
+*
+* \note The map refers to the joints that are not blocked when
+*       build() is called: typically all of them should be
+*       released beforehand.
+*/
+class iKinReachMap
+{
+private:
+    // Copy constructor: not implemented.
+    iKinReachMap(const iKinReachMap&);
+    // Assignment operator: not implemented.
+    iKinReachMap &operator=(const iKinReachMap&);
+
+protected:
+    struct Header
+    {
+        char     magic[8];
+        uint32_t version;
+        uint32_t endianness;
+        uint32_t size[3];
+        uint32_t dof;
+        uint64_t numSamples;
+        double   origin[3];
+        double   resolution;
+        uint64_t offsFlags;
+        uint64_t offsHits;
+        uint64_t offsManip;
+        uint64_t offsSeeds;
+        uint64_t length;
+    };
+
+    std::vector<uint64_t> storage;
+    void  *mapped;
+    size_t mappedLength;
+
+    const Header   *header;
+    const uint8_t  *flags;
+    const uint32_t *hits;
+    const float    *manip;
+    const float    *seeds;
+
+    void unload();
+    bool attach(const void *buf, const size_t length);
+    bool getIndex(const yarp::sig::Vector &x, size_t &idx) const;
+
+public:
+    /**
+    * Constructor.
+    */
+    iKinReachMap();
+
+    /**
+    * Builds the map by sampling the joints space of a chain.
+    * @param chain is the chain, whose not blocked joints are
+    *              sampled uniformly within their bounds.
+    * @param resolution is the edge of the voxels [m].
+    * @param numSamples is the number of samples.
+    * @param seed is the seed of the samples generator: the map
+    *             depends only on the chain, the resolution, the
+    *             number of samples and the seed.
+    * @param numThreads is the number of threads the forward
+    *                   kinematics is evaluated by.
+    * @return true/false on success/failure.
+    */
+    bool build(iKinChain &chain, const double resolution,
+               const size_t numSamples, const unsigned int seed=0,
+               const unsigned int numThreads=1);
+
+    /**
+    * Saves the map to file.
+    * @param fileName is the file name.
+    * @return true/false on success/failure.
+    */
+    bool save(const std::string &fileName) const;
+
+    /**
+    * Loads a map from file.
+    * @param fileName is the file name.
+    * @return true/false on success/failure.
+    */
+    bool load(const std::string &fileName);
+
+    /**
+    * Checks whether a map is available.
+    * @return true iff the map has been built or loaded.
+    */
+    bool isValid() const { return (header!=nullptr); }
+
+    /**
+    * Returns the number of DOF of the map.
+    * @return the number of DOF (i.e. the length of the seeds).
+    */
+    unsigned int getDOF() const;
+
+    /**
+    * Returns the edge of the voxels.
+    * @return the resolution [m].
+    */
+    double getResolution() const;
+
+    /**
+    * Returns the bounding box of the map.
+    * @param lower is the corner with the smallest coordinates [m].
+    * @param upper is the corner with the largest coordinates [m].
+    * @return true/false on success/failure.
+    */
+    bool getBoundingBox(yarp::sig::Vector &lower, yarp::sig::Vector &upper) const;
+
+    /**
+    * Checks whether a position can be reached.
+    * @param x is the position [m] (only the first three components
+    *          are considered, thus a pose can be passed as well).
+    * @param conservative if true, the positions lying next to a
+    *                     reached voxel are also deemed reachable.
+    * @return true iff the position is reachable.
+    */
+    bool isReachable(const yarp::sig::Vector &x, const bool conservative=false) const;
+
+    /**
+    * Returns the manipulability at a position.
+    * @param x is the position [m].
+    * @return the best manipulability found within the voxel, 0.0
+    *         if the position is not reachable.
+    */
+    double getManipulability(const yarp::sig::Vector &x) const;
+
+    /**
+    * Returns the configuration reaching a position with the best
+    * manipulability.
+    * @param x is the position [m].
+    * @param q is the configuration [rad].
+    * @return true iff the position is reachable.
+    */
+    bool getSeed(const yarp::sig::Vector &x, yarp::sig::Vector &q) const;
+
+    /**
+    * Destructor.
+    */
+    virtual ~iKinReachMap();
+};
+
+}
+
+}
+
+#endif
+
+
@@ -188,6 +188,14 @@ given rest
  *    found configuration q is returned as well as the final
  *    attained pose x.
  *
+ * \b batch request: example [ask] ([xd] ((x y z ...) (x y z ...)
+ *    ...)) ([pose] [full]) ([q] ((...) (...) ...)). Ask to solve
+ *    for a list of targets, optionally with one starting joint
+ *    configuration each. The targets are solved concurrently on
+ *    a copy of the current settings, without holding the main
+ *    loop, and the reply contains the lists of the results as in
+ *    [ack] ([x] ((...) (...) ...)) ([q] ((...) (...) ...)).
+ *
  * Commands concerning the thread status:
  *
  * \b susp request: example [susp], suspend the thread.
@@ -239,6 +247,7 @@ given rest
 
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
 #include <string>
 #include <deque>
 
@@ -262,6 +271,65 @@ namespace iKin
 
 class CartesianSolver;
 
+/**
+* \ingroup iKinSlv
+*
+* Single-slot mailbox to exchange Bottles between two threads of
+* the same process in place of a pair of ports (see 
+* CartesianSolver::setMailboxes()). 
+*  
+* The slot is a triple buffer: the writer never waits for the 
+* reader and always overwrites the message not yet taken, while 
+* the reader always gets the latest message. One writer and one 
+* reader are assumed. 
+*/
+class BottleMailbox
+{
+protected:
+    yarp::os::Bottle buf[3];
+    std::atomic<int> middle;
+    int back;
+    int front;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+
+public:
+    /**
+    * Constructor.
+    */
+    BottleMailbox();
+
+    /**
+    * Returns the (cleared) Bottle to be filled in by the writer.
+    * @return the Bottle to fill in.
+    */
+    yarp::os::Bottle &prepare();
+
+    /**
+    * Publishes the Bottle returned by prepare(), waking up the 
+    * reader if waiting. 
+    */
+    void post();
+
+    /**
+    * Takes the latest message, if any.
+    * @return the pointer to the message, which stays valid until 
+    *         the next call to take() or wait(); NULL if no new
+    *         message is available.
+    */
+    yarp::os::Bottle *take();
+
+    /**
+    * Waits for a new message.
+    * @param timeout the maximum waiting time [s].
+    * @return the pointer to the message as in take(); NULL if the
+    *         timeout has expired.
+    */
+    yarp::os::Bottle *wait(const double timeout);
+};
+
+
 class RpcProcessor : public yarp::os::PortReader
 {
 protected:
@@ -294,6 +362,8 @@ protected:
 
     virtual void onRead(yarp::os::Bottle &b);
 
+    friend class CartesianSolver;
+
 public:
     InputPort(CartesianSolver *_slv);
 
@@ -359,6 +429,8 @@ protected:
     yarp::os::Port                           *rpcPort;
     InputPort                                *inPort;
     yarp::os::BufferedPort<yarp::os::Bottle> *outPort;
+    BottleMailbox                            *inbox;
+    BottleMailbox                            *outbox;
     std::mutex                                mtx;
 
     std::string   slvName;
@@ -376,6 +448,7 @@ protected:
     int           maxPartJoints;
     int           unctrlJointsNum;
     double        ping_robot_tmo;
+    int           batchThreads;
     double        token;
     double       *pToken;
 
@@ -399,7 +472,7 @@ protected:
     std::condition_variable cv_dofEvent;
 
     virtual PartDescriptor *getPartDesc(yarp::os::Searchable &options)=0;
-    virtual yarp::sig::Vector solve(yarp::sig::Vector &xd);
+    virtual yarp::sig::Vector solve(yarp::sig::Vector &xd, const bool seeded=false);
 
     virtual yarp::sig::Vector &encodeDOF();
     virtual bool decodeDOF(const yarp::sig::Vector &_dof);
@@ -432,6 +505,7 @@ protected:
 
     virtual void prepareJointsRestTask();
     virtual void respond(const yarp::os::Bottle &command, yarp::os::Bottle &reply);
+    virtual void askBatch(const yarp::os::Bottle &command, yarp::os::Bottle &reply);
     virtual bool threadInit();
     virtual void afterStart(bool);
     virtual void run();
@@ -526,10 +600,41 @@ public:
     *    ports are pinged prior to connecting; a timeout equal to
     *    zero disables this option.
     *  
+    * \b batchThreads <int>: example (batchThreads 4), specifies 
+    *    the number of threads used to serve the [ask] requests
+    *    carrying a list of targets; with IPOPT older than 3.14 the
+    *    targets are solved by one thread, while the main loop is
+    *    held, since the default linear solver is not thread-safe
+    *    there.
+    *  
+    * \b multiStart <int>: example (multiStart 4), specifies the 
+    *    number of starting points optimized in parallel for each
+    *    target, the first one being the current configuration; the
+    *    default value 1 disables the multi-start mode. With IPOPT
+    *    older than 3.14 the starting points are optimized one after
+    *    the other (see iKinIpOptMin::isReentrant()).
+    *  
+    * \b multiStartSeed <int>: example (multiStartSeed 0), specifies
+    *    the seed used to generate the further starting points.
+    *  
     * @return true/false if successful/failed
     */
     virtual bool open(yarp::os::Searchable &options);
 
+    /**
+    * Makes the solver exchange targets and solutions with a client
+    * living in the same process through mailboxes in place of the
+    * /in and /out ports, which are not opened. Each target wakes 
+    * up the solver straightaway, without waiting for the next 
+    * period. The rpc port is still available. 
+    * @param _inbox is where the client posts the requests (same 
+    *               content as for the /in port).
+    * @param _outbox is where the solver posts the solutions (same
+    *                content as for the /out port).
+    * @note to be called before open(). 
+    */
+    void setMailboxes(BottleMailbox *_inbox, BottleMailbox *_outbox);
+
     /**
     * Interrupt the open() method waiting for motor parts to be 
     * ready. 
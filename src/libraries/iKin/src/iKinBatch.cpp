@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <functional>
+
+#include <yarp/os/Log.h>
+#include <yarp/math/Math.h>
+
+#include <iCub/iKin/iKinBatch.h>
+
+using namespace std;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace iCub::iKin;
+
+namespace
+{
+    // number of configurations processed together
+    constexpr size_t IKINBATCH_BLOCK=32;
+}
+
+
+/************************************************************************/
+iKinBatch::iKinBatch(iKinChain &chain, const unsigned int _numThreads)
+{
+    setNumThreads(_numThreads);
+    update(chain);
+}
+
+
+/************************************************************************/
+void iKinBatch::update(iKinChain &chain)
+{
+    N=chain.getN();
+    DOF=0;
+
+    A.resize(N);
+    D.resize(N);
+    c_alpha.resize(N);
+    s_alpha.resize(N);
+    Offset.resize(N);
+    Min.resize(N);
+    Max.resize(N);
+    Ang.resize(N);
+    dof.resize(N);
+    constrained.resize(N);
+
+    for (unsigned int i=0; i<N; i++)
+    {
+        iKinLink &l=chain[i];
+
+        A[i]=l.getA();
+        D[i]=l.getD();
+        c_alpha[i]=cos(l.getAlpha());
+        s_alpha[i]=sin(l.getAlpha());
+        Offset[i]=l.getOffset();
+        Min[i]=l.getMin();
+        Max[i]=l.getMax();
+        Ang[i]=l.getAng();
+        constrained[i]=l.getConstraint();
+        dof[i]=l.isBlocked() ? -1 : (int)DOF++;
+    }
+
+    H0.fromMatrix(chain.getH0());
+    HN.fromMatrix(chain.getHN());
+}
+
+
+/************************************************************************/
+void iKinBatch::setNumThreads(const unsigned int _numThreads)
+{
+    numThreads=std::max(_numThreads,1U);
+}
+
+
+/************************************************************************/
+void iKinBatch::compute(const Matrix &Q, Matrix *X, Matrix *J,
+                        const bool axisRep, const size_t k0,
+                        const size_t k1) const
+{
+    constexpr size_t B=IKINBATCH_BLOCK;
+
+    // structure-of-arrays scratch: T holds the 3x4 upper block of
+    // the current frame for each configuration of the block, while
+    // Z and P store the z-axis and the origin of the frames the
+    // DOF are attached to
+    double c[B],s[B];
+    double T[12][B];
+    vector<double> Z(J!=nullptr ? 3*DOF*B : 0);
+    vector<double> P(J!=nullptr ? 3*DOF*B : 0);
+
+    for (size_t b0=k0; b0<k1; b0+=B)
+    {
+        const size_t nb=std::min(B,k1-b0);
+
+        for (int e=0; e<12; e++)
+            for (size_t k=0; k<nb; k++)
+                T[e][k]=H0.h[e>>2][e&3];
+
+        for (unsigned int i=0; i<N; i++)
+        {
+            if (dof[i]>=0)
+            {
+                const double *q=&Q(dof[i],b0);
+                if (J!=nullptr)
+                {
+                    double *z=&Z[3*dof[i]*B];
+                    double *p=&P[3*dof[i]*B];
+                    for (size_t k=0; k<nb; k++)
+                    {
+                        z[k]=T[2][k];     z[B+k]=T[6][k];     z[2*B+k]=T[10][k];
+                        p[k]=T[3][k];     p[B+k]=T[7][k];     p[2*B+k]=T[11][k];
+                    }
+                }
+
+                for (size_t k=0; k<nb; k++)
+                {
+                    double ang=q[k];
+                    if (constrained[i])
+                        ang=(ang<Min[i]) ? Min[i] : ((ang>Max[i]) ? Max[i] : ang);
+                    c[k]=ang+Offset[i];
+                }
+            }
+            else for (size_t k=0; k<nb; k++)
+                c[k]=Ang[i]+Offset[i];
+
+            for (size_t k=0; k<nb; k++)
+                s[k]=sin(c[k]);
+            for (size_t k=0; k<nb; k++)
+                c[k]=cos(c[k]);
+
+            const double ca=c_alpha[i];
+            const double sa=s_alpha[i];
+            const double a=A[i];
+            const double d=D[i];
+
+            // T=T*H_i, exploiting the DH structure of H_i
+            for (int r=0; r<12; r+=4)
+            {
+                double *t0=T[r],*t1=T[r+1],*t2=T[r+2],*t3=T[r+3];
+                for (size_t k=0; k<nb; k++)
+                {
+                    const double x=t0[k]*c[k]+t1[k]*s[k];
+                    const double y=-t0[k]*s[k]+t1[k]*c[k];
+                    t0[k]=x;
+                    t3[k]+=a*x+d*t2[k];
+                    t1[k]=ca*y+sa*t2[k];
+                    t2[k]=ca*t2[k]-sa*y;
+                }
+            }
+        }
+
+        // T=T*HN
+        for (int r=0; r<12; r+=4)
+        {
+            double *t0=T[r],*t1=T[r+1],*t2=T[r+2],*t3=T[r+3];
+            for (size_t k=0; k<nb; k++)
+            {
+                const double x0=t0[k],x1=t1[k],x2=t2[k];
+                t0[k]=x0*HN.h[0][0]+x1*HN.h[1][0]+x2*HN.h[2][0];
+                t1[k]=x0*HN.h[0][1]+x1*HN.h[1][1]+x2*HN.h[2][1];
+                t2[k]=x0*HN.h[0][2]+x1*HN.h[1][2]+x2*HN.h[2][2];
+                t3[k]+=x0*HN.h[0][3]+x1*HN.h[1][3]+x2*HN.h[2][3];
+            }
+        }
+
+        if (X!=nullptr)
+        {
+            for (size_t k=0; k<nb; k++)
+            {
+                const size_t col=b0+k;
+                (*X)(0,col)=T[3][k];
+                (*X)(1,col)=T[7][k];
+                (*X)(2,col)=T[11][k];
+
+                if (axisRep)
+                {
+                    // same as yarp::math::dcm2axis()
+                    double v0=T[9][k]-T[6][k];
+                    double v1=T[2][k]-T[8][k];
+                    double v2=T[4][k]-T[1][k];
+                    double nrm=sqrt(v0*v0+v1*v1+v2*v2);
+                    if (nrm<1e-9)
+                    {
+                        Matrix R(3,3);
+                        for (int r=0; r<3; r++)
+                            for (int cc=0; cc<3; cc++)
+                                R(r,cc)=T[(r<<2)+cc][k];
+                        Vector v=dcm2axis(R);
+                        (*X)(3,col)=v[0];
+                        (*X)(4,col)=v[1];
+                        (*X)(5,col)=v[2];
+                        (*X)(6,col)=v[3];
+                    }
+                    else
+                    {
+                        (*X)(3,col)=v0/nrm;
+                        (*X)(4,col)=v1/nrm;
+                        (*X)(5,col)=v2/nrm;
+                        (*X)(6,col)=atan2(0.5*nrm,0.5*(T[0][k]+T[5][k]+T[10][k]-1.0));
+                    }
+                }
+                else
+                {
+                    // same as iKinChain::RotAng()
+                    (*X)(3,col)=atan2(-T[9][k],T[10][k]);
+                    (*X)(4,col)=asin(T[8][k]);
+                    (*X)(5,col)=atan2(-T[4][k],T[0][k]);
+                }
+            }
+        }
+
+        if (J!=nullptr)
+        {
+            for (unsigned int j=0; j<DOF; j++)
+            {
+                const double *z=&Z[3*j*B];
+                const double *p=&P[3*j*B];
+                for (size_t k=0; k<nb; k++)
+                {
+                    const size_t col=b0+k;
+                    const double dx=T[3][k]-p[k];
+                    const double dy=T[7][k]-p[B+k];
+                    const double dz=T[11][k]-p[2*B+k];
+
+                    (*J)(j,col)      =z[B+k]*dz-z[2*B+k]*dy;
+                    (*J)(DOF+j,col)  =z[2*B+k]*dx-z[k]*dz;
+                    (*J)(2*DOF+j,col)=z[k]*dy-z[B+k]*dx;
+                    (*J)(3*DOF+j,col)=z[k];
+                    (*J)(4*DOF+j,col)=z[B+k];
+                    (*J)(5*DOF+j,col)=z[2*B+k];
+                }
+            }
+        }
+    }
+}
+
+
+/************************************************************************/
+bool iKinBatch::run(const Matrix &Q, Matrix *X, Matrix *J,
+                    const bool axisRep) const
+{
+    if ((DOF==0) || (Q.rows()!=DOF))
+    {
+        yError("iKinBatch: wrong size of the configurations matrix (%d rows instead of %d)",
+               (int)Q.rows(),DOF);
+        return false;
+    }
+
+    const size_t K=Q.cols();
+    if (X!=nullptr)
+    {
+        size_t rows=axisRep ? 7 : 6;
+        if ((X->rows()!=rows) || (X->cols()!=K))
+            X->resize(rows,K);
+    }
+
+    if (J!=nullptr)
+    {
+        if ((J->rows()!=6*DOF) || (J->cols()!=K))
+            J->resize(6*DOF,K);
+    }
+
+    // split the batch in contiguous chunks, each made of whole
+    // blocks; the outputs are row-major, so every thread writes a
+    // range of columns in each row and neighbouring threads may
+    // still share the cache line straddling a chunk boundary
+    size_t nBlocks=(K+IKINBATCH_BLOCK-1)/IKINBATCH_BLOCK;
+    size_t nThreads=std::min((size_t)numThreads,nBlocks);
+    if (nThreads<=1)
+    {
+        compute(Q,X,J,axisRep,0,K);
+        return true;
+    }
+
+    vector<thread> workers;
+    size_t blocksPerThread=(nBlocks+nThreads-1)/nThreads;
+    for (size_t t=0; t<nThreads; t++)
+    {
+        size_t k0=std::min(t*blocksPerThread*IKINBATCH_BLOCK,K);
+        size_t k1=std::min((t+1)*blocksPerThread*IKINBATCH_BLOCK,K);
+        if (k0<k1)
+            workers.push_back(thread(&iKinBatch::compute,this,std::cref(Q),
+                                     X,J,axisRep,k0,k1));
+    }
+
+    for (auto &w:workers)
+        w.join();
+
+    return true;
+}
+
+
+/************************************************************************/
+bool iKinBatch::EndEffPose(const Matrix &Q, Matrix &X, const bool axisRep) const
+{
+    return run(Q,&X,nullptr,axisRep);
+}
+
+
+/************************************************************************/
+bool iKinBatch::GeoJacobian(const Matrix &Q, Matrix &J) const
+{
+    return run(Q,nullptr,&J,true);
+}
+
+
+/************************************************************************/
+bool iKinBatch::EndEffPoseAndJacobian(const Matrix &Q, Matrix &X, Matrix &J,
+                                      const bool axisRep) const
+{
+    return run(Q,&X,&J,axisRep);
+}
+
+
+/************************************************************************/
+Matrix iKinBatch::getJacobian(const Matrix &J, const size_t k) const
+{
+    yAssert((J.rows()==6*DOF) && (k<J.cols()));
+
+    Matrix Jk(6,DOF);
+    for (unsigned int r=0; r<6; r++)
+        for (unsigned int c=0; c<DOF; c++)
+            Jk(r,c)=J(r*DOF+c,k);
+
+    return Jk;
+}
+
+
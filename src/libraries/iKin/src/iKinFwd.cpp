@@ -43,6 +43,112 @@ void iCub::iKin::notImplemented(const unsigned int verbose)
 }
 
 
+/************************************************************************/
+namespace
+{
+    // C=A*B, with B homogeneous; A may have either [0 0 0 1]
+    // or [0 0 0 0] as last row, which is preserved in C.
+    // Aliasing between C and either A or B is allowed.
+    inline void mulH(const iKinHMatrix &A, const iKinHMatrix &B, iKinHMatrix &C)
+    {
+        double t[3][4];
+        for (int r=0; r<3; r++)
+        {
+            for (int c=0; c<3; c++)
+                t[r][c]=A.h[r][0]*B.h[0][c]+A.h[r][1]*B.h[1][c]+A.h[r][2]*B.h[2][c];
+            t[r][3]=A.h[r][0]*B.h[0][3]+A.h[r][1]*B.h[1][3]+A.h[r][2]*B.h[2][3]+A.h[r][3];
+        }
+
+        std::copy(&t[0][0],&t[0][0]+12,&C.h[0][0]);
+    }
+
+    // C=A*D, with A homogeneous and D having [0 0 0 0] as last row.
+    // Aliasing between C and either A or D is allowed.
+    inline void mulDH(const iKinHMatrix &A, const iKinHMatrix &D, iKinHMatrix &C)
+    {
+        double t[3][4];
+        for (int r=0; r<3; r++)
+            for (int c=0; c<4; c++)
+                t[r][c]=A.h[r][0]*D.h[0][c]+A.h[r][1]*D.h[1][c]+A.h[r][2]*D.h[2][c];
+
+        std::copy(&t[0][0],&t[0][0]+12,&C.h[0][0]);
+    }
+
+    // see iKinChain::RotAng()
+    inline void fastRotAng(const iKinHMatrix &R, double *r)
+    {
+        r[0]=atan2(-R(2,1),R(2,2));
+        r[1]=asin(R(2,0));
+        r[2]=atan2(-R(1,0),R(0,0));
+    }
+
+    // see iKinChain::dRotAng()
+    inline void fastDRotAng(const iKinHMatrix &R, const iKinHMatrix &dR, double *dr)
+    {
+        dr[0]=(R(2,1)*dR(2,2) - R(2,2)*dR(2,1)) / (R(2,1)*R(2,1) + R(2,2)*R(2,2));
+        dr[1]=dR(2,0)/sqrt(fabs(1-R(2,0)*R(2,0)));
+        dr[2]=(R(1,0)*dR(0,0) - R(0,0)*dR(1,0)) / (R(1,0)*R(1,0) + R(0,0)*R(0,0));
+    }
+
+    // same as yarp::math::dcm2axis(), relying on it only
+    // for the degenerate case of symmetric rotation matrices
+    inline void fastDcm2Axis(const iKinHMatrix &R, double *v)
+    {
+        v[0]=R(2,1)-R(1,2);
+        v[1]=R(0,2)-R(2,0);
+        v[2]=R(1,0)-R(0,1);
+        double r=sqrt(v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
+
+        if (r<1e-9)
+        {
+            Matrix H;
+            R.toMatrix(H);
+            Vector a=yarp::math::dcm2axis(H);
+            v[0]=a[0]; v[1]=a[1]; v[2]=a[2]; v[3]=a[3];
+        }
+        else
+        {
+            double theta=atan2(0.5*r,0.5*(R(0,0)+R(1,1)+R(2,2)-1));
+            v[0]/=r; v[1]/=r; v[2]/=r;
+            v[3]=theta;
+        }
+    }
+}
+
+
+/************************************************************************/
+void iKinHMatrix::eye()
+{
+    for (int r=0; r<3; r++)
+        for (int c=0; c<4; c++)
+            h[r][c]=(r==c) ? 1.0 : 0.0;
+}
+
+
+/************************************************************************/
+void iKinHMatrix::fromMatrix(const Matrix &H)
+{
+    for (int r=0; r<3; r++)
+        for (int c=0; c<4; c++)
+            h[r][c]=H(r,c);
+}
+
+
+/************************************************************************/
+void iKinHMatrix::toMatrix(Matrix &H) const
+{
+    if ((H.rows()!=4) || (H.cols()!=4))
+        H.resize(4,4);
+
+    for (int r=0; r<3; r++)
+        for (int c=0; c<4; c++)
+            H(r,c)=h[r][c];
+
+    H(3,0)=H(3,1)=H(3,2)=0.0;
+    H(3,3)=1.0;
+}
+
+
 /************************************************************************/
 iKinLink::iKinLink(double _A, double _D, double _Alpha, double _Offset,
                    double _Min, double _Max): zeros1x1(zeros(1,1)), zeros1(zeros(1))
@@ -69,6 +175,7 @@ iKinLink::iKinLink(double _A, double _D, double _Alpha, double _Offset,
     DnH =H;
     cumH=H;
     cumH.eye();
+    fastCumH.eye();
 
     H(2,1)=s_alpha;
     H(2,2)=c_alpha;
@@ -100,6 +207,8 @@ void iKinLink::clone(const iKinLink &l)
     H   =l.H;
     cumH=l.cumH;
     DnH =l.DnH;
+
+    fastCumH=l.fastCumH;
 }
 
 
@@ -252,11 +361,69 @@ Matrix iKinLink::getDnH(unsigned int n, bool c_override)
 }
 
 
+/************************************************************************/
+void iKinLink::fastGetH(iKinHMatrix &_H, bool c_override) const
+{
+    double theta=Ang+Offset;
+    double c_theta=cos(theta);
+    double s_theta=sin(theta);
+
+    iKinHMatrix L;
+    L(0,0)=c_theta;
+    L(0,1)=-s_theta*c_alpha;
+    L(0,2)=s_theta*s_alpha;
+    L(0,3)=c_theta*A;
+
+    L(1,0)=s_theta;
+    L(1,1)=c_theta*c_alpha;
+    L(1,2)=-c_theta*s_alpha;
+    L(1,3)=s_theta*A;
+
+    L(2,0)=0.0;
+    L(2,1)=s_alpha;
+    L(2,2)=c_alpha;
+    L(2,3)=D;
+
+    if (cumulative && !c_override)
+        mulH(fastCumH,L,_H);
+    else
+        _H=L;
+}
+
+
+/************************************************************************/
+void iKinLink::fastGetDH(iKinHMatrix &_DH, bool c_override) const
+{
+    double theta=Ang+Offset;
+    double c_theta=cos(theta);
+    double s_theta=sin(theta);
+
+    iKinHMatrix L;
+    L(0,0)=-s_theta;
+    L(0,1)=-c_theta*c_alpha;
+    L(0,2)=c_theta*s_alpha;
+    L(0,3)=-s_theta*A;
+
+    L(1,0)=c_theta;
+    L(1,1)=-s_theta*c_alpha;
+    L(1,2)=s_theta*s_alpha;
+    L(1,3)=c_theta*A;
+
+    L(2,0)=L(2,1)=L(2,2)=L(2,3)=0.0;
+
+    if (cumulative && !c_override)
+        mulDH(fastCumH,L,_DH);
+    else
+        _DH=L;
+}
+
+
 /************************************************************************/
 void iKinLink::addCumH(const Matrix &_cumH)
 {
     cumulative=true;
     cumH=_cumH;
+    fastCumH.fromMatrix(cumH);
 }
 
 
@@ -265,6 +432,10 @@ iKinChain::iKinChain()
 {
     N=DOF=verbose=0;
     H0=HN=eye(4,4);
+
+    cacheOn=false;
+    cacheHits=cacheRecomputations=0;
+    invalidateCache();
 }
 
 
@@ -284,6 +455,10 @@ void iKinChain::clone(const iKinChain &c)
     quickList.assign(c.quickList.begin(),c.quickList.end());
     hash.assign(c.hash.begin(),c.hash.end());
     hash_dof.assign(c.hash_dof.begin(),c.hash_dof.end());
+
+    cacheOn=c.cacheOn;
+    cacheHits=cacheRecomputations=0;
+    invalidateCache();
 }
 
 
@@ -367,6 +542,8 @@ void iKinChain::clear()
 
     N=DOF=0;
     H0=HN=eye(4,4);
+
+    invalidateCache();
 }
 
 
@@ -447,6 +624,8 @@ bool iKinChain::setBlockingValue(const unsigned int i, double Ang)
                 allList[j]->addCumH(H);
             } 
 
+            invalidateCache();
+
             return true;
         }
         else
@@ -563,6 +742,169 @@ void iKinChain::build()
 
     if (DOF>0)
         curr_q.resize(DOF,0);
+
+    fastReserve();
+    invalidateCache();
+}
+
+
+/************************************************************************/
+void iKinChain::invalidateCache()
+{
+    cacheAllValid=cacheQuickValid=0;
+    cacheStale=true;
+}
+
+
+/************************************************************************/
+void iKinChain::setCaching(const bool sw)
+{
+    cacheOn=sw;
+    invalidateCache();
+}
+
+
+/************************************************************************/
+void iKinChain::validateCache()
+{
+    // the structure of the chain has changed
+    if (cacheStale)
+    {
+        unsigned int nq=(unsigned int)quickList.size();
+        cacheAllH.resize(N+1);
+        cacheQuickH.resize(nq+1);
+        cacheKeys.resize(6*N);
+
+        // quickList entries are a subsequence of allList ones
+        cacheQuickIdx.resize(nq);
+        for (unsigned int i=0,j=0; (i<N) && (j<nq); i++)
+            if (allList[i]==quickList[j])
+                cacheQuickIdx[j++]=i;
+
+        cacheStale=false;
+    }
+
+    // first link whose parameters differ from the cached ones;
+    // a change in H0 invalidates the whole chain
+    unsigned int first=N;
+    if ((cacheH0.rows()!=4) || (cacheH0.cols()!=4))
+        first=0;
+    else
+    {
+        for (int r=0; (r<4) && (first>0); r++)
+            for (int c=0; c<4; c++)
+                if (cacheH0(r,c)!=H0(r,c))
+                {
+                    first=0;
+                    break;
+                }
+    }
+
+    if (first==0)
+        cacheH0=H0;
+
+    for (unsigned int i=0; i<N; i++)
+    {
+        const iKinLink *l=allList[i];
+        double *key=&cacheKeys[6*i];
+        if ((key[0]!=l->Ang) || (key[1]!=l->Offset) || (key[2]!=l->A) ||
+            (key[3]!=l->D) || (key[4]!=l->c_alpha) || (key[5]!=l->s_alpha))
+        {
+            key[0]=l->Ang;
+            key[1]=l->Offset;
+            key[2]=l->A;
+            key[3]=l->D;
+            key[4]=l->c_alpha;
+            key[5]=l->s_alpha;
+
+            if (i<first)
+                first=i;
+        }
+    }
+
+    // truncate the valid prefixes: entry j+1 depends on links 0..j
+    if (cacheAllValid>first+1)
+        cacheAllValid=first+1;
+
+    for (unsigned int j=0; j<cacheQuickValid; j++)
+    {
+        if (cacheQuickIdx[j]>=first)
+        {
+            cacheQuickValid=j+1;
+            break;
+        }
+    }
+
+    // entry 0 is always H0
+    if (first==0)
+        cacheAllValid=cacheQuickValid=0;
+}
+
+
+/************************************************************************/
+const Matrix &iKinChain::getCachedAllH(const unsigned int n)
+{
+    validateCache();
+
+    if (cacheAllValid==0)
+    {
+        cacheAllH[0]=H0;
+        cacheAllValid=1;
+    }
+
+    if (cacheAllValid>n)
+        cacheHits++;
+    else
+    {
+        for (unsigned int j=cacheAllValid-1; j<n; j++)
+        {
+            cacheAllH[j+1]=cacheAllH[j]*allList[j]->getH(true);
+            cacheRecomputations++;
+        }
+
+        cacheAllValid=n+1;
+    }
+
+    return cacheAllH[n];
+}
+
+
+/************************************************************************/
+const Matrix &iKinChain::getCachedQuickH(const unsigned int n)
+{
+    validateCache();
+
+    if (cacheQuickValid==0)
+    {
+        cacheQuickH[0]=H0;
+        cacheQuickValid=1;
+    }
+
+    if (cacheQuickValid>n)
+        cacheHits++;
+    else
+    {
+        for (unsigned int j=cacheQuickValid-1; j<n; j++)
+        {
+            cacheQuickH[j+1]=cacheQuickH[j]*quickList[j]->getH();
+            cacheRecomputations++;
+        }
+
+        cacheQuickValid=n+1;
+    }
+
+    return cacheQuickH[n];
+}
+
+
+/************************************************************************/
+void iKinChain::fastReserve()
+{
+    if (fastFwdH.size()<N+1)
+        fastFwdH.resize(N+1);
+
+    if (fastBwdH.size()<N+1)
+        fastBwdH.resize(N+1);
 }
 
 
@@ -772,7 +1114,9 @@ Matrix iKinChain::getH(const unsigned int i, const bool allLink)
 
     yAssert(i<n);
 
-    for (unsigned int j=0; j<=_i; j++)
+    if (cacheOn)
+        H=allLink ? getCachedAllH(_i+1) : getCachedQuickH(_i+1);
+    else for (unsigned int j=0; j<=_i; j++)
         H*=((*l)[j]->getH(c_override));
 
     if (cumulHN)
@@ -788,6 +1132,9 @@ Matrix iKinChain::getH()
     // may be different from DOF since one blocked link may lie
     // at the end of the chain.
     unsigned int n=(unsigned int)quickList.size();
+    if (cacheOn)
+        return getCachedQuickH(n)*HN;
+
     Matrix H=H0;
 
     for (unsigned int i=0; i<n; i++)
@@ -1025,11 +1372,18 @@ Matrix iKinChain::GeoJacobian(const unsigned int i)
     Matrix PN,Z;
     Vector w;
 
-    deque<Matrix> intH;
-    intH.push_back(H0);
+    vector<Matrix> _intH;
+    if (cacheOn)
+        getCachedAllH(i+1);
+    else
+    {
+        _intH.push_back(H0);
 
-    for (unsigned int j=0; j<=i; j++)
-        intH.push_back(intH[j]*allList[j]->getH(true));
+        for (unsigned int j=0; j<=i; j++)
+            _intH.push_back(_intH[j]*allList[j]->getH(true));
+    }
+
+    const vector<Matrix> &intH=cacheOn ? cacheAllH : _intH;
 
     PN=intH[i+1];
     if (i>=N-1)
@@ -1061,12 +1415,18 @@ Matrix iKinChain::GeoJacobian()
     Matrix PN,Z;
     Vector w;
 
-    deque<Matrix> intH;
-    intH.push_back(H0);
+    vector<Matrix> _intH;
+    if (cacheOn)
+        getCachedAllH(N);
+    else
+    {
+        _intH.push_back(H0);
 
-    for (unsigned int i=0; i<N; i++)
-        intH.push_back(intH[i]*allList[i]->getH(true));
+        for (unsigned int i=0; i<N; i++)
+            _intH.push_back(_intH[i]*allList[i]->getH(true));
+    }
 
+    const vector<Matrix> &intH=cacheOn ? cacheAllH : _intH;
     PN=intH[N]*HN;
 
     for (unsigned int i=0; i<DOF; i++)
@@ -1304,6 +1664,215 @@ Matrix iKinChain::DJacobian(const unsigned int lnk, const Vector &dq)
 }
 
 
+/************************************************************************/
+void iKinChain::fastGetH(const unsigned int i, iKinHMatrix &H, const bool allLink)
+{
+    unsigned int _i,n;
+    deque<iKinLink*> *l;
+    bool cumulHN=false;
+    bool c_override;
+
+    if (allLink)
+    {
+        n=N;
+        l=&allList;
+        c_override=true;
+
+        _i=i;
+        if (_i>=N-1)
+            cumulHN=true;
+    }
+    else
+    {
+        n=DOF;
+        l=&quickList;
+        c_override=false;
+
+        if (i==DOF)
+            _i=(unsigned int)quickList.size();
+        else
+            _i=i;
+
+        if (hash[_i]>=N-1)
+            cumulHN=true;
+    }
+
+    yAssert(i<n);
+
+    iKinHMatrix L;
+    H.fromMatrix(H0);
+
+    for (unsigned int j=0; j<=_i; j++)
+    {
+        (*l)[j]->fastGetH(L,c_override);
+        mulH(H,L,H);
+    }
+
+    if (cumulHN)
+    {
+        L.fromMatrix(HN);
+        mulH(H,L,H);
+    }
+}
+
+
+/************************************************************************/
+void iKinChain::fastGetH(iKinHMatrix &H)
+{
+    // may be different from DOF since one blocked link may lie
+    // at the end of the chain.
+    unsigned int n=(unsigned int)quickList.size();
+    iKinHMatrix L;
+    H.fromMatrix(H0);
+
+    for (unsigned int i=0; i<n; i++)
+    {
+        quickList[i]->fastGetH(L);
+        mulH(H,L,H);
+    }
+
+    L.fromMatrix(HN);
+    mulH(H,L,H);
+}
+
+
+/************************************************************************/
+void iKinChain::fastPosition(const unsigned int i, Vector &p)
+{
+    yAssert(i<N);
+
+    iKinHMatrix H;
+    fastGetH(i,H,true);
+
+    if (p.length()!=3)
+        p.resize(3);
+
+    p[0]=H(0,3);
+    p[1]=H(1,3);
+    p[2]=H(2,3);
+}
+
+
+/************************************************************************/
+void iKinChain::fastEndEffPose(Vector &x, const bool axisRep)
+{
+    iKinHMatrix H;
+    fastGetH(H);
+
+    size_t len=axisRep ? 7 : 6;
+    if (x.length()!=len)
+        x.resize(len);
+
+    x[0]=H(0,3);
+    x[1]=H(1,3);
+    x[2]=H(2,3);
+
+    if (axisRep)
+        fastDcm2Axis(H,&x[3]);
+    else
+        fastRotAng(H,&x[3]);
+}
+
+
+/************************************************************************/
+void iKinChain::fastAnaJacobian(Matrix &J, unsigned int col)
+{
+    yAssert(DOF>0);
+
+    col=col>3 ? 3 : col;
+
+    if ((J.rows()!=6) || (J.cols()!=DOF))
+        J.resize(6,DOF);
+
+    fastReserve();
+
+    // may be different from DOF since one blocked link may lie
+    // at the end of the chain.
+    unsigned int n=(unsigned int)quickList.size();
+
+    // forward products: fastFwdH[j]=H0*H_0*...*H_(j-1);
+    // the links are temporarily parked in fastBwdH
+    fastFwdH[0].fromMatrix(H0);
+    for (unsigned int j=0; j<n; j++)
+    {
+        quickList[j]->fastGetH(fastBwdH[j]);
+        mulH(fastFwdH[j],fastBwdH[j],fastFwdH[j+1]);
+    }
+
+    // backward products: fastBwdH[j]=H_j*...*H_(n-1)*HN
+    fastBwdH[n].fromMatrix(HN);
+    for (int j=n-1; j>=0; j--)
+        mulH(fastBwdH[j],fastBwdH[j+1],fastBwdH[j]);
+
+    iKinHMatrix H,dH;
+    mulH(fastFwdH[n],fastBwdH[n],H);
+
+    double dr[3];
+    for (unsigned int i=0; i<DOF; i++)
+    {
+        unsigned int j=hash_dof[i];
+
+        quickList[j]->fastGetDH(dH);
+        mulDH(fastFwdH[j],dH,dH);
+        mulH(dH,fastBwdH[j+1],dH);
+        fastDRotAng(H,dH,dr);
+
+        J(0,i)=dH(0,col);
+        J(1,i)=dH(1,col);
+        J(2,i)=dH(2,col);
+        J(3,i)=dr[0];
+        J(4,i)=dr[1];
+        J(5,i)=dr[2];
+    }
+}
+
+
+/************************************************************************/
+void iKinChain::fastGeoJacobian(Matrix &J)
+{
+    iKinHMatrix PN;
+    fastPoseAndGeoJacobian(PN,J);
+}
+
+
+/************************************************************************/
+void iKinChain::fastPoseAndGeoJacobian(iKinHMatrix &PN, Matrix &J)
+{
+    yAssert(DOF>0);
+
+    if ((J.rows()!=6) || (J.cols()!=DOF))
+        J.resize(6,DOF);
+
+    fastReserve();
+
+    iKinHMatrix L;
+    fastFwdH[0].fromMatrix(H0);
+    for (unsigned int i=0; i<N; i++)
+    {
+        allList[i]->fastGetH(L,true);
+        mulH(fastFwdH[i],L,fastFwdH[i+1]);
+    }
+
+    L.fromMatrix(HN);
+    mulH(fastFwdH[N],L,PN);
+
+    for (unsigned int i=0; i<DOF; i++)
+    {
+        const iKinHMatrix &Z=fastFwdH[hash[i]];
+        double dx=PN(0,3)-Z(0,3);
+        double dy=PN(1,3)-Z(1,3);
+        double dz=PN(2,3)-Z(2,3);
+
+        J(0,i)=Z(1,2)*dz-Z(2,2)*dy;
+        J(1,i)=Z(2,2)*dx-Z(0,2)*dz;
+        J(2,i)=Z(0,2)*dy-Z(1,2)*dx;
+        J(3,i)=Z(0,2);
+        J(4,i)=Z(1,2);
+        J(5,i)=Z(2,2);
+    }
+}
+
+
 /************************************************************************/
 iKinChain::~iKinChain()
 {
@@ -82,6 +82,67 @@ bool CartesianHelper::getDesiredOption(const Bottle &reply, Vector &xdhat,
 }
 
 
+/************************************************************************/
+void CartesianHelper::addVectorsOption(Bottle &b, const int vcb,
+                                       const std::deque<Vector> &v)
+{
+    Bottle &part=b.addList();
+    part.addVocab32(vcb);
+    Bottle &list=part.addList();
+
+    for (auto &vi:v)
+    {
+        Bottle &vect=list.addList();
+        for (size_t i=0; i<vi.length(); i++)
+            vect.addFloat64(vi[i]);
+    }
+}
+
+
+/************************************************************************/
+bool CartesianHelper::getDesiredOption(const Bottle &reply, std::deque<Vector> &xdhat,
+                                       std::deque<Vector> &odhat, std::deque<Vector> &qdhat)
+{
+    if (reply.size()==0)
+        return false;
+
+    if (reply.get(0).asVocab32()!=IKINSLV_VOCAB_REP_ACK)
+        return false;
+
+    Bottle *xData=getEndEffectorPoseOption(reply);
+    Bottle *qData=getJointsOption(reply);
+    if ((xData==NULL) || (qData==NULL) || (xData->size()!=qData->size()))
+        return false;
+
+    size_t num=xData->size();
+    xdhat.resize(num);
+    odhat.resize(num);
+    qdhat.resize(num);
+
+    for (size_t k=0; k<num; k++)
+    {
+        Bottle *x=xData->get(k).asList();
+        Bottle *q=qData->get(k).asList();
+        if ((x==NULL) || (q==NULL) || (x->size()<7))
+            return false;
+
+        xdhat[k].resize(3);
+        for (size_t i=0; i<xdhat[k].length(); i++)
+            xdhat[k][i]=x->get(i).asFloat64();
+
+        odhat[k].resize(4);
+        for (size_t i=0; i<odhat[k].length(); i++)
+            odhat[k][i]=x->get(xdhat[k].length()+i).asFloat64();
+
+        qdhat[k].resize(q->size());
+        for (size_t i=0; i<qdhat[k].length(); i++)
+            qdhat[k][i]=q->get(i).asFloat64();
+    }
+
+    return true;
+}
+
+
 /************************************************************************/
 void CartesianHelper::addTargetOption(Bottle &b, const Vector &xd)
 {
@@ -746,9 +746,9 @@ MultiRefMinJerkCtrl::MultiRefMinJerkCtrl(iKinChain &c, unsigned int _ctrlPose, d
     if (nonIdealPlant)
         mjCtrlJoint=new minJerkVelCtrlForNonIdealPlant(Ts,dim);
     else
-        mjCtrlJoint=new minJerkVelCtrlForIdealPlant(Ts,dim);
+        mjCtrlJoint=new minJerkVelCtrlForIdealPlantSoA(Ts,dim);
 
-    mjCtrlTask=new minJerkVelCtrlForIdealPlant(Ts,(int)e.length());
+    mjCtrlTask=new minJerkVelCtrlForIdealPlantSoA(Ts,(int)e.length());
     I=new Integrator(Ts,q,lim);
 
     gamma=0.05;
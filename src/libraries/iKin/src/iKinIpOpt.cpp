@@ -8,10 +8,17 @@
  * details.
 */
 
+#include <cmath>
 #include <cstdlib>
+#include <algorithm>
 #include <limits>
 #include <string>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <random>
 
+#include <IpoptConfig.h>
 #include <IpTNLP.hpp>
 #include <IpIpoptApplication.hpp>
 
@@ -27,6 +34,37 @@ using namespace iCub::ctrl;
 using namespace iCub::iKin;
 using namespace Ipopt;
 
+namespace
+{
+    // same as iKinChain::fastHessian_ij(), but working
+    // on a geometric Jacobian already at hand
+    inline void hessian_ij(const yarp::sig::Matrix &J, const unsigned int i,
+                           const unsigned int j, double *h)
+    {
+        if (i<j)
+        {
+            h[0]=J(4,i)*J(2,j)-J(5,i)*J(1,j);
+            h[1]=J(5,i)*J(0,j)-J(3,i)*J(2,j);
+            h[2]=J(3,i)*J(1,j)-J(4,i)*J(0,j);
+            h[3]=J(4,i)*J(5,j)-J(5,i)*J(4,j);
+            h[4]=J(5,i)*J(3,j)-J(3,i)*J(5,j);
+            h[5]=J(3,i)*J(4,j)-J(4,i)*J(3,j);
+        }
+        else
+        {
+            h[0]=J(4,j)*J(2,i)-J(5,j)*J(1,i);
+            h[1]=J(5,j)*J(0,i)-J(3,j)*J(2,i);
+            h[2]=J(3,j)*J(1,i)-J(4,j)*J(0,i);
+            h[3]=h[4]=h[5]=0.0;
+        }
+    }
+
+    inline double dot3(const double *a, const yarp::sig::Vector &b)
+    {
+        return a[0]*b[0]+a[1]*b[1]+a[2]*b[2];
+    }
+}
+
 
 /************************************************************************/
 iKinLinIneqConstr::iKinLinIneqConstr()
@@ -274,6 +312,25 @@ protected:
 
     yarp::sig::Vector linC;
 
+    // scratch storage for the fused pose/Jacobian sweep
+    iKinHMatrix       H;
+    iKinHMatrix       H_2nd;
+    yarp::sig::Matrix J1;
+    yarp::sig::Matrix J2;
+    double            Rd[3][3];
+
+    // warm start data (in) and final multipliers (out)
+    bool              warmStart;
+    yarp::sig::Vector ws_x;
+    yarp::sig::Vector ws_zL;
+    yarp::sig::Vector ws_zU;
+    yarp::sig::Vector ws_lambda;
+    yarp::sig::Vector sol_zL;
+    yarp::sig::Vector sol_zU;
+    yarp::sig::Vector sol_lambda;
+    double            sol_obj;
+    double            sol_viol;
+
     double __obj_scaling;
     double __x_scaling;
     double __g_scaling;
@@ -289,49 +346,65 @@ protected:
     /************************************************************************/
     virtual void computeQuantities(const Number *x)
     {
-        yarp::sig::Vector new_q(dim);
-        for (Index i=0; i<(int)dim; i++)
-            new_q[i]=x[i];
+        bool changed=firstGo;
+        for (unsigned int i=0; (i<dim) && !changed; i++)
+            changed=(q[i]!=x[i]);
 
-        if (!(q==new_q) || firstGo)
+        if (changed)
         {
             firstGo=false;
-            q=new_q;
+            for (unsigned int i=0; i<dim; i++)
+                q[i]=chain(i).setAng(x[i]);
+
+            chain.fastPoseAndGeoJacobian(H,J1);
 
-            yarp::sig::Vector v(4,0.0);
-            if (xd.length()>=7)
-            {
-                v[0]=xd[3];
-                v[1]=xd[4];
-                v[2]=xd[5];
-                v[3]=xd[6];
-            }
-            
-            q=chain.setAng(q);
-            yarp::sig::Matrix H=chain.getH();
-            yarp::sig::Matrix E=axis2dcm(v)*H.transposed();
-            v=dcm2axis(E);
-            
             e_xyz[0]=xd[0]-H(0,3);
             e_xyz[1]=xd[1]-H(1,3);
             e_xyz[2]=xd[2]-H(2,3);
-            e_ang[0]=v[3]*v[0];
-            e_ang[1]=v[3]*v[1];
-            e_ang[2]=v[3]*v[2];
 
-            yarp::sig::Matrix J1=chain.GeoJacobian();
-            submatrix(J1,J_xyz,0,2,0,dim-1);
-            submatrix(J1,J_ang,3,5,0,dim-1);
+            // E=Rd*R^T, then same as yarp::math::dcm2axis()
+            double E[3][3];
+            for (int r=0; r<3; r++)
+                for (int c=0; c<3; c++)
+                    E[r][c]=Rd[r][0]*H(c,0)+Rd[r][1]*H(c,1)+Rd[r][2]*H(c,2);
+
+            double v0=E[2][1]-E[1][2];
+            double v1=E[0][2]-E[2][0];
+            double v2=E[1][0]-E[0][1];
+            double r=sqrt(v0*v0+v1*v1+v2*v2);
+            if (r<1e-9)
+            {
+                yarp::sig::Matrix R(3,3);
+                for (int i=0; i<3; i++)
+                    for (int j=0; j<3; j++)
+                        R(i,j)=E[i][j];
+
+                yarp::sig::Vector v=dcm2axis(R);
+                e_ang[0]=v[3]*v[0];
+                e_ang[1]=v[3]*v[1];
+                e_ang[2]=v[3]*v[2];
+            }
+            else
+            {
+                double theta=atan2(0.5*r,0.5*(E[0][0]+E[1][1]+E[2][2]-1.0));
+                e_ang[0]=theta*v0/r;
+                e_ang[1]=theta*v1/r;
+                e_ang[2]=theta*v2/r;
+            }
+
+            for (unsigned int i=0; i<dim; i++)
+            {
+                J_xyz(0,i)=J1(0,i); J_xyz(1,i)=J1(1,i); J_xyz(2,i)=J1(2,i);
+                J_ang(0,i)=J1(3,i); J_ang(1,i)=J1(4,i); J_ang(2,i)=J1(5,i);
+            }
 
             if (weight2ndTask!=0.0)
             {
-                yarp::sig::Matrix H_2nd=chain2ndTask.getH();
+                chain2ndTask.fastPoseAndGeoJacobian(H_2nd,J2);
                 e_2nd[0]=w_2nd[0]*(xd_2nd[0]-H_2nd(0,3));
                 e_2nd[1]=w_2nd[1]*(xd_2nd[1]-H_2nd(1,3));
                 e_2nd[2]=w_2nd[2]*(xd_2nd[2]-H_2nd(2,3));
 
-                yarp::sig::Matrix J2=chain2ndTask.GeoJacobian();
-
                 for (unsigned int i=0; i<dim_2nd; i++)
                 {
                     J_2nd(0,i)=w_2nd[0]*J2(0,i);
@@ -345,7 +418,19 @@ protected:
                     e_3rd[i]=w_3rd[i]*(qd_3rd[i]-q[i]);
 
             if (LIC.isActive())
-                linC=LIC.getC()*q;
+            {
+                const yarp::sig::Matrix &C=LIC.getC();
+                if (linC.length()!=C.rows())
+                    linC.resize(C.rows());
+
+                for (size_t row=0; row<C.rows(); row++)
+                {
+                    double tmp=0.0;
+                    for (unsigned int col=0; col<dim; col++)
+                        tmp+=C(row,col)*q[col];
+                    linC[row]=tmp;
+                }
+            }
         }
     }
 
@@ -412,8 +497,30 @@ public:
         e_cst=&e_xyz;
         J_cst=&J_xyz;
 
+        J1.resize(6,dim);
+        if (dim_2nd>0)
+            J2.resize(6,dim_2nd);
+
+        // the target orientation does not change during the solve
+        yarp::sig::Vector v(4,0.0);
+        if (xd.length()>=7)
+        {
+            v[0]=xd[3];
+            v[1]=xd[4];
+            v[2]=xd[5];
+            v[3]=xd[6];
+        }
+
+        yarp::sig::Matrix R=axis2dcm(v);
+        for (int r=0; r<3; r++)
+            for (int c=0; c<3; c++)
+                Rd[r][c]=R(r,c);
+
+        warmStart=false;
         firstGo=true;
 
+        sol_obj=sol_viol=std::numeric_limits<double>::max();
+
         __obj_scaling=1.0;
         __x_scaling  =1.0;
         __g_scaling  =1.0;
@@ -430,6 +537,33 @@ public:
     /************************************************************************/
     void set_callback(iKinIterateCallback *_callback) { callback=_callback; }
 
+    /************************************************************************/
+    void set_warm_start(const yarp::sig::Vector &x, const yarp::sig::Vector &zL,
+                        const yarp::sig::Vector &zU, const yarp::sig::Vector &lambda)
+    {
+        ws_x=x;
+        ws_zL=zL;
+        ws_zU=zU;
+        ws_lambda=lambda;
+        warmStart=true;
+    }
+
+    /************************************************************************/
+    void get_multipliers(yarp::sig::Vector &zL, yarp::sig::Vector &zU,
+                         yarp::sig::Vector &lambda) const
+    {
+        zL=sol_zL;
+        zU=sol_zU;
+        lambda=sol_lambda;
+    }
+
+    /************************************************************************/
+    void get_cost(double &obj, double &viol) const
+    {
+        obj=sol_obj;
+        viol=sol_viol;
+    }
+
     /************************************************************************/
     void set_scaling(double _obj_scaling, double _x_scaling, double _g_scaling)
     {
@@ -548,8 +682,35 @@ public:
                             Number* z_L, Number* z_U, Index m, bool init_lambda,
                             Number* lambda)
     {
-        for (Index i=0; i<n; i++)
-            x[i]=q0[i];
+        if (init_x)
+        {
+            const yarp::sig::Vector &x0=warmStart ? ws_x : q0;
+            for (Index i=0; i<n; i++)
+                x[i]=x0[i];
+        }
+
+        // multipliers are requested only when
+        // IpOpt is told to warm start
+        if (init_z)
+        {
+            if (!warmStart)
+                return false;
+
+            for (Index i=0; i<n; i++)
+            {
+                z_L[i]=ws_zL[i];
+                z_U[i]=ws_zU[i];
+            }
+        }
+
+        if (init_lambda)
+        {
+            if (!warmStart)
+                return false;
+
+            for (Index i=0; i<m; i++)
+                lambda[i]=ws_lambda[i];
+        }
 
         return true;
     }
@@ -575,16 +736,18 @@ public:
     {
         computeQuantities(x);
 
-        yarp::sig::Vector grad=-2.0*(J_1st->transposed() * *e_1st);
+        for (Index i=0; i<n; i++)
+        {
+            double g=(*J_1st)(0,i)*(*e_1st)[0]+(*J_1st)(1,i)*(*e_1st)[1]+(*J_1st)(2,i)*(*e_1st)[2];
 
-        if (weight2ndTask!=0.0)
-            grad=grad-2.0*weight2ndTask*(J_2nd.transposed()*e_2nd);
+            if (weight2ndTask!=0.0)
+                g+=weight2ndTask*(J_2nd(0,i)*e_2nd[0]+J_2nd(1,i)*e_2nd[1]+J_2nd(2,i)*e_2nd[2]);
 
-        if (weight3rdTask!=0.0)
-            grad=grad-2.0*weight3rdTask*(w_3rd*e_3rd);
+            if (weight3rdTask!=0.0)
+                g+=weight3rdTask*w_3rd[i]*e_3rd[i];
 
-        for (Index i=0; i<n; i++)
-            grad_f[i]=grad[i];
+            grad_f[i]=-2.0*g;
+        }
 
         return true;
     }
@@ -633,8 +796,6 @@ public:
             else
             {
                 computeQuantities(x);
-            
-                yarp::sig::Vector grad=-2.0*(J_cst->transposed() * *e_cst);
 
                 Index idx =0;
                 Index offs=0;
@@ -645,7 +806,9 @@ public:
                     {    
                         if (row==0)
                         {
-                            values[idx]=grad[idx];                    
+                            values[idx]=-2.0*((*J_cst)(0,col)*(*e_cst)[0]+
+                                              (*J_cst)(1,col)*(*e_cst)[1]+
+                                              (*J_cst)(2,col)*(*e_cst)[2]);
                             offs=1;
                         }
                         else
@@ -683,11 +846,12 @@ public:
         {
             // Given the task: min f(q)=||xd-F(q)||^2
             // the Hessian Hij is: 2 * (<dF/dqi,dF/dqj> - <d2F/dqidqj,e>)
+            // where d2F/dqidqj is obtained from the geometric
+            // Jacobians already computed for the current x
             computeQuantities(x);
-            chain.prepareForHessian();
 
-            if (weight2ndTask!=0.0)
-                chain2ndTask.prepareForHessian();
+            const double h_zero[3]={0.0,0.0,0.0};
+            double h[6],h2[6];
 
             Index idx=0;
             for (Index row=0; row<n; row++)
@@ -696,41 +860,35 @@ public:
                 {
                     // warning: row and col are swapped due to asymmetry
                     // of orientation part within the hessian 
-                    yarp::sig::Vector h=chain.fastHessian_ij(col,row);
-                    yarp::sig::Vector h_xyz(3), h_ang(3), h_zero(3,0.0);
-                    h_xyz[0]=h[0];
-                    h_xyz[1]=h[1];
-                    h_xyz[2]=h[2];
-                    h_ang[0]=h[3];
-                    h_ang[1]=h[4];
-                    h_ang[2]=h[5];
-
-                    yarp::sig::Vector *h_1st,*h_cst;
+                    hessian_ij(J1,col,row,h);
+                    const double *h_xyz=h;
+                    const double *h_ang=h+3;
+
+                    const double *h_1st,*h_cst;
                     if (e_cst==&e_xyz)
                     {
-                        h_1st=(ctrlPose==IKINCTRL_POSE_FULL)?&h_ang:&h_zero;
-                        h_cst=&h_xyz;
+                        h_1st=(ctrlPose==IKINCTRL_POSE_FULL)?h_ang:h_zero;
+                        h_cst=h_xyz;
                     }
                     else
                     {
-                        h_1st=(ctrlPose==IKINCTRL_POSE_FULL)?&h_xyz:&h_zero;
-                        h_cst=&h_ang;
+                        h_1st=(ctrlPose==IKINCTRL_POSE_FULL)?h_xyz:h_zero;
+                        h_cst=h_ang;
                     }
 
-                    values[idx]=2.0*(obj_factor*(dot(*J_1st,row,*J_1st,col)-dot(*h_1st,*e_1st))+
-                                     lambda[0]*(dot(*J_cst,row,*J_cst,col)-dot(*h_cst,*e_cst)));
+                    values[idx]=2.0*(obj_factor*(dot(*J_1st,row,*J_1st,col)-dot3(h_1st,*e_1st))+
+                                     lambda[0]*(dot(*J_cst,row,*J_cst,col)-dot3(h_cst,*e_cst)));
                 
                     if ((weight2ndTask!=0.0) && (row<(int)dim_2nd) && (col<(int)dim_2nd))
                     {    
                         // warning: row and col are swapped due to asymmetry
                         // of orientation part within the hessian 
-                        yarp::sig::Vector h2=chain2ndTask.fastHessian_ij(col,row);
-                        yarp::sig::Vector h_2nd(3);
-                        h_2nd[0]=(w_2nd[0]*w_2nd[0])*h2[0];
-                        h_2nd[1]=(w_2nd[1]*w_2nd[1])*h2[1];
-                        h_2nd[2]=(w_2nd[2]*w_2nd[2])*h2[2];
+                        hessian_ij(J2,col,row,h2);
+                        h2[0]*=w_2nd[0]*w_2nd[0];
+                        h2[1]*=w_2nd[1]*w_2nd[1];
+                        h2[2]*=w_2nd[2]*w_2nd[2];
                 
-                        values[idx]+=2.0*obj_factor*weight2ndTask*(dot(J_2nd,row,J_2nd,col)-dot(h_2nd,e_2nd));
+                        values[idx]+=2.0*obj_factor*weight2ndTask*(dot(J_2nd,row,J_2nd,col)-dot3(h2,e_2nd));
                     }
                 
                     idx++;
@@ -785,6 +943,31 @@ public:
             qd[i]=x[i];
 
         qd=chain.setAng(qd);
+
+        sol_zL.resize(n);
+        sol_zU.resize(n);
+        for (Index i=0; i<n; i++)
+        {
+            sol_zL[i]=z_L[i];
+            sol_zU[i]=z_U[i];
+        }
+
+        sol_lambda.resize(m);
+        for (Index i=0; i<m; i++)
+            sol_lambda[i]=lambda[i];
+
+        // same bounds as in get_bounds_info()
+        sol_obj=obj_value;
+        sol_viol=0.0;
+        Index offs=1;
+        for (Index i=0; i<m; i++)
+        {
+            if (i==0)
+                sol_viol=fabs(g[0]);
+            else
+                sol_viol=std::max(sol_viol,std::max(LIC.getlB()[i-offs]-g[i],
+                                                    g[i]-LIC.getuB()[i-offs]));
+        }
     }
 
     /************************************************************************/
@@ -792,6 +975,51 @@ public:
 };
 
 
+/************************************************************************/
+class MultiStartMonitor : public iKinIterateCallback
+{
+protected:
+    const std::atomic<int> &winner;
+    const bool *exhalt;
+    int index;
+
+public:
+    bool halt;
+
+    /************************************************************************/
+    MultiStartMonitor(const std::atomic<int> &_winner, const bool *_exhalt,
+                      const int _index) :
+                      winner(_winner), exhalt(_exhalt), index(_index), halt(false) { }
+
+    /************************************************************************/
+    void exec(const yarp::sig::Vector &xd, const yarp::sig::Vector &q)
+    {
+        // a start with a lower index has already converged
+        // hence this one cannot be selected anymore
+        halt=(winner.load(std::memory_order_relaxed)<index) ||
+             ((exhalt!=NULL) && *exhalt);
+    }
+};
+
+
+/************************************************************************/
+struct iKinIpOptMin::MultiStartLane
+{
+    deque<iKinLink*> links;
+    iKinChain        chain;
+    iKinIpOptMin    *slv;
+
+    MultiStartLane() : slv(NULL) { }
+
+    ~MultiStartLane()
+    {
+        delete slv;
+        for (auto &l:links)
+            delete l;
+    }
+};
+
+
 /************************************************************************/
 iKinIpOptMin::iKinIpOptMin(iKinChain &c, const unsigned int _ctrlPose, const double tol,
                            const double constr_tol, const int max_iter,
@@ -802,6 +1030,15 @@ iKinIpOptMin::iKinIpOptMin(iKinChain &c, const unsigned int _ctrlPose, const dou
     posePriority="position";
     pLIC=&noLIC;
 
+    warmStartOn=warmStartSet=warmStartValid=warmStartSuspended=false;
+    warmStartMaxPosDist=0.02;
+    warmStartMaxAngDist=0.1;
+    warmStartMaxJntDist=0.2;
+    warmStartCtrlPose=ctrlPose;
+
+    multiStartNum=1;
+    multiStartSeed=0;
+
     if (ctrlPose>IKINCTRL_POSE_ANG)
         ctrlPose=IKINCTRL_POSE_ANG;
 
@@ -825,10 +1062,151 @@ iKinIpOptMin::iKinIpOptMin(iKinChain &c, const unsigned int _ctrlPose, const dou
     if (!useHessian)
         CAST_IPOPTAPP(App)->Options()->SetStringValue("hessian_approximation","limited-memory");
 
+    // keep the warm start point close to the previous solution
+    CAST_IPOPTAPP(App)->Options()->SetNumericValue("warm_start_bound_push",1e-6);
+    CAST_IPOPTAPP(App)->Options()->SetNumericValue("warm_start_mult_bound_push",1e-6);
+
     CAST_IPOPTAPP(App)->Initialize();
 }
 
 
+/************************************************************************/
+void iKinIpOptMin::setWarmStart(const bool sw, const double maxPosDist,
+                                const double maxAngDist, const double maxJntDist)
+{
+    warmStartOn=sw;
+    warmStartMaxPosDist=maxPosDist;
+    warmStartMaxAngDist=maxAngDist;
+    warmStartMaxJntDist=maxJntDist;
+
+    if (!warmStartOn)
+        warmStartValid=false;
+}
+
+
+/************************************************************************/
+void iKinIpOptMin::setMultiStart(const int num, const unsigned int seed)
+{
+    multiStartNum=std::max(num,1);
+    multiStartSeed=seed;
+
+    while ((int)lanes.size()>multiStartNum-1)
+    {
+        delete lanes.back();
+        lanes.pop_back();
+    }
+}
+
+
+/************************************************************************/
+void iKinIpOptMin::syncLane(MultiStartLane *lane)
+{
+    // the lane owns a copy of the links, which is refreshed
+    // at each call to account for blocked joints and limits
+    unsigned int N=chain.getN();
+    if (lane->links.size()!=N)
+    {
+        delete lane->slv;
+        lane->slv=NULL;
+
+        for (auto &l:lane->links)
+            delete l;
+        lane->links.clear();
+
+        for (unsigned int i=0; i<N; i++)
+            lane->links.push_back(new iKinLink(chain[i]));
+    }
+    else for (unsigned int i=0; i<N; i++)
+        *lane->links[i]=chain[i];
+
+    lane->chain.clear();
+    for (unsigned int i=0; i<N; i++)
+        lane->chain<<*lane->links[i];
+    lane->chain.setH0(chain.getH0());
+    lane->chain.setHN(chain.getHN());
+
+    if (lane->slv==NULL)
+        lane->slv=new iKinIpOptMin(lane->chain,ctrlPose,getTol(),getConstrTol(),getMaxIter());
+
+    iKinIpOptMin *slv=lane->slv;
+    *CAST_IPOPTAPP(slv->App)->Options()=*CAST_IPOPTAPP(App)->Options();
+    CAST_IPOPTAPP(slv->App)->Options()->SetStringValue("warm_start_init_point","no");
+    slv->warmStartSet=false;
+
+    slv->ctrlPose=ctrlPose;
+    slv->posePriority=posePriority;
+    slv->obj_scaling=obj_scaling;
+    slv->x_scaling=x_scaling;
+    slv->g_scaling=g_scaling;
+    slv->lowerBoundInf=lowerBoundInf;
+    slv->upperBoundInf=upperBoundInf;
+    slv->pLIC=pLIC;
+    slv->specify2ndTaskEndEff(chain2ndTask.getN());
+}
+
+
+/************************************************************************/
+void iKinIpOptMin::setWarmStartOption(const bool sw)
+{
+    // options are parsed by IpOpt at each optimization,
+    // thus there is no need to call Initialize() again
+    if (sw!=warmStartSet)
+    {
+        CAST_IPOPTAPP(App)->Options()->SetStringValue("warm_start_init_point",sw?"yes":"no");
+        warmStartSet=sw;
+    }
+}
+
+
+/************************************************************************/
+bool iKinIpOptMin::isWarmStartFeasible(const yarp::sig::Vector &q0, const yarp::sig::Vector &xd,
+                                       const int n, const int m) const
+{
+    if (!warmStartOn || warmStartSuspended || !warmStartValid)
+        return false;
+
+    if ((ctrlPose!=warmStartCtrlPose) || (posePriority!=warmStartPosePriority))
+        return false;
+
+    if (((int)warmStart_x.length()!=n) || ((int)warmStart_lambda.length()!=m) ||
+        (warmStart_xd.length()!=xd.length()) || ((int)q0.length()!=n))
+        return false;
+
+    // the caller's starting point must not be discarded
+    // if it is far from where the solver would start
+    for (int i=0; i<n; i++)
+        if (fabs(q0[i]-warmStart_x[i])>warmStartMaxJntDist)
+            return false;
+
+    if (xd.length()>=3)
+    {
+        double dx=xd[0]-warmStart_xd[0];
+        double dy=xd[1]-warmStart_xd[1];
+        double dz=xd[2]-warmStart_xd[2];
+        if (sqrt(dx*dx+dy*dy+dz*dz)>warmStartMaxPosDist)
+            return false;
+    }
+
+    if ((ctrlPose!=IKINCTRL_POSE_XYZ) && (xd.length()>=7))
+    {
+        yarp::sig::Matrix R1=axis2dcm(warmStart_xd.subVector(3,6));
+        yarp::sig::Matrix R2=axis2dcm(xd.subVector(3,6));
+
+        // trace(R1^T*R2)=1+2*cos(theta)
+        double tr=0.0;
+        for (int r=0; r<3; r++)
+            for (int c=0; c<3; c++)
+                tr+=R1(r,c)*R2(r,c);
+
+        double cos_theta=std::min(std::max(0.5*(tr-1.0),-1.0),1.0);
+        if (acos(cos_theta)>warmStartMaxAngDist)
+            return false;
+    }
+
+    return true;
+}
+
+
 /************************************************************************/
 void iKinIpOptMin::set_ctrlPose(const unsigned int _ctrlPose)
 {
@@ -1027,11 +1405,12 @@ void iKinIpOptMin::setBoundsInf(const double lower, const double upper)
 
 
 /************************************************************************/
-yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Vector &xd,
-                                      double weight2ndTask, yarp::sig::Vector &xd_2nd,
-                                      yarp::sig::Vector &w_2nd, double weight3rdTask,
-                                      yarp::sig::Vector &qd_3rd, yarp::sig::Vector &w_3rd,
-                                      int *exit_code, bool *exhalt, iKinIterateCallback *iterate)
+yarp::sig::Vector iKinIpOptMin::solveSingleStart(const yarp::sig::Vector &q0, yarp::sig::Vector &xd,
+                                                 double weight2ndTask, yarp::sig::Vector &xd_2nd,
+                                                 yarp::sig::Vector &w_2nd, double weight3rdTask,
+                                                 yarp::sig::Vector &qd_3rd, yarp::sig::Vector &w_3rd,
+                                                 int *exit_code, bool *exhalt, iKinIterateCallback *iterate,
+                                                 double *obj, double *viol)
 {
     SmartPtr<iKin_NLP> nlp=new iKin_NLP(chain,ctrlPose,q0,xd,
                                         weight2ndTask,chain2ndTask,xd_2nd,w_2nd,
@@ -1043,15 +1422,205 @@ yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Ve
     nlp->set_posePriority(posePriority);
     nlp->set_callback(iterate);
 
+    bool warm=false;
+    if (warmStartOn && !warmStartSuspended)
+    {
+        Index n,m,nnz_jac_g,nnz_h_lag;
+        TNLP::IndexStyleEnum index_style;
+        nlp->get_nlp_info(n,m,nnz_jac_g,nnz_h_lag,index_style);
+
+        if (isWarmStartFeasible(q0,xd,n,m))
+        {
+            nlp->set_warm_start(warmStart_x,warmStart_zL,warmStart_zU,warmStart_lambda);
+            warm=true;
+        }
+    }
+
+    setWarmStartOption(warm);
+
     ApplicationReturnStatus status=CAST_IPOPTAPP(App)->OptimizeTNLP(GetRawPtr(nlp));
 
     if (exit_code!=NULL)
         *exit_code=status;
 
+    if (warmStartOn && !warmStartSuspended)
+    {
+        warmStartValid=(status==Solve_Succeeded) || (status==Solved_To_Acceptable_Level);
+        if (warmStartValid)
+        {
+            warmStart_x=nlp->get_qd();
+            nlp->get_multipliers(warmStart_zL,warmStart_zU,warmStart_lambda);
+            warmStart_xd=xd;
+            warmStartCtrlPose=ctrlPose;
+            warmStartPosePriority=posePriority;
+        }
+    }
+
+    if ((obj!=NULL) && (viol!=NULL))
+        nlp->get_cost(*obj,*viol);
+
     return nlp->get_qd();
 }
 
 
+/************************************************************************/
+yarp::sig::Vector iKinIpOptMin::solveMultiStart(const yarp::sig::Vector &q0, yarp::sig::Vector &xd,
+                                                double weight2ndTask, yarp::sig::Vector &xd_2nd,
+                                                yarp::sig::Vector &w_2nd, double weight3rdTask,
+                                                yarp::sig::Vector &qd_3rd, yarp::sig::Vector &w_3rd,
+                                                int *exit_code, bool *exhalt, iKinIterateCallback *iterate)
+{
+    int num=multiStartNum;
+    while ((int)lanes.size()<num-1)
+        lanes.push_back(new MultiStartLane);
+
+    for (auto &lane:lanes)
+        syncLane(lane);
+
+    // the starting points depend only on the seed and on the
+    // joints limits; the raw output of mt19937 is used to be
+    // independent of the standard library implementation
+    mt19937 gen(multiStartSeed);
+    deque<yarp::sig::Vector> qs(num,q0);
+    for (int k=1; k<num; k++)
+    {
+        qs[k].resize(chain.getDOF());
+        for (unsigned int i=0; i<chain.getDOF(); i++)
+        {
+            double r=gen()/4294967296.0;
+            qs[k][i]=chain(i).getMin()+r*(chain(i).getMax()-chain(i).getMin());
+        }
+    }
+
+    struct Result
+    {
+        yarp::sig::Vector qd;
+        int    exit_code;
+        double obj,viol;
+        Result() : exit_code(Internal_Error), obj(0.0), viol(0.0) { }
+    };
+
+    deque<Result> res(num);
+    atomic<int> winner(num);
+
+    auto converged=[](const int code)
+    {
+        return (code==Solve_Succeeded) || (code==Solved_To_Acceptable_Level);
+    };
+
+    auto claim=[&winner](const int k)
+    {
+        int w=winner.load();
+        while ((k<w) && !winner.compare_exchange_weak(w,k));
+    };
+
+    auto exec=[&](const int k)
+    {
+        yarp::sig::Vector xd_lane=xd;
+        yarp::sig::Vector xd_2nd_lane=xd_2nd;
+        yarp::sig::Vector w_2nd_lane=w_2nd;
+        yarp::sig::Vector qd_3rd_lane=qd_3rd;
+        yarp::sig::Vector w_3rd_lane=w_3rd;
+
+        MultiStartMonitor monitor(winner,exhalt,k);
+        Result &r=res[k];
+        r.qd=lanes[k-1]->slv->solveSingleStart(qs[k],xd_lane,
+                                               weight2ndTask,xd_2nd_lane,w_2nd_lane,
+                                               weight3rdTask,qd_3rd_lane,w_3rd_lane,
+                                               &r.exit_code,&monitor.halt,&monitor,
+                                               &r.obj,&r.viol);
+        if (converged(r.exit_code))
+            claim(k);
+    };
+
+    // the starts run in parallel only if IPOPT is reentrant
+    const bool parallel=isReentrant();
+    deque<thread> workers;
+    if (parallel)
+        for (int k=1; k<num; k++)
+            workers.push_back(thread(exec,k));
+
+    Result &r0=res[0];
+    r0.qd=solveSingleStart(q0,xd,weight2ndTask,xd_2nd,w_2nd,
+                           weight3rdTask,qd_3rd,w_3rd,
+                           &r0.exit_code,exhalt,iterate,&r0.obj,&r0.viol);
+    if (converged(r0.exit_code))
+        claim(0);
+
+    if (parallel)
+    {
+        for (auto &w:workers)
+            w.join();
+    }
+    else for (int k=1; (k<num) && (winner.load()>k); k++)
+        exec(k);    // once a start converges, the next ones cannot be selected
+
+    // pick the converged start with the lowest index, or
+    // the least violating and then the cheapest otherwise
+    int sel=winner.load();
+    if (sel>=num)
+    {
+        double constr_tol=getConstrTol();
+        sel=0;
+        for (int k=1; k<num; k++)
+        {
+            bool feasible_k=(res[k].viol<=constr_tol);
+            bool feasible_sel=(res[sel].viol<=constr_tol);
+            if (feasible_k!=feasible_sel)
+            {
+                if (feasible_k)
+                    sel=k;
+            }
+            else if (feasible_k ? (res[k].obj<res[sel].obj) : (res[k].viol<res[sel].viol))
+                sel=k;
+        }
+    }
+
+    if (exit_code!=NULL)
+        *exit_code=res[sel].exit_code;
+
+    // the warm start data refer to the start from q0
+    if (sel>0)
+    {
+        res[sel].qd=chain.setAng(res[sel].qd);
+        if (!warmStartSuspended)
+            warmStartValid=false;
+    }
+
+    return res[sel].qd;
+}
+
+
+/************************************************************************/
+bool iKinIpOptMin::isReentrant()
+{
+#if defined(IPOPT_VERSION_MAJOR) && defined(IPOPT_VERSION_MINOR) && \
+    ((IPOPT_VERSION_MAJOR>3) || ((IPOPT_VERSION_MAJOR==3) && (IPOPT_VERSION_MINOR>=14)))
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+/************************************************************************/
+yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Vector &xd,
+                                      double weight2ndTask, yarp::sig::Vector &xd_2nd,
+                                      yarp::sig::Vector &w_2nd, double weight3rdTask,
+                                      yarp::sig::Vector &qd_3rd, yarp::sig::Vector &w_3rd,
+                                      int *exit_code, bool *exhalt, iKinIterateCallback *iterate)
+{
+    if (multiStartNum>1)
+        return solveMultiStart(q0,xd,weight2ndTask,xd_2nd,w_2nd,
+                               weight3rdTask,qd_3rd,w_3rd,
+                               exit_code,exhalt,iterate);
+    else
+        return solveSingleStart(q0,xd,weight2ndTask,xd_2nd,w_2nd,
+                                weight3rdTask,qd_3rd,w_3rd,
+                                exit_code,exhalt,iterate,NULL,NULL);
+}
+
+
 /************************************************************************/
 yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Vector &xd,
                                       double weight2ndTask, yarp::sig::Vector &xd_2nd,
@@ -1073,6 +1642,9 @@ yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Ve
 /************************************************************************/
 iKinIpOptMin::~iKinIpOptMin()
 {
+    for (auto &lane:lanes)
+        delete lane;
+
     delete CAST_IPOPTAPP(App);
 }
 
@@ -0,0 +1,474 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <algorithm>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+#include <yarp/os/Log.h>
+#include <yarp/sig/Matrix.h>
+
+#include <iCub/iKin/iKinBatch.h>
+#include <iCub/iKin/iKinReachMap.h>
+
+using namespace std;
+using namespace yarp::sig;
+using namespace iCub::iKin;
+
+namespace
+{
+    constexpr char     IKINREACHMAP_MAGIC[8]="IKREACH";
+    constexpr uint32_t IKINREACHMAP_VERSION=1;
+    constexpr uint32_t IKINREACHMAP_ENDIANNESS=0x01020304;
+
+    // number of samples evaluated in one go
+    constexpr size_t IKINREACHMAP_BLOCK=4096;
+
+    constexpr uint8_t IKINREACHMAP_HIT=0x01;
+    constexpr uint8_t IKINREACHMAP_NEAR=0x02;
+
+    /************************************************************************/
+    inline uint64_t align8(const uint64_t n)
+    {
+        return (n+7)&~(uint64_t)7;
+    }
+
+    /************************************************************************/
+    // checks that an array of num elements of the given size starting
+    // at offs lies past the header, aligned and within the buffer,
+    // in a way that cannot overflow
+    bool fitsIn(const uint64_t offs, const uint64_t num, const uint64_t size,
+                const uint64_t length, const uint64_t headerSize)
+    {
+        return (offs>=headerSize) && ((offs&3)==0) && (offs<=length) &&
+               (size>0) && (num<=(length-offs)/size);
+    }
+
+    /************************************************************************/
+    // the raw output of mt19937 is used in place of the standard
+    // distributions to get the same samples on any platform
+    void fillSamples(mt19937 &gen, const Vector &qMin, const Vector &qMax,
+                     Matrix &Q)
+    {
+        for (size_t k=0; k<Q.cols(); k++)
+            for (size_t i=0; i<Q.rows(); i++)
+                Q(i,k)=qMin[i]+(gen()/4294967296.0)*(qMax[i]-qMin[i]);
+    }
+}
+
+
+/************************************************************************/
+iKinReachMap::iKinReachMap() : mapped(nullptr), mappedLength(0),
+                               header(nullptr), flags(nullptr),
+                               hits(nullptr), manip(nullptr),
+                               seeds(nullptr)
+{
+}
+
+
+/************************************************************************/
+void iKinReachMap::unload()
+{
+#ifndef _WIN32
+    if (mapped!=nullptr)
+        munmap(mapped,mappedLength);
+#endif
+
+    mapped=nullptr;
+    mappedLength=0;
+    storage.clear();
+
+    header=nullptr;
+    flags=nullptr;
+    hits=nullptr;
+    manip=nullptr;
+    seeds=nullptr;
+}
+
+
+/************************************************************************/
+bool iKinReachMap::attach(const void *buf, const size_t length)
+{
+    if (length<sizeof(Header))
+        return false;
+
+    const Header *h=static_cast<const Header*>(buf);
+    if ((memcmp(h->magic,IKINREACHMAP_MAGIC,sizeof(h->magic))!=0) ||
+        (h->version!=IKINREACHMAP_VERSION) ||
+        (h->endianness!=IKINREACHMAP_ENDIANNESS) ||
+        (h->length!=length) || !(h->resolution>0.0))
+        return false;
+
+    uint64_t nVox=(uint64_t)h->size[0]*h->size[1];
+    if ((h->size[2]!=0) && (nVox>numeric_limits<uint64_t>::max()/h->size[2]))
+        return false;
+    nVox*=h->size[2];
+
+    if (!fitsIn(h->offsFlags,nVox,sizeof(uint8_t),length,sizeof(Header)) ||
+        !fitsIn(h->offsHits,nVox,sizeof(uint32_t),length,sizeof(Header)) ||
+        !fitsIn(h->offsManip,nVox,sizeof(float),length,sizeof(Header)) ||
+        !fitsIn(h->offsSeeds,nVox,(uint64_t)h->dof*sizeof(float),length,sizeof(Header)))
+        return false;
+
+    const uint8_t *base=static_cast<const uint8_t*>(buf);
+    header=h;
+    flags=base+h->offsFlags;
+    hits=reinterpret_cast<const uint32_t*>(base+h->offsHits);
+    manip=reinterpret_cast<const float*>(base+h->offsManip);
+    seeds=reinterpret_cast<const float*>(base+h->offsSeeds);
+
+    return true;
+}
+
+
+/************************************************************************/
+bool iKinReachMap::build(iKinChain &chain, const double resolution,
+                         const size_t numSamples, const unsigned int seed,
+                         const unsigned int numThreads)
+{
+    unsigned int dof=chain.getDOF();
+    if ((dof==0) || !(resolution>0.0) || (numSamples==0))
+    {
+        yError("iKinReachMap: wrong build parameters (dof=%d, resolution=%g, samples=%d)",
+               dof,resolution,(int)numSamples);
+        return false;
+    }
+
+    unload();
+
+    Vector qMin(dof),qMax(dof);
+    for (unsigned int i=0; i<dof; i++)
+    {
+        qMin[i]=chain(i).getMin();
+        qMax[i]=chain(i).getMax();
+    }
+
+    iKinBatch batch(chain,numThreads);
+    Matrix Q,X,J;
+
+    // first pass: bounding box of the end-effector positions
+    mt19937 gen(seed);
+    double lo[3],hi[3];
+    for (int a=0; a<3; a++)
+    {
+        lo[a]=std::numeric_limits<double>::max();
+        hi[a]=-std::numeric_limits<double>::max();
+    }
+
+    for (size_t k0=0; k0<numSamples; k0+=IKINREACHMAP_BLOCK)
+    {
+        Q.resize(dof,std::min(IKINREACHMAP_BLOCK,numSamples-k0));
+        fillSamples(gen,qMin,qMax,Q);
+        batch.EndEffPose(Q,X,false);
+        for (size_t k=0; k<X.cols(); k++)
+        {
+            for (int a=0; a<3; a++)
+            {
+                lo[a]=std::min(lo[a],X(a,k));
+                hi[a]=std::max(hi[a],X(a,k));
+            }
+        }
+    }
+
+    // leave one empty voxel on each side for the neighbours flags
+    Header h;
+    memset(&h,0,sizeof(h));
+    memcpy(h.magic,IKINREACHMAP_MAGIC,sizeof(h.magic));
+    h.version=IKINREACHMAP_VERSION;
+    h.endianness=IKINREACHMAP_ENDIANNESS;
+    h.dof=dof;
+    h.numSamples=numSamples;
+    h.resolution=resolution;
+    for (int a=0; a<3; a++)
+    {
+        h.origin[a]=lo[a]-resolution;
+        h.size[a]=(uint32_t)floor((hi[a]-lo[a])/resolution)+3;
+    }
+
+    uint64_t nVox=(uint64_t)h.size[0]*h.size[1]*h.size[2];
+    h.offsFlags=align8(sizeof(Header));
+    h.offsHits=align8(h.offsFlags+nVox);
+    h.offsManip=align8(h.offsHits+nVox*sizeof(uint32_t));
+    h.offsSeeds=align8(h.offsManip+nVox*sizeof(float));
+    h.length=align8(h.offsSeeds+nVox*dof*sizeof(float));
+
+    storage.assign(h.length/sizeof(uint64_t),0);
+    uint8_t *base=reinterpret_cast<uint8_t*>(storage.data());
+    memcpy(base,&h,sizeof(h));
+
+    uint8_t  *_flags=base+h.offsFlags;
+    uint32_t *_hits=reinterpret_cast<uint32_t*>(base+h.offsHits);
+    float    *_manip=reinterpret_cast<float*>(base+h.offsManip);
+    float    *_seeds=reinterpret_cast<float*>(base+h.offsSeeds);
+
+    // second pass: same samples, now with the Jacobians
+    gen.seed(seed);
+    for (size_t k0=0; k0<numSamples; k0+=IKINREACHMAP_BLOCK)
+    {
+        Q.resize(dof,std::min(IKINREACHMAP_BLOCK,numSamples-k0));
+        fillSamples(gen,qMin,qMax,Q);
+        batch.EndEffPoseAndJacobian(Q,X,J,false);
+        for (size_t k=0; k<X.cols(); k++)
+        {
+            size_t idx=0;
+            for (int a=2; a>=0; a--)
+            {
+                size_t i=(size_t)floor((X(a,k)-h.origin[a])/resolution);
+                idx=idx*h.size[a]+std::min(i,(size_t)h.size[a]-1);
+            }
+
+            // manipulability of the translational part
+            double JJt[3][3];
+            for (unsigned int r=0; r<3; r++)
+            {
+                for (unsigned int c=r; c<3; c++)
+                {
+                    double s=0.0;
+                    for (unsigned int j=0; j<dof; j++)
+                        s+=J(r*dof+j,k)*J(c*dof+j,k);
+                    JJt[r][c]=JJt[c][r]=s;
+                }
+            }
+
+            double det=JJt[0][0]*(JJt[1][1]*JJt[2][2]-JJt[1][2]*JJt[2][1])-
+                       JJt[0][1]*(JJt[1][0]*JJt[2][2]-JJt[1][2]*JJt[2][0])+
+                       JJt[0][2]*(JJt[1][0]*JJt[2][1]-JJt[1][1]*JJt[2][0]);
+            float m=(float)sqrt(std::max(det,0.0));
+
+            if ((_hits[idx]==0) || (m>_manip[idx]))
+            {
+                _manip[idx]=m;
+                for (unsigned int j=0; j<dof; j++)
+                    _seeds[idx*dof+j]=(float)Q(j,k);
+            }
+
+            if (_hits[idx]<std::numeric_limits<uint32_t>::max())
+                _hits[idx]++;
+        }
+    }
+
+    // flag the voxels hit and their neighbours
+    for (uint32_t z=0; z<h.size[2]; z++)
+    {
+        for (uint32_t y=0; y<h.size[1]; y++)
+        {
+            for (uint32_t x=0; x<h.size[0]; x++)
+            {
+                size_t idx=((size_t)z*h.size[1]+y)*h.size[0]+x;
+                if (_hits[idx]==0)
+                    continue;
+
+                _flags[idx]|=IKINREACHMAP_HIT;
+                for (uint32_t zz=std::max(z,1u)-1; zz<=std::min(z+1,h.size[2]-1); zz++)
+                    for (uint32_t yy=std::max(y,1u)-1; yy<=std::min(y+1,h.size[1]-1); yy++)
+                        for (uint32_t xx=std::max(x,1u)-1; xx<=std::min(x+1,h.size[0]-1); xx++)
+                            _flags[((size_t)zz*h.size[1]+yy)*h.size[0]+xx]|=IKINREACHMAP_NEAR;
+            }
+        }
+    }
+
+    return attach(base,h.length);
+}
+
+
+/************************************************************************/
+bool iKinReachMap::save(const string &fileName) const
+{
+    if (header==nullptr)
+    {
+        yError("iKinReachMap: no map to save");
+        return false;
+    }
+
+    FILE *fout=fopen(fileName.c_str(),"wb");
+    if (fout==nullptr)
+    {
+        yError("iKinReachMap: unable to open %s for writing",fileName.c_str());
+        return false;
+    }
+
+    bool ret=(fwrite(header,1,header->length,fout)==header->length);
+    ret&=(fclose(fout)==0);
+    if (!ret)
+        yError("iKinReachMap: unable to write %s",fileName.c_str());
+
+    return ret;
+}
+
+
+/************************************************************************/
+bool iKinReachMap::load(const string &fileName)
+{
+    unload();
+
+#ifndef _WIN32
+    int fd=open(fileName.c_str(),O_RDONLY);
+    if (fd<0)
+    {
+        yError("iKinReachMap: unable to open %s",fileName.c_str());
+        return false;
+    }
+
+    struct stat st;
+    if ((fstat(fd,&st)==0) && (st.st_size>0))
+    {
+        void *buf=mmap(nullptr,(size_t)st.st_size,PROT_READ,MAP_SHARED,fd,0);
+        if (buf!=MAP_FAILED)
+        {
+            mapped=buf;
+            mappedLength=(size_t)st.st_size;
+        }
+    }
+    close(fd);
+
+    bool ok=(mapped!=nullptr) && attach(mapped,mappedLength);
+#else
+    FILE *fin=fopen(fileName.c_str(),"rb");
+    if (fin==nullptr)
+    {
+        yError("iKinReachMap: unable to open %s",fileName.c_str());
+        return false;
+    }
+
+    fseek(fin,0,SEEK_END);
+    long length=ftell(fin);
+    fseek(fin,0,SEEK_SET);
+
+    bool ok=false;
+    if (length>0)
+    {
+        storage.resize(((size_t)length+sizeof(uint64_t)-1)/sizeof(uint64_t));
+        ok=(fread(storage.data(),1,(size_t)length,fin)==(size_t)length);
+    }
+    fclose(fin);
+
+    ok=ok && attach(storage.data(),(size_t)length);
+#endif
+
+    if (!ok)
+    {
+        yError("iKinReachMap: %s is not a valid map",fileName.c_str());
+        unload();
+        return false;
+    }
+
+    return true;
+}
+
+
+/************************************************************************/
+unsigned int iKinReachMap::getDOF() const
+{
+    return (header!=nullptr) ? header->dof : 0;
+}
+
+
+/************************************************************************/
+double iKinReachMap::getResolution() const
+{
+    return (header!=nullptr) ? header->resolution : 0.0;
+}
+
+
+/************************************************************************/
+bool iKinReachMap::getBoundingBox(Vector &lower, Vector &upper) const
+{
+    if (header==nullptr)
+        return false;
+
+    lower.resize(3);
+    upper.resize(3);
+    for (int a=0; a<3; a++)
+    {
+        lower[a]=header->origin[a];
+        upper[a]=header->origin[a]+header->size[a]*header->resolution;
+    }
+
+    return true;
+}
+
+
+/************************************************************************/
+bool iKinReachMap::getIndex(const Vector &x, size_t &idx) const
+{
+    if ((header==nullptr) || (x.length()<3))
+        return false;
+
+    idx=0;
+    for (int a=2; a>=0; a--)
+    {
+        double i=floor((x[a]-header->origin[a])/header->resolution);
+        if (!(i>=0.0) || (i>=header->size[a]))
+            return false;
+
+        idx=idx*header->size[a]+(size_t)i;
+    }
+
+    return true;
+}
+
+
+/************************************************************************/
+bool iKinReachMap::isReachable(const Vector &x, const bool conservative) const
+{
+    size_t idx;
+    if (!getIndex(x,idx))
+        return false;
+
+    return ((flags[idx]&(conservative?IKINREACHMAP_NEAR:IKINREACHMAP_HIT))!=0);
+}
+
+
+/************************************************************************/
+double iKinReachMap::getManipulability(const Vector &x) const
+{
+    size_t idx;
+    if (!getIndex(x,idx) || (hits[idx]==0))
+        return 0.0;
+
+    return manip[idx];
+}
+
+
+/************************************************************************/
+bool iKinReachMap::getSeed(const Vector &x, Vector &q) const
+{
+    size_t idx;
+    if (!getIndex(x,idx) || (hits[idx]==0))
+        return false;
+
+    unsigned int dof=header->dof;
+    if (q.length()!=dof)
+        q.resize(dof);
+
+    const float *s=&seeds[idx*dof];
+    for (unsigned int j=0; j<dof; j++)
+        q[j]=s[j];
+
+    return true;
+}
+
+
+/************************************************************************/
+iKinReachMap::~iKinReachMap()
+{
+    unload();
+}
+
+
@@ -11,6 +11,8 @@
 #include <cstdlib>
 #include <cmath>
 #include <algorithm>
+#include <thread>
+#include <chrono>
 
 #include <yarp/os/LogStream.h>
 #include <yarp/os/Network.h>
@@ -26,6 +28,7 @@
 #define CARTSLV_WEIGHT_2ND_TASK             0.01
 #define CARTSLV_WEIGHT_3RD_TASK             0.01
 #define CARTSLV_UNCTRLEDJNTS_THRES          1.0     // [deg]
+#define CARTSLV_DEFAULT_BATCH_THREADS       4
 
 using namespace std;
 using namespace yarp::os;
@@ -56,6 +59,60 @@ bool RpcProcessor::read(ConnectionReader &connection)
 }
 
 
+/************************************************************************/
+BottleMailbox::BottleMailbox() : middle(1), back(0), front(2)
+{
+}
+
+
+/************************************************************************/
+Bottle &BottleMailbox::prepare()
+{
+    buf[back].clear();
+    return buf[back];
+}
+
+
+/************************************************************************/
+void BottleMailbox::post()
+{
+    // swap the back buffer with the middle one,
+    // flagging the latter as new (bit 2)
+    back=middle.exchange(back|4)&3;
+
+    // the mutex only avoids missing the wake-up
+    // of a reader that is about to wait
+    {
+        lock_guard<mutex> lck(mtx);
+    }
+    cv.notify_one();
+}
+
+
+/************************************************************************/
+Bottle *BottleMailbox::take()
+{
+    if ((middle.load()&4)==0)
+        return NULL;
+
+    front=middle.exchange(front)&3;
+    return &buf[front];
+}
+
+
+/************************************************************************/
+Bottle *BottleMailbox::wait(const double timeout)
+{
+    {
+        unique_lock<mutex> lck(mtx);
+        cv.wait_for(lck,chrono::duration<double>(timeout),
+                    [this](){ return (middle.load()&4)!=0; });
+    }
+
+    return take();
+}
+
+
 /************************************************************************/
 InputPort::InputPort(CartesianSolver *_slv)
 {
@@ -278,12 +335,14 @@ CartesianSolver::CartesianSolver(const string &_slvName) :
     maxPartJoints=0;
     unctrlJointsNum=0;
     ping_robot_tmo=0.0;
+    batchThreads=CARTSLV_DEFAULT_BATCH_THREADS;
 
     prt=NULL;
     slv=NULL;
     clb=NULL;
     inPort=NULL;
     outPort=NULL;
+    inbox=outbox=NULL;
 
     // open rpc port
     rpcPort=new Port;
@@ -940,6 +999,13 @@ void CartesianSolver::respond(const Bottle &command, Bottle &reply)
             {
                 Bottle *b_xd=getTargetOption(command);
                 Bottle *b_q=getJointsOption(command);
+
+                // a list of targets is served in batch
+                if ((b_xd!=NULL) && (b_xd->size()>0) && b_xd->get(0).isList())
+                {
+                    askBatch(command,reply);
+                    break;
+                }
             
                 // some integrity checks
                 if (b_xd==NULL)
@@ -989,7 +1055,7 @@ void CartesianSolver::respond(const Bottle &command, Bottle &reply)
             
                 // call the solver to converge
                 double t0=Time::now();
-                Vector q=solve(xd);
+                Vector q=solve(xd,b_q!=NULL);
                 double t1=Time::now();
             
                 Vector x=prt->chn->EndEffPose(q);
@@ -1122,11 +1188,164 @@ void CartesianSolver::respond(const Bottle &command, Bottle &reply)
 }
 
 
+/************************************************************************/
+void CartesianSolver::askBatch(const Bottle &command, Bottle &reply)
+{
+    Bottle *b_xd=getTargetOption(command);
+    Bottle *b_q=getJointsOption(command);
+
+    size_t num=b_xd->size();
+    if ((b_q!=NULL) && (b_q->size()!=num))
+    {
+        reply.addVocab32(IKINSLV_VOCAB_REP_NACK);
+        return;
+    }
+
+    // get the targets and the seeds
+    deque<Vector> xd(num), q0;
+    for (size_t k=0; k<num; k++)
+    {
+        Bottle *b=b_xd->get(k).asList();
+        if ((b==NULL) || (b->size()<3))     // at least the positional part must be given
+        {
+            reply.addVocab32(IKINSLV_VOCAB_REP_NACK);
+            return;
+        }
+
+        xd[k].resize(b->size());
+        for (size_t i=0; i<xd[k].length(); i++)
+            xd[k][i]=b->get(i).asFloat64();
+
+        if (b_q!=NULL)
+        {
+            Bottle *bq=b_q->get(k).asList();
+            if (bq==NULL)
+            {
+                reply.addVocab32(IKINSLV_VOCAB_REP_NACK);
+                return;
+            }
+
+            Vector q(bq->size());
+            for (size_t i=0; i<q.length(); i++)
+                q[i]=CTRL_DEG2RAD*bq->get(i).asFloat64();
+            q0.push_back(q);
+        }
+    }
+
+    // take a snapshot of the current settings, so that the
+    // main loop is held only for the time of the copy; if IPOPT
+    // is not reentrant, the lock is kept during the solve instead
+    // in order not to run concurrently with the solver in run()
+    bool reentrant=iKinIpOptMin::isReentrant();
+    lock();
+
+    if (b_q==NULL)
+        getFeedback();
+
+    iKinLimb limb(*prt->lmb);
+    iKinLinIneqConstr lic(slv->getLIC());
+    unsigned int pose=slv->get_ctrlPose();
+    string posePriority=slv->get_posePriority();
+    double tol=slv->getTol();
+    double constr_tol=slv->getConstrTol();
+    int maxIter=slv->getMaxIter();
+    unsigned int n2ndTask=slv->get2ndTaskChain().getN();
+    Vector xd_2nd=xd_2ndTask;
+    Vector w_2nd=w_2ndTask;
+    Vector w_3rd=w_3rdTask;
+    Vector idx_3rd=idx_3rdTask;
+
+    if (reentrant)
+        unlock();
+
+    if (command.check(Vocab32::decode(IKINSLV_VOCAB_OPT_POSE)))
+    {
+        int p=command.find(Vocab32::decode(IKINSLV_VOCAB_OPT_POSE)).asVocab32();
+
+        if (p==IKINSLV_VOCAB_VAL_POSE_FULL)
+            pose=IKINCTRL_POSE_FULL;
+        else if (p==IKINSLV_VOCAB_VAL_POSE_XYZ)
+            pose=IKINCTRL_POSE_XYZ;
+    }
+
+    // each lane owns a copy of the limb and of the optimizer,
+    // and solves the targets k=lane, lane+nLanes, ...
+    deque<Vector> x(num), q(num);
+    auto exec=[&](const size_t lane, const size_t nLanes)
+    {
+        iKinLimb lmb(limb);
+        iKinChain &chn=*lmb.asChain();
+        iKinLinIneqConstr cns(lic);
+
+        iKinIpOptMin opt(chn,pose,tol,constr_tol,maxIter);
+        opt.setUserScaling(true,100.0,100.0,100.0);
+        opt.set_posePriority(posePriority);
+        opt.attachLIC(cns);
+        opt.specify2ndTaskEndEff(n2ndTask);
+
+        Vector xd_2nd_lane=xd_2nd;
+        Vector w_2nd_lane=w_2nd;
+        Vector w_3rd_lane=w_3rd;
+        Vector qInit=chn.getAng();
+        Vector qd_3rd(chn.getDOF(),0.0);
+        for (size_t k=lane; k<num; k+=nLanes)
+        {
+            if (q0.empty())
+                chn.setAng(qInit);
+            else
+            {
+                size_t len=std::min(q0[k].length(),(size_t)chn.getDOF());
+                for (unsigned int i=0; i<len; i++)
+                    chn(i).setAng(q0[k][i]);
+            }
+
+            // set things for the 3rd task
+            for (unsigned int i=0; i<chn.getDOF(); i++)
+                if (idx_3rd[i]!=0.0)
+                    qd_3rd[i]=chn(i).getAng();
+
+            Vector qd=opt.solve(chn.getAng(),xd[k],
+                                n2ndTask>0?CARTSLV_WEIGHT_2ND_TASK:0.0,xd_2nd_lane,w_2nd_lane,
+                                CARTSLV_WEIGHT_3RD_TASK,qd_3rd,w_3rd_lane);
+
+            x[k]=chn.EndEffPose(qd);
+
+            q[k].resize(chn.getN());
+            for (unsigned int i=0; i<chn.getN(); i++)
+                q[k][i]=CTRL_RAD2DEG*chn.getAng(i);
+        }
+    };
+
+    double t0=Time::now();
+
+    size_t nLanes=std::min((size_t)batchThreads,num);
+    deque<thread> workers;
+    for (size_t lane=1; lane<nLanes; lane++)
+        workers.push_back(thread(exec,lane,nLanes));
+
+    exec(0,nLanes);
+    for (auto &w:workers)
+        w.join();
+
+    if (!reentrant)
+        unlock();
+
+    if (verbosity)
+        yInfo("%s: batch of %d targets solved in %g [s] by %d threads",
+              slvName.c_str(),(int)num,Time::now()-t0,(int)nLanes);
+
+    // fill the reply accordingly
+    reply.addVocab32(IKINSLV_VOCAB_REP_ACK);
+    addVectorsOption(reply,IKINSLV_VOCAB_OPT_X,x);
+    addVectorsOption(reply,IKINSLV_VOCAB_OPT_Q,q);
+}
+
+
 /************************************************************************/
 void CartesianSolver::send(const Vector &xd, const Vector &x, const Vector &q,
                            double *tok)
 {       
-    Bottle &b=outPort->prepare();
+    Bottle &b=(outbox!=NULL)?outbox->prepare():outPort->prepare();
     b.clear();
 
     addVectorOption(b,IKINSLV_VOCAB_OPT_XD,xd);
@@ -1136,7 +1355,10 @@ void CartesianSolver::send(const Vector &xd, const Vector &x, const Vector &q,
     if (tok!=NULL)
         addTokenOption(b,*tok);
 
-    outPort->writeStrict();
+    if (outbox!=NULL)
+        outbox->post();
+    else
+        outPort->writeStrict();
 }
 
 
@@ -1282,6 +1504,10 @@ bool CartesianSolver::open(Searchable &options)
         return false;
     }
 
+    // the chain is queried only while holding the lock,
+    // hence it can cache the transformations across the solves
+    prt->chn->setCaching(true);
+
     Property DHTable; prt->lmb->toLinksProperties(DHTable);
     yInfo()<<"DH Table: "<<DHTable.toString();  // stream version to prevent long strings truncation
     
@@ -1394,6 +1620,13 @@ bool CartesianSolver::open(Searchable &options)
     double tol=options.check("tol",Value(CARTSLV_DEFAULT_TOL)).asFloat64();
     double constr_tol=options.check("constr_tol",Value(CARTSLV_DEFAULT_CONSTR_TOL)).asFloat64();
     int maxIter=options.check("maxIter",Value(CARTSLV_DEFAULT_MAXITER)).asInt32();
+    batchThreads=std::max(1,options.check("batchThreads",Value(CARTSLV_DEFAULT_BATCH_THREADS)).asInt32());
+    if ((batchThreads>1) && !iKinIpOptMin::isReentrant())
+    {
+        yWarning("%s: IPOPT is not reentrant (version < 3.14), batches are solved by one thread",
+                 slvName.c_str());
+        batchThreads=1;
+    }
 
     // instantiate the optimizer
     slv=new iKinIpOptMin(*prt->chn,ctrlPose,tol,constr_tol,maxIter);
@@ -1406,6 +1639,11 @@ bool CartesianSolver::open(Searchable &options)
     // enable scaling
     slv->setUserScaling(true,100.0,100.0,100.0);
 
+    // multi-start mode, if required
+    int multiStart=options.check("multiStart",Value(1)).asInt32();
+    int multiStartSeed=options.check("multiStartSeed",Value(0)).asInt32();
+    slv->setMultiStart(multiStart,(unsigned int)multiStartSeed);
+
     // enforce linear inequalities constraints, if any
     if (prt->cns!=NULL)
     {
@@ -1447,13 +1685,23 @@ bool CartesianSolver::open(Searchable &options)
     // open ports as very last thing, so that
     // the solver is completely operative
     // when it becomes yarp-visible
-    inPort->open("/"+slvName+"/in");
-    outPort->open("/"+slvName+"/out");
+    if (inbox==NULL)
+        inPort->open("/"+slvName+"/in");
+    if (outbox==NULL)
+        outPort->open("/"+slvName+"/out");
 
     return true;
 }
 
 
+/************************************************************************/
+void CartesianSolver::setMailboxes(BottleMailbox *_inbox, BottleMailbox *_outbox)
+{
+    inbox=_inbox;
+    outbox=_outbox;
+}
+
+
 /************************************************************************/
 bool CartesianSolver::changeDOF(const Vector &_dof)
 {
@@ -1512,12 +1760,24 @@ void CartesianSolver::prepareJointsRestTask()
 
 
 /************************************************************************/
-Vector CartesianSolver::solve(Vector &xd)
+Vector CartesianSolver::solve(Vector &xd, const bool seeded)
 {
-    return slv->solve(prt->chn->getAng(),xd,
-                      slv->get2ndTaskChain().getN()>0?CARTSLV_WEIGHT_2ND_TASK:0.0,xd_2ndTask,w_2ndTask,
-                      CARTSLV_WEIGHT_3RD_TASK,qd_3rdTask,w_3rdTask,
-                      NULL,NULL,clb);
+    // in continuous mode the target moves little between
+    // two consecutive requests, hence warm start the solver
+    if (slv->getWarmStart()!=inPort->get_contMode())
+        slv->setWarmStart(inPort->get_contMode());
+
+    // a starting point given explicitly with the request is
+    // honored and does not replace the warm start data
+    slv->suspendWarmStart(seeded);
+
+    Vector q=slv->solve(prt->chn->getAng(),xd,
+                        slv->get2ndTaskChain().getN()>0?CARTSLV_WEIGHT_2ND_TASK:0.0,xd_2ndTask,w_2ndTask,
+                        CARTSLV_WEIGHT_3RD_TASK,qd_3rdTask,w_3rdTask,
+                        NULL,NULL,clb);
+
+    slv->suspendWarmStart(false);
+    return q;
 }
 
 
@@ -1643,6 +1903,12 @@ void CartesianSolver::resume()
 /************************************************************************/
 void CartesianSolver::run()
 {
+    // in-process requests are served as soon as they
+    // arrive, otherwise the loop goes on at its pace
+    if (inbox!=NULL)
+        if (Bottle *b=inbox->wait(getPeriod()))
+            inPort->onRead(*b);
+
     lock();
 
     // init conditions
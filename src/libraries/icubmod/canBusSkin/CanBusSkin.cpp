@@ -23,6 +23,8 @@ const int CAN_DRIVER_BUFFER_SIZE = 2047;
 
 #define SKIN_DEBUG 0
 
+#define STATS_REPORT_PERIOD             10.0    // [s]
+
 using namespace std;
 using namespace iCub::skin::diagnostics;
 using yarp::os::Bottle;
@@ -33,8 +35,13 @@ using yarp::dev::CanMessage;
 
 CanBusSkin::CanBusSkin() :  PeriodicThread(0.02),
                             _verbose(false),
-                            _isDiagnosticPresent(false)
-{ }
+                            _isDiagnosticPresent(false),
+                            _statsMaxDecodeTime(0.0),
+                            _statsCycles(0),
+                            _statsLastReport(0.0)
+{
+    _statsSum = SkinDecodeStats();
+}
 
 
 bool CanBusSkin::open(yarp::os::Searchable& config)
@@ -90,6 +97,11 @@ bool CanBusSkin::open(yarp::os::Searchable& config)
     data.resize(sensorsNum);
     data.zero();
 
+    if (!decoder.setBoards(cardId, netID))
+    {
+        yWarning() << "Skin on can bus " << _canBusNum << ": skinCanIds contains repeated or invalid board addresses, their messages are decoded only in the first slot";
+    }
+
     Property prop;
     prop.put("device", config.find("canbusDevice").asString().c_str());
     prop.put("physDevice", config.find("physDevice").asString().c_str());
@@ -588,6 +600,7 @@ bool CanBusSkin::threadInit() {
 //    } else {
 //        return false;
 //    }
+    _statsLastReport = yarp::os::Time::now();
     return true;
 }
 
@@ -604,96 +617,18 @@ void CanBusSkin::run() {
     } 
     else 
     {
-        // Allocate error vector
-        errors.resize(canMessages);
-
-        for (unsigned int i = 0; i < canMessages; i++) {
-
-            CanMessage &msg = inBuffer[i];
-
-            unsigned int msgid = msg.getId();
-            unsigned int id = (msgid & 0x00F0) >> 4;
-            unsigned int sensorId = (msgid & 0x000F);
-            unsigned int msgType = (int) msg.getData()[0];
-            int len = msg.getLen();
-
-#if 0
-            cout << "DEBUG: CanBusSkin: Board ID (" << id <<"): Sensor ID (" << sensorId << "): " 
-                << "Message type (" << std::uppercase << std::showbase << std::hex << (int) msg.getData()[0] << ") " 
-                << std::nouppercase << std::noshowbase << std::dec << " Length (" << len << "): ";
-            cout << "Content: " << std::uppercase << std::showbase << std::hex;
-            for (int k = 0; k < len; ++k) {
-                cout << (int) msg.getData()[k] << " ";
-            }
-            cout << "\n" << std::nouppercase << std::noshowbase << std::dec;
-#endif
-
-            for (size_t j = 0; j < cardId.size(); j++) {
-                if (id == cardId[j]) {
-                    int index = 16*12*j + sensorId*12;
-                    
-                    if (msgType == 0x40) {
-                        // Message head
-                        for(int k = 0; k < 7; k++) {
-                            data[index + k] = msg.getData()[k + 1];
-                        }
-                    } else if (msgType == 0xC0) {
-                        // Message tail
-                        for(int k = 0; k < 5; k++) {
-                            data[index + k + 7] = msg.getData()[k + 1];
-                        }
-
-                        // Skin diagnostics
-                        if (_brdCfg.useDiagnostic)  // if user requests to check the diagnostic
-                        {
-                            if (len == 8)   // firmware is sending diagnostic info
-                            {
-                                _isDiagnosticPresent = true;
-
-                                // Get error code head and tail
-                                short head = msg.getData()[6];
-                                short tail = msg.getData()[7];
-                                int fullMsg = (head << 8) | (tail & 0xFF);
-
-                                // Store error message
-                                errors[i].net = netID;
-                                errors[i].board = id;
-                                errors[i].sensor = sensorId;
-                                errors[i].error = fullMsg;
-
-                                if(fullMsg != SkinErrorCode::StatusOK)
-                                {
-                                    yError() << "canBusSkin error code: " <<
-                                                "canDeviceNum: " << errors[i].net <<
-                                                "board: " <<  errors[i].board <<
-                                                "sensor: " << errors[i].sensor <<
-                                                "error: " << iCub::skin::diagnostics::printErrorCode(errors[i].error).c_str();
+        // The messages are decoded in place into the taxels, through a table from board address to slot
+        decoder.decode(inBuffer, canMessages, data.data(), _brdCfg.useDiagnostic);
 
-                                    yarp::sig::Vector &out = portSkinDiagnosticsOut.prepare();
-                                    out.clear();
-
-                                    out.push_back(errors[i].net);
-                                    out.push_back(errors[i].board);
-                                    out.push_back(errors[i].sensor);
-                                    out.push_back(errors[i].error);
-
-                                    portSkinDiagnosticsOut.write(true);
-
-                                }
-                            }
-                            else
-                            {
-                                _isDiagnosticPresent = false;
-                            }
-                        }
-                    }
-                }
-          //    else
-          //        {
-          //            yError()<< "Error: skin received malformed message\n";
-          //        }
-            }
+        // Skin diagnostics
+        if (_brdCfg.useDiagnostic)  // if user requests to check the diagnostic
+        {
+            _isDiagnosticPresent = decoder.isDiagnosticPresent();
+            if (!decoder.getErrors().empty())
+                diagnoseSkin();
         }
+
+        updateStats();
     }
 }
 
@@ -712,9 +647,17 @@ bool CanBusSkin::diagnoseSkin(void) {
     using iCub::skin::diagnostics::DetectedError;   // FG: Skin diagnostics errors
     using yarp::sig::Vector;
 
+    const std::vector<DetectedError> &errors = decoder.getErrors();
+
     // Write errors to port
     for (size_t i = 0; i < errors.size(); ++i)
     {
+        yError() << "canBusSkin error code: " <<
+                    "canDeviceNum: " << errors[i].net <<
+                    "board: " <<  errors[i].board <<
+                    "sensor: " << errors[i].sensor <<
+                    "error: " << iCub::skin::diagnostics::printErrorCode(errors[i].error).c_str();
+
         Vector &out = portSkinDiagnosticsOut.prepare();
         out.clear();
 
@@ -730,6 +673,36 @@ bool CanBusSkin::diagnoseSkin(void) {
 }
 /* *********************************************************************************************************************** */
 
+
+/* *********************************************************************************************************************** */
+/* ******* Accumulates and reports the decoding statistics.                 ********************************************** */
+void CanBusSkin::updateStats(void) {
+    const SkinDecodeStats &stats = decoder.getStats();
+    _statsSum.messages += stats.messages;
+    _statsSum.discarded += stats.discarded;
+    _statsSum.incomplete += stats.incomplete;
+    _statsSum.diagErrors += stats.diagErrors;
+    _statsSum.decodeTime += stats.decodeTime;
+    if (stats.decodeTime > _statsMaxDecodeTime)
+        _statsMaxDecodeTime = stats.decodeTime;
+    _statsCycles++;
+
+    double now = yarp::os::Time::now();
+    if (now - _statsLastReport < STATS_REPORT_PERIOD)
+        return;
+
+    yDebug("canSkin on bus %d: %u cycles, %.1f msg/cycle, %u discarded msg, %u incomplete triangles, %u diagnostic errors, decode time av %.1f [us] max %.1f [us]",
+           _canBusNum, _statsCycles, (double)_statsSum.messages/_statsCycles,
+           _statsSum.discarded, _statsSum.incomplete, _statsSum.diagErrors,
+           1e6*_statsSum.decodeTime/_statsCycles, 1e6*_statsMaxDecodeTime);
+
+    _statsSum = SkinDecodeStats();
+    _statsMaxDecodeTime = 0.0;
+    _statsCycles = 0;
+    _statsLastReport = now;
+}
+/* *********************************************************************************************************************** */
+
 /* *********************************************************************************************************************** */
 /* ******* Converts input parameter bottle into a std vector.               ********************************************** */
 void CanBusSkin::checkParameterListLength(const string &i_paramName, Bottle &i_paramList, const int &i_length, const Value &i_defaultValue) {
@@ -21,6 +21,7 @@
 
 #include "SkinConfigReader.h"
 #include <SkinDiagnostics.h>
+#include "SkinFrameDecoder.h"
 
 
 class CanBusSkin : public yarp::os::PeriodicThread, public yarp::dev::IAnalogSensor, public yarp::dev::DeviceDriver 
@@ -63,6 +64,13 @@ private:
     bool _isDiagnosticPresent;       // is the diagnostic available from the firmware
     /*************************************************************/
 
+    /****************** decoding statistics **********************/
+    SkinDecodeStats _statsSum;       // sums of the statistics of the cycles since the last report
+    double _statsMaxDecodeTime;      // max decoding time since the last report
+    unsigned int _statsCycles;       // cycles since the last report
+    double _statsLastReport;         // time of the last report
+    /*************************************************************/
+
 protected:
     yarp::dev::PolyDriver driver;
     yarp::dev::ICanBus *pCanBus;
@@ -80,8 +88,8 @@ protected:
 
     yarp::sig::Vector data;
 
-    /** The detected skin errors. These are used for diagnostics purposes. */
-    yarp::sig::VectorOf<iCub::skin::diagnostics::DetectedError> errors;
+    /** The decoder of the skin messages, holding the detected skin errors for diagnostics purposes. */
+    SkinFrameDecoder decoder;
 
 public:
     CanBusSkin();
@@ -111,6 +119,11 @@ private:
      */
     bool diagnoseSkin(void);
 
+    /**
+     * Accumulates the decoding statistics of the last cycle and prints them out periodically.
+     */
+    void updateStats(void);
+
     /**
      * Checks that the given parameter list, extracted from the configuration file, is of the same lenght as the number of cards on the CAN bus.
      * If thins is not the case then the missing parameters in the list are initialised with default values.
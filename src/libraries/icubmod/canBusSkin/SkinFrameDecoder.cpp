@@ -0,0 +1,125 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+// Copyright: (C) 2018 iCub Facility - Istituto Italiano di Tecnologia
+// CopyPolicy: Released under the terms of the GNU GPL v2.0.
+
+#include <SkinFrameDecoder.h>
+
+#include <chrono>
+
+using namespace iCub::skin::diagnostics;
+using yarp::dev::CanBuffer;
+using yarp::dev::CanMessage;
+
+#define SKIN_MSG_HEAD   0x40
+#define SKIN_MSG_TAIL   0xC0
+
+
+SkinFrameDecoder::SkinFrameDecoder() :  netId(0),
+                                        diagnosticPresent(false)
+{
+    for (int i = 0; i < 16; i++)
+        slotOf[i] = -1;
+    stats = SkinDecodeStats();
+}
+
+
+bool SkinFrameDecoder::setBoards(const yarp::sig::VectorOf<int> &i_cardId, int i_netId)
+{
+    bool ret = true;
+    for (int i = 0; i < 16; i++)
+        slotOf[i] = -1;
+
+    for (size_t j = 0; j < i_cardId.size(); j++)
+    {
+        int id = i_cardId[j];
+        if ((id < 0) || (id > 15) || (slotOf[id] >= 0))
+            ret = false;
+        else
+            slotOf[id] = (int)j;
+    }
+
+    netId = i_netId;
+    headPending.assign(i_cardId.size()*TRIANGLES_PER_BOARD, 0);
+    errors.clear();
+    errors.reserve(headPending.size());
+    return ret;
+}
+
+
+void SkinFrameDecoder::decode(CanBuffer &i_buffer, unsigned int i_num, double *o_taxels, bool i_useDiagnostic)
+{
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    unsigned int heads = 0, tails = 0, incomplete = 0;
+    errors.clear();
+
+    for (unsigned int i = 0; i < i_num; i++)
+    {
+        const CanMessage &msg = i_buffer[i];
+        const unsigned int msgid = msg.getId();
+        const int slot = slotOf[(msgid & 0x00F0) >> 4];
+        const unsigned char *d = msg.getData();
+        const unsigned char type = d[0];
+
+        // only the heads and the tails of the boards on the bus are decoded,
+        // everything else is counted as discarded
+        const bool isHead = (type == SKIN_MSG_HEAD);
+        const bool isTail = (type == SKIN_MSG_TAIL);
+        if ((slot < 0) || !(isHead || isTail))
+            continue;
+
+        const unsigned int sensorId = msgid & 0x000F;
+        const unsigned int triangle = slot*TRIANGLES_PER_BOARD + sensorId;
+        double *taxels = o_taxels + triangle*TAXELS_PER_TRIANGLE;
+        unsigned char &pending = headPending[triangle];
+
+        if (isHead)
+        {
+            for (int k = 0; k < 7; k++)
+                taxels[k] = d[k + 1];
+
+            // a head still waiting means that its tail went lost
+            incomplete += pending;
+            pending = 1;
+            heads++;
+        }
+        else
+        {
+            for (int k = 0; k < 5; k++)
+                taxels[k + 7] = d[k + 1];
+
+            // a tail with no head waiting means that the head went lost
+            incomplete += 1 - pending;
+            pending = 0;
+            tails++;
+
+            if (i_useDiagnostic)
+            {
+                // firmware is sending diagnostic info
+                diagnosticPresent = (msg.getLen() == 8);
+                if (diagnosticPresent)
+                {
+                    int fullMsg = (d[6] << 8) | d[7];
+                    if (fullMsg != SkinErrorCode::StatusOK)
+                    {
+                        DetectedError err;
+                        err.net = netId;
+                        err.board = (msgid & 0x00F0) >> 4;
+                        err.sensor = sensorId;
+                        err.error = fullMsg;
+                        errors.push_back(err);
+                    }
+                }
+            }
+        }
+    }
+
+    stats.messages = i_num;
+    stats.heads = heads;
+    stats.tails = tails;
+    stats.discarded = i_num - heads - tails;
+    stats.incomplete = incomplete;
+    stats.diagErrors = (unsigned int)errors.size();
+    stats.decodeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
@@ -0,0 +1,99 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+// Copyright: (C) 2018 iCub Facility - Istituto Italiano di Tecnologia
+// CopyPolicy: Released under the terms of the GNU GPL v2.0.
+
+#ifndef __SKINFRAMEDECODER_H__
+#define __SKINFRAMEDECODER_H__
+
+#include <vector>
+
+#include <yarp/dev/CanBusInterface.h>
+#include <yarp/sig/Vector.h>
+
+#include <SkinDiagnostics.h>
+
+
+/**
+ * Statistics of the decoding of a batch of CAN messages.
+ */
+struct SkinDecodeStats
+{
+    unsigned int messages;      // messages in the batch
+    unsigned int heads;         // head frames decoded
+    unsigned int tails;         // tail frames decoded
+    unsigned int discarded;     // messages from unknown boards or of unknown type
+    unsigned int incomplete;    // triangles whose head or tail went missing
+    unsigned int diagErrors;    // diagnostic messages reporting an error
+    double decodeTime;          // time spent decoding the batch [s]
+};
+
+
+/**
+ * Decoder of the periodic skin messages of the MTB boards on a CAN bus.
+ *
+ * Every triangle sends its 12 taxels in two frames, a head (type 0x40)
+ * with the first 7 taxels and a tail (type 0xC0) with the other 5 and,
+ * optionally, the diagnostic code. The board of a message is resolved
+ * through a table indexed by its 4-bit address, built once from the
+ * list of the boards, and the taxels are written in place in the
+ * output array (16 triangles of 12 taxels per board, in the order of
+ * the list). Head and tail of every triangle are tracked across
+ * batches in order to detect the lost frames.
+ *
+ * All the buffers are allocated by setBoards(), hence decode() does
+ * not allocate memory.
+ */
+class SkinFrameDecoder
+{
+public:
+    static const int TAXELS_PER_TRIANGLE = 12;
+    static const int TRIANGLES_PER_BOARD = 16;
+    static const int TAXELS_PER_BOARD = TAXELS_PER_TRIANGLE*TRIANGLES_PER_BOARD;
+
+    SkinFrameDecoder();
+
+    /**
+     * Sets the boards on the bus.
+     *
+     * \param i_cardId The addresses of the boards, in the order of their slots in the output
+     * \param i_netId The CAN bus ID, reported in the detected errors
+     * \return false if an address is out of range or repeated (the first slot gets the data)
+     */
+    bool setBoards(const yarp::sig::VectorOf<int> &i_cardId, int i_netId);
+
+    /**
+     * Decodes a batch of messages.
+     *
+     * \param i_buffer The messages
+     * \param i_num The number of messages
+     * \param o_taxels The taxels of all the boards, TAXELS_PER_BOARD for each one
+     * \param i_useDiagnostic If true the diagnostic codes of the tails are checked
+     */
+    void decode(yarp::dev::CanBuffer &i_buffer, unsigned int i_num, double *o_taxels, bool i_useDiagnostic);
+
+    /**
+     * \return the errors detected in the last batch
+     */
+    const std::vector<iCub::skin::diagnostics::DetectedError>& getErrors() const { return errors; }
+
+    /**
+     * \return the statistics of the last batch
+     */
+    const SkinDecodeStats& getStats() const { return stats; }
+
+    /**
+     * \return true if the last tail received carried the diagnostic code
+     */
+    bool isDiagnosticPresent() const { return diagnosticPresent; }
+
+private:
+    int slotOf[16];                         // slot of each board address (-1 for boards not on the bus)
+    int netId;
+    std::vector<unsigned char> headPending; // 1 for the triangles waiting for their tail
+    std::vector<iCub::skin::diagnostics::DetectedError> errors;
+    SkinDecodeStats stats;
+    bool diagnosticPresent;
+};
+
+#endif
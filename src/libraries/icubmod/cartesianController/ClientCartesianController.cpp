@@ -443,6 +443,46 @@ bool ClientCartesianController::getPose(const int axis, Vector &x, Vector &o,
 }
 
 
+/************************************************************************/
+bool ClientCartesianController::getPoseAt(const int axis, const double time,
+                                          Vector &x, Vector &o)
+{
+    if (!connected)
+        return false;
+
+    Bottle command, reply;
+    command.addVocab32(IKINCARTCTRL_VOCAB_CMD_GET);
+    command.addVocab32(IKINCARTCTRL_VOCAB_OPT_POSE);
+    command.addInt32(axis);
+    command.addFloat64(time);
+
+    if (!portRpc.write(command,reply))
+    {
+        yError("unable to get reply from server!");
+        return false;
+    }
+
+    if (reply.get(0).asVocab32()==IKINCARTCTRL_VOCAB_REP_ACK)
+    {
+        if (Bottle *posePart=reply.get(1).asList())
+        {
+            x.resize(3);
+            o.resize(posePart->size()-x.length());
+
+            for (size_t i=0; i<x.length(); i++)
+                x[i]=posePart->get(i).asFloat64();
+
+            for (size_t i=0; i<o.length(); i++)
+                o[i]=posePart->get(x.length()+i).asFloat64();
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
 /************************************************************************/
 bool ClientCartesianController::goToPose(const Vector &xd, const Vector &od,
                                          const double t)
@@ -675,6 +715,61 @@ bool ClientCartesianController::askForPosition(const Vector &q0, const Vector &x
 }
 
 
+/************************************************************************/
+bool ClientCartesianController::askForPoses(const deque<Vector> &q0, const deque<Vector> &xd,
+                                            const deque<Vector> &od, deque<Vector> &xdhat,
+                                            deque<Vector> &odhat, deque<Vector> &qdhat)
+{
+    if (!connected || xd.empty() || (od.size()!=xd.size()) ||
+        (!q0.empty() && (q0.size()!=xd.size())))
+        return false;
+
+    Bottle command, reply;
+    deque<Vector> tg;
+    for (size_t k=0; k<xd.size(); k++)
+        tg.push_back(cat(xd[k],od[k]));
+
+    command.addVocab32(IKINCARTCTRL_VOCAB_CMD_ASK);
+    addVectorsOption(command,IKINCARTCTRL_VOCAB_OPT_XD,tg);
+    if (!q0.empty())
+        addVectorsOption(command,IKINCARTCTRL_VOCAB_OPT_Q,q0);
+    addPoseOption(command,IKINCTRL_POSE_FULL);
+
+    if (!portRpc.write(command,reply))
+    {
+        yError("unable to get reply from server!");
+        return false;
+    }
+
+    return getDesiredOption(reply,xdhat,odhat,qdhat);
+}
+
+
+/************************************************************************/
+bool ClientCartesianController::askForPositions(const deque<Vector> &q0, const deque<Vector> &xd,
+                                                deque<Vector> &xdhat, deque<Vector> &odhat,
+                                                deque<Vector> &qdhat)
+{
+    if (!connected || xd.empty() || (!q0.empty() && (q0.size()!=xd.size())))
+        return false;
+
+    Bottle command, reply;
+    command.addVocab32(IKINCARTCTRL_VOCAB_CMD_ASK);
+    addVectorsOption(command,IKINCARTCTRL_VOCAB_OPT_XD,xd);
+    if (!q0.empty())
+        addVectorsOption(command,IKINCARTCTRL_VOCAB_OPT_Q,q0);
+    addPoseOption(command,IKINCTRL_POSE_XYZ);
+
+    if (!portRpc.write(command,reply))
+    {
+        yError("unable to get reply from server!");
+        return false;
+    }
+
+    return getDesiredOption(reply,xdhat,odhat,qdhat);
+}
+
+
 /************************************************************************/
 bool ClientCartesianController::getDOF(Vector &curDof)
 {
@@ -22,6 +22,7 @@
 #include <string>
 #include <set>
 #include <map>
+#include <deque>
 
 #include <yarp/os/all.h>
 #include <yarp/dev/all.h>
@@ -103,6 +104,7 @@ public:
     bool getPosePriority(std::string &p);
     bool getPose(yarp::sig::Vector &x, yarp::sig::Vector &o, yarp::os::Stamp *stamp=NULL);
     bool getPose(const int axis, yarp::sig::Vector &x, yarp::sig::Vector &o, yarp::os::Stamp *stamp=NULL);
+    bool getPoseAt(const int axis, const double time, yarp::sig::Vector &x, yarp::sig::Vector &o);
     bool goToPose(const yarp::sig::Vector &xd, const yarp::sig::Vector &od, const double t=0.0);
     bool goToPosition(const yarp::sig::Vector &xd, const double t=0.0);
     bool goToPoseSync(const yarp::sig::Vector &xd, const yarp::sig::Vector &od, const double t=0.0);
@@ -116,6 +118,12 @@ public:
                         yarp::sig::Vector &qdhat);
     bool askForPosition(const yarp::sig::Vector &q0, const yarp::sig::Vector &xd, yarp::sig::Vector &xdhat,
                         yarp::sig::Vector &odhat, yarp::sig::Vector &qdhat);
+    bool askForPoses(const std::deque<yarp::sig::Vector> &q0, const std::deque<yarp::sig::Vector> &xd,
+                     const std::deque<yarp::sig::Vector> &od, std::deque<yarp::sig::Vector> &xdhat,
+                     std::deque<yarp::sig::Vector> &odhat, std::deque<yarp::sig::Vector> &qdhat);
+    bool askForPositions(const std::deque<yarp::sig::Vector> &q0, const std::deque<yarp::sig::Vector> &xd,
+                         std::deque<yarp::sig::Vector> &xdhat, std::deque<yarp::sig::Vector> &odhat,
+                         std::deque<yarp::sig::Vector> &qdhat);
     bool getDOF(yarp::sig::Vector &curDof);
     bool setDOF(const yarp::sig::Vector &newDof, yarp::sig::Vector &curDof);
     bool getRestPos(yarp::sig::Vector &curRestPos);
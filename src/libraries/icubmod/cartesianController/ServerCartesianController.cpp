@@ -195,7 +195,13 @@ void ServerCartesianController::init()
 
     portCmd     =NULL;
     rpcProcessor=NULL;
+    timing      =NULL;
+    embeddedSlv =NULL;
+    history     =NULL;
+    reachMap    =NULL;
 
+    reachReject  =false;
+    reachSeed    =false;
     attached     =false;
     connected    =false;
     closed       =true;
@@ -230,6 +236,8 @@ void ServerCartesianController::openPorts()
     portCmd     =new CartesianCtrlCommandPort(this);
     rpcProcessor=new CartesianCtrlRpcProcessor(this);
     portRpc.setReader(*rpcProcessor);
+    timing=new TimingProbe({"input","control","commands","output"},getPeriod());
+    timing->setLogDir(timingLogDir);
 
     string prefixName="/";
     prefixName=prefixName+ctrlName;
@@ -281,6 +289,14 @@ void ServerCartesianController::closePorts()
     }
 
     delete rpcProcessor;
+
+    // the rpc may still be serving a "timing" request
+    {
+        lock_guard<mutex> lck(mtx_timing);
+        delete timing;
+        timing=NULL;
+    }
+
     connected=false;
 }
 
@@ -288,6 +304,13 @@ void ServerCartesianController::closePorts()
 /************************************************************************/
 bool ServerCartesianController::respond(const Bottle &command, Bottle &reply)
 {
+    {
+        // a dedicated mutex keeps the loop free from the rpc
+        lock_guard<mutex> lck(mtx_timing);
+        if ((timing!=NULL) && timing->respond(command,reply))
+            return true;
+    }
+
     if (command.size())
         switch (command.get(0).asVocab32())
         {
@@ -664,7 +687,18 @@ bool ServerCartesianController::respond(const Bottle &command, Bottle &reply)
                                 Vector x,o;
                                 Stamp stamp;
 
-                                if (getPose(axis,x,o,&stamp))
+                                // optional query time
+                                bool ok;
+                                if (command.size()>3)
+                                {
+                                    double time=command.get(3).asFloat64();
+                                    ok=getPoseAt(axis,time,x,o);
+                                    stamp.update(time);
+                                }
+                                else
+                                    ok=getPose(axis,x,o,&stamp);
+
+                                if (ok)
                                 {
                                     reply.addVocab32(IKINCARTCTRL_VOCAB_REP_ACK);
                                     Bottle &posePart=reply.addList();
@@ -1191,7 +1225,8 @@ void ServerCartesianController::createController()
 /************************************************************************/
 bool ServerCartesianController::getNewTarget()
 {
-    if (Bottle *b1=portSlvIn.read(false))
+    Bottle *b1=(embeddedSlv!=NULL)?slvOutbox.take():portSlvIn.read(false);
+    if (b1!=NULL)
     {
         bool tokened=getTokenOption(*b1,&rxToken);
 
@@ -1612,6 +1647,7 @@ void ServerCartesianController::run()
     if (connected)
     {
         lock_guard<mutex> lck(mtx);
+        timing->beginCycle();
 
         // read the feedback
         double stamp=getFeedback(fb);
@@ -1622,6 +1658,11 @@ void ServerCartesianController::run()
         else
             txInfo.update();
 
+        // keep track of all the joints for queries about the past
+        for (unsigned int i=0, k=0; i<chainState->getN(); i++)
+            qHistory[i]=(*chainState)[i].isBlocked()?(*chainState)[i].getAng():fb[k++];
+        history->push(txInfo.getTime(),qHistory);
+
         vector<int> jointsToSet;
         jointsHealthy=areJointsHealthyAndSet(jointsToSet);
         if (!jointsHealthy)
@@ -1671,6 +1712,7 @@ void ServerCartesianController::run()
         double dist=norm(qdes-q0);
         pathPerc=(dist>1e-6)?norm(fb-q0)/dist:1.0;
         pathPerc=std::min(std::max(pathPerc,0.0),1.0);
+        timing->mark(STAGE_INPUT);
 
         if (executingTraj)
         {
@@ -1682,6 +1724,7 @@ void ServerCartesianController::run()
                 ctrl->iterate(xdes,qdes,xdot_set);
             else
                 ctrl->iterate(xdes,qdes);
+            timing->mark(STAGE_CONTROL);
 
             // handle the end-trajectory event
             bool inTarget=ctrl->isInTarget();
@@ -1714,6 +1757,7 @@ void ServerCartesianController::run()
                 else
                     (this->*sendCtrlCmd)();
             }
+            timing->mark(STAGE_COMMANDS);
         }        
 
         // stream out the end-effector pose
@@ -1734,6 +1778,8 @@ void ServerCartesianController::run()
             motionOngoingEventsFlush();
             notifyEvent(event);
         }
+        timing->mark(STAGE_OUTPUT);
+        timing->endCycle();
     }
     else if ((++connectCnt)*getPeriod()>CARTCTRL_CONNECT_SOLVER_PING)
     {
@@ -1872,6 +1918,9 @@ bool ServerCartesianController::open(Searchable &config)
     if (debugInfoEnabled)
         yDebug("Commands to robot will be also streamed out on debug port");
 
+    // the "timing log" rpc command can only write within this directory
+    timingLogDir=optGeneral.check("TimingLogDir",Value("")).asString();
+
     // scan DRIVER groups
     for (int i=0; i<numDrv; i++)
     {
@@ -2000,8 +2049,167 @@ bool ServerCartesianController::open(Searchable &config)
     chainState=limbState->asChain();
     chainPlan=limbPlan->asChain();
 
+    // the state chain is queried only while holding the mutex,
+    // hence it can cache the transformations across the cycles
+    chainState->setCaching(true);
+
+    history=new StateHistory(chainState->getN(),CARTCTRL_HISTORY_LENGTH);
+    qHistory.resize(chainState->getN(),0.0);
+
+    if (optGeneral.check("ReachabilityMap"))
+    {
+        if (!openReachMap(optGeneral))
+        {
+            close();
+            return false;
+        }
+    }
+
     openPorts();
 
+    // the solver may run within the controller, exchanging
+    // targets and solutions through mailboxes instead of ports
+    if (optGeneral.check("EmbeddedSolver",Value("off")).asString()=="on")
+    {
+        if (!openEmbeddedSolver(config))
+        {
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/************************************************************************/
+bool ServerCartesianController::openReachMap(Searchable &optGeneral)
+{
+    ResourceFinder rf_map;
+    if (optGeneral.check("ReachabilityMapContext"))
+        rf_map.setDefaultContext(optGeneral.find("ReachabilityMapContext").asString());
+    rf_map.configure(0,NULL);
+    string pathToMap=rf_map.findFileByName(optGeneral.find("ReachabilityMap").asString());
+
+    reachMap=new iKinReachMap;
+    if (!reachMap->load(pathToMap))
+    {
+        yError("%s: unable to load the reachability map",ctrlName.c_str());
+        return false;
+    }
+
+    // rejection is safe, as the map is built with all the joints
+    // released and unreachable means not even close to a sample
+    reachReject=optGeneral.check("ReachabilityReject",Value("on")).asString()=="on";
+
+    // seeding instead moves the starting point of [ask]
+    // requests away from the current configuration
+    reachSeed=optGeneral.check("ReachabilitySeed",Value("off")).asString()=="on";
+    if (reachSeed && (reachMap->getDOF()!=chainState->getN()))
+    {
+        yWarning("%s: the reachability map accounts for %d joints instead of %d, seeding disabled",
+                 ctrlName.c_str(),reachMap->getDOF(),chainState->getN());
+        reachSeed=false;
+    }
+
+    yInfo("%s: reachability map %s loaded (reject %s, seed %s)",ctrlName.c_str(),
+          pathToMap.c_str(),reachReject?"on":"off",reachSeed?"on":"off");
+
+    return true;
+}
+
+
+/************************************************************************/
+bool ServerCartesianController::isTargetReachable(const Vector &xd)
+{
+    if (!reachReject || (reachMap==NULL) || reachMap->isReachable(xd,true))
+        return true;
+
+    yWarning("%s: target (%s) is out of reach",ctrlName.c_str(),
+             xd.subVector(0,2).toString(3,3).c_str());
+    return false;
+}
+
+
+/************************************************************************/
+bool ServerCartesianController::getTargetSeed(const Vector &xd, Vector &q0)
+{
+    Vector seed;
+    if (!reachSeed || (reachMap==NULL) || !reachMap->getSeed(xd,seed))
+        return false;
+
+    // the solver expects the joints that are not blocked [deg]
+    q0.resize(0);
+    for (unsigned int i=0; i<chainState->getN(); i++)
+    {
+        iKinLink &lnk=(*chainState)[i];
+        if (!lnk.isBlocked())
+            q0.push_back(CTRL_RAD2DEG*std::min(std::max(seed[i],lnk.getMin()),lnk.getMax()));
+    }
+
+    return true;
+}
+
+
+/************************************************************************/
+void ServerCartesianController::getTargetSeeds(const deque<Vector> &xd,
+                                               deque<Vector> &q0)
+{
+    q0.clear();
+    if (!reachSeed || (reachMap==NULL))
+        return;
+
+    // targets without a seed start from the current configuration
+    Vector qCur;
+    {
+        lock_guard<mutex> lck(mtx);
+        for (unsigned int i=0; i<chainState->getN(); i++)
+            if (!(*chainState)[i].isBlocked())
+                qCur.push_back(CTRL_RAD2DEG*chainState->getAng(i));
+    }
+
+    for (size_t k=0; k<xd.size(); k++)
+    {
+        Vector seed;
+        q0.push_back(getTargetSeed(xd[k],seed)?seed:qCur);
+    }
+}
+
+
+/************************************************************************/
+bool ServerCartesianController::openEmbeddedSolver(Searchable &config)
+{
+    Bottle &optSolver=config.findGroup("EMBEDDED_SOLVER");
+    if (optSolver.isNull())
+    {
+        yError("EMBEDDED_SOLVER group is missing");
+        return false;
+    }
+
+    if (kinPart=="arm")
+        embeddedSlv=new iCubArmCartesianSolver(slvName);
+    else if (kinPart=="leg")
+        embeddedSlv=new iCubLegCartesianSolver(slvName);
+    else
+    {
+        yError("Embedded solver is not available for custom kinematics");
+        return false;
+    }
+
+    Property options(optSolver.toString().c_str());
+    if (!options.check("type"))
+        options.put("type",kinType);
+
+    yInfo("%s: opening embedded solver %s...",ctrlName.c_str(),slvName.c_str());
+    embeddedSlv->setMailboxes(&slvInbox,&slvOutbox);
+    if (!embeddedSlv->open(options))
+    {
+        yError("%s: unable to open the embedded solver",ctrlName.c_str());
+        delete embeddedSlv;
+        embeddedSlv=NULL;
+        return false;
+    }
+
     return true;
 }
 
@@ -2016,12 +2224,20 @@ bool ServerCartesianController::close()
 
     delete limbState;
     delete limbPlan;
+    delete history;
+    delete reachMap;
 
     while (eventsMap.size()>0)
         unregisterEvent(*eventsMap.begin()->second);
 
     closePorts();
 
+    if (embeddedSlv!=NULL)
+    {
+        delete embeddedSlv;
+        embeddedSlv=NULL;
+    }
+
     contextMap.clear();
 
     return closed=true;
@@ -2247,6 +2463,9 @@ bool ServerCartesianController::detachAll()
 /************************************************************************/
 bool ServerCartesianController::pingSolver()
 {    
+    if (embeddedSlv!=NULL)
+        return true;
+
     string portSlvName="/";
     portSlvName=portSlvName+slvName+"/in";    
 
@@ -2270,8 +2489,11 @@ bool ServerCartesianController::connectToSolver()
 
         bool ok=true;
 
-        ok&=Network::connect(portSlvName+"/out",portSlvIn.getName(),"udp");
-        ok&=Network::connect(portSlvOut.getName(),portSlvName+"/in","udp");
+        if (embeddedSlv==NULL)
+        {
+            ok&=Network::connect(portSlvName+"/out",portSlvIn.getName(),"udp");
+            ok&=Network::connect(portSlvOut.getName(),portSlvName+"/in","udp");
+        }
         ok&=Network::connect(portSlvRpc.getName(),portSlvName+"/rpc");
 
         if (ok)
@@ -2327,6 +2549,10 @@ bool ServerCartesianController::connectToSolver()
 bool ServerCartesianController::goTo(unsigned int _ctrlPose, const Vector &xd,
                                      const double t, const bool latchToken)
 {    
+    // targets integrated in task velocity mode are not checked
+    if (!taskVelModeOn && !isTargetReachable(xd))
+        return false;
+
     if (connected && (ctrl->get_dim()!=0) && jointsHealthy)
     {
         motionDone=false;
@@ -2337,7 +2563,7 @@ bool ServerCartesianController::goTo(unsigned int _ctrlPose, const Vector &xd,
         if (t>0.0)
             setTrajTimeHelper(t);
 
-        Bottle &b=portSlvOut.prepare();
+        Bottle &b=(embeddedSlv!=NULL)?slvInbox.prepare():portSlvOut.prepare();
         b.clear();
     
         // xd part
@@ -2358,7 +2584,10 @@ bool ServerCartesianController::goTo(unsigned int _ctrlPose, const Vector &xd,
         if (latchToken)
             txTokenLatchedGoToRpc=txToken;
 
-        portSlvOut.writeStrict();
+        if (embeddedSlv!=NULL)
+            slvInbox.post();
+        else
+            portSlvOut.writeStrict();
         return true;
     }
     else
@@ -2549,6 +2778,44 @@ bool ServerCartesianController::getPose(const int axis, Vector &x,
 }
 
 
+/************************************************************************/
+bool ServerCartesianController::getPoseAt(const int axis, const double time,
+                                          Vector &x, Vector &o)
+{
+    if (attached)
+    {
+        lock_guard<mutex> lck(mtx);
+
+        Vector q;
+        if ((axis<0) || (axis>=(int)chainState->getN()) || !history->get(time,q))
+            return false;
+
+        // move the chain temporarily to the past configuration
+        Vector qNow(chainState->getN());
+        for (unsigned int i=0; i<chainState->getN(); i++)
+        {
+            qNow[i]=(*chainState)[i].getAng();
+            (*chainState)[i].setAng(q[i]);
+        }
+
+        Matrix H=chainState->getH(axis,true);
+
+        for (unsigned int i=0; i<chainState->getN(); i++)
+            (*chainState)[i].setAng(qNow[i]);
+
+        x.resize(3);
+        for (size_t i=0; i<x.length(); i++)
+            x[i]=H(i,3);
+
+        o=dcm2axis(H);
+
+        return true;
+    }
+    else
+        return false;
+}
+
+
 /************************************************************************/
 bool ServerCartesianController::goToPose(const Vector &xd, const Vector &od,
                                          const double t)
@@ -2655,8 +2922,14 @@ bool ServerCartesianController::askForPose(const Vector &xd, const Vector &od,
     for (size_t i=0; i<od.length(); i++)
         tg[xd.length()+i]=od[i];
     
+    if (!isTargetReachable(tg))
+        return false;
+
     command.addVocab32(IKINSLV_VOCAB_CMD_ASK);
     addVectorOption(command,IKINSLV_VOCAB_OPT_XD,tg);
+    Vector q0;
+    if (getTargetSeed(tg,q0))
+        addVectorOption(command,IKINSLV_VOCAB_OPT_Q,q0);
     addPoseOption(command,IKINCTRL_POSE_FULL);
 
     // send command and wait for reply
@@ -2688,6 +2961,9 @@ bool ServerCartesianController::askForPose(const Vector &q0, const Vector &xd,
     for (size_t i=0; i<od.length(); i++)
         tg[xd.length()+i]=od[i];
 
+    if (!isTargetReachable(tg))
+        return false;
+
     command.addVocab32(IKINSLV_VOCAB_CMD_ASK);
     addVectorOption(command,IKINSLV_VOCAB_OPT_XD,tg);
     addVectorOption(command,IKINSLV_VOCAB_OPT_Q,q0);
@@ -2713,9 +2989,15 @@ bool ServerCartesianController::askForPosition(const Vector &xd, Vector &xdhat,
 
     lock_guard<mutex> lck(mtx);
 
+    if (!isTargetReachable(xd))
+        return false;
+
     Bottle command, reply;
     command.addVocab32(IKINSLV_VOCAB_CMD_ASK);
     addVectorOption(command,IKINSLV_VOCAB_OPT_XD,xd);
+    Vector q0;
+    if (getTargetSeed(xd,q0))
+        addVectorOption(command,IKINSLV_VOCAB_OPT_Q,q0);
     addPoseOption(command,IKINCTRL_POSE_XYZ);
 
     // send command and wait for reply
@@ -2739,6 +3021,9 @@ bool ServerCartesianController::askForPosition(const Vector &q0, const Vector &x
 
     lock_guard<mutex> lck(mtx);
 
+    if (!isTargetReachable(xd))
+        return false;
+
     Bottle command, reply;
     command.addVocab32(IKINSLV_VOCAB_CMD_ASK);
     addVectorOption(command,IKINSLV_VOCAB_OPT_XD,xd);
@@ -2756,6 +3041,77 @@ bool ServerCartesianController::askForPosition(const Vector &q0, const Vector &x
 }
 
 
+/************************************************************************/
+bool ServerCartesianController::askForPoses(const deque<Vector> &q0, const deque<Vector> &xd,
+                                            const deque<Vector> &od, deque<Vector> &xdhat,
+                                            deque<Vector> &odhat, deque<Vector> &qdhat)
+{
+    if (!connected || xd.empty() || (od.size()!=xd.size()) ||
+        (!q0.empty() && (q0.size()!=xd.size())))
+        return false;
+
+    Bottle command, reply;
+    deque<Vector> tg;
+    for (size_t k=0; k<xd.size(); k++)
+        tg.push_back(cat(xd[k],od[k]));
+
+    deque<Vector> seeds;
+    if (q0.empty())
+        getTargetSeeds(tg,seeds);
+
+    command.addVocab32(IKINSLV_VOCAB_CMD_ASK);
+    addVectorsOption(command,IKINSLV_VOCAB_OPT_XD,tg);
+    if (!q0.empty())
+        addVectorsOption(command,IKINSLV_VOCAB_OPT_Q,q0);
+    else if (!seeds.empty())
+        addVectorsOption(command,IKINSLV_VOCAB_OPT_Q,seeds);
+    addPoseOption(command,IKINCTRL_POSE_FULL);
+
+    // the controller state is not involved, hence the
+    // control loop is not held while the batch is solved
+    bool ret=false;
+    if (portSlvRpc.write(command,reply))
+        ret=getDesiredOption(reply,xdhat,odhat,qdhat);
+    else
+        yError("%s: unable to get reply from solver!",ctrlName.c_str());         
+
+    return ret;
+}
+
+
+/************************************************************************/
+bool ServerCartesianController::askForPositions(const deque<Vector> &q0, const deque<Vector> &xd,
+                                                deque<Vector> &xdhat, deque<Vector> &odhat,
+                                                deque<Vector> &qdhat)
+{
+    if (!connected || xd.empty() || (!q0.empty() && (q0.size()!=xd.size())))
+        return false;
+
+    deque<Vector> seeds;
+    if (q0.empty())
+        getTargetSeeds(xd,seeds);
+
+    Bottle command, reply;
+    command.addVocab32(IKINSLV_VOCAB_CMD_ASK);
+    addVectorsOption(command,IKINSLV_VOCAB_OPT_XD,xd);
+    if (!q0.empty())
+        addVectorsOption(command,IKINSLV_VOCAB_OPT_Q,q0);
+    else if (!seeds.empty())
+        addVectorsOption(command,IKINSLV_VOCAB_OPT_Q,seeds);
+    addPoseOption(command,IKINCTRL_POSE_XYZ);
+
+    // the controller state is not involved, hence the
+    // control loop is not held while the batch is solved
+    bool ret=false;
+    if (portSlvRpc.write(command,reply))
+        ret=getDesiredOption(reply,xdhat,odhat,qdhat);
+    else
+        yError("%s: unable to get reply from solver!",ctrlName.c_str());         
+
+    return ret;
+}
+
+
 /************************************************************************/
 bool ServerCartesianController::getDOF(Vector &curDof)
 {
@@ -32,13 +32,20 @@
 #include <yarp/sig/all.h>
 
 #include <iCub/ctrl/pids.h>
+#include <iCub/ctrl/timingProbe.h>
+#include <iCub/ctrl/stateHistory.h>
 #include <iCub/iKin/iKinHlp.h>
 #include <iCub/iKin/iKinFwd.h>
 #include <iCub/iKin/iKinInv.h>
+#include <iCub/iKin/iKinSlv.h>
+#include <iCub/iKin/iKinReachMap.h>
 
 #include "SmithPredictor.h"
 
 
+#define CARTCTRL_HISTORY_LENGTH     256
+
+
 class ServerCartesianController;
 
 
@@ -129,6 +136,7 @@ protected:
 
     std::string ctrlName;
     std::string slvName;
+    std::string timingLogDir;
     std::string kinPart;
     std::string kinType;
     int numDrv;
@@ -171,6 +179,7 @@ protected:
 
     std::mutex mtx;
     std::mutex mtx_syncEvent;
+    std::mutex mtx_timing;
     std::condition_variable cv_syncEvent;
     yarp::os::Stamp txInfo;
     yarp::os::Stamp poseInfo;
@@ -184,10 +193,25 @@ protected:
     yarp::sig::Vector fb;
     yarp::sig::Vector q0;
 
+    // all the joints of chainState, as read over time
+    iCub::ctrl::StateHistory *history;
+    yarp::sig::Vector         qHistory;
+
     yarp::os::BufferedPort<yarp::os::Bottle>   portSlvIn;
     yarp::os::BufferedPort<yarp::os::Bottle>   portSlvOut;
     yarp::os::RpcClient                        portSlvRpc;
 
+    // offline map of the workspace used to reject
+    // unreachable targets and to seed the solver
+    iCub::iKin::iKinReachMap *reachMap;
+    bool                      reachReject;
+    bool                      reachSeed;
+
+    // in-process solver replacing portSlvIn/portSlvOut
+    iCub::iKin::CartesianSolver               *embeddedSlv;
+    iCub::iKin::BottleMailbox                  slvInbox;
+    iCub::iKin::BottleMailbox                  slvOutbox;
+
     yarp::os::BufferedPort<yarp::sig::Vector>  portState;
     yarp::os::BufferedPort<yarp::os::Bottle>   portEvent;
     yarp::os::BufferedPort<yarp::os::Bottle>   portDebugInfo;
@@ -196,6 +220,11 @@ protected:
     CartesianCtrlCommandPort                  *portCmd;
     CartesianCtrlRpcProcessor                 *rpcProcessor;
 
+    // stages of run() monitored by the timing probe,
+    // queried through the "timing" rpc command
+    enum { STAGE_INPUT=0, STAGE_CONTROL, STAGE_COMMANDS, STAGE_OUTPUT };
+    iCub::ctrl::TimingProbe                   *timing;
+
     struct Context
     {
         yarp::sig::Vector dof;
@@ -234,6 +263,11 @@ protected:
     bool   alignJointsBounds();
     double getFeedback(yarp::sig::Vector &_fb);
     void   createController();
+    bool   openEmbeddedSolver(yarp::os::Searchable &config);
+    bool   openReachMap(yarp::os::Searchable &optGeneral);
+    bool   isTargetReachable(const yarp::sig::Vector &xd);
+    bool   getTargetSeed(const yarp::sig::Vector &xd, yarp::sig::Vector &q0);
+    void   getTargetSeeds(const std::deque<yarp::sig::Vector> &xd, std::deque<yarp::sig::Vector> &q0);
     bool   getNewTarget();
     bool   areJointsHealthyAndSet(std::vector<int> &jointsToSet);
     void   setJointsCtrlMode(const std::vector<int> &jointsToSet);
@@ -287,6 +321,7 @@ public:
     bool getPosePriority(std::string &p);
     bool getPose(yarp::sig::Vector &x, yarp::sig::Vector &o, yarp::os::Stamp *stamp=NULL);
     bool getPose(const int axis, yarp::sig::Vector &x, yarp::sig::Vector &o, yarp::os::Stamp *stamp=NULL);
+    bool getPoseAt(const int axis, const double time, yarp::sig::Vector &x, yarp::sig::Vector &o);
     bool goToPose(const yarp::sig::Vector &xd, const yarp::sig::Vector &od, const double t=0.0);
     bool goToPosition(const yarp::sig::Vector &xd, const double t=0.0);
     bool goToPoseSync(const yarp::sig::Vector &xd, const yarp::sig::Vector &od, const double t=0.0);
@@ -300,6 +335,12 @@ public:
                         yarp::sig::Vector &qdhat);
     bool askForPosition(const yarp::sig::Vector &q0, const yarp::sig::Vector &xd, yarp::sig::Vector &xdhat,
                         yarp::sig::Vector &odhat, yarp::sig::Vector &qdhat);
+    bool askForPoses(const std::deque<yarp::sig::Vector> &q0, const std::deque<yarp::sig::Vector> &xd,
+                     const std::deque<yarp::sig::Vector> &od, std::deque<yarp::sig::Vector> &xdhat,
+                     std::deque<yarp::sig::Vector> &odhat, std::deque<yarp::sig::Vector> &qdhat);
+    bool askForPositions(const std::deque<yarp::sig::Vector> &q0, const std::deque<yarp::sig::Vector> &xd,
+                         std::deque<yarp::sig::Vector> &xdhat, std::deque<yarp::sig::Vector> &odhat,
+                         std::deque<yarp::sig::Vector> &qdhat);
     bool getDOF(yarp::sig::Vector &curDof);
     bool setDOF(const yarp::sig::Vector &newDof, yarp::sig::Vector &curDof);
     bool getRestPos(yarp::sig::Vector &curRestPos);
@@ -7,6 +7,8 @@
 
 #include "fakeCan.h"
 #include <iostream>
+#include <fstream>
+#include <sstream>
 
 #include <yarp/os/Bottle.h>
 #include <yarp/os/Value.h>
@@ -16,7 +18,9 @@ using namespace yarp::dev;
 using namespace yarp::os;
 
 FakeCan::FakeCan()
-{}
+{
+    replayIndex=0;
+}
 
 FakeCan::~FakeCan()
 {}
@@ -47,6 +51,24 @@ bool FakeCan::canRead(CanBuffer &msgs,
         unsigned int *read,
         bool wait)
 {
+    if (!replay.empty())
+    {
+        const std::vector<FCMSG> &rec=replay[replayIndex];
+        unsigned int l=(unsigned int)rec.size();
+        if (size<l)
+            l=size;
+
+        *read=l;
+        for(unsigned int k=0;k<l;k++)
+        {
+            FCMSG *r=reinterpret_cast<FCMSG *>(msgs[k].getPointer());
+            *r=rec[k];
+        }
+
+        replayIndex=(replayIndex+1)%replay.size();
+        return true;
+    }
+
     replies.lock();
     unsigned int l=replies.size();
 
@@ -101,6 +123,9 @@ bool FakeCan::open(yarp::os::Searchable &par)
 
     //fprintf(stderr, "%s", par.toString().c_str());
 
+    if (par.check("replayFile"))
+        return loadReplay(par.find("replayFile").asString());
+
     int njoints=par.findGroup("GENERAL").find("Joints").asInt32();
     Bottle &can = par.findGroup("CAN");
     Bottle ids=can.findGroup("CanAddresses");
@@ -124,6 +149,54 @@ bool FakeCan::open(yarp::os::Searchable &par)
     return true;
 }
 
+bool FakeCan::loadReplay(const std::string &fileName)
+{
+    ifstream file(fileName.c_str());
+    if (!file.is_open())
+    {
+        fprintf(stderr, "Unable to open the replay file %s\n", fileName.c_str());
+        return false;
+    }
+
+    replay.clear();
+    replayIndex=0;
+
+    string line;
+    while (getline(file,line))
+    {
+        istringstream str(line);
+        std::vector<FCMSG> rec;
+        FCMSG m;
+        int v[10];
+        while (str>>v[0])
+        {
+            for(int k=1;k<10;k++)
+                str>>v[k];
+            if (str.fail())
+            {
+                fprintf(stderr, "Malformed line %d of the replay file %s\n", (int)replay.size()+1, fileName.c_str());
+                return false;
+            }
+
+            m.id=v[0];
+            m.len=v[1];
+            for(int k=0;k<8;k++)
+                m.data[k]=(unsigned char)v[k+2];
+            rec.push_back(m);
+        }
+        replay.push_back(rec);
+    }
+
+    if (replay.empty())
+    {
+        fprintf(stderr, "The replay file %s is empty\n", fileName.c_str());
+        return false;
+    }
+
+    cerr<<"Replaying "<<replay.size()<<" reads from "<<fileName<<endl;
+    return true;
+}
+
 bool FakeCan::close()
 {
     cerr<<"Closing FakeCan network" << endl;
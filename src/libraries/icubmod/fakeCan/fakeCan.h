@@ -17,6 +17,8 @@
 
 #include <memory.h>
 #include <list>
+#include <string>
+#include <vector>
 
 namespace yarp
 {
@@ -98,6 +100,12 @@ typedef std::list<FakeBoard *>::const_iterator BoardsConstIt;
  * The behavior of the fake boards is very simplified, this module
  * is not simulating a real robot.
  *
+ * Alternatively, the bus can replay a recorded traffic: if the
+ * parameter `replayFile` is given, every call to canRead() returns
+ * the messages of the next line of the file, starting over at the
+ * end. Each line lists the messages read in one cycle, as groups of
+ * 10 integers: id, length and the 8 data bytes.
+ *
  * | YARP device name |
  * |:-----------------:|
  * | `fakecan` |
@@ -109,6 +117,10 @@ class yarp::dev::FakeCan: public ImplementCanBufferFactory<FakeCanMessage, FCMSG
 private:
     Boards boardList;
     MsgList replies;
+    std::vector<std::vector<FCMSG> > replay;   // recorded messages, one list per read
+    size_t replayIndex;
+
+    bool loadReplay(const std::string &fileName);
 public:
     FakeCan();
     ~FakeCan();
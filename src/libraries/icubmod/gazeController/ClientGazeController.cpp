@@ -1090,6 +1090,97 @@ bool ClientGazeController::triangulate3DPoint(const Vector &pxl, const Vector &p
 }
 
 
+/************************************************************************/
+bool ClientGazeController::getPointsHelper(const Bottle &command, const int width,
+                                           Matrix &m)
+{
+    Bottle reply;
+    if (!portRpc.write(command,reply))
+    {
+        yError("unable to get reply from server!");
+        return false;
+    }
+
+    if ((reply.get(0).asVocab32()==GAZECTRL_ACK) && (reply.size()>1))
+    {
+        if (Bottle *bPoints=reply.get(1).asList())
+        {
+            m.resize(bPoints->size()/width,width);
+            double *p=m.data();
+            for (size_t i=0; i<m.rows()*m.cols(); i++)
+                p[i]=bPoints->get(i).asFloat64();
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/************************************************************************/
+bool ClientGazeController::get2DPixels(const int camSel, const Matrix &x,
+                                       Matrix &px)
+{
+    if (!connected || (x.cols()<3))
+        return false;
+
+    Bottle command;
+    command.addString("get");
+    command.addString("2D");
+    Bottle &bOpt=command.addList();
+    bOpt.addString((camSel==0)?"left":"right");
+    Bottle &bPoints=bOpt.addList();
+    for (size_t i=0; i<x.rows(); i++)
+        for (int j=0; j<3; j++)
+            bPoints.addFloat64(x(i,j));
+
+    return getPointsHelper(command,2,px);
+}
+
+
+/************************************************************************/
+bool ClientGazeController::get3DPoints(const int camSel, const Matrix &pxz,
+                                       Matrix &x)
+{
+    if (!connected || (pxz.cols()<3))
+        return false;
+
+    Bottle command;
+    command.addString("get");
+    command.addString("3D");
+    command.addString("mono");
+    Bottle &bOpt=command.addList();
+    bOpt.addString((camSel==0)?"left":"right");
+    Bottle &bPoints=bOpt.addList();
+    for (size_t i=0; i<pxz.rows(); i++)
+        for (int j=0; j<3; j++)
+            bPoints.addFloat64(pxz(i,j));
+
+    return getPointsHelper(command,3,x);
+}
+
+
+/************************************************************************/
+bool ClientGazeController::triangulate3DPoints(const Matrix &pxlr, Matrix &x)
+{
+    if (!connected || (pxlr.cols()<4))
+        return false;
+
+    Bottle command;
+    command.addString("get");
+    command.addString("3D");
+    command.addString("stereo");
+    Bottle &bOpt=command.addList();
+    Bottle &bPoints=bOpt.addList();
+    for (size_t i=0; i<pxlr.rows(); i++)
+        for (int j=0; j<4; j++)
+            bPoints.addFloat64(pxlr(i,j));
+
+    return getPointsHelper(command,3,x);
+}
+
+
 /************************************************************************/
 bool ClientGazeController::getJointsDesired(Vector &qdes)
 {
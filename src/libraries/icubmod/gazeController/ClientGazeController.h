@@ -100,6 +100,7 @@ protected:
     bool clearJoint(const std::string &joint);
     void eventHandling(yarp::os::Bottle &event);
     bool getInfoHelper(yarp::os::Bottle &info);
+    bool getPointsHelper(const yarp::os::Bottle &command, const int width, yarp::sig::Matrix &m);
 
 public:
     ClientGazeController();
@@ -142,6 +143,12 @@ public:
     bool get3DPointFromAngles(const int mode, const yarp::sig::Vector &ang, yarp::sig::Vector &x);
     bool getAnglesFrom3DPoint(const yarp::sig::Vector &x, yarp::sig::Vector &ang);
     bool triangulate3DPoint(const yarp::sig::Vector &pxl, const yarp::sig::Vector &pxr, yarp::sig::Vector &x);
+
+    // batch versions taking and returning one point per row
+    bool get2DPixels(const int camSel, const yarp::sig::Matrix &x, yarp::sig::Matrix &px);
+    bool get3DPoints(const int camSel, const yarp::sig::Matrix &pxz, yarp::sig::Matrix &x);
+    bool triangulate3DPoints(const yarp::sig::Matrix &pxlr, yarp::sig::Matrix &x);
+
     bool getJointsDesired(yarp::sig::Vector &qdes);
     bool getJointsVelocities(yarp::sig::Vector &qdot);
     bool getStereoOptions(yarp::os::Bottle &options);
@@ -25,6 +25,7 @@
 #ifndef __DINCONT_H__
 #define __DINCONT_H__
 
+#include <vector>
 #include <yarp/os/Portable.h>
 #include <yarp/sig/Vector.h>
 #include <yarp/sig/Matrix.h>
@@ -84,6 +85,10 @@ protected:
         const yarp::sig::Vector &_Mu=yarp::sig::Vector(0), const yarp::sig::Vector &_Fdir=yarp::sig::Vector(0));
     bool checkVectorDim(const yarp::sig::Vector &v, unsigned int dim, const std::string &descr="");
 
+    // raw copies from/to the buffers of the compact binary format
+    static void appendBytes(std::vector<char> &buf, const void *data, size_t n);
+    static bool parseBytes(const char *&data, const char *end, void *out, size_t n);
+
 public:
     //~~~~~~~~~~~~~~~~~~~~~~
     //   CONSTRUCTORS
@@ -308,6 +313,22 @@ public:
     */
     virtual bool write(yarp::os::ConnectionWriter& connection) const override;
 
+    /**
+    * Append this contact to a buffer in the compact binary format
+    * (see dynContactList::setBinaryFormat()), i.e. a fixed-size block of:
+    * - 3 int32, i.e. contactId, bodyPart, linkNumber
+    * - 9 float64, i.e. the CoP, the force and the moment
+    * @param buf the buffer to append to
+    */
+    virtual void appendBinary(std::vector<char> &buf) const;
+    /**
+    * Parse a contact written by appendBinary().
+    * @param data pointer to the contact, moved past it on success
+    * @param end pointer past the end of the buffer
+    * @return true iff a contact was parsed correctly
+    */
+    virtual bool parseBinary(const char *&data, const char *end);
+
     
     /**
      * Convert this contact into a string. Useful to print some information.
@@ -26,9 +26,15 @@
 #define __DYNCONTLIST_H__
 
 #include <vector>
+#include <yarp/os/Vocab.h>
 #include <yarp/os/Portable.h>
 #include "iCub/skinDynLib/dynContact.h"
 
+#define DYNCONTACTLIST_MAGIC      yarp::os::createVocab32('d','c','l','b')
+#define DYNCONTACTLIST_VERSION    1
+// size in bytes of a dynContact in the binary format (3 int32 and 9 float64)
+#define DYNCONTACT_BINARY_SIZE    (3*4+9*8)
+
 namespace iCub
 {
 namespace skinDynLib
@@ -38,11 +44,31 @@ namespace skinDynLib
 * @ingroup skinDynLib 
 *  
 * Class representing a list of external contacts.
+*
+* By default the list is written as a list of dynContacts (Bottle format),
+* which any client can read. Alternatively (see setBinaryFormat()) it
+* can be written in a compact binary format:
+* \code
+* int32   magic    ('dclb' vocab)
+* int32   version  (DYNCONTACTLIST_VERSION)
+* int32   number of contacts
+* int32   size of the block of contacts (in bytes)
+* char    contacts[size]  (see dynContact::appendBinary())
+* \endcode
+* where integers and doubles follow the native little-endian encoding
+* used by YARP. read() accepts both formats, so the binary one can be
+* enabled on a stream as soon as all its readers have been updated.
+* Text-mode connections always get the Bottle format.
 */
 class dynContactList : public std::vector<dynContact>, public yarp::os::Portable
 {
 protected:
-    
+    bool binaryFormat;                  // true if write() uses the compact binary format
+    std::vector<char> buffer;           // contacts read in the compact binary format (kept across calls)
+
+    bool readBinary(yarp::os::ConnectionReader& connection);
+    bool writeBinary(yarp::os::ConnectionWriter& connection) const;
+
 public:
     //~~~~~~~~~~~~~~~~~~~~~~
     //   CONSTRUCTORS
@@ -54,8 +80,21 @@ public:
     //~~~~~~~~~~~~~~~~~~~~~~~~~
     //   SERIALIZATION methods
     //~~~~~~~~~~~~~~~~~~~~~~~~~
+    /**
+    * Select the format used by write(): the compact binary one if true,
+    * otherwise the Bottle one (default), readable also by old clients.
+    * @param binary true for the compact binary format
+    */
+    void setBinaryFormat(bool binary){ binaryFormat = binary; }
+
+    /**
+    * @return true if write() uses the compact binary format
+    */
+    bool isBinaryFormat() const{ return binaryFormat; }
+
     /*
-    * Read dynContactList from a connection.
+    * Read dynContactList from a connection, in either format. The contacts
+    * already in the list are reused.
     * return true iff a dynContactList was read correctly
     */
     virtual bool read(yarp::os::ConnectionReader& connection);
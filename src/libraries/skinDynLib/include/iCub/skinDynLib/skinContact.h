@@ -255,6 +255,28 @@ public:
     */
     virtual bool write(yarp::os::ConnectionWriter& connection) const override;
 
+    /**
+    * Append this skinContact to a buffer in the compact binary format
+    * (see skinContactList::setBinaryFormat()), i.e.:
+    * - the fixed-size block of dynContact::appendBinary()
+    * - 1 int32, i.e. the skin part
+    * - 7 float64, i.e. the geometric center, the normal direction and the pressure
+    * - the active taxel ids, as a coding byte followed by the number of ids
+    *   and either the differences between consecutive ids (zigzag varints)
+    *   or, if it is smaller and the ids are strictly ascending, the first id
+    *   and a bitmap of the following ones
+    * @param buf the buffer to append to
+    */
+    virtual void appendBinary(std::vector<char> &buf) const override;
+    /**
+    * Parse a skinContact written by appendBinary(). The taxel list is
+    * resized in place, hence its storage is reused.
+    * @param data pointer to the contact, moved past it on success
+    * @param end pointer past the end of the buffer
+    * @return true iff a skinContact was parsed correctly
+    */
+    virtual bool parseBinary(const char *&data, const char *end) override;
+
     /**
     * Convert this skinContact to a vector. The size of the vector is 21 plus
     * the number of active taxels. The vector contains this data, in this order:
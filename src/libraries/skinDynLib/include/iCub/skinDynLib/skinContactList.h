@@ -27,10 +27,17 @@
 
 #include <vector>
 #include <map>
+#include <yarp/os/Vocab.h>
 #include <yarp/os/Portable.h>
 #include "iCub/skinDynLib/skinContact.h"
 #include "iCub/skinDynLib/dynContactList.h"
 
+#define SKINCONTACTLIST_MAGIC      yarp::os::createVocab32('s','c','l','b')
+#define SKINCONTACTLIST_VERSION    1
+// minimum size in bytes of a skinContact in the binary format: the dynContact
+// block, 1 int32 and 7 float64, the taxel ids coding byte and their number
+#define SKINCONTACT_BINARY_MIN_SIZE    (DYNCONTACT_BINARY_SIZE+4+7*8+2)
+
 namespace iCub
 {
 namespace skinDynLib
@@ -40,11 +47,31 @@ namespace skinDynLib
 * @ingroup skinDynLib 
 *  
 * Class representing a list of external contacts acting on the iCub' skin.
+*
+* By default the list is written as a list of skinContacts (Bottle format),
+* which any client can read. Alternatively (see setBinaryFormat()) it
+* can be written in a compact binary format:
+* \code
+* int32   magic    ('sclb' vocab)
+* int32   version  (SKINCONTACTLIST_VERSION)
+* int32   number of contacts
+* int32   size of the block of contacts (in bytes)
+* char    contacts[size]  (see skinContact::appendBinary())
+* \endcode
+* where integers and doubles follow the native little-endian encoding
+* used by YARP. read() accepts both formats, so the binary one can be
+* enabled on a stream as soon as all its readers have been updated.
+* Text-mode connections always get the Bottle format.
 */
 class skinContactList  : public std::vector<skinContact>, public yarp::os::Portable
 {
 protected:
-    
+    bool binaryFormat;                  // true if write() uses the compact binary format
+    std::vector<char> buffer;           // contacts read in the compact binary format (kept across calls)
+
+    bool readBinary(yarp::os::ConnectionReader& connection);
+    bool writeBinary(yarp::os::ConnectionWriter& connection) const;
+
 public:
     //~~~~~~~~~~~~~~~~~~~~~~
     //   CONSTRUCTORS
@@ -73,8 +100,21 @@ public:
     //~~~~~~~~~~~~~~~~~~~~~~~~~
     //   SERIALIZATION methods
     //~~~~~~~~~~~~~~~~~~~~~~~~~
+    /**
+    * Select the format used by write(): the compact binary one if true,
+    * otherwise the Bottle one (default), readable also by old clients.
+    * @param binary true for the compact binary format
+    */
+    void setBinaryFormat(bool binary){ binaryFormat = binary; }
+
+    /**
+    * @return true if write() uses the compact binary format
+    */
+    bool isBinaryFormat() const{ return binaryFormat; }
+
     /*
-    * Read skinContactList from a connection.
+    * Read skinContactList from a connection, in either format. The contacts
+    * already in the list are reused.
     * return true iff a skinContactList was read correctly
     */
     virtual bool read(yarp::os::ConnectionReader& connection);
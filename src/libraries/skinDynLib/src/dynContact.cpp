@@ -9,6 +9,8 @@
 #include <sstream>
 #include <iomanip>
 #include <string>
+#include <cstring>
+#include <cstdint>
 #include "stdio.h"
 
 #include <yarp/os/ConnectionReader.h>
@@ -260,6 +262,44 @@ bool dynContact::read(ConnectionReader& connection){
     return !connection.isError();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void dynContact::appendBinary(vector<char> &buf) const{
+    // fixed-size block of 3 int32 (contactId, bodyPart, linkNumber)
+    // and 9 float64 (CoP, force, moment), in native byte order
+    int32_t ids[3] = { (int32_t)contactId, (int32_t)bodyPart, (int32_t)linkNumber };
+    appendBytes(buf, ids, sizeof(ids));
+    appendBytes(buf, CoP.data(), 3*sizeof(double));
+    appendBytes(buf, F.data(), 3*sizeof(double));
+    appendBytes(buf, Mu.data(), 3*sizeof(double));
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool dynContact::parseBinary(const char *&data, const char *end){
+    int32_t ids[3];
+    if(!parseBytes(data, end, ids, sizeof(ids)))
+        return false;
+    contactId   = ids[0];
+    bodyPart    = (BodyPart)ids[1];
+    linkNumber  = ids[2];
+    if(!parseBytes(data, end, CoP.data(), 3*sizeof(double)) ||
+       !parseBytes(data, end, F.data(), 3*sizeof(double)) ||
+       !parseBytes(data, end, Mu.data(), 3*sizeof(double)))
+        return false;
+    setForce(F);
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void dynContact::appendBytes(vector<char> &buf, const void *data, size_t n){
+    const char *d = (const char*)data;
+    buf.insert(buf.end(), d, d+n);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool dynContact::parseBytes(const char *&data, const char *end, void *out, size_t n){
+    if((size_t)(end-data) < n)
+        return false;
+    memcpy(out, data, n);
+    data += n;
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 string dynContact::toString(int precision) const{
     stringstream res;
     res<< "Contact id: "<< contactId<< ", Body part: "<< BodyPart_s[bodyPart]<< ", link: "<< linkNumber<< ", CoP: "<< 
@@ -21,10 +21,10 @@ using namespace iCub::skinDynLib;
 
 
 dynContactList::dynContactList()
-:vector<dynContact>(){}
+:vector<dynContact>(), binaryFormat(false){}
 
 dynContactList::dynContactList(const size_type &n, const dynContact& value)
-:vector<dynContact>(n, value){}
+:vector<dynContact>(n, value), binaryFormat(false){}
 
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -34,7 +34,10 @@ bool dynContactList::read(ConnectionReader& connection)
 {
     // A dynContactList is represented as a list of list
     // where each list is a skinContact
-    if(connection.expectInt32()!=BOTTLE_TAG_LIST)
+    int tag = connection.expectInt32();
+    if(tag==DYNCONTACTLIST_MAGIC)
+        return readBinary(connection);
+    if(tag!=BOTTLE_TAG_LIST)
         return false;
 
     int listLength = connection.expectInt32();
@@ -52,6 +55,9 @@ bool dynContactList::read(ConnectionReader& connection)
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool dynContactList::write(ConnectionWriter& connection) const
 {
+    if(binaryFormat && !connection.isTextMode())
+        return writeBinary(connection);
+
     // A dynContactList is represented as a list of list
     // where each list is a skinContact
     connection.appendInt32(BOTTLE_TAG_LIST);
@@ -64,6 +70,59 @@ bool dynContactList::write(ConnectionWriter& connection) const
     return !connection.isError();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool dynContactList::readBinary(ConnectionReader& connection)
+{
+    // newer versions are supposed to append fields to the header,
+    // which older readers cannot skip safely
+    int version = connection.expectInt32();
+    if(version<1 || version>DYNCONTACTLIST_VERSION)
+        return false;
+
+    int listLength = connection.expectInt32();
+    int bytes = connection.expectInt32();
+    if(listLength<0 || bytes<0)
+        return false;
+
+    // the sizes come from the wire, hence they are checked against
+    // the data actually available before allocating anything
+    if((size_t)bytes>connection.getSize() || listLength>bytes/DYNCONTACT_BINARY_SIZE)
+        return false;
+
+    buffer.resize(bytes);
+    if(bytes>0 && !connection.expectBlock(buffer.data(), bytes))
+        return false;
+
+    if(listLength!=size())
+        resize(listLength);
+
+    const char *data = buffer.data(), *dataEnd = data+bytes;
+    for(iterator it=begin(); it!=end(); it++)
+        if(!it->parseBinary(data, dataEnd))
+            return false;
+
+    return data==dataEnd && !connection.isError();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool dynContactList::writeBinary(ConnectionWriter& connection) const
+{
+    // write() is called once per connection, possibly by concurrent
+    // threads, hence the contacts are encoded into a buffer owned by
+    // the calling thread and copied into the connection
+    static thread_local vector<char> block;
+    block.clear();
+    for(auto it=begin(); it!=end(); it++)
+        it->appendBinary(block);
+
+    connection.appendInt32(DYNCONTACTLIST_MAGIC);
+    connection.appendInt32(DYNCONTACTLIST_VERSION);
+    connection.appendInt32(size());
+    connection.appendInt32((int)block.size());
+    if(!block.empty())
+        connection.appendBlock(block.data(), block.size());
+
+    return !connection.isError();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 string dynContactList::toString(const int &precision) const{
     stringstream ss;
     for(const_iterator it=begin();it!=end();it++)
@@ -8,6 +8,7 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <cstdint>
 #include <yarp/os/ConnectionReader.h>
 #include <yarp/os/ConnectionWriter.h>
 #include <yarp/math/Math.h>
@@ -19,6 +20,42 @@ using namespace yarp::sig;
 using namespace yarp::os;
 using namespace std;
 
+namespace
+{
+    // coding of the taxel ids in the compact binary format
+    enum TaxelIdCoding { TAXEL_IDS_DELTA=0, TAXEL_IDS_BITMAP=1 };
+
+    inline uint32_t zigzag(uint32_t delta){ return (delta<<1) ^ (uint32_t)(-(int32_t)(delta>>31)); }
+    inline uint32_t unzigzag(uint32_t z){ return (z>>1) ^ (uint32_t)(-(int32_t)(z&1)); }
+
+    inline size_t varintSize(uint32_t v){
+        size_t n = 1;
+        while(v>=0x80){ v>>=7; n++; }
+        return n;
+    }
+
+    inline void appendVarint(vector<char> &buf, uint32_t v){
+        while(v>=0x80){
+            buf.push_back((char)(v|0x80));
+            v >>= 7;
+        }
+        buf.push_back((char)v);
+    }
+
+    inline bool parseVarint(const char *&data, const char *end, uint32_t &v){
+        v = 0;
+        for(int shift=0; shift<35; shift+=7){
+            if(data==end)
+                return false;
+            uint8_t b = (uint8_t)*data++;
+            v |= (uint32_t)(b&0x7f)<<shift;
+            if(!(b&0x80))
+                return true;
+        }
+        return false;
+    }
+}
+
 //~~~~~~~~~~~~~~~~~~~~~~
 //   CONSTRUCTORS
 //~~~~~~~~~~~~~~~~~~~~~~
@@ -217,6 +254,117 @@ bool skinContact::read(ConnectionReader& connection){
     return !connection.isError();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void skinContact::appendBinary(vector<char> &buf) const{
+    dynContact::appendBinary(buf);
+
+    // fixed-size block of 1 int32 (skinPart) and 7 float64 (geometric center, normal direction, pressure)
+    int32_t sp = skinPart;
+    appendBytes(buf, &sp, sizeof(sp));
+    appendBytes(buf, geoCenter.data(), 3*sizeof(double));
+    appendBytes(buf, normalDir.data(), 3*sizeof(double));
+    appendBytes(buf, &pressure, sizeof(pressure));
+
+    // active taxel ids: pick the smaller coding between deltas and bitmap
+    const unsigned int n = activeTaxels;
+    size_t deltaBytes = 0;
+    bool ascending = true;
+    uint32_t prev = 0;
+    for(unsigned int i=0; i<n; i++){
+        deltaBytes += varintSize(zigzag(taxelList[i]-prev));
+        if(i>0 && taxelList[i]<=prev)
+            ascending = false;
+        prev = taxelList[i];
+    }
+    size_t bitmapBytes = 0;
+    bool bitmap = false;
+    if(ascending && n>0){
+        bitmapBytes = (taxelList[n-1]-taxelList[0])/8+1;
+        bitmap = varintSize(taxelList[0])+varintSize((uint32_t)bitmapBytes)+bitmapBytes < deltaBytes;
+    }
+
+    buf.push_back((char)(bitmap ? TAXEL_IDS_BITMAP : TAXEL_IDS_DELTA));
+    appendVarint(buf, n);
+    if(bitmap){
+        const uint32_t first = taxelList[0];
+        appendVarint(buf, first);
+        appendVarint(buf, (uint32_t)bitmapBytes);
+        size_t start = buf.size();
+        buf.resize(start+bitmapBytes, 0);
+        for(unsigned int i=0; i<n; i++){
+            uint32_t k = taxelList[i]-first;
+            buf[start+k/8] |= (char)(1<<(k%8));
+        }
+    }
+    else{
+        prev = 0;
+        for(unsigned int i=0; i<n; i++){
+            appendVarint(buf, zigzag(taxelList[i]-prev));
+            prev = taxelList[i];
+        }
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinContact::parseBinary(const char *&data, const char *end){
+    if(!dynContact::parseBinary(data, end))
+        return false;
+
+    int32_t sp;
+    if(!parseBytes(data, end, &sp, sizeof(sp)) ||
+       !parseBytes(data, end, geoCenter.data(), 3*sizeof(double)) ||
+       !parseBytes(data, end, normalDir.data(), 3*sizeof(double)) ||
+       !parseBytes(data, end, &pressure, sizeof(pressure)))
+        return false;
+    skinPart = (SkinPart)sp;
+
+    if(data==end)
+        return false;
+    const uint8_t coding = (uint8_t)*data++;
+    uint32_t n;
+    if(!parseVarint(data, end, n))
+        return false;
+
+    if(coding==TAXEL_IDS_BITMAP){
+        uint32_t first, bytes;
+        if(!parseVarint(data, end, first) || !parseVarint(data, end, bytes) ||
+           (size_t)(end-data)<bytes || n>8*(size_t)bytes)
+            return false;
+        taxelList.resize(n);
+        activeTaxels = n;
+        unsigned int i = 0;
+        for(uint32_t b=0; b<bytes; b++){
+            uint8_t bits = (uint8_t)data[b];
+            for(uint32_t k=0; bits!=0; k++, bits>>=1){
+                if(bits&1){
+                    if(i==n)
+                        return false;
+                    taxelList[i++] = first+8*b+k;
+                }
+            }
+        }
+        data += bytes;
+        if(i!=n)
+            return false;
+    }
+    else if(coding==TAXEL_IDS_DELTA){
+        // every id takes at least one byte
+        if((size_t)(end-data)<n)
+            return false;
+        taxelList.resize(n);
+        activeTaxels = n;
+        uint32_t prev = 0, z;
+        for(unsigned int i=0; i<n; i++){
+            if(!parseVarint(data, end, z))
+                return false;
+            prev += unzigzag(z);
+            taxelList[i] = prev;
+        }
+    }
+    else
+        return false;
+
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 Vector skinContact::toVector() const{
     Vector v(activeTaxels+21);
     unsigned int index = 0;
@@ -25,10 +25,10 @@ using namespace iCub::skinDynLib;
 //   CONSTRUCTORS
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 skinContactList::skinContactList()
-:vector<skinContact>(){}
+:vector<skinContact>(), binaryFormat(false){}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 skinContactList::skinContactList(const size_type &n, const skinContact& value)
-:vector<skinContact>(n, value){}
+:vector<skinContact>(n, value), binaryFormat(false){}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 skinContactList skinContactList::filterBodyPart(const BodyPart &bp)
 {
@@ -61,7 +61,10 @@ bool skinContactList::read(ConnectionReader& connection)
 {
     // A skinContactList is represented as a list of list
     // where each list is a skinContact
-    if(connection.expectInt32()!=BOTTLE_TAG_LIST)
+    int tag = connection.expectInt32();
+    if(tag==SKINCONTACTLIST_MAGIC)
+        return readBinary(connection);
+    if(tag!=BOTTLE_TAG_LIST)
         return false;
 
     int listLength = connection.expectInt32();
@@ -79,6 +82,9 @@ bool skinContactList::read(ConnectionReader& connection)
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool skinContactList::write(ConnectionWriter& connection) const
 {
+    if(binaryFormat && !connection.isTextMode())
+        return writeBinary(connection);
+
     // A skinContactList is represented as a list of list
     // where each list is a skinContact
     connection.appendInt32(BOTTLE_TAG_LIST);
@@ -91,9 +97,63 @@ bool skinContactList::write(ConnectionWriter& connection) const
     return !connection.isError();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinContactList::readBinary(ConnectionReader& connection)
+{
+    // newer versions are supposed to append fields to the header,
+    // which older readers cannot skip safely
+    int version = connection.expectInt32();
+    if(version<1 || version>SKINCONTACTLIST_VERSION)
+        return false;
+
+    int listLength = connection.expectInt32();
+    int bytes = connection.expectInt32();
+    if(listLength<0 || bytes<0)
+        return false;
+
+    // the sizes come from the wire, hence they are checked against
+    // the data actually available before allocating anything
+    if((size_t)bytes>connection.getSize() || listLength>bytes/SKINCONTACT_BINARY_MIN_SIZE)
+        return false;
+
+    buffer.resize(bytes);
+    if(bytes>0 && !connection.expectBlock(buffer.data(), bytes))
+        return false;
+
+    if(listLength!=size())
+        resize(listLength);
+
+    const char *data = buffer.data(), *dataEnd = data+bytes;
+    for(iterator it=begin(); it!=end(); it++)
+        if(!it->parseBinary(data, dataEnd))
+            return false;
+
+    return data==dataEnd && !connection.isError();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool skinContactList::writeBinary(ConnectionWriter& connection) const
+{
+    // write() is called once per connection, possibly by concurrent
+    // threads, hence the contacts are encoded into a buffer owned by
+    // the calling thread and copied into the connection
+    static thread_local vector<char> block;
+    block.clear();
+    for(auto it=begin(); it!=end(); it++)
+        it->appendBinary(block);
+
+    connection.appendInt32(SKINCONTACTLIST_MAGIC);
+    connection.appendInt32(SKINCONTACTLIST_VERSION);
+    connection.appendInt32(size());
+    connection.appendInt32((int)block.size());
+    if(!block.empty())
+        connection.appendBlock(block.data(), block.size());
+
+    return !connection.isError();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 dynContactList skinContactList::toDynContactList() const
 {
     dynContactList res(this->size());
+    res.setBinaryFormat(binaryFormat);
     const_iterator itSkin = begin();
     for(dynContactList::iterator itDyn=res.begin(); itDyn!=res.end(); itDyn++)
     {
@@ -198,7 +198,8 @@ gravityCompensatorThread::gravityCompensatorThread(string _wholeBodyName, int _r
                                                                              gravity_torques_LL(6,0.0), gravity_torques_RL(6,0.0),
                                                                              exec_torques_TO(3,0.0), exec_torques_LL(6,0.0),
                                                                              exec_torques_RL(6,0.0), externalcmd_torques_TO(3,0.0),
-                                                                             externalcmd_torques_LL(6,0.0), externalcmd_torques_RL(6,0.0)
+                                                                             externalcmd_torques_LL(6,0.0), externalcmd_torques_RL(6,0.0),
+                                                                             timing({"input","dynamics","commands","output"},(double)_rate/1000.0)
 {
     gravity_mode = GRAVITY_COMPENSATION_ON;
     external_mode = EXTERNAL_TRQ_ON;
@@ -655,6 +656,7 @@ void gravityCompensatorThread::run()
     static int delay_check=0;
     if(isCalibrated)
     {
+        timing.beginCycle();
         if (!readAndUpdate(false))
         {
             delay_check++;
@@ -669,6 +671,7 @@ void gravityCompensatorThread::run()
         {
             delay_check = 0;
         }
+        timing.mark(STAGE_INPUT);
 
         Vector F_up(6,0.0);
         icub->upperTorso->setInertialMeasure(w0,dw0,d2p0);
@@ -694,6 +697,7 @@ void gravityCompensatorThread::run()
         Matrix F_sens_low = icub->lowerTorso->estimateSensorsWrench(F_ext_low,false);
         gravity_torques_LL = icub->lowerTorso->getTorques("left_leg");
         gravity_torques_RL = icub->lowerTorso->getTorques("right_leg");  
+        timing.mark(STAGE_DYNAMICS);
         
 //#define DEBUG_TORQUES
 #ifdef  DEBUG_TORQUES
@@ -779,6 +783,8 @@ void gravityCompensatorThread::run()
             }
         }
 
+        timing.mark(STAGE_COMMANDS);
+
         //execute the commands
         static yarp::os::Stamp timestamp;
         timestamp.update();
@@ -862,6 +868,8 @@ void gravityCompensatorThread::run()
                 right_leg_gravity_torques->write();
             }
         }
+        timing.mark(STAGE_OUTPUT);
+        timing.endCycle();
     }
     else
     {
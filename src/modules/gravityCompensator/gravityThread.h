@@ -29,6 +29,7 @@
 #include <yarp/dev/PolyDriver.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
 #include <iCub/ctrl/adaptWinPolyEstimator.h>
+#include <iCub/ctrl/timingProbe.h>
 #include <iCub/iDyn/iDyn.h>
 #include <iCub/iDyn/iDynBody.h>
 
@@ -41,6 +42,7 @@ using namespace iCub::iDyn;
 enum thread_status_enum {STATUS_OK=0, STATUS_DISCONNECTED}; 
 enum{GRAVITY_COMPENSATION_OFF = 0, GRAVITY_COMPENSATION_ON = 1};
 enum{EXTERNAL_TRQ_OFF = 0, EXTERNAL_TRQ_ON = 1};
+enum stage_enum {STAGE_INPUT=0, STAGE_DYNAMICS, STAGE_COMMANDS, STAGE_OUTPUT, STAGE_NUM};
 
 class gravityCompensatorThread: public yarp::os::PeriodicThread
 {
@@ -150,6 +152,9 @@ private:
     Vector ampli_LA, ampli_RA, ampli_LL, ampli_RL, ampli_TO;
     bool isCalibrated;
     bool inertial_enabled;
+
+    // time spent in each stage of run()
+    TimingProbe timing;
     
     Vector evalVelUp(const Vector &x);
     Vector evalVelLow(const Vector &x);
@@ -182,6 +187,11 @@ public:
         return thread_status;
     }
 
+    inline TimingProbe &getTimingProbe()
+    {
+        return timing;
+    }
+
 };
 
 #endif
@@ -34,6 +34,10 @@ http://wiki.icub.org/wiki/Force_Control
 --no_legs
 - This option disables the gravity compensation for the legs joints.
 
+--timing_log_dir \e dir
+- The directory where the "timing log <file>" rpc command creates
+  its binary log; if not specified, the command is refused.
+
 \section portsa_sec Ports Accessed
 The port the service is listening to.
 
@@ -370,6 +374,7 @@ public:
         //--------------------------THREAD--------------------------
 
         g_comp = new gravityCompensatorThread(wholeBodyName, rate, dd_left_arm, dd_right_arm, dd_head, dd_left_leg, dd_right_leg, dd_torso, icub_type, inertial_enabled);
+        g_comp->getTimingProbe().setLogDir(rf.check("timing_log_dir",Value("")).asString());
         yInfo("ft thread istantiated...\n");
         g_comp->start();
         yInfo("thread started\n");
@@ -412,7 +417,9 @@ public:
                             "gravity_on   to enabl e the gravity compensation \n" + 
                             "gravity_off  to disbale the gravity compensation \n" +
                             "external_on  to enable the external input torque \n" +
-                            "external_off to disable the external input torque \n";
+                            "external_off to disable the external input torque \n" +
+                            "timing       to get the time spent in each stage of the loop \n" +
+                            "             [hist <stage>|reset|log <file>|log off] \n";
 
           reply.clear(); 
         if (command.get(0).asString()=="help")
@@ -454,6 +461,11 @@ public:
                 reply.addString("external input off");
             }
         }
+        else if (command.get(0).asString()=="timing")
+        {
+            if (g_comp)
+                g_comp->getTimingProbe().respond(command,reply);
+        }
         else
         {
             reply.addString("unknown command. type help.");
@@ -546,6 +558,7 @@ int main(int argc, char * argv[])
         yInfo() << "--gravity_off      disables gravity compensation";
         yInfo() << "--external_on      enables external torque command (default)";
         yInfo() << "--external_off     disables external torque command";
+        yInfo() << "--timing_log_dir   the directory of the binary log of the timing";
         return 0;
     }
 
@@ -32,6 +32,7 @@
 
 #include <iCub/ctrl/minJerkCtrl.h>
 #include <iCub/ctrl/pids.h>
+#include <iCub/ctrl/timingProbe.h>
 #include <iCub/utils.h>
 
 constexpr int32_t GAZECTRL_SWOFFCOND_DISABLESLOT   = 10;      // [-]
@@ -105,9 +106,14 @@ protected:
     double q_stamp;
     double Ts;
 
+    // stages of run() monitored by the timing probe
+    enum { STAGE_INPUT=0, STAGE_SWITCHING, STAGE_CONTROL, STAGE_COMMANDS, STAGE_OUTPUT };
+    TimingProbe timing;
+
     Matrix lim;
     Vector qddeg,qdeg,vdeg;
     Vector v,vNeck,vEyes;
+    Vector qHistory;
     Vector q0,qd,qdNeck,qdEyes;
     Vector fbTorso,fbHead,fbNeck,fbEyes;
     vector<int> neckJoints,eyesJoints;
@@ -161,6 +167,7 @@ public:
     bool   registerMotionOngoingEvent(const double checkPoint);
     bool   unregisterMotionOngoingEvent(const double checkPoint);
     Bottle listMotionOngoingEvents();
+    TimingProbe &getTimingProbe() { return timing; }
 };
 
 
@@ -38,6 +38,19 @@ using namespace iCub::ctrl;
 using namespace iCub::iKin;
 
 
+// The eye kinematics along with the projection matrices
+// computed for a given configuration of the joints.
+struct EyeCache
+{
+    Vector q;           // joints the cache refers to
+    Matrix H;           // eye frame wrt the root frame
+    Matrix invH;        // root frame wrt the eye frame
+    Matrix PrjInvH;     // 3x4 projection of root points
+    Matrix HInvPrj;     // 3x3 back-projection of pixels
+    bool   valid;
+};
+
+
 // The thread launched by the application which is
 // in charge of localizing target 3D position from
 // image coordinates.
@@ -68,6 +81,20 @@ protected:
     parallelPID *pid;
     string dominantEye;
 
+    // kinematics are recomputed only when the joints change,
+    // so that bursts of requests share the same matrices
+    EyeCache cacheL, cacheR;
+    Vector   qCache, qStamp;
+
+    bool      readJoints(const double stamp, double *q);
+    EyeCache *updateEyeCache(const bool isLeft, const double *q);
+    EyeCache *updateEyeCache(const bool isLeft, const double stamp=-1.0);
+    void      invalidateEyeCache();
+    bool      project(const EyeCache &cache, const double *x, double *px) const;
+    void      backProject(const EyeCache &cache, const double u, const double v,
+                          const double z, double *x) const;
+    bool      triangulate(const double *pxl, const double *pxr, double *x) const;
+
     void handleMonocularInput();
     void handleStereoInput();
     void handleAnglesInput();
@@ -80,16 +107,26 @@ public:
     double getDistFromVergence(const double ver);
     void   getPidOptions(Bottle &options);
     void   setPidOptions(const Bottle &options);
-    bool   projectPoint(const string &type, const Vector &x, Vector &px);
+    // a non-negative stamp selects the joints
+    // configuration at that time from the history
+    bool   projectPoint(const string &type, const Vector &x, Vector &px,
+                        const double stamp=-1.0);
     bool   projectPoint(const string &type, const double u, const double v,
-                        const double z, Vector &x);
+                        const double z, Vector &x, const double stamp=-1.0);
     bool   projectPoint(const string &type, const double u, const double v,
-                        const Vector &plane, Vector &x);
-    bool   triangulatePoint(const Vector &pxl, const Vector &pxr, Vector &x);
+                        const Vector &plane, Vector &x, const double stamp=-1.0);
+    bool   triangulatePoint(const Vector &pxl, const Vector &pxr, Vector &x,
+                            const double stamp=-1.0);
+    bool   projectPoints(const string &type, const Matrix &x, Matrix &px,
+                         const double stamp=-1.0);
+    bool   backProjectPoints(const string &type, const Matrix &uvz, Matrix &x,
+                             const double stamp=-1.0);
+    bool   triangulatePoints(const Matrix &pxlr, Matrix &x, const double stamp=-1.0);
     Vector getAbsAngles(const Vector &x);
     Vector get3DPoint(const string &type, const Vector &ang);
     bool   getIntrinsicsMatrix(const string &type, Matrix &M, int &w, int &h);
     bool   setIntrinsicsMatrix(const string &type, const Matrix &M, const int w, const int h);
+    bool   setExtrinsicsMatrix(const string &type, const Matrix &M);
     bool   threadInit();
     void   threadRelease();
     void   afterStart(bool s);
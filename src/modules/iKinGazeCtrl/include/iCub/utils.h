@@ -31,8 +31,14 @@
 #include <yarp/math/Math.h>
 #include <yarp/math/SVD.h>
 
+#include <iCub/ctrl/seqLock.h>
+#include <iCub/ctrl/stateHistory.h>
 #include <iCub/gazeNlp.h>
 
+#define EXCHANGEDATA_MAXLEN     8
+#define GAZE_HISTORY_DIM        9       // torso (3) + head (6)
+#define GAZE_HISTORY_LENGTH     256
+
 using namespace std;
 using namespace yarp::os;
 using namespace yarp::dev;
@@ -89,17 +95,38 @@ public:
 };
 
 
+// Fixed-size storage of a vector exchanged among components.
+struct ExchangeVector
+{
+    double data[EXCHANGEDATA_MAXLEN];
+    size_t len;
+
+    void   set(const Vector &v);
+    void   get(Vector &v) const;
+    Vector get() const { Vector v; get(v); return v; }
+};
+
+
+// The whole set of data exchanged among components,
+// which is always updated and read in one go.
+struct ExchangeState
+{
+    ExchangeVector xd,qd;
+    ExchangeVector x,q,torso;
+    ExchangeVector v,counterv;
+    double S[16];
+    double x_stamp;
+};
+
+
 // This class handles the data exchange among components.
+// Readers never block: they get consistent snapshots
+// out of a sequence lock with no memory allocation.
 class ExchangeData
 {
 protected:
-    mutex  mtx[8];
-    Vector xd,qd;
-    Vector x,q,torso;
-    Vector v,counterv;
-    Matrix S;
+    SeqLock<ExchangeState> state;
     Vector imu;
-    double x_stamp;
 
 public:
     ExchangeData();
@@ -117,6 +144,7 @@ public:
     void    set_v(const Vector &_v);
     void    set_counterv(const Vector &_counterv);
     void    set_fpFrame(const Matrix &_S);
+    void    set_feedback(const Vector &_q, const Vector &_torso, const Vector &_v);
 
     Vector  get_xd();
     Vector  get_qd();
@@ -127,6 +155,7 @@ public:
     Vector  get_v();
     Vector  get_counterv();
     Matrix  get_fpFrame();
+    void    get_snapshot(ExchangeState &snapshot) const;
 
     std::pair<Vector,bool>  get_gyro();
     std::pair<Vector,bool>  get_accel();
@@ -134,6 +163,7 @@ public:
     string  headVersion2String();
 
     // data members that do not need protection
+    StateHistory    history;        // joints read by the controller
     xdPort         *port_xd;
     string          robotName;
     string          localStemName;
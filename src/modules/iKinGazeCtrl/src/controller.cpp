@@ -31,7 +31,8 @@ Controller::Controller(PolyDriver *_drvTorso, PolyDriver *_drvHead, ExchangeData
                        PeriodicThread((double)_period/1000.0), drvTorso(_drvTorso), drvHead(_drvHead),
                        commData(_commData),                    neckTime(_neckTime), eyesTime(_eyesTime),
                        min_abs_vel(_min_abs_vel),              period(_period),     Ts(_period/1000.0),
-                       printAccTime(0.0)
+                       printAccTime(0.0),
+                       timing({"input","switching","control","commands","output"},_period/1000.0)
 {
     // Instantiate objects
     neck=new iCubHeadCenter("right_"+commData->headVersion2String());
@@ -95,6 +96,7 @@ Controller::Controller(PolyDriver *_drvTorso, PolyDriver *_drvHead, ExchangeData
     // read starting position
     fbTorso.resize(nJointsTorso,0.0);
     fbHead.resize(nJointsHead,0.0);
+    qHistory.resize(commData->history.getDim(),0.0);
 
     // exclude acceleration constraints by fixing
     // thresholds at high values
@@ -122,8 +124,8 @@ Controller::Controller(PolyDriver *_drvTorso, PolyDriver *_drvHead, ExchangeData
     setTeyes(eyesTime);
     setTneck(neckTime);
 
-    mjCtrlNeck=new minJerkVelCtrlForIdealPlant(Ts,(int)fbNeck.length());
-    mjCtrlEyes=new minJerkVelCtrlForIdealPlant(Ts,(int)fbEyes.length());
+    mjCtrlNeck=new minJerkVelCtrlForIdealPlantSoA(Ts,(int)fbNeck.length());
+    mjCtrlEyes=new minJerkVelCtrlForIdealPlantSoA(Ts,(int)fbEyes.length());
     IntState=new Integrator(Ts,fbHead,lim);
     IntPlan=new Integrator(Ts,fbNeck,lim.submatrix(0,2,0,1));
     IntStabilizer=new Integrator(Ts,zeros((int)vNeck.length()));
@@ -642,6 +644,7 @@ bool Controller::getGazeStabilization() const
 void Controller::run()
 {
     lock_guard<mutex> lg(mutexRun);
+    timing.beginCycle();
     
     mutexCtrl.lock();
     bool jointsHealthy=areJointsHealthyAndSet();
@@ -669,11 +672,13 @@ void Controller::run()
     }
     mutexCtrl.unlock();
     
-    // get data
-    double x_stamp;
-    Vector xd=commData->get_xd();
-    Vector x=commData->get_x(x_stamp);
-    qd=commData->get_qd();
+    // get data out of the same solver cycle
+    ExchangeState snapshot;
+    commData->get_snapshot(snapshot);
+    double x_stamp=snapshot.x_stamp;
+    Vector xd=snapshot.xd.get();
+    Vector x=snapshot.x.get();
+    snapshot.qd.get(qd);
 
     // read feedbacks
     q_stamp=Time::now();
@@ -710,10 +715,18 @@ void Controller::run()
         mutexChain.unlock();
     }
 
+    // keep track of the joints for queries about the past
+    for (int i=0; i<3; i++)
+        qHistory[i]=(i<nJointsTorso)?fbTorso[i]:0.0;
+    for (int i=0; i<6; i++)
+        qHistory[3+i]=(i<nJointsHead)?fbHead[i]:0.0;
+    commData->history.push(q_stamp,qHistory);
+
     IntState->reset(fbHead);
 
     fbNeck=fbHead.subVector(0,2);
     fbEyes=fbHead.subVector(3,5);
+    timing.mark(STAGE_INPUT);
 
     double errNeck=norm(qd.subVector(0,2)-fbNeck);
     double errEyes=norm(qd.subVector(3,(unsigned int)qd.length()-1)-fbEyes);
@@ -816,6 +829,7 @@ void Controller::run()
 
     qdNeck=qd.subVector(0,2);
     qdEyes=qd.subVector(3,5);
+    timing.mark(STAGE_SWITCHING);
 
     // compute current point [%] in the path
     double dist=norm(qd-q0);
@@ -899,6 +913,7 @@ void Controller::run()
     qdeg =CTRL_RAD2DEG*fbHead;
     vdeg =CTRL_RAD2DEG*v;
     mutexData.unlock();
+    timing.mark(STAGE_CONTROL);
 
     // send commands to the robot
     if (commData->ctrlActive || stabilizeGaze)
@@ -949,6 +964,7 @@ void Controller::run()
 
         mutexCtrl.unlock();
     }
+    timing.mark(STAGE_COMMANDS);
 
     // print info
     if (commData->verbose)
@@ -991,9 +1007,9 @@ void Controller::run()
 
     // update joints angles
     fbHead=IntState->integrate(v);
-    commData->set_q(fbHead);
-    commData->set_torso(fbTorso);
-    commData->set_v(v);
+    commData->set_feedback(fbHead,fbTorso,v);
+    timing.mark(STAGE_OUTPUT);
+    timing.endCycle();
 }
 
 
@@ -120,6 +120,10 @@ Localizer::Localizer(ExchangeData *_commData, const unsigned int _period) :
     Vector z0(1,0.5);
     pid->reset(z0);
     dominantEye="left";
+
+    qCache.resize(8,0.0);
+    qStamp.resize(commData->history.getDim(),0.0);
+    invalidateEyeCache();
 }
 
 
@@ -293,54 +297,209 @@ Vector Localizer::get3DPoint(const string &type, const Vector &ang)
 
 
 /************************************************************************/
-bool Localizer::projectPoint(const string &type, const Vector &x, Vector &px)
+bool Localizer::readJoints(const double stamp, double *q)
 {
-    lock_guard<mutex> lck(mtx);
-    if (x.length()<3)
+    // q is filled with the 3 torso joints followed by the 6 head joints
+    if (stamp<0.0)
     {
-        yError("Not enough values given for the point!");
+        // torso and head from the same controller cycle
+        ExchangeState snapshot;
+        commData->get_snapshot(snapshot);
+        std::copy(snapshot.torso.data,snapshot.torso.data+3,q);
+        std::copy(snapshot.q.data,snapshot.q.data+6,q+3);
+    }
+    else if (commData->history.get(stamp,qStamp))
+        std::copy(qStamp.data(),qStamp.data()+GAZE_HISTORY_DIM,q);
+    else
+    {
+        yError("No joints state available at stamp %.6f!",stamp);
         return false;
     }
 
-    bool isLeft=(type=="left");
+    return true;
+}
+
+
+/************************************************************************/
+EyeCache *Localizer::updateEyeCache(const bool isLeft, const double stamp)
+{
+    double q[GAZE_HISTORY_DIM];
+    if (!readJoints(stamp,q))
+        return nullptr;
 
-    Matrix  *Prj=(isLeft?PrjL:PrjR);
+    return updateEyeCache(isLeft,q);
+}
+
+
+/************************************************************************/
+EyeCache *Localizer::updateEyeCache(const bool isLeft, const double *q)
+{
+    const double *torso=q;
+    const double *head=q+3;
+
+    qCache[0]=torso[0];
+    qCache[1]=torso[1];
+    qCache[2]=torso[2];
+    qCache[3]=head[0];
+    qCache[4]=head[1];
+    qCache[5]=head[2];
+    qCache[6]=head[3];
+    qCache[7]=head[4]+head[5]/(isLeft?2.0:-2.0);
+
+    EyeCache &cache=(isLeft?cacheL:cacheR);
+    if (cache.valid && std::equal(qCache.begin(),qCache.end(),cache.q.begin()))
+        return &cache;
+
+    Matrix *Prj=(isLeft?PrjL:PrjR);
+    Matrix *invPrj=(isLeft?invPrjL:invPrjR);
     iCubEye *eye=(isLeft?eyeL:eyeR);
 
+    cache.q=qCache;
+    cache.H=eye->getH(qCache);
+    cache.invH=SE3inv(cache.H);
     if (Prj!=nullptr)
     {
-        Vector torso=commData->get_torso();
-        Vector head=commData->get_q();
+        cache.PrjInvH=*Prj*cache.invH;
+        cache.HInvPrj=cache.H.submatrix(0,2,0,2)*invPrj->submatrix(0,2,0,2);
+    }
+    cache.valid=true;
 
-        Vector q(8);
-        q[0]=torso[0];
-        q[1]=torso[1];
-        q[2]=torso[2];
-        q[3]=head[0];
-        q[4]=head[1];
-        q[5]=head[2];
-        q[6]=head[3];
-        q[7]=head[4]+head[5]/(isLeft?2.0:-2.0);
-        
-        Vector xo=x;
-        // impose homogeneous coordinates
-        if (xo.length()<4)
-            xo.push_back(1.0);
-        else
+    return &cache;
+}
+
+
+/************************************************************************/
+void Localizer::invalidateEyeCache()
+{
+    cacheL.valid=cacheR.valid=false;
+}
+
+
+/************************************************************************/
+bool Localizer::project(const EyeCache &cache, const double *x, double *px) const
+{
+    const Matrix &P=cache.PrjInvH;
+    double p[3];
+    for (int i=0; i<3; i++)
+        p[i]=P(i,0)*x[0]+P(i,1)*x[1]+P(i,2)*x[2]+P(i,3);
+
+    if (p[2]==0.0)
+        return false;
+
+    px[0]=p[0]/p[2];
+    px[1]=p[1]/p[2];
+    return true;
+}
+
+
+/************************************************************************/
+void Localizer::backProject(const EyeCache &cache, const double u, const double v,
+                            const double z, double *x) const
+{
+    // find the 3D position from the 2D projection,
+    // knowing the coordinate z in the camera frame
+    const Matrix &B=cache.HInvPrj;
+    const Matrix &H=cache.H;
+    for (int i=0; i<3; i++)
+        x[i]=z*(B(i,0)*u+B(i,1)*v+B(i,2))+H(i,3);
+}
+
+
+/************************************************************************/
+bool Localizer::triangulate(const double *pxl, const double *pxr, double *x) const
+{
+    // each pixel yields two rows of the system A*x=b, i.e.
+    // ((Prj-px*e3')*inv(H))*[x;1]=0; the least-squares
+    // solution is found through the normal equations
+    double A[4][4];
+    for (int i=0; i<2; i++)
+    {
+        for (int j=0; j<4; j++)
         {
-            xo=xo.subVector(0,3); 
-            xo[3]=1.0;
+            A[i][j]=cacheL.PrjInvH(i,j)-pxl[i]*cacheL.invH(2,j);
+            A[i+2][j]=cacheR.PrjInvH(i,j)-pxr[i]*cacheR.invH(2,j);
         }
+    }
 
-        // find position wrt the camera frame
-        Vector xe=SE3inv(eye->getH(q))*xo;
+    double N[3][3], r[3];
+    for (int i=0; i<3; i++)
+    {
+        r[i]=0.0;
+        for (int k=0; k<4; k++)
+            r[i]-=A[k][i]*A[k][3];
 
-        // find the 2D projection
-        px=*Prj*xe;
-        px=px/px[2];
-        px.pop_back();
+        for (int j=i; j<3; j++)
+        {
+            N[i][j]=0.0;
+            for (int k=0; k<4; k++)
+                N[i][j]+=A[k][i]*A[k][j];
+            N[j][i]=N[i][j];
+        }
+    }
+
+    double C[3][3];
+    C[0][0]=N[1][1]*N[2][2]-N[1][2]*N[2][1];
+    C[0][1]=N[0][2]*N[2][1]-N[0][1]*N[2][2];
+    C[0][2]=N[0][1]*N[1][2]-N[0][2]*N[1][1];
+    C[1][0]=N[1][2]*N[2][0]-N[1][0]*N[2][2];
+    C[1][1]=N[0][0]*N[2][2]-N[0][2]*N[2][0];
+    C[1][2]=N[0][2]*N[1][0]-N[0][0]*N[1][2];
+    C[2][0]=N[1][0]*N[2][1]-N[1][1]*N[2][0];
+    C[2][1]=N[0][1]*N[2][0]-N[0][0]*N[2][1];
+    C[2][2]=N[0][0]*N[1][1]-N[0][1]*N[1][0];
+
+    double det=N[0][0]*C[0][0]+N[0][1]*C[1][0]+N[0][2]*C[2][0];
+    double scale=N[0][0]*N[1][1]*N[2][2];
+    if (fabs(det)<=1e-12*fabs(scale))
+    {
+        // rays (almost) parallel: resort to the pseudo-inverse
+        Matrix M(4,3);
+        Vector b(4);
+        for (int k=0; k<4; k++)
+        {
+            b[k]=-A[k][3];
+            for (int j=0; j<3; j++)
+                M(k,j)=A[k][j];
+        }
+
+        Vector sol=pinv(M)*b;
+        x[0]=sol[0]; x[1]=sol[1]; x[2]=sol[2];
         return true;
     }
+
+    for (int i=0; i<3; i++)
+        x[i]=(C[i][0]*r[0]+C[i][1]*r[1]+C[i][2]*r[2])/det;
+
+    return true;
+}
+
+
+/************************************************************************/
+bool Localizer::projectPoint(const string &type, const Vector &x, Vector &px,
+                             const double stamp)
+{
+    lock_guard<mutex> lck(mtx);
+    if (x.length()<3)
+    {
+        yError("Not enough values given for the point!");
+        return false;
+    }
+
+    bool isLeft=(type=="left");
+    if ((isLeft?PrjL:PrjR)!=nullptr)
+    {
+        const EyeCache *cache=updateEyeCache(isLeft,stamp);
+        if (cache==nullptr)
+            return false;
+
+        // find the 2D projection
+        px.resize(2);
+        if (project(*cache,x.data(),px.data()))
+            return true;
+
+        yError("Point lying on the %s camera plane!",type.c_str());
+        return false;
+    }
     else
     {
         yError("Unspecified projection matrix for %s camera!",type.c_str());
@@ -351,42 +510,18 @@ bool Localizer::projectPoint(const string &type, const Vector &x, Vector &px)
 
 /************************************************************************/
 bool Localizer::projectPoint(const string &type, const double u, const double v,
-                             const double z, Vector &x)
+                             const double z, Vector &x, const double stamp)
 {
     lock_guard<mutex> lck(mtx);
     bool isLeft=(type=="left");
-
-    Matrix  *invPrj=(isLeft?invPrjL:invPrjR);
-    iCubEye *eye=(isLeft?eyeL:eyeR);
-
-    if (invPrj!=nullptr)
+    if ((isLeft?invPrjL:invPrjR)!=nullptr)
     {
-        Vector torso=commData->get_torso();
-        Vector head=commData->get_q();
-
-        Vector q(8);
-        q[0]=torso[0];
-        q[1]=torso[1];
-        q[2]=torso[2];
-        q[3]=head[0];
-        q[4]=head[1];
-        q[5]=head[2];
-        q[6]=head[3];
-        q[7]=head[4]+head[5]/(isLeft?2.0:-2.0);
-
-        Vector p(3);
-        p[0]=z*u;
-        p[1]=z*v;
-        p[2]=z;
-
-        // find the 3D position from the 2D projection,
-        // knowing the coordinate z in the camera frame
-        Vector xe=*invPrj*p;
-        xe[3]=1.0;  // impose homogeneous coordinates
+        const EyeCache *cache=updateEyeCache(isLeft,stamp);
+        if (cache==nullptr)
+            return false;
 
-        // find position wrt the root frame        
-        x=eye->getH(q)*xe;
-        x.pop_back();
+        x.resize(3);
+        backProject(*cache,u,v,z,x.data());
         return true;
     }
     else
@@ -399,7 +534,7 @@ bool Localizer::projectPoint(const string &type, const double u, const double v,
 
 /************************************************************************/
 bool Localizer::projectPoint(const string &type, const double u, const double v,
-                             const Vector &plane, Vector &x)
+                             const Vector &plane, Vector &x, const double stamp)
 {
     if (plane.length()<4)
     {
@@ -407,47 +542,53 @@ bool Localizer::projectPoint(const string &type, const double u, const double v,
         return false;
     }
 
+    lock_guard<mutex> lck(mtx);
     bool isLeft=(type=="left");
-    iCubEye *eye=(isLeft?eyeL:eyeR);
+    if ((isLeft?invPrjL:invPrjR)==nullptr)
+    {
+        yError("Unspecified projection matrix for %s camera!",type.c_str());
+        return false;
+    }
 
-    if (projectPoint(type,u,v,1.0,x))
+    // pick up a point belonging to the plane
+    Vector p0(3,0.0);
+    if (plane[0]!=0.0)
+        p0[0]=-plane[3]/plane[0];
+    else if (plane[1]!=0.0)
+        p0[1]=-plane[3]/plane[1];
+    else if (plane[2]!=0.0)
+        p0[2]=-plane[3]/plane[2];
+    else
     {
-        lock_guard<mutex> lck(mtx);
+        yError("Error while specifying projection plane!");
+        return false;
+    }
 
-        // pick up a point belonging to the plane
-        Vector p0(3,0.0);
-        if (plane[0]!=0.0)
-            p0[0]=-plane[3]/plane[0];
-        else if (plane[1]!=0.0)
-            p0[1]=-plane[3]/plane[1];
-        else if (plane[2]!=0.0)
-            p0[2]=-plane[3]/plane[2];
-        else
-        {
-            yError("Error while specifying projection plane!");
-            return false;
-        }
+    // take a vector orthogonal to the plane
+    Vector n(3);
+    n[0]=plane[0];
+    n[1]=plane[1];
+    n[2]=plane[2];
 
-        // take a vector orthogonal to the plane
-        Vector n(3);
-        n[0]=plane[0];
-        n[1]=plane[1];
-        n[2]=plane[2];
+    const EyeCache *cache=updateEyeCache(isLeft,stamp);
+    if (cache==nullptr)
+        return false;
 
-        // compute the projection
-        Vector e=eye->EndEffPose().subVector(0,2);
-        Vector v=x-e;
-        x=e+(dot(p0-e,n)/dot(v,n))*v;
+    x.resize(3);
+    backProject(*cache,u,v,1.0,x.data());
 
-        return true;
-    }
-    else
-        return false;
+    // compute the projection
+    Vector e=cache->H.getCol(3).subVector(0,2);
+    Vector v=x-e;
+    x=e+(dot(p0-e,n)/dot(v,n))*v;
+
+    return true;
 }
 
 
 /************************************************************************/
-bool Localizer::triangulatePoint(const Vector &pxl, const Vector &pxr, Vector &x)
+bool Localizer::triangulatePoint(const Vector &pxl, const Vector &pxr, Vector &x,
+                                 const double stamp)
 {
     lock_guard<mutex> lck(mtx);
     if ((pxl.length()<2) || (pxr.length()<2))
@@ -458,48 +599,120 @@ bool Localizer::triangulatePoint(const Vector &pxl, const Vector &pxr, Vector &x
 
     if (PrjL && PrjR)
     {
-        Vector torso=commData->get_torso();
-        Vector head=commData->get_q();
+        // both the eyes from the same joints configuration
+        double q[GAZE_HISTORY_DIM];
+        if (!readJoints(stamp,q))
+            return false;
 
-        Vector qL(8);
-        qL[0]=torso[0];
-        qL[1]=torso[1];
-        qL[2]=torso[2];
-        qL[3]=head[0];
-        qL[4]=head[1];
-        qL[5]=head[2];
-        qL[6]=head[3];
-        qL[7]=head[4]+head[5]/2.0;
-
-        Vector qR=qL;
-        qR[7]-=head[5];
-        
-        Matrix HL=SE3inv(eyeL->getH(qL));
-        Matrix HR=SE3inv(eyeR->getH(qR));
+        updateEyeCache(true,q);
+        updateEyeCache(false,q);
 
-        Matrix tmp=zeros(3,4); tmp(2,2)=1.0;
-        tmp(0,2)=pxl[0]; tmp(1,2)=pxl[1];
-        Matrix AL=(*PrjL-tmp)*HL;
+        // solve the least-squares problem
+        x.resize(3);
+        return triangulate(pxl.data(),pxr.data(),x.data());
+    }
+    else
+    {
+        yError("Unspecified projection matrix for at least one camera!");
+        return false;
+    }
+}
 
-        tmp(0,2)=pxr[0]; tmp(1,2)=pxr[1];
-        Matrix AR=(*PrjR-tmp)*HR;
 
-        Matrix A(4,3);
-        Vector b(4);
-        for (int i=0; i<2; i++)
-        {
-            b[i]=-AL(i,3);
-            b[i+2]=-AR(i,3);
+/************************************************************************/
+bool Localizer::projectPoints(const string &type, const Matrix &x, Matrix &px,
+                              const double stamp)
+{
+    lock_guard<mutex> lck(mtx);
+    if (x.cols()<3)
+    {
+        yError("Not enough values given for the points!");
+        return false;
+    }
 
-            for (int j=0; j<3; j++)
+    bool isLeft=(type=="left");
+    if ((isLeft?PrjL:PrjR)!=nullptr)
+    {
+        const EyeCache *cache=updateEyeCache(isLeft,stamp);
+        if (cache==nullptr)
+            return false;
+
+        px.resize(x.rows(),2);
+        for (size_t i=0; i<x.rows(); i++)
+        {
+            if (!project(*cache,x[i],px[i]))
             {
-                A(i,j)=AL(i,j);
-                A(i+2,j)=AR(i,j);
+                yError("Point #%d lying on the %s camera plane!",
+                       (int)i,type.c_str());
+                return false;
             }
         }
 
-        // solve the least-squares problem
-        x=pinv(A)*b;
+        return true;
+    }
+    else
+    {
+        yError("Unspecified projection matrix for %s camera!",type.c_str());
+        return false;
+    }
+}
+
+
+/************************************************************************/
+bool Localizer::backProjectPoints(const string &type, const Matrix &uvz, Matrix &x,
+                                  const double stamp)
+{
+    lock_guard<mutex> lck(mtx);
+    if (uvz.cols()<3)
+    {
+        yError("Not enough values given for the pixels!");
+        return false;
+    }
+
+    bool isLeft=(type=="left");
+    if ((isLeft?invPrjL:invPrjR)!=nullptr)
+    {
+        const EyeCache *cache=updateEyeCache(isLeft,stamp);
+        if (cache==nullptr)
+            return false;
+
+        x.resize(uvz.rows(),3);
+        for (size_t i=0; i<uvz.rows(); i++)
+            backProject(*cache,uvz(i,0),uvz(i,1),uvz(i,2),x[i]);
+
+        return true;
+    }
+    else
+    {
+        yError("Unspecified projection matrix for %s camera!",type.c_str());
+        return false;
+    }
+}
+
+
+/************************************************************************/
+bool Localizer::triangulatePoints(const Matrix &pxlr, Matrix &x, const double stamp)
+{
+    lock_guard<mutex> lck(mtx);
+    if (pxlr.cols()<4)
+    {
+        yError("Not enough values given for the pixels!");
+        return false;
+    }
+
+    if (PrjL && PrjR)
+    {
+        // both the eyes from the same joints configuration
+        double q[GAZE_HISTORY_DIM];
+        if (!readJoints(stamp,q))
+            return false;
+
+        updateEyeCache(true,q);
+        updateEyeCache(false,q);
+
+        x.resize(pxlr.rows(),3);
+        for (size_t i=0; i<pxlr.rows(); i++)
+            triangulate(pxlr[i],pxlr[i]+2,x[i]);
 
         return true;
     }
@@ -683,6 +896,9 @@ bool Localizer::getIntrinsicsMatrix(const string &type, Matrix &M,
 bool Localizer::setIntrinsicsMatrix(const string &type, const Matrix &M,
                                     const int w, const int h)
 {
+    lock_guard<mutex> lck(mtx);
+    invalidateEyeCache();
+
     if (type=="left")
     {
         if (PrjL!=nullptr)
@@ -724,6 +940,15 @@ bool Localizer::setIntrinsicsMatrix(const string &type, const Matrix &M,
 }
 
 
+/************************************************************************/
+bool Localizer::setExtrinsicsMatrix(const string &type, const Matrix &M)
+{
+    lock_guard<mutex> lck(mtx);
+    invalidateEyeCache();
+    return GazeComponent::setExtrinsicsMatrix(type,M);
+}
+
+
 /************************************************************************/
 void Localizer::run()
 {
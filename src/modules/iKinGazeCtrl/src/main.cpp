@@ -228,6 +228,11 @@ Factors</a>.
   retrieved from file will be overwritten by those values
   contained in the tweak file. The \e switch is "on" by default.
 
+--timing_log_dir \e dir
+- The directory where the binary log requested through the
+  "timing log <file>" command is created; if not provided, the
+  command is refused.
+
 \section portsa_sec Ports Accessed
 
 The ports the module is connected to: e.g.
@@ -422,6 +427,24 @@ following ports:
       results from the intersection with the plane expressed
       with its implicit equation ax+by+cz+d=0 in the root
       reference frame.
+    - [get] [2D] (<type> (<x1> <y1> <z1> ... <xn> <yn> <zn>)):
+      batch version of the [get] [2D] request, returning the
+      flat list (<u1> <v1> ... <un> <vn>) of the projections.
+    - [get] [3D] [mono] (<type> (<u1> <v1> <z1> ... <un> <vn> <zn>)):
+      batch version of the [get] [3D] [mono] request, returning
+      the flat list (<x1> <y1> <z1> ... <xn> <yn> <zn>).
+    - [get] [3D] [stereo] ((<ul1> <vl1> <ur1> <vr1> ... )): batch
+      version of the [get] [3D] [stereo] request, returning the
+      flat list (<x1> <y1> <z1> ... <xn> <yn> <zn>).
+      @note Batch requests are served with the same kinematics
+      of the eyes, i.e. the one corresponding to the latest
+      encoders readings.
+    - The [get] [2D] and [get] [3D] requests (except [ang])
+      accept a trailing optional <stamp> [s] (e.g. the stamp of
+      the image where the pixels come from): the projections
+      are then computed with the joints configuration at that
+      time, interpolated from the history of the latest 256
+      encoders readings.
     - [get] [3D] [ang] (<type> <azi> <ele> <ver>): transforms
       angular coordinates into cartesian coordinates. The
       option <type> can be ["abs"|"rel"].
@@ -500,6 +523,15 @@ following ports:
     - [susp]: suspend the module.
     - [run]: resume the module.
     - [status]: returns "running" or "suspended".
+    - timing: returns (name count mean max overruns) of each
+      stage of the control loop, of the whole cycle and of the
+      period, with times in [ms].
+    - timing hist <stage>: returns the histogram of the given
+      stage, "cycle" or "period".
+    - timing reset: reset the timing statistics.
+    - timing log <file>|off: start/stop dumping the timing of
+      each cycle to a binary log, created within the directory
+      given by --timing_log_dir (refused otherwise).
     - [quit]: quit the module.
 
 \note When the tracking mode is active and the controller has
@@ -1066,6 +1098,28 @@ protected:
         }
     }
 
+    /************************************************************************/
+    bool listToPoints(const Bottle *b, const int width, Matrix &m)
+    {
+        if ((b==nullptr) || (b->size()%width!=0))
+            return false;
+
+        m.resize(b->size()/width,width);
+        double *p=m.data();
+        for (size_t i=0; i<b->size(); i++)
+            p[i]=b->get(i).asFloat64();
+
+        return true;
+    }
+
+    /************************************************************************/
+    void pointsToList(const Matrix &m, Bottle &b)
+    {
+        const double *p=m.data();
+        for (size_t i=0; i<m.rows()*m.cols(); i++)
+            b.addFloat64(p[i]);
+    }
+
     /************************************************************************/
     double constrainHeadVersion(const double ver_in)
     {
@@ -1271,6 +1325,7 @@ public:
         // create and start threads
         // creation order does matter (for the minimum allowed vergence computation) !!
         ctrl=new Controller(drvTorso,drvHead,&commData,neckTime,eyesTime,min_abs_vel,10);
+        ctrl->getTimingProbe().setLogDir(rf.check("timing_log_dir",Value("")).asString());
         loc=new Localizer(&commData,10);
         eyesRefGen=new EyePinvRefGen(drvTorso,drvHead,&commData,ctrl,counterRotGain,20);
         slv=new Solver(drvTorso,drvHead,&commData,eyesRefGen,loc,ctrl,20);
@@ -1304,6 +1359,9 @@ public:
 
         if (command.size()>0)
         {
+            if (command.get(0).asString()=="timing")
+                return ctrl->getTimingProbe().respond(command,reply);
+
             switch (command.get(0).asVocab32())
             {
                 //-----------------
@@ -1465,9 +1523,22 @@ public:
                         }
                         else if ((type==createVocab32('2','D')) && (command.size()>2))
                         {
+                            double stamp=(command.size()>3)?command.get(3).asFloat64():-1.0;
                             if (Bottle *bOpt=command.get(2).asList())
                             {
-                                if (bOpt->size()>3)
+                                if ((bOpt->size()>1) && bOpt->get(1).isList())
+                                {
+                                    Matrix x,px;
+                                    string eye=bOpt->get(0).asString();
+                                    if (listToPoints(bOpt->get(1).asList(),3,x) &&
+                                        loc->projectPoints(eye,x,px,stamp))
+                                    {
+                                        reply.addVocab32(ack);
+                                        pointsToList(px,reply.addList());
+                                        return true;
+                                    }
+                                }
+                                else if (bOpt->size()>3)
                                 {
                                     Vector x(3);
                                     string eye=bOpt->get(0).asString();
@@ -1476,7 +1547,7 @@ public:
                                     x[2]=bOpt->get(3).asFloat64();
 
                                     Vector px;
-                                    if (loc->projectPoint(eye,x,px))
+                                    if (loc->projectPoint(eye,x,px,stamp))
                                     {
                                         reply.addVocab32(ack);
                                         reply.addList().read(px);
@@ -1488,11 +1559,24 @@ public:
                         else if ((type==createVocab32('3','D')) && (command.size()>3))
                         {
                             int subType=command.get(2).asVocab32();
+                            double stamp=(command.size()>4)?command.get(4).asFloat64():-1.0;
                             if (subType==createVocab32('m','o','n','o'))
                             {
                                 if (Bottle *bOpt=command.get(3).asList())
                                 {
-                                    if (bOpt->size()>3)
+                                    if ((bOpt->size()>1) && bOpt->get(1).isList())
+                                    {
+                                        Matrix uvz,x;
+                                        string eye=bOpt->get(0).asString();
+                                        if (listToPoints(bOpt->get(1).asList(),3,uvz) &&
+                                            loc->backProjectPoints(eye,uvz,x,stamp))
+                                        {
+                                            reply.addVocab32(ack);
+                                            pointsToList(x,reply.addList());
+                                            return true;
+                                        }
+                                    }
+                                    else if (bOpt->size()>3)
                                     {
                                         string eye=bOpt->get(0).asString();
                                         double u=bOpt->get(1).asFloat64();
@@ -1500,7 +1584,7 @@ public:
                                         double z=bOpt->get(3).asFloat64();
 
                                         Vector x;
-                                        if (loc->projectPoint(eye,u,v,z,x))
+                                        if (loc->projectPoint(eye,u,v,z,x,stamp))
                                         {
                                             reply.addVocab32(ack);
                                             reply.addList().read(x);
@@ -1513,7 +1597,18 @@ public:
                             {
                                 if (Bottle *bOpt=command.get(3).asList())
                                 {
-                                    if (bOpt->size()>3)
+                                    if ((bOpt->size()>0) && bOpt->get(0).isList())
+                                    {
+                                        Matrix pxlr,x;
+                                        if (listToPoints(bOpt->get(0).asList(),4,pxlr) &&
+                                            loc->triangulatePoints(pxlr,x,stamp))
+                                        {
+                                            reply.addVocab32(ack);
+                                            pointsToList(x,reply.addList());
+                                            return true;
+                                        }
+                                    }
+                                    else if (bOpt->size()>3)
                                     {
                                         Vector pxl(2),pxr(2);
                                         pxl[0]=bOpt->get(0).asFloat64();
@@ -1522,7 +1617,7 @@ public:
                                         pxr[1]=bOpt->get(3).asFloat64();
 
                                         Vector x;
-                                        if (loc->triangulatePoint(pxl,pxr,x))
+                                        if (loc->triangulatePoint(pxl,pxr,x,stamp))
                                         {
                                             reply.addVocab32(ack);
                                             reply.addList().read(x);
@@ -1547,7 +1642,7 @@ public:
                                         plane[3]=bOpt->get(6).asFloat64();
 
                                         Vector x;
-                                        if (loc->projectPoint(eye,u,v,plane,x))
+                                        if (loc->projectPoint(eye,u,v,plane,x,stamp))
                                         {
                                             reply.addVocab32(ack);
                                             reply.addList().read(x);
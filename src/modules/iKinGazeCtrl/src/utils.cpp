@@ -24,14 +24,6 @@
 #include <iCub/utils.h>
 #include <iCub/solver.h>
 
-constexpr int32_t MUTEX_XD       = 0;
-constexpr int32_t MUTEX_QD       = 1;
-constexpr int32_t MUTEX_X        = 2;
-constexpr int32_t MUTEX_Q        = 3;
-constexpr int32_t MUTEX_TORSO    = 4;
-constexpr int32_t MUTEX_V        = 5;
-constexpr int32_t MUTEX_COUNTERV = 6;
-constexpr int32_t MUTEX_FPFRAME  = 7;
 
 /************************************************************************/
 xdPort::xdPort(void *_slv) : slv(_slv)
@@ -136,7 +128,24 @@ void xdPort::run()
 
 
 /************************************************************************/
-ExchangeData::ExchangeData()
+void ExchangeVector::set(const Vector &v)
+{
+    len=std::min(v.length(),(size_t)EXCHANGEDATA_MAXLEN);
+    std::copy(v.data(),v.data()+len,data);
+}
+
+
+/************************************************************************/
+void ExchangeVector::get(Vector &v) const
+{
+    if (v.length()!=len)
+        v.resize(len);
+    std::copy(data,data+len,v.data());
+}
+
+
+/************************************************************************/
+ExchangeData::ExchangeData() : history(GAZE_HISTORY_DIM,GAZE_HISTORY_LENGTH)
 {
     imu.resize(12,0.0);
     port_xd=nullptr;
@@ -168,180 +177,200 @@ ExchangeData::ExchangeData()
 /************************************************************************/
 void ExchangeData::resize_v(const int sz, const double val)
 {
-    lock_guard<mutex> lg(mtx[MUTEX_V]);
-    v.resize(sz,val);
+    state.update([&](ExchangeState &s)
+    {
+        s.v.len=std::min((size_t)sz,(size_t)EXCHANGEDATA_MAXLEN);
+        std::fill(s.v.data,s.v.data+s.v.len,val);
+    });
 }
 
 
 /************************************************************************/
 void ExchangeData::resize_counterv(const int sz, const double val)
 {
-    lock_guard<mutex> lg(mtx[MUTEX_COUNTERV]);
-    counterv.resize(sz,val);
+    state.update([&](ExchangeState &s)
+    {
+        s.counterv.len=std::min((size_t)sz,(size_t)EXCHANGEDATA_MAXLEN);
+        std::fill(s.counterv.data,s.counterv.data+s.counterv.len,val);
+    });
 }
 
 
 /************************************************************************/
 void ExchangeData::set_xd(const Vector &_xd)
 {
-    lock_guard<mutex> lg(mtx[MUTEX_XD]);
-    xd=_xd;
+    state.update([&](ExchangeState &s) { s.xd.set(_xd); });
 }
 
 
 /************************************************************************/
 void ExchangeData::set_qd(const Vector &_qd)
 {
-    lock_guard<mutex> lg(mtx[MUTEX_QD]);
-    qd=_qd;
+    state.update([&](ExchangeState &s) { s.qd.set(_qd); });
 }
 
 
 /************************************************************************/
 void ExchangeData::set_qd(const int i, const double val)
 {
-    lock_guard<mutex> lg(mtx[MUTEX_QD]);
-    qd[i]=val;
+    state.update([&](ExchangeState &s)
+    {
+        if ((size_t)i<s.qd.len)
+            s.qd.data[i]=val;
+    });
 }
 
 
 /************************************************************************/
 void ExchangeData::set_x(const Vector &_x)
 {
-    lock_guard<mutex> lg(mtx[MUTEX_X]);
-    x=_x;
+    state.update([&](ExchangeState &s) { s.x.set(_x); });
 }
 
 
 /************************************************************************/
 void ExchangeData::set_x(const Vector &_x, const double stamp)
 {
-    lock_guard<mutex> lg(mtx[MUTEX_X]);
-    x=_x;
-    x_stamp=stamp;
+    state.update([&](ExchangeState &s)
+    {
+        s.x.set(_x);
+        s.x_stamp=stamp;
+    });
 }
 
 
 /************************************************************************/
 void ExchangeData::set_q(const Vector &_q)
 {
-    lock_guard<mutex> lg(mtx[MUTEX_Q]);
-    q=_q;
+    state.update([&](ExchangeState &s) { s.q.set(_q); });
 }
 
 
 /************************************************************************/
 void ExchangeData::set_torso(const Vector &_torso)
 {
-    lock_guard<mutex> lg(mtx[MUTEX_TORSO]);
-    torso=_torso;
+    state.update([&](ExchangeState &s) { s.torso.set(_torso); });
 }
 
 
 /************************************************************************/
 void ExchangeData::set_v(const Vector &_v)
 {
-    lock_guard<mutex> lg(mtx[MUTEX_V]);
-    v=_v;
+    state.update([&](ExchangeState &s) { s.v.set(_v); });
 }
 
 
 /************************************************************************/
 void ExchangeData::set_counterv(const Vector &_counterv)
 {
-    lock_guard<mutex> lg(mtx[MUTEX_COUNTERV]);
-    counterv=_counterv;
+    state.update([&](ExchangeState &s) { s.counterv.set(_counterv); });
 }
 
 
 /************************************************************************/
 void ExchangeData::set_fpFrame(const Matrix &_S)
 {
-    lock_guard<mutex> lg(mtx[MUTEX_FPFRAME]);
-    S=_S;
+    state.update([&](ExchangeState &s)
+    {
+        for (int r=0; r<4; r++)
+            for (int c=0; c<4; c++)
+                s.S[4*r+c]=_S(r,c);
+    });
 }
 
+
+/************************************************************************/
+void ExchangeData::set_feedback(const Vector &_q, const Vector &_torso,
+                                const Vector &_v)
+{
+    state.update([&](ExchangeState &s)
+    {
+        s.q.set(_q);
+        s.torso.set(_torso);
+        s.v.set(_v);
+    });
+}
+
+
 /************************************************************************/
 Vector ExchangeData::get_xd()
 {
-    lock_guard<mutex> lg(mtx[MUTEX_XD]);
-    Vector _xd=xd;
-    return _xd;
+    return state.read().xd.get();
 }
 
 
 /************************************************************************/
 Vector ExchangeData::get_qd()
 {
-    lock_guard<mutex> lg(mtx[MUTEX_QD]);
-    Vector _qd=qd;
-    return _qd;
+    return state.read().qd.get();
 }
 
 
 /************************************************************************/
 Vector ExchangeData::get_x()
 {
-    lock_guard<mutex> lg(mtx[MUTEX_X]);
-    Vector _x=x;
-    return _x;
+    return state.read().x.get();
 }
 
 
 /************************************************************************/
 Vector ExchangeData::get_x(double &stamp)
 {
-    lock_guard<mutex> lg(mtx[MUTEX_X]);
-    Vector _x=x;
-    stamp=x_stamp;
-    return _x;
+    ExchangeState s;
+    state.read(s);
+    stamp=s.x_stamp;
+    return s.x.get();
 }
 
 
 /************************************************************************/
 Vector ExchangeData::get_q()
 {
-    lock_guard<mutex> lg(mtx[MUTEX_Q]);
-    Vector _q=q;
-    return _q;
+    return state.read().q.get();
 }
 
 
 /************************************************************************/
 Vector ExchangeData::get_torso()
 {
-    lock_guard<mutex> lg(mtx[MUTEX_TORSO]);
-    Vector _torso=torso;
-    return _torso;
+    return state.read().torso.get();
 }
 
 
 /************************************************************************/
 Vector ExchangeData::get_v()
 {
-    lock_guard<mutex> lg(mtx[MUTEX_V]);
-    Vector _v=v;
-    return _v;
+    return state.read().v.get();
 }
 
 
 /************************************************************************/
 Vector ExchangeData::get_counterv()
 {
-    lock_guard<mutex> lg(mtx[MUTEX_COUNTERV]);
-    Vector _counterv=counterv;
-    return _counterv;
+    return state.read().counterv.get();
 }
 
 
 /************************************************************************/
 Matrix ExchangeData::get_fpFrame()
 {
-    lock_guard<mutex> lg(mtx[MUTEX_FPFRAME]);
-    Matrix _S=S;
+    ExchangeState s;
+    state.read(s);
+
+    Matrix _S(4,4);
+    for (int r=0; r<4; r++)
+        for (int c=0; c<4; c++)
+            _S(r,c)=s.S[4*r+c];
     return _S;
 }
 
+
+/************************************************************************/
+void ExchangeData::get_snapshot(ExchangeState &snapshot) const
+{
+    state.read(snapshot);
+}
+
 /************************************************************************/
 std::pair<Vector,bool>  ExchangeData::get_gyro() {
     std::pair<Vector, bool> ret;
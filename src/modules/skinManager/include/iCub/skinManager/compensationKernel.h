@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#ifndef __COMPENSATIONKERNEL_H__
+#define __COMPENSATIONKERNEL_H__
+
+namespace iCub{
+
+namespace skinManager{
+
+/**
+* Parameters of the compensation of a skin port, read once per cycle.
+*/
+struct CompensationParams
+{
+    double maxSkin;             // max value of the raw data
+    double addThreshold;        // value added to the touch threshold of every taxel
+    double binTouch;            // output of the binarization filter when touch is detected
+    double binNoTouch;          // output of the binarization filter when no touch is detected
+    float smoothFactor;         // intensity of the smooth filter action
+    bool zeroUpRawData;         // if true the raw data are considered from zero up, otherwise from maxSkin down
+    bool smoothFilter;          // if true the smooth filter is on
+    bool binarization;          // if true binarize the output value
+};
+
+/**
+* Per-taxel arrays of the compensation of a skin port. All of them
+* are contiguous, hold one value per taxel and must not overlap.
+* The flags are 1 when set and 0 otherwise.
+*/
+struct CompensationBuffers
+{
+    const double *raw;          // data read from the skin
+    const double *baselines;    // mean of the raw data
+    const double *thresholds;   // touch thresholds
+    double *compensated;        // compensated data, before filtering
+    double *compensatedOld;     // state of the smooth filter
+    double *compensatedFilt;    // compensated data after the smooth filter
+    double *output;             // data to send (filtered, binarized and trimmed at zero)
+    unsigned char *touch;       // touch detected before filtering
+    unsigned char *subTouch;    // value gone under the baseline
+    unsigned char *touchFilt;   // touch detected after filtering
+};
+
+/**
+* Compensate the raw data of n taxels: baseline subtraction, touch
+* and subtouch detection, smooth filter, binarization and trimming.
+* The options are resolved once per call, so that the loop over the
+* taxels is free of branches and can be vectorized by the compiler;
+* the results are the same as the ones of the per-taxel formulation.
+* @param n the number of taxels
+* @param p the parameters
+* @param b the arrays
+*/
+void compensate(const unsigned int n, const CompensationParams &p, const CompensationBuffers &b);
+
+/**
+* Move the baselines of n taxels toward the compensated data,
+* proportionally to their ratio with the touch thresholds.
+* @param n the number of taxels
+* @param gain the proportional gain for the taxels not in contact
+* @param contactGain the proportional gain for the taxels in contact
+* @param compensated the compensated data (before filtering)
+* @param touch the touch flags (before filtering)
+* @param thresholds the touch thresholds
+* @param baselines the baselines to update
+*/
+void updateBaselines(const unsigned int n, const double gain, const double contactGain,
+                     const double *compensated, const unsigned char *touch,
+                     const double *thresholds, double *baselines);
+
+} //namespace skinManager
+
+} //namespace iCub
+
+#endif
+
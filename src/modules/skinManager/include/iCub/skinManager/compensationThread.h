@@ -139,6 +139,7 @@ private:
 
     // SKIN EVENTS
     bool skinEventsOn;
+    bool skinEventsBinary;              // if true the skin events are sent in the compact binary format
 
     /* ports */
     BufferedPort<skinContactList> skinEventsPort;   // skin events output port
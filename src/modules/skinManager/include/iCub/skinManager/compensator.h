@@ -41,6 +41,9 @@
 #include "iCub/skinDynLib/skinContactList.h"
 #include "iCub/skinDynLib/rpcSkinManager.h"
 #include "iCub/skinDynLib/common.h"
+#include "iCub/skinManager/taxelNeighbors.h"
+#include "iCub/skinManager/taxelClusters.h"
+#include "iCub/skinManager/compensationKernel.h"
 
 using namespace std;
 using namespace yarp::os; 
@@ -71,7 +74,8 @@ private:
     unsigned int linkNum;                       // number of the link
 
     // SKIN CONTACTS
-    vector< list<int> >     neighborsXtaxel;    // list of neighbors for each taxel    
+    TaxelNeighbors          neighbors;          // neighbors of each taxel
+    TaxelClusters           clusters;           // clusters of active taxels (buffers kept across calls)
     vector<Vector>          taxelPos;           // taxel positions {xPos, yPos, zPos}
     vector<Vector>          taxelOri;           // taxel normals {xOri, yOri, zOri}
     Vector                  taxelPoseConfidence;// taxels pose estimation confidence
@@ -79,9 +83,9 @@ private:
     mutex                   poseSem;            // mutex to access taxel poses
 
     // COMPENSATION
-    vector<bool> touchDetected;                 // true if touch has been detected in the last read of the taxel
-    vector<bool> touchDetectedFilt;             // true if touch has been detected after applying the filtering
-    vector<bool> subTouchDetected;              // true if the taxel value has gone under the baseline (because of touch in neighbouring taxels)
+    vector<unsigned char> touchDetected;        // 1 if touch has been detected in the last read of the taxel
+    vector<unsigned char> touchDetectedFilt;    // 1 if touch has been detected after applying the filtering
+    vector<unsigned char> subTouchDetected;     // 1 if the taxel value has gone under the baseline (because of touch in neighbouring taxels)
     Vector rawData;                             // data read from the skin
     Vector touchThresholds;                     // thresholds for discriminating between "touch" and "no touch"
     mutex touchThresholdSem;                    // semaphore for controlling the access to the touchThreshold
@@ -125,6 +125,10 @@ These are the parameters of this section:
     missing calibration procedure for that skin part).
  - \c maxNeighborDist \c 0.015 \n
     maximum distance between two neighbor tactile sensors (in meters).
+ - \c binaryFormat \c [not active] \n
+    if specified the skin events are sent in the compact binary format of skinContactList
+    instead of a Bottle; readers of skinContactList accept both formats transparently,
+    while text-mode connections keep receiving the Bottle format.
  
 
 \section portsa_sec Ports Accessed
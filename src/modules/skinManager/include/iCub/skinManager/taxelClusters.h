@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#ifndef __TAXELCLUSTERS_H__
+#define __TAXELCLUSTERS_H__
+
+#include <vector>
+
+#include "iCub/skinManager/taxelNeighbors.h"
+
+namespace iCub{
+
+namespace skinManager{
+
+/**
+* Clusters of active taxels, i.e. the connected components of the
+* active taxels with respect to their neighborhood, found by a
+* single union-find pass.
+*
+* The clusters are sorted by their lowest taxel id and each one
+* lists its taxels in ascending order. All the buffers are kept
+* across calls, hence no memory is allocated once the number of
+* taxels is stable.
+*/
+class TaxelClusters
+{
+    std::vector<int> parent;                // union-find forest (-1 for inactive taxels)
+    std::vector<unsigned int> activeTaxels; // active taxels in ascending order
+    std::vector<unsigned int> clusterOf;    // cluster of each taxel
+    std::vector<unsigned int> clusterStart; // first taxel of each cluster (one more than the clusters)
+    std::vector<unsigned int> taxels;       // taxels grouped by cluster
+    unsigned int numClusters;
+    unsigned int numSeeds;
+
+    int findRoot(int i);
+
+public:
+    /**
+    * Constructor: no clusters.
+    */
+    TaxelClusters();
+
+    /**
+    * Compute the clusters.
+    * @param neighbors the neighbors of the taxels
+    * @param active nonzero for the active taxels (as many as the neighbors)
+    */
+    void compute(const TaxelNeighbors &neighbors, const std::vector<unsigned char> &active);
+
+    /**
+    * @return the number of clusters
+    */
+    unsigned int size() const { return numClusters; }
+
+    /**
+    * @return the number of taxels of the cluster k
+    */
+    unsigned int count(const unsigned int k) const { return clusterStart[k+1]-clusterStart[k]; }
+
+    /**
+    * @return pointers to the first and past the last taxel of the
+    *         cluster k
+    */
+    const unsigned int* begin(const unsigned int k) const { return taxels.data()+clusterStart[k]; }
+    const unsigned int* end(const unsigned int k) const { return taxels.data()+clusterStart[k+1]; }
+
+    /**
+    * @return the number of active taxels having no active neighbor
+    *         with a lower id, i.e. the number of clusters a scan in
+    *         ascending order of the taxels opens before merging them
+    */
+    unsigned int getNumSeeds() const { return numSeeds; }
+};
+
+} //namespace skinManager
+
+} //namespace iCub
+
+#endif
+
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#ifndef __TAXELNEIGHBORS_H__
+#define __TAXELNEIGHBORS_H__
+
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+
+#include <yarp/sig/Vector.h>
+
+namespace iCub{
+
+namespace skinManager{
+
+/**
+* Neighborhood of the taxels of a skin patch, i.e. for each taxel
+* the (sorted) list of the taxels lying within a given distance.
+*
+* The positions are indexed by a uniform grid whose cells are as
+* large as the max distance, so that the neighbors of a taxel are
+* searched only within the 27 cells surrounding it. The adjacency
+* is stored in compressed rows (CSR), each one with some spare
+* room: when a single taxel moves, only its row and the rows of its
+* old and new neighbors are patched in place, and the arrays are
+* laid out again only when a row runs out of room.
+*/
+class TaxelNeighbors
+{
+    struct Cell
+    {
+        long long x, y, z;
+        bool operator==(const Cell &c) const { return (x==c.x) && (y==c.y) && (z==c.z); }
+    };
+
+    struct CellHash
+    {
+        size_t operator()(const Cell &c) const;
+    };
+
+    static const unsigned int SLACK = 4;    // spare room of each row
+
+    double maxDist;
+    double cellSize;
+    std::vector<double> pos;                // positions {x0, y0, z0, x1, ...}
+    std::vector<Cell> cellOf;               // cell of each taxel
+    std::unordered_map<Cell, std::vector<unsigned int>, CellHash> grid;
+
+    std::vector<unsigned int> rowStart;     // first entry of each row (one more than the taxels)
+    std::vector<unsigned int> rowCount;     // number of neighbors of each taxel
+    std::vector<unsigned int> adj;          // neighbors
+
+    std::vector<unsigned int> tmpNew, tmpOld;
+
+    Cell getCell(const double *p) const;
+    void query(const unsigned int i, std::vector<unsigned int> &out) const;
+    void relayout(const unsigned int i=0, const unsigned int need=0);
+    void removeFromRow(const unsigned int row, const unsigned int j);
+    void insertIntoRow(const unsigned int row, const unsigned int j);
+
+public:
+    /**
+    * Constructor: no taxels.
+    */
+    TaxelNeighbors();
+
+    /**
+    * Recompute the neighbors of all the taxels.
+    * @param positions the taxel positions {x, y, z}
+    * @param maxDist max distance between two neighbor taxels
+    */
+    void build(const std::vector<yarp::sig::Vector> &positions, const double maxDist);
+
+    /**
+    * Move a single taxel and update the neighbors of the taxels
+    * affected by the change.
+    * @param taxelId the taxel id
+    * @param position the new position {x, y, z}
+    * @return false if the id is out of range
+    */
+    bool update(const unsigned int taxelId, const yarp::sig::Vector &position);
+
+    /**
+    * @return the number of taxels
+    */
+    unsigned int size() const { return (unsigned int)rowCount.size(); }
+
+    /**
+    * @return the number of neighbors of the taxel i
+    */
+    unsigned int count(const unsigned int i) const { return rowCount[i]; }
+
+    /**
+    * @return pointers to the first and past the last neighbor of
+    *         the taxel i, sorted in ascending order
+    */
+    const unsigned int* begin(const unsigned int i) const { return adj.data()+rowStart[i]; }
+    const unsigned int* end(const unsigned int i) const { return adj.data()+rowStart[i]+rowCount[i]; }
+
+    /**
+    * Retrieve the min and max number of neighbors among the taxels.
+    */
+    void getStats(unsigned int &minNeighbors, unsigned int &maxNeighbors) const;
+};
+
+} //namespace skinManager
+
+} //namespace iCub
+
+#endif
+
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#include "iCub/skinManager/compensationKernel.h"
+
+using namespace iCub::skinManager;
+
+namespace
+{
+
+// one instance per combination of the options, so that the loops
+// only contain selects and the compiler can vectorize them; the
+// values and the flags are computed in separate loops because the
+// narrowing of the comparisons to bytes keeps the compiler from
+// vectorizing the doubles on plain SSE2
+template<bool zeroUp, bool smooth, bool binarize>
+void compensateTaxels(const unsigned int n, const CompensationParams &p,
+                      const double * __restrict raw, const double * __restrict baselines,
+                      const double * __restrict thresholds, double * __restrict compensated,
+                      double * __restrict compensatedOld, double * __restrict compensatedFilt,
+                      double * __restrict output, unsigned char * __restrict touch,
+                      unsigned char * __restrict subTouch, unsigned char * __restrict touchFilt){
+    const double maxSkin = p.maxSkin;
+    const double add = p.addThreshold;
+    const double binTouch = p.binTouch;
+    const double binNoTouch = p.binNoTouch;
+    // same precision as (1-smoothFactor)*d + smoothFactor*old
+    const double oneMinusFactor = (double)(1-p.smoothFactor);
+    const double factor = (double)p.smoothFactor;
+
+    // the values, over doubles only
+    for(unsigned int i=0; i<n; i++){
+        // baseline compensation
+        double d = (zeroUp ? raw[i] : maxSkin-raw[i]) - baselines[i];
+        d = (d<maxSkin) ? d : maxSkin;
+        compensated[i] = d;
+
+        // smooth filter
+        if(smooth){
+            d = oneMinusFactor*d + factor*compensatedOld[i];
+            compensatedOld[i] = d;
+        }
+        compensatedFilt[i] = d;
+
+        // binarization filter, on the filtered values
+        if(binarize)
+            d = (d>thresholds[i]+add) ? binTouch : binNoTouch;
+
+        // trim only the data to send
+        output[i] = (0.0<d) ? d : 0.0;
+    }
+
+    // the flags: touch and subtouch before filtering, touch after filtering
+    for(unsigned int i=0; i<n; i++){
+        const double thr = thresholds[i]+add;
+        touch[i] = (unsigned char)(compensated[i]>thr);
+        subTouch[i] = (unsigned char)(compensated[i]<-thresholds[i]-add);
+        touchFilt[i] = (unsigned char)(compensatedFilt[i]>thr);
+    }
+}
+
+}
+
+void iCub::skinManager::compensate(const unsigned int n, const CompensationParams &p, const CompensationBuffers &b){
+    typedef void (*Kernel)(const unsigned int, const CompensationParams&,
+                           const double*, const double*, const double*, double*, double*,
+                           double*, double*, unsigned char*, unsigned char*, unsigned char*);
+    static const Kernel kernels[8] = {
+        compensateTaxels<false,false,false>, compensateTaxels<false,false,true>,
+        compensateTaxels<false,true,false>,  compensateTaxels<false,true,true>,
+        compensateTaxels<true,false,false>,  compensateTaxels<true,false,true>,
+        compensateTaxels<true,true,false>,   compensateTaxels<true,true,true>
+    };
+    const int k = (p.zeroUpRawData ? 4 : 0) | (p.smoothFilter ? 2 : 0) | (p.binarization ? 1 : 0);
+    kernels[k](n, p, b.raw, b.baselines, b.thresholds, b.compensated, b.compensatedOld,
+               b.compensatedFilt, b.output, b.touch, b.subTouch, b.touchFilt);
+}
+
+void iCub::skinManager::updateBaselines(const unsigned int n, const double gain, const double contactGain,
+                                        const double * __restrict compensated, const unsigned char * __restrict touch,
+                                        const double * __restrict thresholds, double * __restrict baselines){
+    for(unsigned int j=0; j<n; j++)
+        baselines[j] += (touch[j] ? contactGain : gain)*compensated[j]/thresholds[j];
+}
+
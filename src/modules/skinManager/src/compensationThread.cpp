@@ -135,6 +135,7 @@ bool CompensationThread::threadInit()
 
     // configure the SKIN_EVENT if the corresponding section exists
     skinEventsOn = false;
+    skinEventsBinary = false;
     Bottle &skinEventsConf = rf->findGroup("SKIN_EVENTS");
     if(!skinEventsConf.isNull()){
         yDebug("SKIN_EVENTS section found");
@@ -144,6 +145,11 @@ bool CompensationThread::threadInit()
         else
             skinEventsOn = true;
 
+        if(skinEventsConf.check("binaryFormat")){
+            skinEventsBinary = true;
+            yInfo("Skin events sent in the binary format");
+        }
+
         if(skinEventsConf.check("skinParts")){
             Bottle* skinPartList = skinEventsConf.find("skinParts").asList();
             if(skinPartList->size() != portNum){
@@ -251,6 +257,7 @@ void CompensationThread::run(){
 void CompensationThread::sendSkinEvents(){
     skinContactList &skinEvents = skinEventsPort.prepare();
     skinEvents.clear();
+    skinEvents.setBinaryFormat(skinEventsBinary);
 
     skinContactList temp;
     Stamp timestamp;
@@ -133,12 +133,9 @@ bool Compensator::init(string name, string robotName, string outputPortName, str
     taxelOri.resize(skinDim, zeros(3));
     taxelPoseConfidence.resize(skinDim,0.0);
     maxNeighDist = MAX_NEIGHBOR_DISTANCE;
-    // by default every taxel is neighbor with all the other taxels
-    list<int> defaultNeighbors(skinDim);
-    int i=0;
-    for(list<int>::iterator it=defaultNeighbors.begin();it!=defaultNeighbors.end();it++, i++) 
-        *it = i;
-    neighborsXtaxel.resize(skinDim, defaultNeighbors);
+    // all the positions are unknown (i.e. zero), hence
+    // every taxel is neighbor with all the other taxels
+    neighbors.build(taxelPos, maxNeighDist);
 
     // test read to check if the skin is broken (all taxel output is 0)
     if(robotName!="icubSim" && readInputData(compensatedData)){
@@ -342,105 +339,54 @@ bool Compensator::readRawAndWriteCompensatedData(){
     compensatedData2Send.resize(skinDim);   // local variable with data to send
     compensatedData.resize(skinDim);        // global variable with data to store
     
-    double d;
-    for(unsigned int i=0; i<skinDim; i++){
-        // baseline compensation
-        d =  (double)( zeroUpRawData ? rawData(i)-baselines[i] : MAX_SKIN-rawData(i)-baselines[i] );
-        d =   min<double>( MAX_SKIN, d);
-        compensatedData[i] = d;     // save the data before applying filtering
-
-        // detect touch (before applying filtering, so the compensation algorithm is not affected by the filters)
-        touchDetected[i] = (d > touchThresholds[i] + addThreshold);
-        
-        // detect subtouch
-        subTouchDetected[i] = (d < -touchThresholds[i] - addThreshold);
-        
-        // smooth filter
-        if(smoothFilter){
-            lock_guard<mutex> lck(smoothFactorSem);
-            d = (1-smoothFactor)*d + smoothFactor*compensatedDataOld(i);
-            compensatedDataOld(i) = d;    // update old value
-        }
-        compensatedDataFilt[i] = d;
-
-        // binarization filter
-        // here we don't use the touchDetected array because, if the smooth filter is on,
-        // we want to use the filtered values
-        touchDetectedFilt[i] = (d > touchThresholds[i] + addThreshold);
-        if(binarization)
-            d = ( touchDetectedFilt[i] ? BIN_TOUCH : BIN_NO_TOUCH );
-        
-        compensatedData2Send[i] = max<double>(0.0, d); // trim only data to send because you need negative values for update baseline
-    }
+    // read the parameters once per cycle, then run the whole pipeline in a single pass
+    CompensationParams p;
+    p.maxSkin       = MAX_SKIN;
+    p.addThreshold  = addThreshold;
+    p.binTouch      = BIN_TOUCH;
+    p.binNoTouch    = BIN_NO_TOUCH;
+    p.zeroUpRawData = zeroUpRawData;
+    p.binarization  = binarization;
+    p.smoothFilter  = smoothFilter;
+    {
+        lock_guard<mutex> lck(smoothFactorSem);
+        p.smoothFactor = smoothFactor;
+    }
+
+    CompensationBuffers b;
+    b.raw               = rawData.data();
+    b.baselines         = baselines.data();
+    b.thresholds        = touchThresholds.data();
+    b.compensated       = compensatedData.data();
+    b.compensatedOld    = compensatedDataOld.data();
+    b.compensatedFilt   = compensatedDataFilt.data();
+    b.output            = compensatedData2Send.data();  // trimmed at zero, unlike compensatedData that updateBaseline() needs signed
+    b.touch             = touchDetected.data();
+    b.subTouch          = subTouchDetected.data();
+    b.touchFilt         = touchDetectedFilt.data();
+    compensate(skinDim, p, b);
 
     compensatedTactileDataPort.write();
     return true;
 }
 
 void Compensator::updateBaseline(){
-    double mean_change = 0, change, gain;
-    unsigned int non_touching_taxels = 0;
-    double d; 
+    const double gain = compensationGain*0.02;
+    const double contactGain = contactCompensationGain*0.02;
+    iCub::skinManager::updateBaselines(skinDim, gain, contactGain, compensatedData.data(),
+        touchDetected.data(), touchThresholds.data(), baselines.data());
 
+    // negative baselines are rare, hence they are looked for out of the kernel
     for(unsigned int j=0; j<skinDim; j++) {
-        // *** Algorithm 1
-        /*if(!touchDetected[j]){
-            if(d > 0.5) {
-                baselines[j]        += compensationGain;
-                mean_change            += compensationGain;                //for changing the taxels where we detected touch
-            }else if(d < -0.5) {
-                baselines[j]        -= compensationGain;
-                mean_change            -= compensationGain;                //for changing the taxels where we detected touch
-            }
-        }*/
-
-        // *** Algorithm 2
-        /*if(!(touchDetected[j] || subTouchDetected[j])){
-            non_touching_taxels++;                                        //for changing the taxels where we detected touch
-            d = compensatedData(j);
-            if(fabs(d)>0.5){
-                change          = (compensationGain/50)*d/touchThresholds[j];
-                baselines[j]    += change;
-                mean_change     += change;
-            }
-        }*/
-    
-        d = compensatedData(j);
-        if(touchDetected[j]){
-            gain            = contactCompensationGain*0.02;                
-        }else{
-            gain            = compensationGain*0.02;
-            non_touching_taxels++;
-        }
-        change          = gain*d/touchThresholds[j];
-        baselines[j]    += change;
-        mean_change     += change;
-
-    //        if(j<5)
-    //        printf("%d touch detected %s, change %.6f, gain: %.3f\n", j, touchDetected[j]?"yes":"no", change, touchDetected[j]?contactCompensationGain:compensationGain);
-
         if(baselines[j]<0){
-            char* temp = new char[300];
-            sprintf(temp, "ERROR-Negative baseline. Port %s; tax %d; baseline %.2f; gain: %.4f; d: %.2f; raw: %.2f; change: %f; touchThr: %.2f", 
-                SkinPart_s[skinPart].c_str(), j, baselines[j], gain, d, rawData[j], change, touchThresholds[j]);
+            double g = touchDetected[j] ? contactGain : gain;
+            double d = compensatedData[j];
+            char temp[300];
+            snprintf(temp, sizeof(temp), "ERROR-Negative baseline. Port %s; tax %d; baseline %.2f; gain: %.4f; d: %.2f; raw: %.2f; change: %f; touchThr: %.2f", 
+                SkinPart_s[skinPart].c_str(), j, baselines[j], g, d, rawData[j], g*d/touchThresholds[j], touchThresholds[j]);
             sendInfoMsg(temp);
-        }      
-    }
-    
-    //for compensating the taxels where we detected touch
-    /*if (non_touching_taxels>0 && non_touching_taxels<skinDim && mean_change!=0){
-        mean_change /= non_touching_taxels;
-        for(unsigned int j=0; j<skinDim; j++) {
-            if (touchDetected[j]) {
-                baselines[j]        += mean_change;
-                if(baselines[j]<0){
-                    char* temp = new char[300];
-                    sprintf(temp, "ERROR-Negative baseline. Taxel %d; baseline %.2f; meanchange: %f", j, baselines[j], mean_change);
-                    sendInfoMsg(temp);
-                }
-            }
         }
-    }*/
+    }
 }
 
 bool Compensator::doesBaselineExceed(unsigned int &taxelIndex, double &baseline, double &initialBaseline){
@@ -462,49 +408,9 @@ bool Compensator::doesBaselineExceed(unsigned int &taxelIndex, double &baseline,
 }
 
 skinContactList Compensator::getContacts(){    
-    vector<int>         contactXtaxel(skinDim, -1);     // contact for each taxel (-1 means no contact)
-    deque<deque<int> >  taxelsXcontact;                 // taxels for each contact
-    int                 contactId = 0;                  // id of the next contact to create
-    int                 neighCont;                      // id of the contact of the current neighbor
-
+    // group the active taxels into contacts
     poseSem.lock();
-    {
-        for(unsigned int i=0; i<skinDim; i++){
-            if(touchDetectedFilt[i] ){ // && contactXtaxel[i]<0 (second condition should always be true)
-                list<int> *neighbors = &(neighborsXtaxel[i]);
-                //printf("Taxel %d active. Going to check its %d neighbors\n", i, neighbors->size());
-                for(list<int>::iterator it=neighbors->begin(); it!=neighbors->end(); it++){
-                    neighCont = contactXtaxel[(*it)];
-                    if(neighCont >= 0){                                     // ** if neighbor belongs to a contact
-                        if(contactXtaxel[i]<0){                             // ** add taxel to pre-existing contact
-                            contactXtaxel[i] = neighCont;
-                            taxelsXcontact[neighCont].push_back(i);
-                            //printf("Add taxel to pre existing contact %d (neighbor %d)\n", neighCont, (*neighbors)[n]);
-                        }else if(contactXtaxel[i]!=neighCont){              // ** merge 2 contacts
-                            //mergeContacts(contactXtaxel[i], neighCont);
-                            int newId = min(contactXtaxel[i], neighCont);
-                            int oldId = max(contactXtaxel[i], neighCont);
-                            deque<int> tax2move = taxelsXcontact[oldId];
-                            for(deque<int>::iterator it=tax2move.begin(); it!=tax2move.end(); it++){
-                                contactXtaxel[(*it)] = newId;               // assign new contact id
-                                taxelsXcontact[newId].push_back((*it));     // add taxel ids to contact
-                            }
-                            taxelsXcontact[oldId].clear();      // clear the list of taxels belonging to the merged contact
-                            //printf("Merge two contacts: %d and %d\n", oldId, newId);
-                        }
-                    }
-
-                }
-                if(contactXtaxel[i]<0){            // ** if no neighbor belongs to a contact -> create new contact
-                    contactXtaxel[i] = contactId;
-                    taxelsXcontact.resize(contactId+1);
-                    taxelsXcontact[contactId].push_back(i);
-                    contactId++;
-                    //printf("New contact created: %d\n", contactId-1);
-                }
-            }
-        }
-    }
+    clusters.compute(neighbors, touchDetectedFilt);
     poseSem.unlock();
 
     skinContactList contactList;
@@ -512,9 +418,8 @@ skinContactList Compensator::getContacts(){
     double pressure, pressureCoP, pressureNormal, out;
     int activeTaxels, activeTaxelsGeo;
     vector<unsigned int> taxelList;
-    for( deque<deque<int> >::iterator it=taxelsXcontact.begin(); it!=taxelsXcontact.end(); it++){
-        activeTaxels = it->size();
-        if(activeTaxels==0) continue;
+    for(unsigned int k=0; k<clusters.size(); k++){
+        activeTaxels = clusters.count(k);
         
         taxelList.resize(activeTaxels);
         CoP.zero();
@@ -523,7 +428,7 @@ skinContactList Compensator::getContacts(){
         pressure = pressureCoP = pressureNormal = 0.0;
         activeTaxelsGeo = 0;
         int i=0;
-        for( deque<int>::iterator tax=it->begin(); tax!=it->end(); tax++, i++){
+        for(const unsigned int *tax=clusters.begin(k); tax!=clusters.end(k); tax++, i++){
             out         = max(compensatedDataFilt[(*tax)], 0.0);
             if(norm(taxelPos[(*tax)])!=0.0){  // if the taxel position estimate exists
                 CoP         += taxelPos[(*tax)] * out;
@@ -539,7 +444,8 @@ skinContactList Compensator::getContacts(){
             taxelList[i] = *tax;
         }
         // if this is not the only contact and no taxel in this contact has a position => discard it
-        if(taxelsXcontact.size()>1 && activeTaxelsGeo==0)
+        // (as before, contacts that have been merged together count as distinct ones here)
+        if(clusters.getNumSeeds()>1 && activeTaxelsGeo==0)
             continue;
         if(pressureCoP!=0.0)        CoP         /= pressureCoP;
         if(pressureNormal!=0.0)     normal      /= pressureNormal;
@@ -842,51 +748,17 @@ bool Compensator::setTaxelOrientation(unsigned int taxelId, const Vector &orient
     return true;
 }
 void Compensator::computeNeighbors(){
-    neighborsXtaxel.clear();
-    neighborsXtaxel.resize(skinDim, list<int>(0));
-    Vector v;
-    double d2 = maxNeighDist*maxNeighDist;
-    for(unsigned int i=0; i<skinDim; i++){
-        for(unsigned int j=i+1; j<skinDim; j++){
-            //if(taxelPos[i][0]!=0.0 || taxelPos[i][1]!=0.0 || taxelPos[i][2]!=0.0){  // if the taxel exists
-            v = taxelPos[i]-taxelPos[j];
-            if( dot(v,v) <= d2){
-                neighborsXtaxel[i].push_back(j);
-                neighborsXtaxel[j].push_back(i);
-                //printf("Taxels %d (%s) and %d (%s) are neighbors\n", i, taxelPos[i].toString().c_str(), j, taxelPos[j].toString().c_str());
-            }
-            //}
-        }
-    }
+    neighbors.build(taxelPos, maxNeighDist);
 
-    int minNeighbors=skinDim, maxNeighbors=0, ns;
-    for(unsigned int i=0; i<skinDim; i++){
-        //if(taxelPos[i][0]!=0.0 || taxelPos[i][1]!=0.0 || taxelPos[i][2]!=0.0){  // if the taxel exists
-        ns = neighborsXtaxel[i].size();
-        if(ns>maxNeighbors) maxNeighbors = ns;
-        if(ns<minNeighbors) minNeighbors = ns;
-    }
+    unsigned int minNeighbors, maxNeighbors;
+    neighbors.getStats(minNeighbors, maxNeighbors);
     stringstream ss;
     ss<<"Neighbors computed. Min neighbors: "<<minNeighbors<<"; max neighbors: "<<maxNeighbors;
     sendInfoMsg(ss.str());
 }
 void Compensator::updateNeighbors(unsigned int taxelId){
-    Vector v;
-    double d2 = maxNeighDist*maxNeighDist;
-    // remove all the neighbors of the taxel with id=taxelId
-    neighborsXtaxel[taxelId].clear();
-
-    for(unsigned int i=0; i<skinDim; i++){
-        //if(taxelPos[i][0]!=0.0 || taxelPos[i][1]!=0.0 || taxelPos[i][2]!=0.0){  // if the taxel exists
-        // remove taxelId from the neighbor list (if there is)
-        neighborsXtaxel[i].remove(taxelId);
-        // check whether they are neighbors
-        v = taxelPos[i]-taxelPos[taxelId];
-        if( dot(v,v) <= d2){
-            neighborsXtaxel[i].push_back(taxelId);
-            neighborsXtaxel[taxelId].push_back(i);
-        }
-    }
+    // only the taxels close to the old and new position are affected
+    neighbors.update(taxelId, taxelPos[taxelId]);
 }
 
 void Compensator::sendInfoMsg(string msg){
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#include <algorithm>
+
+#include "iCub/skinManager/taxelClusters.h"
+
+using namespace std;
+using namespace iCub::skinManager;
+
+TaxelClusters::TaxelClusters(): numClusters(0), numSeeds(0){
+    clusterStart.push_back(0);
+}
+
+int TaxelClusters::findRoot(int i){
+    // path halving
+    while(parent[i]!=i){
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+void TaxelClusters::compute(const TaxelNeighbors &neighbors, const vector<unsigned char> &active){
+    unsigned int n = std::min(neighbors.size(), (unsigned int)active.size());
+    parent.assign(n, -1);
+    clusterOf.resize(n);
+    clusterStart.resize(n+1);
+    activeTaxels.clear();
+    numSeeds = 0;
+
+    // union the active taxels with their active neighbors having a lower
+    // id, always keeping the lower root so that each root is the lowest
+    // taxel of its cluster
+    for(unsigned int i=0; i<n; i++){
+        if(!active[i])
+            continue;
+        activeTaxels.push_back(i);
+        int ri = parent[i] = i;
+        bool seed = true;
+        for(const unsigned int *it=neighbors.begin(i); it!=neighbors.end(i) && *it<i; it++){
+            if(parent[*it]<0)
+                continue;
+            seed = false;
+            int rj = findRoot(*it);
+            if(rj<ri){
+                parent[ri] = rj;
+                ri = rj;
+            }
+            else if(ri<rj)
+                parent[rj] = ri;
+        }
+        if(seed)
+            numSeeds++;
+    }
+
+    // number the clusters in ascending order of their roots and count their taxels
+    numClusters = 0;
+    for(unsigned int i : activeTaxels){
+        int r = findRoot(i);
+        if(r==(int)i){
+            clusterOf[i] = numClusters;
+            clusterStart[++numClusters] = 0;
+        }
+        clusterOf[i] = clusterOf[r];
+        clusterStart[clusterOf[i]+1]++;
+    }
+
+    // counting sort of the taxels by cluster, which keeps them in ascending order
+    clusterStart[0] = 0;
+    for(unsigned int k=0; k<numClusters; k++)
+        clusterStart[k+1] += clusterStart[k];
+    taxels.resize(activeTaxels.size());
+    for(unsigned int i : activeTaxels)
+        taxels[clusterStart[clusterOf[i]]++] = i;
+
+    // the previous pass moved each start to the following one
+    for(unsigned int k=numClusters; k>0; k--)
+        clusterStart[k] = clusterStart[k-1];
+    clusterStart[0] = 0;
+}
+
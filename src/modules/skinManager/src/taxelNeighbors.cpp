@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#include <cmath>
+#include <algorithm>
+
+#include "iCub/skinManager/taxelNeighbors.h"
+
+using namespace std;
+using namespace yarp::sig;
+using namespace iCub::skinManager;
+
+size_t TaxelNeighbors::CellHash::operator()(const Cell &c) const{
+    size_t h = (size_t)c.x*73856093u;
+    h ^= (size_t)c.y*19349663u;
+    h ^= (size_t)c.z*83492791u;
+    return h;
+}
+
+TaxelNeighbors::TaxelNeighbors(): maxDist(0.0), cellSize(1.0){
+    rowStart.push_back(0);
+}
+
+TaxelNeighbors::Cell TaxelNeighbors::getCell(const double *p) const{
+    // clamp to keep the conversion well-defined for unreasonable positions
+    const double lim = 1e15;
+    Cell c;
+    c.x = (long long)std::max(-lim, std::min(lim, floor(p[0]/cellSize)));
+    c.y = (long long)std::max(-lim, std::min(lim, floor(p[1]/cellSize)));
+    c.z = (long long)std::max(-lim, std::min(lim, floor(p[2]/cellSize)));
+    return c;
+}
+
+void TaxelNeighbors::query(const unsigned int i, vector<unsigned int> &out) const{
+    out.clear();
+    const double *pi = &pos[3*i];
+    const double d2 = maxDist*maxDist;
+    const Cell &ci = cellOf[i];
+    Cell c;
+    for(c.x=ci.x-1; c.x<=ci.x+1; c.x++){
+        for(c.y=ci.y-1; c.y<=ci.y+1; c.y++){
+            for(c.z=ci.z-1; c.z<=ci.z+1; c.z++){
+                auto it = grid.find(c);
+                if(it==grid.end())
+                    continue;
+                for(unsigned int j : it->second){
+                    if(j==i)
+                        continue;
+                    const double *pj = &pos[3*j];
+                    double dx=pi[0]-pj[0], dy=pi[1]-pj[1], dz=pi[2]-pj[2];
+                    if(dx*dx+dy*dy+dz*dz <= d2)
+                        out.push_back(j);
+                }
+            }
+        }
+    }
+    sort(out.begin(), out.end());
+}
+
+void TaxelNeighbors::relayout(const unsigned int i, const unsigned int need){
+    // lay out the rows again with fresh spare room,
+    // reserving at least need entries for the row i
+    unsigned int n = size();
+    vector<unsigned int> start(n+1);
+    start[0] = 0;
+    for(unsigned int k=0; k<n; k++){
+        unsigned int cap = rowCount[k];
+        if(k==i)
+            cap = std::max(cap, need);
+        start[k+1] = start[k]+cap+SLACK;
+    }
+
+    vector<unsigned int> a(start[n]);
+    for(unsigned int k=0; k<n; k++)
+        copy(begin(k), end(k), a.begin()+start[k]);
+
+    rowStart.swap(start);
+    adj.swap(a);
+}
+
+void TaxelNeighbors::removeFromRow(const unsigned int row, const unsigned int j){
+    unsigned int *b = adj.data()+rowStart[row];
+    unsigned int *e = b+rowCount[row];
+    unsigned int *it = lower_bound(b, e, j);
+    if(it!=e && *it==j){
+        copy(it+1, e, it);
+        rowCount[row]--;
+    }
+}
+
+void TaxelNeighbors::insertIntoRow(const unsigned int row, const unsigned int j){
+    // room is guaranteed by the caller
+    unsigned int *b = adj.data()+rowStart[row];
+    unsigned int *e = b+rowCount[row];
+    unsigned int *it = lower_bound(b, e, j);
+    if(it==e || *it!=j){
+        copy_backward(it, e, e+1);
+        *it = j;
+        rowCount[row]++;
+    }
+}
+
+void TaxelNeighbors::build(const vector<Vector> &positions, const double _maxDist){
+    unsigned int n = (unsigned int)positions.size();
+    maxDist = _maxDist;
+    // cells slightly larger than maxDist, so that no rounding in
+    // getCell() can push two neighbors more than one cell apart
+    cellSize = (maxDist>0.0)? maxDist*(1.0+1e-6): 1.0;
+
+    pos.assign(3*n, 0.0);
+    for(unsigned int i=0; i<n; i++)
+        for(unsigned int k=0; k<3 && k<positions[i].size(); k++)
+            pos[3*i+k] = positions[i][k];
+
+    grid.clear();
+    cellOf.resize(n);
+    for(unsigned int i=0; i<n; i++){
+        cellOf[i] = getCell(&pos[3*i]);
+        grid[cellOf[i]].push_back(i);
+    }
+
+    // gather all the rows contiguously, then add the spare room
+    rowCount.assign(n, 0);
+    rowStart.assign(n+1, 0);
+    adj.clear();
+    for(unsigned int i=0; i<n; i++){
+        query(i, tmpNew);
+        rowStart[i] = (unsigned int)adj.size();
+        rowCount[i] = (unsigned int)tmpNew.size();
+        adj.insert(adj.end(), tmpNew.begin(), tmpNew.end());
+    }
+    rowStart[n] = (unsigned int)adj.size();
+    relayout();
+}
+
+bool TaxelNeighbors::update(const unsigned int taxelId, const Vector &position){
+    if(taxelId>=size())
+        return false;
+
+    double *p = &pos[3*taxelId];
+    for(unsigned int k=0; k<3; k++)
+        p[k] = (k<position.size())? position[k]: 0.0;
+
+    // move the taxel to its new cell
+    Cell c = getCell(p);
+    if(!(c==cellOf[taxelId])){
+        vector<unsigned int> &oldCell = grid[cellOf[taxelId]];
+        auto it = find(oldCell.begin(), oldCell.end(), taxelId);
+        if(it!=oldCell.end()){
+            *it = oldCell.back();
+            oldCell.pop_back();
+        }
+        if(oldCell.empty())
+            grid.erase(cellOf[taxelId]);
+
+        cellOf[taxelId] = c;
+        grid[c].push_back(taxelId);
+    }
+
+    tmpOld.assign(begin(taxelId), end(taxelId));
+    query(taxelId, tmpNew);
+
+    // make sure every row to be extended has enough room
+    bool fits = (tmpNew.size() <= rowStart[taxelId+1]-rowStart[taxelId]);
+    for(unsigned int j : tmpNew){
+        if(!fits)
+            break;
+        if(!binary_search(tmpOld.begin(), tmpOld.end(), j))
+            fits = (rowCount[j] < rowStart[j+1]-rowStart[j]);
+    }
+    if(!fits)
+        relayout(taxelId, (unsigned int)tmpNew.size());
+
+    // patch the rows of the old and new neighbors
+    vector<unsigned int>::const_iterator o = tmpOld.begin(), n = tmpNew.begin();
+    while(o!=tmpOld.end() || n!=tmpNew.end()){
+        if(n==tmpNew.end() || (o!=tmpOld.end() && *o<*n)){
+            removeFromRow(*o, taxelId);
+            o++;
+        }
+        else if(o==tmpOld.end() || *n<*o){
+            insertIntoRow(*n, taxelId);
+            n++;
+        }
+        else{
+            o++;
+            n++;
+        }
+    }
+
+    copy(tmpNew.begin(), tmpNew.end(), adj.begin()+rowStart[taxelId]);
+    rowCount[taxelId] = (unsigned int)tmpNew.size();
+    return true;
+}
+
+void TaxelNeighbors::getStats(unsigned int &minNeighbors, unsigned int &maxNeighbors) const{
+    minNeighbors = size();
+    maxNeighbors = 0;
+    for(unsigned int i=0; i<size(); i++){
+        minNeighbors = std::min(minNeighbors, rowCount[i]);
+        maxNeighbors = std::max(maxNeighbors, rowCount[i]);
+    }
+}
+
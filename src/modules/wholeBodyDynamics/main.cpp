@@ -69,6 +69,27 @@ http://wiki.icub.org/wiki/Force_Control
 --no_legs   
 - this option disables the dynamics computation for the legs joints
 
+--binary_torques
+- the joint torques are streamed over the <part>/Torques:o ports as
+  iCub::ctrl::VectorPacket (address, timestamp and a contiguous array
+  of doubles in a fixed binary layout) instead of Bottles. Readers
+  must use the same format; since the joint_vsens ports of the robot
+  read Bottles, --autoconnect does not connect the torques to them.
+
+--solver_threads \e n
+- the number of threads (default 1) used to solve the whole body
+  dynamics: with n>1 the arms, the head, the torso and the legs are
+  solved concurrently, with results identical to the sequential
+  solver. The latency of each stage of the cycle can be queried
+  through the "latency" rpc command, while the "timing" rpc command
+  gives access to the full statistics, histograms and overruns of
+  each stage (see iCub::ctrl::TimingProbe); both refer to the
+  cycles run since the last "timing reset".
+
+--timing_log_dir \e dir
+- the directory where the "timing log <file>" rpc command creates
+  its binary log; the command is refused if not given.
+
 \section portsa_sec Ports Accessed
 The port the service is listening to.
 
@@ -338,6 +359,21 @@ public:
                 reply.addString("calib arms");
                 reply.addString("calib legs");
                 reply.addString("calib feet");
+                reply.addString("latency");
+                reply.addString("timing [hist <stage>|reset|log <file>|log off]");
+                return true;
+            }
+            else if (command.get(0).asString()=="timing")
+            {
+                if (inv_dyn)
+                    inv_dyn->getTimingProbe().respond(command,reply);
+                return true;
+            }
+            else if (command.get(0).asString()=="latency")
+            {
+                // (stage mean max) in [ms] since the last "timing reset"
+                if (inv_dyn)
+                    inv_dyn->getStageLatency(reply);
                 return true;
             }
             else if (command.get(0).asString()=="calib")
@@ -426,6 +462,16 @@ public:
               autoconnect = false;
         }
 
+        //-------------CHECK THE TORQUES STREAMING FORMAT-----------//
+        bool binary_torques=rf.check("binary_torques");
+        if (binary_torques)
+            yInfo("Streaming joint torques in binary format\n");
+
+        //-------------CHECK THE NUMBER OF SOLVER THREADS------------//
+        int solver_threads=rf.check("solver_threads",Value(1)).asInt32();
+        if (solver_threads>1)
+            yInfo("Solving the whole body dynamics with %d threads\n",solver_threads);
+
         //------------CHECK IF COM COMPUTATION IS ENABLED-----------//
         if (rf.check("no_com"))
         {
@@ -663,7 +709,7 @@ public:
         inertialFilter = new dataFilter(port_filtered_output, m_iGyro, m_iAcc);
 
         //--------------------------THREAD--------------------------
-        inv_dyn = new inverseDynamics(rate, dd_left_arm, dd_right_arm, dd_head, dd_left_leg, dd_right_leg, dd_torso, robot_name, local_name, icub_type, autoconnect);
+        inv_dyn = new inverseDynamics(rate, dd_left_arm, dd_right_arm, dd_head, dd_left_leg, dd_right_leg, dd_torso, robot_name, local_name, icub_type, autoconnect, binary_torques);
         inv_dyn->com_enabled=com_enabled;
         inv_dyn->auto_drift_comp=auto_drift_comp;
         inv_dyn->com_vel_enabled=com_vel_enabled;
@@ -671,6 +717,8 @@ public:
         inv_dyn->w0_dw0_enabled=w0_dw0_enabled;
         inv_dyn->dumpvel_enabled=dump_vel_enabled;
         inv_dyn->default_ee_cont=default_ee_cont;
+        inv_dyn->setSolverThreads(solver_threads>1 ? solver_threads : 1);
+        inv_dyn->getTimingProbe().setLogDir(rf.check("timing_log_dir",Value("")).asString());
 
         yInfo("ft thread istantiated...\n");
         Time::delay(5.0);
@@ -823,6 +871,8 @@ int main(int argc, char * argv[])
         cout << "\t--local      name: the prefix of the ports opened by the module. defualt: wholeBodyDynamics"                  << endl;
         cout << "\t--autoconnect     automatically connects the module ports to iCubInterface"                                   << endl;
         cout << "\t--no_legs         this option disables the dynamics computation for the legs joints"                          << endl;  
+        cout << "\t--binary_torques  streams the joint torques as fixed-layout binary packets instead of Bottles"                 << endl;
+        cout << "\t--solver_threads n  number of threads used to solve the whole body dynamics. default: 1"                      << endl;
         cout << "\t--headV2          use the model of the headV2"                                                                << endl;
         cout << "\t--headV2.6        use the model of the headV2.6"                                                              << endl;
         cout << "\t--headV2.7        use the model of the headV2.7"                                                              << endl;
@@ -250,10 +250,11 @@ void inverseDynamics::setStiffMode()
      }
 }
 
-inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR, PolyDriver *_ddH, PolyDriver *_ddLL, PolyDriver *_ddLR, PolyDriver *_ddT, string _robot_name, string _local_name, version_tag _icub_type, bool _autoconnect) : PeriodicThread((double)_rate/1000.0), ddAL(_ddAL), ddAR(_ddAR), ddH(_ddH), ddLL(_ddLL), ddLR(_ddLR), ddT(_ddT), robot_name(_robot_name), icub_type(_icub_type), local_name(_local_name), zero_sens_tolerance (1e-12)
+inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR, PolyDriver *_ddH, PolyDriver *_ddLL, PolyDriver *_ddLR, PolyDriver *_ddT, string _robot_name, string _local_name, version_tag _icub_type, bool _autoconnect, bool _binary_torques) : PeriodicThread((double)_rate/1000.0), ddAL(_ddAL), ddAR(_ddAR), ddH(_ddH), ddLL(_ddLL), ddLR(_ddLR), ddT(_ddT), robot_name(_robot_name), icub_type(_icub_type), local_name(_local_name), zero_sens_tolerance (1e-12), timing(std::vector<std::string>(stage_names,stage_names+STAGE_NUM),(double)_rate/1000.0)
 {
     status_queue_size = 10;
     autoconnect = _autoconnect;
+    binary_torques = _binary_torques;
     com_enabled = true;
     com_vel_enabled = false;
     dummy_ft    = false;
@@ -296,14 +297,6 @@ inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR
     port_ft_leg_right=new BufferedPort<Vector>;
     port_ft_foot_left=new BufferedPort<Vector>;
     port_ft_foot_right=new BufferedPort<Vector>;
-    port_RATorques = new BufferedPort<Bottle>;
-    port_LATorques = new BufferedPort<Bottle>;
-    port_RLTorques = new BufferedPort<Bottle>;
-    port_LLTorques = new BufferedPort<Bottle>;
-    port_RWTorques = new BufferedPort<Bottle>;
-    port_LWTorques = new BufferedPort<Bottle>;
-    port_TOTorques = new BufferedPort<Bottle>;
-    port_HDTorques = new BufferedPort<Bottle>;
     port_external_wrench_RA = new BufferedPort<Vector>;
     port_external_wrench_LA = new BufferedPort<Vector>;
     port_external_wrench_RL = new BufferedPort<Vector>;
@@ -355,14 +348,14 @@ inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR
     port_ft_leg_right->open(string("/"+local_name+"/right_leg/FT:i").c_str());
     port_ft_foot_left->open(string("/"+local_name+"/left_foot/FT:i").c_str());
     port_ft_foot_right->open(string("/"+local_name+"/right_foot/FT:i").c_str());
-    port_RATorques->open(string("/"+local_name+"/right_arm/Torques:o").c_str());
-    port_LATorques->open(string("/"+local_name+"/left_arm/Torques:o").c_str());
-    port_RLTorques->open(string("/"+local_name+"/right_leg/Torques:o").c_str());
-    port_LLTorques->open(string("/"+local_name+"/left_leg/Torques:o").c_str());
-    port_RWTorques->open(string("/"+local_name+"/right_wrist/Torques:o").c_str());
-    port_LWTorques->open(string("/"+local_name+"/left_wrist/Torques:o").c_str());
-    port_TOTorques->open(string("/"+local_name+"/torso/Torques:o").c_str());
-    port_HDTorques->open(string("/"+local_name+"/head/Torques:o").c_str());
+    openTorquePort("right_arm",port_RATorques,port_RATorques_bin);
+    openTorquePort("left_arm",port_LATorques,port_LATorques_bin);
+    openTorquePort("right_leg",port_RLTorques,port_RLTorques_bin);
+    openTorquePort("left_leg",port_LLTorques,port_LLTorques_bin);
+    openTorquePort("right_wrist",port_RWTorques,port_RWTorques_bin);
+    openTorquePort("left_wrist",port_LWTorques,port_LWTorques_bin);
+    openTorquePort("torso",port_TOTorques,port_TOTorques_bin);
+    openTorquePort("head",port_HDTorques,port_HDTorques_bin);
     port_external_wrench_RA->open(string("/"+local_name+"/right_arm/endEffectorWrench:o").c_str()); 
     port_external_wrench_LA->open(string("/"+local_name+"/left_arm/endEffectorWrench:o").c_str()); 
     port_external_wrench_RL->open(string("/"+local_name+"/right_leg/endEffectorWrench:o").c_str()); 
@@ -419,17 +412,26 @@ inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR
         Network::connect(string("/"+robot_name+"/right_leg/analog:o").c_str(), string("/"+local_name+"/right_leg/FT:i").c_str(),"tcp",false);
         Network::connect(string("/"+robot_name+"/left_foot/analog:o").c_str(),  string("/"+local_name+"/left_foot/FT:i").c_str(),"tcp",false);
         Network::connect(string("/"+robot_name+"/right_foot/analog:o").c_str(), string("/"+local_name+"/right_foot/FT:i").c_str(),"tcp",false);  
-        //from wholeBodyDynamics to iCub (mandatory)
-        Network::connect(string("/"+local_name+"/left_arm/Torques:o").c_str(), string("/"+robot_name+"/joint_vsens/left_arm:i").c_str(),"tcp",false);
-        Network::connect(string("/"+local_name+"/right_arm/Torques:o").c_str(),string("/"+robot_name+"/joint_vsens/right_arm:i").c_str(),"tcp",false);
-        Network::connect(string("/"+local_name+"/left_leg/Torques:o").c_str(), string("/"+robot_name+"/joint_vsens/left_leg:i").c_str(),"tcp",false);
-        Network::connect(string("/"+local_name+"/right_leg/Torques:o").c_str(),string("/"+robot_name+"/joint_vsens/right_leg:i").c_str(),"tcp",false);
-        Network::connect(string("/"+local_name+"/torso/Torques:o").c_str(),    string("/"+robot_name+"/joint_vsens/torso:i").c_str(),"tcp",false);
-        //from wholeBodyDynamics to iCub (optional)
-        if (Network::exists(string("/"+robot_name+"/joint_vsens/left_wrist:i").c_str()))
-        Network::connect(string("/"+local_name+"/left_wrist/Torques:o").c_str(), string("/"+robot_name+"/joint_vsens/left_wrist:i").c_str(),"tcp",false);
-        if (Network::exists(string("/"+robot_name+"/joint_vsens/right_wrist:i").c_str()))
-        Network::connect(string("/"+local_name+"/right_wrist/Torques:o").c_str(),string("/"+robot_name+"/joint_vsens/right_wrist:i").c_str(),"tcp",false);
+        //from wholeBodyDynamics to iCub: the joint_vsens ports read Bottles,
+        //hence they cannot be fed with the torques in binary format
+        if (binary_torques)
+        {
+            yWarning ("Torques are streamed in binary format: the Torques:o ports are not connected to /%s/joint_vsens/*:i",robot_name.c_str());
+        }
+        else
+        {
+            //from wholeBodyDynamics to iCub (mandatory)
+            Network::connect(string("/"+local_name+"/left_arm/Torques:o").c_str(), string("/"+robot_name+"/joint_vsens/left_arm:i").c_str(),"tcp",false);
+            Network::connect(string("/"+local_name+"/right_arm/Torques:o").c_str(),string("/"+robot_name+"/joint_vsens/right_arm:i").c_str(),"tcp",false);
+            Network::connect(string("/"+local_name+"/left_leg/Torques:o").c_str(), string("/"+robot_name+"/joint_vsens/left_leg:i").c_str(),"tcp",false);
+            Network::connect(string("/"+local_name+"/right_leg/Torques:o").c_str(),string("/"+robot_name+"/joint_vsens/right_leg:i").c_str(),"tcp",false);
+            Network::connect(string("/"+local_name+"/torso/Torques:o").c_str(),    string("/"+robot_name+"/joint_vsens/torso:i").c_str(),"tcp",false);
+            //from wholeBodyDynamics to iCub (optional)
+            if (Network::exists(string("/"+robot_name+"/joint_vsens/left_wrist:i").c_str()))
+            Network::connect(string("/"+local_name+"/left_wrist/Torques:o").c_str(), string("/"+robot_name+"/joint_vsens/left_wrist:i").c_str(),"tcp",false);
+            if (Network::exists(string("/"+robot_name+"/joint_vsens/right_wrist:i").c_str()))
+            Network::connect(string("/"+local_name+"/right_wrist/Torques:o").c_str(),string("/"+robot_name+"/joint_vsens/right_wrist:i").c_str(),"tcp",false);
+        }
     }
     yInfo ("Ports connected");
 
@@ -446,6 +448,11 @@ inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR
     linEstLow =new AWLinEstimator(16,1.0);
     quadEstLow=new AWQuadEstimator(25,1.0);
     InertialEst = new AWLinEstimator(16,1.0);
+    linEstUp->setRecursive(true);
+    quadEstUp->setRecursive(true);
+    linEstLow->setRecursive(true);
+    quadEstLow->setRecursive(true);
+    InertialEst->setRecursive(true);
 
     //-----------parts INIT VARIABLES----------------//
     init_upper();
@@ -541,6 +548,7 @@ void iCubStatus::dump (FILE* f)
 void inverseDynamics::run()
 {
     timestamp.update();
+    timing.beginCycle();
 
     thread_status = STATUS_OK;
     static int delay_check=0;
@@ -598,6 +606,7 @@ void inverseDynamics::run()
     Vector F_up(6, 0.0);
     icub->upperTorso->setInertialMeasure(current_status.inertial_w0,current_status.inertial_dw0,current_status.inertial_d2p0);
     icub->upperTorso->setSensorMeasurement(F_RArm,F_LArm,F_up);
+    timing.mark(STAGE_INPUT);
 
 //#define DEBUG_PERFORMANCE
 #ifdef DEBUG_PERFORMANCE
@@ -605,9 +614,20 @@ void inverseDynamics::run()
     static double startTime = 0;
     startTime = Time::now();
 #endif
-    icub->upperTorso->solveKinematics();
-    addSkinContacts();
-    icub->upperTorso->solveWrench();
+    bool parallel_solve = (icub->getNumThreads()>1);
+    if (parallel_solve)
+    {
+        // skin contacts do not depend on the kinematics, hence they are set
+        // in advance and the whole body is solved at once by the workers
+        addSkinContacts();
+        icub->solve(F_RLeg,F_LLeg);
+    }
+    else
+    {
+        icub->upperTorso->solveKinematics();
+        addSkinContacts();
+        icub->upperTorso->solveWrench();
+    }
 #ifdef DEBUG_PERFORMANCE
     meanTime += Time::now()-startTime;
     yDebug("Mean uppertorso NE time: %.4f\n", meanTime/getIterations());
@@ -621,9 +641,12 @@ void inverseDynamics::run()
     yDebug ("UPTORSO: %s \n", icub->upperTorso->getTorsoLinAcc().toString().c_str());
 #endif
 
-    icub->attachLowerTorso(F_RLeg,F_LLeg);
-    icub->lowerTorso->solveKinematics();
-    icub->lowerTorso->solveWrench();
+    if (!parallel_solve)
+    {
+        icub->attachLowerTorso(F_RLeg,F_LLeg);
+        icub->lowerTorso->solveKinematics();
+        icub->lowerTorso->solveWrench();
+    }
 
 //#define DEBUG_KINEMATICS
 #ifdef DEBUG_KINEMATICS
@@ -659,6 +682,7 @@ void inverseDynamics::run()
             icub->lowerTorso->up->getForce(2).toString().c_str(),
             icub->lowerTorso->up->getMoment(2).toString().c_str());
 #endif
+    timing.mark(STAGE_DYNAMICS);
 
     Vector LATorques = icub->upperTorso->getTorques("left_arm");
     Vector RATorques = icub->upperTorso->getTorques("right_arm");
@@ -684,15 +708,16 @@ void inverseDynamics::run()
     yDebug ("TORQUES:     %s ***  \n\n", TOTorques.toString().c_str());
 #endif
 
-    writeTorque(RATorques, 1, port_RATorques); //arm
-    writeTorque(LATorques, 1, port_LATorques); //arm
-    writeTorque(TOTorques, 4, port_TOTorques); //torso
-    writeTorque(HDTorques, 0, port_HDTorques); //head
+    writeTorque(RATorques, 1, port_RATorques, port_RATorques_bin); //arm
+    writeTorque(LATorques, 1, port_LATorques, port_LATorques_bin); //arm
+    writeTorque(TOTorques, 4, port_TOTorques, port_TOTorques_bin); //torso
+    writeTorque(HDTorques, 0, port_HDTorques, port_HDTorques_bin); //head
 
-    if (ddLR) writeTorque(RLTorques, 2, port_RLTorques); //leg
-    if (ddLL) writeTorque(LLTorques, 2, port_LLTorques); //leg
-    writeTorque(RATorques, 3, port_RWTorques); //wrist
-    writeTorque(LATorques, 3, port_LWTorques); //wrist
+    if (ddLR) writeTorque(RLTorques, 2, port_RLTorques, port_RLTorques_bin); //leg
+    if (ddLL) writeTorque(LLTorques, 2, port_LLTorques, port_LLTorques_bin); //leg
+    writeTorque(RATorques, 3, port_RWTorques, port_RWTorques_bin); //wrist
+    writeTorque(LATorques, 3, port_LWTorques, port_LWTorques_bin); //wrist
+    timing.mark(STAGE_TORQUES);
 
     Vector com_all(7), com_ll(7), com_rl(7), com_la(7),com_ra(7), com_hd(7), com_to(7), com_lb(7), com_ub(7);
     double mass_all  , mass_ll  , mass_rl  , mass_la  ,mass_ra  , mass_hd,   mass_to, mass_lb, mass_ub;
@@ -776,6 +801,7 @@ void inverseDynamics::run()
         mass_all=mass_ll=mass_rl=mass_la=mass_ra=mass_hd=mass_to=0.0;
         com_all.zero(); com_ll.zero(); com_rl.zero(); com_la.zero(); com_ra.zero(); com_hd.zero(); com_to.zero();
     }
+    timing.mark(STAGE_COM);
 
     // DYN/SKIN CONTACTS
     dynContacts = icub->upperTorso->leftSensor->getContactList();
@@ -951,6 +977,8 @@ void inverseDynamics::run()
     for (int i=0; i<3; i++) F_ext_cartesian_right_foot[i] = tmp1[i];
     for (int i=3; i<6; i++) F_ext_cartesian_right_foot[i] = tmp2[i-3];
 
+    timing.mark(STAGE_EXTERNAL);
+
     // *** MONITOR DATA ***
     //sendMonitorData();
 
@@ -1005,6 +1033,36 @@ void inverseDynamics::run()
 
     broadcastData<Matrix> (foot_root_mat,                           port_root_position_mat);
     broadcastData<Vector> (foot_root_vec,                           port_root_position_vec);
+    timing.mark(STAGE_OUTPUT);
+    timing.endCycle();
+}
+
+void inverseDynamics::getStageLatency(Bottle &_reply, bool _reset)
+{
+    // (name mean max) per stage [ms], since the last reset; the
+    // statistics are shared with the "timing" rpc command, hence
+    // they are reset only on explicit request
+    Bottle stats;
+    timing.getStatistics(stats);
+    for (size_t i=0; i<stats.size(); i++)
+    {
+        Bottle *ch = stats.get(i).asList();
+        if (ch->get(0).asString()=="period")
+            continue;
+
+        Bottle &b = _reply.addList();
+        b.addString(ch->get(0).asString());
+        b.addFloat64(ch->get(2).asFloat64());
+        b.addFloat64(ch->get(3).asFloat64());
+    }
+
+    if (_reset)
+        timing.reset();
+}
+
+void inverseDynamics::setSolverThreads(unsigned int _n)
+{
+    icub->setNumThreads(_n);
 }
 
 void inverseDynamics::threadRelease()
@@ -1040,20 +1098,28 @@ void inverseDynamics::threadRelease()
 
     yInfo( "Closing RATorques port\n");
     closePort(port_RATorques);
+    closePort(port_RATorques_bin);
     yInfo( "Closing LATorques port\n");
     closePort(port_LATorques);
+    closePort(port_LATorques_bin);
     yInfo( "Closing RLTorques port\n");
     closePort(port_RLTorques);
+    closePort(port_RLTorques_bin);
     yInfo( "Closing LLTorques port\n");
     closePort(port_LLTorques);
+    closePort(port_LLTorques_bin);
     yInfo( "Closing RWTorques port\n");
     closePort(port_RWTorques);
+    closePort(port_RWTorques_bin);
     yInfo( "Closing LWTorques port\n");
     closePort(port_LWTorques);
+    closePort(port_LWTorques_bin);
     yInfo( "Closing TOTorques port\n");
     closePort(port_TOTorques);
+    closePort(port_TOTorques_bin);
     yInfo( "Closing HDTorques port\n");
     closePort(port_HDTorques);
+    closePort(port_HDTorques_bin);
     yInfo( "Closing external_wrench_RA port\n");
     closePort(port_external_wrench_RA);
     yInfo( "Closing external_wrench_LA port\n");
@@ -1166,14 +1232,42 @@ template <class T> void inverseDynamics::broadcastData(T& _values, BufferedPort<
     }
 }
 
-void inverseDynamics::writeTorque(Vector _values, int _address, BufferedPort<Bottle> *_port)
+void inverseDynamics::openTorquePort(const string &_part, BufferedPort<Bottle> *&_port, BufferedPort<VectorPacket> *&_port_bin)
 {
-    Bottle a;
-    a.addInt32(_address);
-    for(size_t i=0;i<_values.length();i++)
-        a.addFloat64(_values(i));
-    _port->prepare() = a;
-    _port->write();
+    string name="/"+local_name+"/"+_part+"/Torques:o";
+    if (binary_torques)
+    {
+        _port=nullptr;
+        _port_bin=new BufferedPort<VectorPacket>;
+        _port_bin->open(name);
+    }
+    else
+    {
+        _port=new BufferedPort<Bottle>;
+        _port->open(name);
+        _port_bin=nullptr;
+    }
+}
+
+void inverseDynamics::writeTorque(const Vector &_values, int _address, BufferedPort<Bottle> *_port, BufferedPort<VectorPacket> *_port_bin)
+{
+    // the port buffers are reused across cycles, so that
+    // no allocation takes place once they are warmed up
+    if (_port_bin)
+    {
+        _port_bin->prepare().set(_values,_address,timestamp.getTime());
+        _port_bin->setEnvelope(timestamp);
+        _port_bin->write();
+    }
+    else if (_port)
+    {
+        Bottle &a=_port->prepare();
+        a.clear();
+        a.addInt32(_address);
+        for(size_t i=0;i<_values.length();i++)
+            a.addFloat64(_values(i));
+        _port->write();
+    }
 }
 
 void inverseDynamics::calibrateOffset(calib_enum calib_code)
@@ -24,6 +24,8 @@
 #include <yarp/dev/all.h>
 #include <iCub/ctrl/math.h>
 #include <iCub/ctrl/adaptWinPolyEstimator.h>
+#include <iCub/ctrl/vectorPacket.h>
+#include <iCub/ctrl/timingProbe.h>
 #include <iCub/iDyn/iDyn.h>
 #include <iCub/iDyn/iDynBody.h>
 #include <iCub/skinDynLib/skinContactList.h>
@@ -47,6 +49,8 @@ constexpr float_t SKIN_EVENTS_TIMEOUT = 0.2;     // max time (in sec) a contact
 
 enum thread_status_enum {STATUS_OK=0, STATUS_DISCONNECTED}; 
 enum calib_enum {CALIB_ALL=0, CALIB_ARMS, CALIB_LEGS, CALIB_FEET};
+enum stage_enum {STAGE_INPUT=0, STAGE_DYNAMICS, STAGE_TORQUES, STAGE_COM, STAGE_EXTERNAL, STAGE_OUTPUT, STAGE_NUM};
+const std::string stage_names[STAGE_NUM] = {"input","dynamics","torques","com","external","output"};
 
 // struct version
 // {
@@ -142,6 +146,7 @@ private:
     string      robot_name;
     string      local_name;
     bool        autoconnect;
+    bool        binary_torques;
     version_tag icub_type;
 
     PolyDriver *ddAL;
@@ -194,6 +199,14 @@ private:
     BufferedPort<Bottle> *port_LWTorques;
     BufferedPort<Bottle> *port_TOTorques;
     BufferedPort<Bottle> *port_HDTorques;
+    BufferedPort<iCub::ctrl::VectorPacket> *port_RATorques_bin;
+    BufferedPort<iCub::ctrl::VectorPacket> *port_RLTorques_bin;
+    BufferedPort<iCub::ctrl::VectorPacket> *port_RWTorques_bin;
+    BufferedPort<iCub::ctrl::VectorPacket> *port_LATorques_bin;
+    BufferedPort<iCub::ctrl::VectorPacket> *port_LLTorques_bin;
+    BufferedPort<iCub::ctrl::VectorPacket> *port_LWTorques_bin;
+    BufferedPort<iCub::ctrl::VectorPacket> *port_TOTorques_bin;
+    BufferedPort<iCub::ctrl::VectorPacket> *port_HDTorques_bin;
     BufferedPort<Vector> *port_external_wrench_RA;
     BufferedPort<Vector> *port_external_wrench_LA;
     BufferedPort<Vector> *port_external_wrench_RL;
@@ -241,6 +254,9 @@ private:
     bool first;
     thread_status_enum thread_status;
 
+    // time spent in each stage of run()
+    iCub::ctrl::TimingProbe timing;
+
     AWLinEstimator  *InertialEst;
     AWLinEstimator  *linEstUp;
     AWQuadEstimator *quadEstUp;
@@ -309,9 +325,12 @@ private:
     void addSkinContacts();
 
 public:
-    inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR, PolyDriver *_ddH, PolyDriver *_ddLL, PolyDriver *_ddLR, PolyDriver *_ddT, string _robot_name, string _local_name, version_tag icub_type, bool _autoconnect=false );
+    inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR, PolyDriver *_ddH, PolyDriver *_ddLL, PolyDriver *_ddLR, PolyDriver *_ddT, string _robot_name, string _local_name, version_tag icub_type, bool _autoconnect=false, bool _binary_torques=false );
     bool threadInit() override;
     void setStiffMode();
+    void setSolverThreads(unsigned int _n);
+    void getStageLatency(Bottle &_reply, bool _reset=false);
+    iCub::ctrl::TimingProbe &getTimingProbe() { return timing; }
     inline thread_status_enum getThreadStatus() 
     {
         return thread_status;
@@ -320,7 +339,8 @@ public:
     void run() override;
     void threadRelease() override;
     void closePort(Contactable *_port);
-    void writeTorque(Vector _values, int _address, BufferedPort<Bottle> *_port);
+    void openTorquePort(const string &_part, BufferedPort<Bottle> *&_port, BufferedPort<iCub::ctrl::VectorPacket> *&_port_bin);
+    void writeTorque(const Vector &_values, int _address, BufferedPort<Bottle> *_port, BufferedPort<iCub::ctrl::VectorPacket> *_port_bin);
     template <class T> void broadcastData(T& _values, BufferedPort<T> *_port);
     void calibrateOffset(calib_enum calib_code=CALIB_ALL);
     bool readAndUpdate(bool waitMeasure=false, bool _init=false);
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+\defgroup iKinReachMapTool iKinReachMap
+
+@ingroup icub_tools
+
+Builds offline the \ref iKinReachMap "reachability map" of an
+iCub arm or leg and saves it to file.
+
+\section intro_sec Description
+The joints space of the limb, torso included for the arms, is
+sampled uniformly within the bounds of the kinematic model and
+the end-effector positions are accumulated into voxels, keeping
+for each of them the best manipulability and the configuration
+attaining it. The resulting file can be given to the
+\ref icub_cartesian_interface "Cartesian Interface" to reject
+unreachable targets and to seed the solver.
+
+\section lib_sec Libraries
+- YARP libraries.
+- \ref iKin "iKin" library.
+
+\section parameters_sec Parameters
+--limb \e limb
+- either \e arm (default) or \e leg.
+
+--type \e type
+- the kinematic type as accepted by iCubArm/iCubLeg (e.g. \e
+  left, \e right_v2; \e left by default).
+
+--resolution \e res
+- the edge of the voxels in meters (0.02 by default).
+
+--samples \e num
+- the number of samples (2000000 by default).
+
+--seed \e seed
+- the seed of the samples generator (0 by default).
+
+--threads \e num
+- the number of threads the kinematics is evaluated by (4 by
+  default).
+
+--out \e file
+- the output file (<limb>_<type>.reach by default).
+
+\section tested_os_sec Tested OS
+Linux
+
+\author Ugo Pattacini
+*/
+
+#include <string>
+
+#include <yarp/os/Log.h>
+#include <yarp/os/Time.h>
+#include <yarp/os/ResourceFinder.h>
+#include <yarp/sig/Vector.h>
+
+#include <iCub/iKin/iKinFwd.h>
+#include <iCub/iKin/iKinReachMap.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace iCub::iKin;
+
+
+/***************************************************************************/
+int main(int argc, char *argv[])
+{
+    ResourceFinder rf;
+    rf.configure(argc,argv);
+
+    string limb=rf.check("limb",Value("arm")).asString();
+    string type=rf.check("type",Value("left")).asString();
+    double resolution=rf.check("resolution",Value(0.02)).asFloat64();
+    int samples=rf.check("samples",Value(2000000)).asInt32();
+    int seed=rf.check("seed",Value(0)).asInt32();
+    int threads=rf.check("threads",Value(4)).asInt32();
+    string out=rf.check("out",Value(limb+"_"+type+".reach")).asString();
+
+    iKinLimb *lmb;
+    if (limb=="arm")
+        lmb=new iCubArm(type);
+    else if (limb=="leg")
+        lmb=new iCubLeg(type);
+    else
+    {
+        yError("unknown limb \"%s\"",limb.c_str());
+        return 1;
+    }
+
+    // the map accounts for all the joints
+    iKinChain &chain=*lmb->asChain();
+    for (unsigned int i=0; i<chain.getN(); i++)
+        chain.releaseLink(i);
+
+    yInfo("sampling %s %s: %d samples, %d DOF, resolution %g [m]",
+          type.c_str(),limb.c_str(),samples,chain.getDOF(),resolution);
+
+    iKinReachMap map;
+    double t0=Time::now();
+    bool ok=map.build(chain,resolution,(size_t)samples,(unsigned int)seed,
+                      (unsigned int)threads);
+    double t1=Time::now();
+    delete lmb;
+
+    if (!ok)
+        return 1;
+
+    Vector lower,upper;
+    map.getBoundingBox(lower,upper);
+    yInfo("map built in %g [s]; bounding box (%s) (%s)",t1-t0,
+          lower.toString(3,3).c_str(),upper.toString(3,3).c_str());
+
+    if (!map.save(out))
+        return 1;
+
+    yInfo("map saved to %s",out.c_str());
+    return 0;
+}
+
+
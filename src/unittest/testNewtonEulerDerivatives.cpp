@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2022 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+ */
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+
+#include <iCub/iDyn/iDyn.h>
+
+using namespace yarp::sig;
+using namespace iCub::iDyn;
+
+namespace
+{
+constexpr double stepSize = 1e-6;
+constexpr double tolerance = 1e-4;
+
+enum class Variable
+{
+    pos,
+    vel,
+    acc
+};
+
+Vector makeState(unsigned int dof, double offset, double scale)
+{
+    Vector v(dof);
+    for (unsigned int i = 0; i < dof; i++)
+        v[i] = scale * (offset + 0.1 * i - 0.05 * (i % 3));
+    return v;
+}
+
+std::vector<unsigned int> activeLinks(iDynChain &chain)
+{
+    std::vector<unsigned int> active;
+    for (unsigned int i = 0; i < chain.getN(); i++)
+        if (!chain.isLinkBlocked(i))
+            active.push_back(i);
+    return active;
+}
+
+void setVariable(iDynChain &chain, Variable var, const Vector &x)
+{
+    switch (var)
+    {
+        case Variable::pos:
+            chain.setAng(x);
+            break;
+        case Variable::vel:
+            chain.setDAng(x);
+            break;
+        case Variable::acc:
+            chain.setD2Ang(x);
+            break;
+    }
+}
+
+Vector activeTorques(iDynChain &chain, const Vector &w0, const Vector &dw0, const Vector &ddp0,
+                     const Vector &Fend, const Vector &Muend)
+{
+    chain.computeNewtonEuler(w0, dw0, ddp0, Fend, Muend);
+    Vector tau = chain.getTorquesNewtonEuler();
+    std::vector<unsigned int> active = activeLinks(chain);
+    Vector ret(active.size());
+    for (size_t i = 0; i < active.size(); i++)
+        ret[i] = tau[active[i]];
+    return ret;
+}
+
+// central differences of the Newton-Euler torques w.r.t. the active joints
+Matrix centralDifferences(iDynChain &chain, Variable var, const Vector &x, const Vector &w0, const Vector &dw0,
+                          const Vector &ddp0, const Vector &Fend, const Vector &Muend)
+{
+    unsigned int dof = chain.getDOF();
+    Matrix D(dof, dof);
+    for (unsigned int j = 0; j < dof; j++)
+    {
+        Vector xp = x;
+        xp[j] += stepSize;
+        setVariable(chain, var, xp);
+        Vector taup = activeTorques(chain, w0, dw0, ddp0, Fend, Muend);
+
+        Vector xm = x;
+        xm[j] -= stepSize;
+        setVariable(chain, var, xm);
+        Vector taum = activeTorques(chain, w0, dw0, ddp0, Fend, Muend);
+
+        for (unsigned int i = 0; i < dof; i++)
+            D(i, j) = (taup[i] - taum[i]) / (2.0 * stepSize);
+    }
+    setVariable(chain, var, x);
+    return D;
+}
+
+void expectNear(const Matrix &A, const Matrix &B)
+{
+    ASSERT_EQ(A.rows(), B.rows());
+    ASSERT_EQ(A.cols(), B.cols());
+    for (size_t i = 0; i < A.rows(); i++)
+        for (size_t j = 0; j < A.cols(); j++)
+            EXPECT_NEAR(A(i, j), B(i, j), tolerance) << "element (" << i << "," << j << ")";
+}
+
+void checkDerivatives(iDynChain &chain)
+{
+    chain.setAllConstraints(false);
+
+    unsigned int dof = chain.getDOF();
+    Vector q = makeState(dof, 0.2, 1.0);
+    Vector dq = makeState(dof, -0.3, 2.0);
+    Vector ddq = makeState(dof, 0.5, 3.0);
+    chain.setAng(q);
+    chain.setDAng(dq);
+    chain.setD2Ang(ddq);
+
+    Vector w0(3), dw0(3), ddp0(3), Fend(3), Muend(3);
+    w0[0] = 0.1;  w0[1] = -0.2; w0[2] = 0.3;
+    dw0[0] = 0.4; dw0[1] = 0.1; dw0[2] = -0.2;
+    ddp0[0] = 0.5; ddp0[1] = -0.3; ddp0[2] = 9.81;
+    Fend[0] = 1.0; Fend[1] = -2.0; Fend[2] = 0.5;
+    Muend[0] = 0.1; Muend[1] = 0.2; Muend[2] = -0.3;
+
+    Matrix dtau_q, dtau_dq, dtau_ddq;
+    ASSERT_TRUE(chain.computeNewtonEulerDerivatives(w0, dw0, ddp0, Fend, Muend, dtau_q, dtau_dq, dtau_ddq));
+
+    expectNear(dtau_q, centralDifferences(chain, Variable::pos, q, w0, dw0, ddp0, Fend, Muend));
+    expectNear(dtau_dq, centralDifferences(chain, Variable::vel, dq, w0, dw0, ddp0, Fend, Muend));
+    expectNear(dtau_ddq, centralDifferences(chain, Variable::acc, ddq, w0, dw0, ddp0, Fend, Muend));
+}
+}  // namespace
+
+TEST(NewtonEulerDerivatives, arm_central_differences)
+{
+    iCubArmDyn arm("right");
+    checkDerivatives(arm);
+}
+
+TEST(NewtonEulerDerivatives, leg_central_differences)
+{
+    iCubLegDyn leg("left");
+    checkDerivatives(leg);
+}
+
+TEST(NewtonEulerDerivatives, arm_blocked_links_central_differences)
+{
+    iCubArmDyn arm("left");
+    arm.releaseLink(0);
+    arm.releaseLink(1);
+    arm.blockLink(2, 0.1);
+    arm.blockLink(6, -0.2);
+    checkDerivatives(arm);
+}